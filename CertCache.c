@@ -0,0 +1,157 @@
+/*
+ *  CertCache.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+#include "GLSHeaders.h"
+
+/* Verified certificates, the oldest entry is replaced when full */
+static pthread_mutex_t m_mutexCertCache = PTHREAD_MUTEX_INITIALIZER;
+static GLSCertVerdict m_certCache[GLS_SIZE_CERT_CACHE];
+static int m_nextCertCache = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ Empty the cache of the verified certificates.
+
+ ---------------------------------------------------------*/
+
+void glsClearCertificateCache(void) {
+
+    pthread_mutex_lock(&m_mutexCertCache);
+    memset(m_certCache, 0, sizeof(m_certCache));
+    m_nextCertCache = 0;
+    pthread_mutex_unlock(&m_mutexCertCache);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ SHA-256 of a certificate (PEM).
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int certFingerprint(const byte* cert, const int certLen, byte* fingerprint) {
+
+    if (cert == NULL || certLen <= 0) return GLS_ERROR_NOCERT;
+
+    gcry_md_hash_buffer(GCRY_MD_SHA256, fingerprint, cert, certLen);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Search the fingerprint of verdict in the cache, an entry
+ outside of its validity is removed.
+
+ Return 1 and fill verdict if found, 0 otherwise.
+
+ ---------------------------------------------------------*/
+
+int findCertVerdict(GLSCertVerdict* verdict) {
+
+    long actualTime = time(NULL);
+    int isFound = 0;
+    int i = 0;
+
+    pthread_mutex_lock(&m_mutexCertCache);
+
+    for (i = 0; i < GLS_SIZE_CERT_CACHE; i++) {
+
+        GLSCertVerdict* entry = &m_certCache[i];
+        if (entry->m_isUsed == 0 || memcmp(entry->m_fingerprint, verdict->m_fingerprint, GLS_SIZE_FINGERPRINT) != 0) continue;
+
+        if (actualTime < entry->m_notBefore || actualTime > entry->m_notAfter) entry->m_isUsed = 0;
+        else {
+            memcpy(verdict, entry, sizeof(GLSCertVerdict));
+            isFound = 1;
+        }
+        break;
+
+    }
+
+    pthread_mutex_unlock(&m_mutexCertCache);
+
+    return isFound;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Add a verdict to the cache (a successful verification),
+ in a free entry or in place of the oldest one.
+
+ ---------------------------------------------------------*/
+
+void storeCertVerdict(const GLSCertVerdict* verdict) {
+
+    int index = -1;
+    int i = 0;
+
+    pthread_mutex_lock(&m_mutexCertCache);
+
+    /* Already added by another thread or free entry */
+    for (i = 0; i < GLS_SIZE_CERT_CACHE; i++) {
+
+        if (m_certCache[i].m_isUsed == 0) {
+            if (index < 0) index = i;
+        }
+        else if (memcmp(m_certCache[i].m_fingerprint, verdict->m_fingerprint, GLS_SIZE_FINGERPRINT) == 0) {
+            index = i;
+            break;
+        }
+
+    }
+
+    if (index < 0) {
+        index = m_nextCertCache;
+        m_nextCertCache = (m_nextCertCache + 1) % GLS_SIZE_CERT_CACHE;
+    }
+
+    memcpy(&m_certCache[index], verdict, sizeof(GLSCertVerdict));
+    m_certCache[index].m_isUsed = 1;
+
+    pthread_mutex_unlock(&m_mutexCertCache);
+
+}
@@ -42,31 +42,23 @@ int addToCrl(GLSSock* myGLSSocket, const char* serial) {
     printf("Serial Size : %ld\n", strlen(serial));
     #endif
     
-    int size = (int) strlen(serial) / 2;
-    char temp[3];
-    byte *keyToAdd = malloc(size + 1);
-    keyToAdd[0] = size;
-    
-    /* Hash conversion (Hexa -> byte) */
-    int i = 0;
-    for (i = 0; i < (size * 2); i += 2) {
+    /* First serial of the socket */
+    if (myGLSSocket->m_crl == NULL) {
         
-        temp[0] = serial[i];
-        temp[1] = serial[i + 1];
-        temp[2] = '\0';
-        keyToAdd[1 + i / 2] = strtoul(temp, 0, 16);
+        myGLSSocket->m_crl = GLSCrlList();
+        if (myGLSSocket->m_crl == NULL) return GLS_ERROR_NOMEM;
         
     }
     
-    /* Add serial to the socket's CRL array */
-    addKeyToArray(keyToAdd, &myGLSSocket->m_crl, &myGLSSocket->m_sizeCrl);
+    /* Add serial to the socket's CRL */
+    int error = addToCrlList(myGLSSocket->m_crl, serial);
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
     printf("### addToCrl() End ###\n\n");
     #endif
     
-    return 0;
+    return error;
 }
 
 
@@ -280,7 +272,8 @@ int charFromFile(const char* fileName, char **content) {
 
 /*-------------------------------------------------------
  
- Add a root certificate for the Register connexion. PEM format.
+ Add a root certificate for the Register connexion. PEM format,
+ it can hold many certificates, added to the roots of the socket.
  Return 0 for success, a negative number for an error.
  
  ---------------------------------------------------------*/
@@ -292,36 +285,27 @@ int addRootCertificate(GLSSock* myGLSSocket, const char* cert) {
     printf("### addRootCertificate() Start ###\n");
     #endif
     
-    if (strlen(cert) < 52) return GLS_ERROR_BADROOTCERT;
-    
-    /* Free memory if cert already set */
-    if (myGLSSocket->m_certRoot != NULL) {
-        free(myGLSSocket->m_certRoot);
-        myGLSSocket->m_certRoot = 0;
-        myGLSSocket->m_certRootSize = 0;
-    }
-    
-    /* memory allocation */
-    myGLSSocket->m_certRoot = malloc(sizeof(byte) * strlen(cert));
-    if (myGLSSocket->m_certRoot == NULL) return GLS_ERROR_NOMEM;
+    if (cert == NULL || strlen(cert) < 52) return GLS_ERROR_BADROOTCERT;
     
-    /* Set the certificate's size */
-    myGLSSocket->m_certRootSize = (int) strlen(cert);
-    
-    /* copy certificate */
-    int i = 0;
-    for (i = 0; i < myGLSSocket->m_certRootSize; i++) {
+    /* First root of the socket */
+    if (myGLSSocket->m_roots == NULL) {
         
-        myGLSSocket->m_certRoot[i] = cert[i];
+        myGLSSocket->m_roots = GLSRootList();
+        if (myGLSSocket->m_roots == NULL) return GLS_ERROR_NOMEM;
         
     }
     
+    /* Parsed and checked once, here */
+    int error = addToRootList(myGLSSocket->m_roots, cert);
+    
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Size cert : %d\n", myGLSSocket->m_certRootSize);
+    printf("Roots added : %d\n", error);
     printf("### addRootCertificate() End ###\n\n");
     #endif
     
+    if (error < 0) return error;
+    
     return 0;
 }
 
@@ -394,6 +378,12 @@ int addServerCertificate(GLSServerSock* myGLSServerSock, const char* publicCert,
     
     if (sizePubCert > 52 && sizePrivCert > 60) {
         
+        /* The clients already accepted keep the old certificate */
+        if (myGLSServerSock->m_serverCert != NULL) {
+            releaseServerCert(myGLSServerSock->m_serverCert);
+            myGLSServerSock->m_serverCert = 0;
+        }
+        
         /* Free memory if cert already set */
         if (myGLSServerSock->m_publicKey != NULL) {
             free(myGLSServerSock->m_publicKey);
@@ -452,6 +442,12 @@ int addServerCertificateFromFile(GLSServerSock* myGLSServerSock, const char* pub
     
     if (sizePubCertFile > 0 && sizePrivCertFile > 0) {
         
+        /* The clients already accepted keep the old certificate */
+        if (myGLSServerSock->m_serverCert != NULL) {
+            releaseServerCert(myGLSServerSock->m_serverCert);
+            myGLSServerSock->m_serverCert = 0;
+        }
+        
         /* Free memory if cert already set */
         if (myGLSServerSock->m_publicKeyFile != NULL) {
             free(myGLSServerSock->m_publicKeyFile);
@@ -497,68 +493,87 @@ int addServerCertificateFromFile(GLSServerSock* myGLSServerSock, const char* pub
  
  PRIVATE
  
- Add the server certificate from a char for the GLSSocket. 
- PEM format. Return 0 for success, a negative 
- number for an error.
+ Parse the server certificate and private key (PEM format)
+ once for all the clients of a server. The private key is
+ kept as a gcrypt S-Exp in secure memory, ready for
+ _decryptWithPK(). The certificate starts with one
+ reference, see releaseServerCert().
+ Return 0 for success, a negative number for an error.
  
  ---------------------------------------------------------*/
 
-int _addServerCertificate(GLSSock* myGLSSocket, const char* publicCert, const char* privateKey) {
+int newServerCert(const char* publicCert, const char* privateKey, GLSServerCert** serverCert) {
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### addServerCertificate() Start ###\n");
+    printf("### newServerCert() Start ###\n");
     #endif
     
-    /* Free memory if certificate already set */
-    if (myGLSSocket->m_publicCert != NULL) {
-        free(myGLSSocket->m_publicCert);
-        myGLSSocket->m_publicCert = 0;
-        myGLSSocket->m_publicCertSize = 0;
-    }
-    if (myGLSSocket->m_privateKey != NULL) {
-        gcry_free(myGLSSocket->m_privateKey);
-        myGLSSocket->m_privateKey = 0;
-        myGLSSocket->m_privateKeySize = 0;
-    }
+    *serverCert = 0;
+    if (publicCert == NULL || privateKey == NULL) return GLS_ERROR_BADSERVERCERT;
+    
+    GLSServerCert* cert = malloc(sizeof(GLSServerCert));
+    if (cert == NULL) return GLS_ERROR_NOMEM;
+    cert->m_publicCertSize = (int) strlen(publicCert);
+    cert->m_privateKey = 0;
+    cert->m_nbRef = 1;
+    pthread_mutex_init(&cert->m_mutexRef, NULL);
     
-    /* memory allocation */
-    myGLSSocket->m_publicCert = malloc(sizeof(byte) * strlen(publicCert));
-    if (myGLSSocket->m_publicCert == NULL) return GLS_ERROR_NOMEM;
-    myGLSSocket->m_privateKey = gcry_malloc_secure(sizeof(byte) * strlen(privateKey));
-    if (myGLSSocket->m_privateKey == NULL) {
+    /* Public certificate, sent as it is in the Register Server message */
+    cert->m_publicCert = malloc(sizeof(byte) * cert->m_publicCertSize);
+    if (cert->m_publicCert == NULL) {
         
-        /* Free memory */
-        if (myGLSSocket->m_publicCert != NULL) {
-            free(myGLSSocket->m_publicCert);
-            myGLSSocket->m_publicCert = 0;
-            myGLSSocket->m_publicCertSize = 0;
-        }
+        free(cert);
         
         return GLS_ERROR_NOMEM;
+        
     }
+    memcpy(cert->m_publicCert, publicCert, cert->m_publicCertSize);
     
-    /* Get size */
-    myGLSSocket->m_publicCertSize = (int) strlen(publicCert);
-    myGLSSocket->m_privateKeySize = (int) strlen(privateKey);
+    /* Key size for decryptWithPK() */
+    cert->m_modulusSize = getModulusSize(cert->m_publicCert, cert->m_publicCertSize);
+    if (cert->m_modulusSize < 0) {
+        
+        int error = cert->m_modulusSize;
+        releaseServerCert(cert);
+        
+        return error;
+        
+    }
     
-    /* copy certificate */
-    int i = 0;
-    for (i = 0; i < myGLSSocket->m_publicCertSize; i++) {
+    /* Base64 PEM private key decoding (to DER) */
+    byte *privateKeyDer = 0;
+    int sizePriv = pemToAsn((const byte*) privateKey, (int) strlen(privateKey), &privateKeyDer);
+    if (sizePriv < 0) {
+        
+        if (privateKeyDer != NULL) free(privateKeyDer);
+        releaseServerCert(cert);
         
-        myGLSSocket->m_publicCert[i] = publicCert[i];
+        return sizePriv;
         
     }
-    for (i = 0; i < myGLSSocket->m_privateKeySize; i++) {
+    
+    /* DER Private key convertion to S-Exp */
+    int error = getPrivateRsaFromDer(privateKeyDer, sizePriv, &cert->m_privateKey);
+    
+    /* The DER key isn't needed anymore */
+    memset(privateKeyDer, 0, sizePriv);
+    free(privateKeyDer);
+    
+    if (error < 0) {
         
-        myGLSSocket->m_privateKey[i] = privateKey[i];
+        releaseServerCert(cert);
+        
+        return error;
         
     }
     
+    *serverCert = cert;
+    
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Size cert : %d\n", myGLSSocket->m_certRootSize);
-    printf("### addServerCertificate() End ###\n\n");
+    printf("Size cert : %d, modulus : %d bits\n", cert->m_publicCertSize, cert->m_modulusSize);
+    printf("### newServerCert() End ###\n\n");
     #endif
     
     return 0;
@@ -572,53 +587,21 @@ int _addServerCertificate(GLSSock* myGLSSocket, const char* publicCert, const ch
  
  PRIVATE
  
- Add the server certificate from a file for the GLSSocket. 
- PEM format. Return 0 for success, a negative 
- number for an error.
+ Same as newServerCert() with the PEM files.
+ Return 0 for success, a negative number for an error.
  
  ---------------------------------------------------------*/
 
-int _addServerCertificateFromFile(GLSSock* myGLSSocket, const char* publicCertFileName, const char* privateKeyFileName) {
+int newServerCertFromFile(const char* publicCertFileName, const char* privateKeyFileName, GLSServerCert** serverCert) {
     
     /* Getting the file */
     char *myPublicFile = 0;
     char *myPrivateFile = 0;
     int error = charFromFile(publicCertFileName, &myPublicFile);
     int error2 = charFromFile(privateKeyFileName, &myPrivateFile);
-    if (error != 0 || error2 !=0) {
-        
-        /* Freeing memory */
-        if (myPublicFile != NULL) {
-            free(myPublicFile);
-            myPublicFile = 0;
-        }
-        if (myPrivateFile != NULL) {
-            free(myPrivateFile);
-            myPrivateFile = 0;
-        }
-        
-        if (error != 0) return error;
-        else return error2;
-        
-    }
     
-    /* adding the file */
-    error = _addServerCertificate(myGLSSocket, myPublicFile, myPrivateFile);
-    if (error != 0) {
-        
-        /* Freeing memory */
-        if (myPublicFile != NULL) {
-            free(myPublicFile);
-            myPublicFile = 0;
-        }
-        if (myPrivateFile != NULL) {
-            free(myPrivateFile);
-            myPrivateFile = 0;
-        }
-
-        return error;
-
-    }
+    if (error == 0 && error2 == 0) error = newServerCert(myPublicFile, myPrivateFile, serverCert);
+    else if (error == 0) error = error2;
     
     /* Freeing memory */
     if (myPublicFile != NULL) {
@@ -626,11 +609,62 @@ int _addServerCertificateFromFile(GLSSock* myGLSSocket, const char* publicCertFi
         myPublicFile = 0;
     }
     if (myPrivateFile != NULL) {
+        memset(myPrivateFile, 0, strlen(myPrivateFile));
         free(myPrivateFile);
         myPrivateFile = 0;
     }
     
-    return 0;
+    return error;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Add a reference to a server certificate (a new client).
+ 
+ ---------------------------------------------------------*/
+
+void retainServerCert(GLSServerCert* serverCert) {
+    
+    pthread_mutex_lock(&serverCert->m_mutexRef);
+    serverCert->m_nbRef++;
+    pthread_mutex_unlock(&serverCert->m_mutexRef);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Remove a reference to a server certificate, the last one
+ frees it (the private key is wiped by gcrypt).
+ 
+ ---------------------------------------------------------*/
+
+void releaseServerCert(GLSServerCert* serverCert) {
+    
+    pthread_mutex_lock(&serverCert->m_mutexRef);
+    int nbRef = --serverCert->m_nbRef;
+    pthread_mutex_unlock(&serverCert->m_mutexRef);
+    
+    if (nbRef > 0) return;
+    
+    if (serverCert->m_publicCert != NULL) free(serverCert->m_publicCert);
+    if (serverCert->m_privateKey != NULL) gcry_sexp_release(serverCert->m_privateKey);
+    pthread_mutex_destroy(&serverCert->m_mutexRef);
+    free(serverCert);
+    
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Delete Server Certificate OK\n");
+    #endif
     
 }
 
@@ -949,7 +983,6 @@ int pemToAsn(const byte *pem, const int pemLen, byte** asn) {
  Return 0 for success or a negative number for an error.
  
   ==> CHECK FOR BUFFER OVERFLOW <==
-  ==> Optimization - one general array ASN1_ARRAY_TYPE <==
   ==> Optimization - allocate memory dynamically <==
 
  ---------------------------------------------------------*/
@@ -965,85 +998,15 @@ int getPublicRsaFromDer(const byte *der, const int sizeDerInBits, gcry_sexp_t *p
     if ((sizeDerInBits % 8) != 0) return GLS_ERROR_ASN1;
     int len = sizeDerInBits / 8;
     
-    ASN1_ARRAY_TYPE def[] = {
-        { "GLS", 536872976, NULL },
-        { NULL, 1073741836, NULL },
-        { "RSAPublicKey", 1610612741, NULL },
-        { "modulus", 1073741827, NULL },
-        { "publicExponent", 3, NULL },
-        { "RSAPrivateKey", 1610612741, NULL },
-        { "version", 1073741826, "Version"},
-        { "modulus", 1073741827, NULL },
-        { "publicExponent", 1073741827, NULL },
-        { "privateExponent", 1073741827, NULL },
-        { "prime1", 1073741827, NULL },
-        { "prime2", 1073741827, NULL },
-        { "exponent1", 1073741827, NULL },
-        { "exponent2", 1073741827, NULL },
-        { "coefficient", 1073741827, NULL },
-        { "otherPrimeInfos", 16386, "OtherPrimeInfos"},
-        { "Version", 1610874883, NULL },
-        { "two-prime", 1073741825, "0"},
-        { "multi", 1, "1"},
-        { "OtherPrimeInfos", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "OtherPrimeInfo"},
-        { "OtherPrimeInfo", 1610612741, NULL },
-        { "prime", 1073741827, NULL },
-        { "exponent", 1073741827, NULL },
-        { "coefficient", 3, NULL },
-        { "AlgorithmIdentifier", 1610612741, NULL },
-        { "algorithm", 1073741836, NULL },
-        { "parameters", 541081613, NULL },
-        { "algorithm", 1, NULL },
-        { "DigestInfo", 1610612741, NULL },
-        { "digestAlgorithm", 1073741826, "DigestAlgorithmIdentifier"},
-        { "digest", 2, "Digest"},
-        { "DigestAlgorithmIdentifier", 1073741826, "AlgorithmIdentifier"},
-        { "Digest", 1073741831, NULL },
-        { "DSAPublicKey", 1073741827, NULL },
-        { "DSAParameters", 1610612741, NULL },
-        { "p", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "g", 3, NULL },
-        { "DSASignatureValue", 1610612741, NULL },
-        { "r", 1073741827, NULL },
-        { "s", 3, NULL },
-        { "DSAPrivateKey", 1610612741, NULL },
-        { "version", 1073741827, NULL },
-        { "p", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "g", 1073741827, NULL },
-        { "Y", 1073741827, NULL },
-        { "priv", 3, NULL },
-        { "DHParameter", 536870917, NULL },
-        { "prime", 1073741827, NULL },
-        { "base", 1073741827, NULL },
-        { "privateValueLength", 16387, NULL },
-        { NULL, 0, NULL }
-    };
-    
-    /* certificate's structure creation */
-    ASN1_TYPE certDef = ASN1_TYPE_EMPTY;
+    /* Definitions compiled once for the whole process */
+    asn1_node certDef = getAsnDefinition(GLS_ASN_GLS);
     char errorDescription[ASN1_MAX_ERROR_DESCRIPTION_SIZE];
-    int result = asn1_array2tree(def, &certDef, errorDescription);
-    if (result != ASN1_SUCCESS) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Problems creating structure asn1_array2tree\n");
-        int i = 0;
-        for (i = 0; i < ASN1_MAX_ERROR_DESCRIPTION_SIZE; i++) {
-            printf("%c", errorDescription[i]);
-        }
-        printf("\n");
-        #endif
-        
-        /* Free memory */
-        asn1_delete_structure(&certDef);
+    int result = ASN1_SUCCESS;
+    if (certDef == NULL) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("ASN1 definitions not available\n");
         printf("### getPublicRsaFromDer() End ###\n\n");
         #endif
         
@@ -1052,7 +1015,7 @@ int getPublicRsaFromDer(const byte *der, const int sizeDerInBits, gcry_sexp_t *p
     }
     
     /* ASN1 structure creation */
-    ASN1_TYPE structDer = ASN1_TYPE_EMPTY;
+    asn1_node structDer = NULL;
     result = asn1_create_element(certDef, "GLS.RSAPublicKey", &structDer);
     int result2 = asn1_der_decoding(&structDer, der, len, errorDescription);
     if (result != ASN1_SUCCESS || result2 != ASN1_SUCCESS) {
@@ -1074,7 +1037,6 @@ int getPublicRsaFromDer(const byte *der, const int sizeDerInBits, gcry_sexp_t *p
         
         /* Free memory */
         asn1_delete_structure(&structDer);
-        asn1_delete_structure(&certDef);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -1101,7 +1063,6 @@ int getPublicRsaFromDer(const byte *der, const int sizeDerInBits, gcry_sexp_t *p
         
         /* Free memory */
         asn1_delete_structure(&structDer);
-        asn1_delete_structure(&certDef);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -1134,7 +1095,6 @@ int getPublicRsaFromDer(const byte *der, const int sizeDerInBits, gcry_sexp_t *p
         
         /* Free memory */
         asn1_delete_structure(&structDer);
-        asn1_delete_structure(&certDef);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -1147,7 +1107,6 @@ int getPublicRsaFromDer(const byte *der, const int sizeDerInBits, gcry_sexp_t *p
         
     /* Free memory */
     asn1_delete_structure(&structDer);
-    asn1_delete_structure(&certDef);
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -1169,7 +1128,6 @@ int getPublicRsaFromDer(const byte *der, const int sizeDerInBits, gcry_sexp_t *p
  Return 0 for success or a negative number for an error.
  
  ==> CHECK FOR BUFFER OVERFLOW <==
- ==> Optimization - one general array ASN1_ARRAY_TYPE <==
  ==> Optimization - allocate memory dynamically <==
  
  ---------------------------------------------------------*/
@@ -1183,85 +1141,15 @@ int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privat
     
     int len = sizeDer;
     
-    ASN1_ARRAY_TYPE def[] = {
-        { "GLS", 536872976, NULL },
-        { NULL, 1073741836, NULL },
-        { "RSAPublicKey", 1610612741, NULL },
-        { "modulus", 1073741827, NULL },
-        { "publicExponent", 3, NULL },
-        { "RSAPrivateKey", 1610612741, NULL },
-        { "version", 1073741826, "Version"},
-        { "modulus", 1073741827, NULL },
-        { "publicExponent", 1073741827, NULL },
-        { "privateExponent", 1073741827, NULL },
-        { "prime1", 1073741827, NULL },
-        { "prime2", 1073741827, NULL },
-        { "exponent1", 1073741827, NULL },
-        { "exponent2", 1073741827, NULL },
-        { "coefficient", 1073741827, NULL },
-        { "otherPrimeInfos", 16386, "OtherPrimeInfos"},
-        { "Version", 1610874883, NULL },
-        { "two-prime", 1073741825, "0"},
-        { "multi", 1, "1"},
-        { "OtherPrimeInfos", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "OtherPrimeInfo"},
-        { "OtherPrimeInfo", 1610612741, NULL },
-        { "prime", 1073741827, NULL },
-        { "exponent", 1073741827, NULL },
-        { "coefficient", 3, NULL },
-        { "AlgorithmIdentifier", 1610612741, NULL },
-        { "algorithm", 1073741836, NULL },
-        { "parameters", 541081613, NULL },
-        { "algorithm", 1, NULL },
-        { "DigestInfo", 1610612741, NULL },
-        { "digestAlgorithm", 1073741826, "DigestAlgorithmIdentifier"},
-        { "digest", 2, "Digest"},
-        { "DigestAlgorithmIdentifier", 1073741826, "AlgorithmIdentifier"},
-        { "Digest", 1073741831, NULL },
-        { "DSAPublicKey", 1073741827, NULL },
-        { "DSAParameters", 1610612741, NULL },
-        { "p", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "g", 3, NULL },
-        { "DSASignatureValue", 1610612741, NULL },
-        { "r", 1073741827, NULL },
-        { "s", 3, NULL },
-        { "DSAPrivateKey", 1610612741, NULL },
-        { "version", 1073741827, NULL },
-        { "p", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "g", 1073741827, NULL },
-        { "Y", 1073741827, NULL },
-        { "priv", 3, NULL },
-        { "DHParameter", 536870917, NULL },
-        { "prime", 1073741827, NULL },
-        { "base", 1073741827, NULL },
-        { "privateValueLength", 16387, NULL },
-        { NULL, 0, NULL }
-    };
-    
-    /* Certificate's structure creation */
-    ASN1_TYPE certDef = ASN1_TYPE_EMPTY;
+    /* Definitions compiled once for the whole process */
+    asn1_node certDef = getAsnDefinition(GLS_ASN_GLS);
     char errorDescription[ASN1_MAX_ERROR_DESCRIPTION_SIZE];
-    int result = asn1_array2tree(def, &certDef, errorDescription);
-    if (result != ASN1_SUCCESS) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Problems creating structure asn1_array2tree\n");
-        int i = 0;
-        for (i = 0; i < ASN1_MAX_ERROR_DESCRIPTION_SIZE; i++) {
-            printf("%c", errorDescription[i]);
-        }
-        printf("\n");
-        #endif
-        
-        /* Free memory */
-        asn1_delete_structure(&certDef);
+    int result = ASN1_SUCCESS;
+    if (certDef == NULL) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("ASN1 definitions not available\n");
         printf("### getPrivateRsaFromDer() End ###\n\n");
         #endif
         
@@ -1270,7 +1158,7 @@ int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privat
     }
     
     /* ASN1 structure creation */
-    ASN1_TYPE structDer = ASN1_TYPE_EMPTY;
+    asn1_node structDer = NULL;
     result = asn1_create_element(certDef, "GLS.RSAPrivateKey", &structDer);
     int result2 = asn1_der_decoding(&structDer, der, len, errorDescription);
     if (result != ASN1_SUCCESS || result2 != ASN1_SUCCESS) {
@@ -1292,7 +1180,6 @@ int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privat
         
         /* Free memory */
         asn1_delete_structure(&structDer);
-        asn1_delete_structure(&certDef);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -1331,7 +1218,6 @@ int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privat
         
         /* Free memory */
         asn1_delete_structure(&structDer);
-        asn1_delete_structure(&certDef);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -1364,7 +1250,6 @@ int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privat
         
         /* Free memory */
         asn1_delete_structure(&structDer);
-        asn1_delete_structure(&certDef);
         gcry_mpi_release(mpiModulus);
         gcry_mpi_release(mpiPublicExponent);
         gcry_mpi_release(mpiSecretExponent);
@@ -1391,6 +1276,12 @@ int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privat
         
     }
     
+    /* Secret values in secure memory, the S-Exp is then built in secure memory too */
+    gcry_mpi_set_flag(mpiSecretExponent, GCRYMPI_FLAG_SECURE);
+    gcry_mpi_set_flag(mpiSecretPrimeP, GCRYMPI_FLAG_SECURE);
+    gcry_mpi_set_flag(mpiSecretPrimeQ, GCRYMPI_FLAG_SECURE);
+    gcry_mpi_set_flag(mpiMultInverse, GCRYMPI_FLAG_SECURE);
+    
     int error = gcry_sexp_build(privateKey, NULL, "(private-key(rsa(n %m)(e %m)(d %m)(p %m)(q %m)(u %m)))", mpiModulus, mpiPublicExponent, mpiSecretExponent, mpiSecretPrimeP, mpiSecretPrimeQ, mpiMultInverse);
     if (error != 0) {
         
@@ -1401,7 +1292,6 @@ int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privat
         
         /* Free memory */
         asn1_delete_structure(&structDer);
-        asn1_delete_structure(&certDef);
         gcry_mpi_release(mpiModulus);
         gcry_mpi_release(mpiPublicExponent);
         gcry_mpi_release(mpiSecretExponent);
@@ -1420,7 +1310,6 @@ int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privat
     
     /* Free memory */
     asn1_delete_structure(&structDer);
-    asn1_delete_structure(&certDef);
     gcry_mpi_release(mpiModulus);
     gcry_mpi_release(mpiPublicExponent);
     gcry_mpi_release(mpiSecretExponent);
@@ -1444,1679 +1333,226 @@ int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privat
  
  PRIVATE
  
- Check the certificate validity, return 0 for OK or a
- negative number for an error.
+ Verify the certificate with its root (found in the list
+ by the issuer name) : validity dates and signature. The
+ roots were checked when added to the list. The serial
+ number (as a CRL entry), the root and the validity window
+ are kept in verdict for the cache, the CRL itself is
+ checked by checkCertificate().
+ 
+ Return 0 for OK or a negative number for an error.
  
  ---------------------------------------------------------*/
 
-int checkCertificate(GLSSock* myGLSSocket, const byte *cert, const int certLen) {
+int verifyCertificate(GLSRoots* roots, const byte *cert, const int certLen, GLSCertVerdict* verdict) {
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### checkCertificate() Start ###\n");
+    printf("### verifyCertificate() Start ###\n");
     #endif
     
-    /* Check for a root certificate */
-    if (myGLSSocket->m_certRoot == NULL) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("No root certificate");
-        printf("### checkCertificate() End ###\n\n");
-        #endif
-        
-        return GLS_ERROR_NOCERT;
-        
-    }
-    
-    /* Certificate's structure definition */
-    ASN1_ARRAY_TYPE structCertificat[] = {
-        { "PKIX1Implicit88", 536875024, NULL },
-        { NULL, 1610612748, NULL },
-        { "iso", 1073741825, "1"},
-        { "identified-organization", 1073741825, "3"},
-        { "dod", 1073741825, "6"},
-        { "internet", 1073741825, "1"},
-        { "security", 1073741825, "5"},
-        { "mechanisms", 1073741825, "5"},
-        { "pkix", 1073741825, "7"},
-        { "id-mod", 1073741825, "0"},
-        { "id-pkix1-implicit-88", 1, "2"},
-        { "id-ce", 1879048204, NULL },
-        { "joint-iso-ccitt", 1073741825, "2"},
-        { "ds", 1073741825, "5"},
-        { NULL, 1, "29"},
-        { "id-ce-authorityKeyIdentifier", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "35"},
-        { "AuthorityKeyIdentifier", 1610612741, NULL },
-        { "keyIdentifier", 1610637314, "KeyIdentifier"},
-        { NULL, 4104, "0"},
-        { "authorityCertIssuer", 1610637314, "GeneralNames"},
-        { NULL, 4104, "1"},
-        { "authorityCertSerialNumber", 536895490, "CertificateSerialNumber"},
-        { NULL, 4104, "2"},
-        { "KeyIdentifier", 1073741831, NULL },
-        { "id-ce-subjectKeyIdentifier", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "14"},
-        { "SubjectKeyIdentifier", 1073741826, "KeyIdentifier"},
-        { "id-ce-keyUsage", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "15"},
-        { "KeyUsage", 1610874886, NULL },
-        { "digitalSignature", 1073741825, "0"},
-        { "nonRepudiation", 1073741825, "1"},
-        { "keyEncipherment", 1073741825, "2"},
-        { "dataEncipherment", 1073741825, "3"},
-        { "keyAgreement", 1073741825, "4"},
-        { "keyCertSign", 1073741825, "5"},
-        { "cRLSign", 1073741825, "6"},
-        { "encipherOnly", 1073741825, "7"},
-        { "decipherOnly", 1, "8"},
-        { "id-ce-privateKeyUsagePeriod", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "16"},
-        { "PrivateKeyUsagePeriod", 1610612741, NULL },
-        { "notBefore", 1619025937, NULL },
-        { NULL, 4104, "0"},
-        { "notAfter", 545284113, NULL },
-        { NULL, 4104, "1"},
-        { "id-ce-certificatePolicies", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "32"},
-        { "CertificatePolicies", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "PolicyInformation"},
-        { "PolicyInformation", 1610612741, NULL },
-        { "policyIdentifier", 1073741826, "CertPolicyId"},
-        { "policyQualifiers", 538984459, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "PolicyQualifierInfo"},
-        { "CertPolicyId", 1073741836, NULL },
-        { "PolicyQualifierInfo", 1610612741, NULL },
-        { "policyQualifierId", 1073741826, "PolicyQualifierId"},
-        { "qualifier", 541065229, NULL },
-        { "policyQualifierId", 1, NULL },
-        { "PolicyQualifierId", 1073741836, NULL },
-        { "CPSuri", 1073741826, "IA5String"},
-        { "UserNotice", 1610612741, NULL },
-        { "noticeRef", 1073758210, "NoticeReference"},
-        { "explicitText", 16386, "DisplayText"},
-        { "NoticeReference", 1610612741, NULL },
-        { "organization", 1073741826, "DisplayText"},
-        { "noticeNumbers", 536870923, NULL },
-        { NULL, 3, NULL },
-        { "DisplayText", 1610612754, NULL },
-        { "visibleString", 1612709890, "VisibleString"},
-        { "200", 524298, "1"},
-        { "bmpString", 1612709890, "BMPString"},
-        { "200", 524298, "1"},
-        { "utf8String", 538968066, "UTF8String"},
-        { "200", 524298, "1"},
-        { "id-ce-policyMappings", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "33"},
-        { "PolicyMappings", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 536870917, NULL },
-        { "issuerDomainPolicy", 1073741826, "CertPolicyId"},
-        { "subjectDomainPolicy", 2, "CertPolicyId"},
-        { "id-ce-subjectAltName", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "17"},
-        { "SubjectAltName", 1073741826, "GeneralNames"},
-        { "GeneralNames", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "GeneralName"},
-        { "GeneralName", 1610612754, NULL },
-        { "otherName", 1610620930, "AnotherName"},
-        { NULL, 4104, "0"},
-        { "rfc822Name", 1610620930, "IA5String"},
-        { NULL, 4104, "1"},
-        { "dNSName", 1610620930, "IA5String"},
-        { NULL, 4104, "2"},
-        { "x400Address", 1610620930, "ORAddress"},
-        { NULL, 4104, "3"},
-        { "directoryName", 1610620930, "Name"},
-        { NULL, 4104, "4"},
-        { "ediPartyName", 1610620930, "EDIPartyName"},
-        { NULL, 4104, "5"},
-        { "uniformResourceIdentifier", 1610620930, "IA5String"},
-        { NULL, 4104, "6"},
-        { "iPAddress", 1610620935, NULL },
-        { NULL, 4104, "7"},
-        { "registeredID", 536879116, NULL },
-        { NULL, 4104, "8"},
-        { "AnotherName", 1610612741, NULL },
-        { "type-id", 1073741836, NULL },
-        { "value", 541073421, NULL },
-        { NULL, 1073743880, "0"},
-        { "type-id", 1, NULL },
-        { "EDIPartyName", 1610612741, NULL },
-        { "nameAssigner", 1610637314, "DirectoryString"},
-        { NULL, 4104, "0"},
-        { "partyName", 536879106, "DirectoryString"},
-        { NULL, 4104, "1"},
-        { "id-ce-issuerAltName", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "18"},
-        { "IssuerAltName", 1073741826, "GeneralNames"},
-        { "id-ce-subjectDirectoryAttributes", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "9"},
-        { "SubjectDirectoryAttributes", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "Attribute"},
-        { "id-ce-basicConstraints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "19"},
-        { "BasicConstraints", 1610612741, NULL },
-        { "cA", 1610645508, NULL },
-        { NULL, 131081, NULL },
-        { "pathLenConstraint", 537411587, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-nameConstraints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "30"},
-        { "NameConstraints", 1610612741, NULL },
-        { "permittedSubtrees", 1610637314, "GeneralSubtrees"},
-        { NULL, 4104, "0"},
-        { "excludedSubtrees", 536895490, "GeneralSubtrees"},
-        { NULL, 4104, "1"},
-        { "GeneralSubtrees", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "GeneralSubtree"},
-        { "GeneralSubtree", 1610612741, NULL },
-        { "base", 1073741826, "GeneralName"},
-        { "minimum", 1610653698, "BaseDistance"},
-        { NULL, 1073741833, "0"},
-        { NULL, 4104, "0"},
-        { "maximum", 536895490, "BaseDistance"},
-        { NULL, 4104, "1"},
-        { "BaseDistance", 1611137027, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-policyConstraints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "36"},
-        { "PolicyConstraints", 1610612741, NULL },
-        { "requireExplicitPolicy", 1610637314, "SkipCerts"},
-        { NULL, 4104, "0"},
-        { "inhibitPolicyMapping", 536895490, "SkipCerts"},
-        { NULL, 4104, "1"},
-        { "SkipCerts", 1611137027, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-cRLDistributionPoints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "31"},
-        { "CRLDistPointsSyntax", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "DistributionPoint"},
-        { "DistributionPoint", 1610612741, NULL },
-        { "distributionPoint", 1610637314, "DistributionPointName"},
-        { NULL, 4104, "0"},
-        { "reasons", 1610637314, "ReasonFlags"},
-        { NULL, 4104, "1"},
-        { "cRLIssuer", 536895490, "GeneralNames"},
-        { NULL, 4104, "2"},
-        { "DistributionPointName", 1610612754, NULL },
-        { "fullName", 1610620930, "GeneralNames"},
-        { NULL, 4104, "0"},
-        { "nameRelativeToCRLIssuer", 536879106, "RelativeDistinguishedName"},
-        { NULL, 4104, "1"},
-        { "ReasonFlags", 1610874886, NULL },
-        { "unused", 1073741825, "0"},
-        { "keyCompromise", 1073741825, "1"},
-        { "cACompromise", 1073741825, "2"},
-        { "affiliationChanged", 1073741825, "3"},
-        { "superseded", 1073741825, "4"},
-        { "cessationOfOperation", 1073741825, "5"},
-        { "certificateHold", 1, "6"},
-        { "id-ce-extKeyUsage", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "37"},
-        { "ExtKeyUsageSyntax", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "KeyPurposeId"},
-        { "KeyPurposeId", 1073741836, NULL },
-        { "id-kp-serverAuth", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "1"},
-        { "id-kp-clientAuth", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "2"},
-        { "id-kp-codeSigning", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "3"},
-        { "id-kp-emailProtection", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "4"},
-        { "id-kp-ipsecEndSystem", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "5"},
-        { "id-kp-ipsecTunnel", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "6"},
-        { "id-kp-ipsecUser", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "7"},
-        { "id-kp-timeStamping", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "8"},
-        { "id-pe-authorityInfoAccess", 1879048204, NULL },
-        { NULL, 1073741825, "id-pe"},
-        { NULL, 1, "1"},
-        { "AuthorityInfoAccessSyntax", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "AccessDescription"},
-        { "AccessDescription", 1610612741, NULL },
-        { "accessMethod", 1073741836, NULL },
-        { "accessLocation", 2, "GeneralName"},
-        { "id-ce-cRLNumber", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "20"},
-        { "CRLNumber", 1611137027, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-issuingDistributionPoint", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "28"},
-        { "IssuingDistributionPoint", 1610612741, NULL },
-        { "distributionPoint", 1610637314, "DistributionPointName"},
-        { NULL, 4104, "0"},
-        { "onlyContainsUserCerts", 1610653700, NULL },
-        { NULL, 1073872905, NULL },
-        { NULL, 4104, "1"},
-        { "onlyContainsCACerts", 1610653700, NULL },
-        { NULL, 1073872905, NULL },
-        { NULL, 4104, "2"},
-        { "onlySomeReasons", 1610637314, "ReasonFlags"},
-        { NULL, 4104, "3"},
-        { "indirectCRL", 536911876, NULL },
-        { NULL, 1073872905, NULL },
-        { NULL, 4104, "4"},
-        { "id-ce-deltaCRLIndicator", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "27"},
-        { "BaseCRLNumber", 1073741826, "CRLNumber"},
-        { "id-ce-cRLReasons", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "21"},
-        { "CRLReason", 1610874901, NULL },
-        { "unspecified", 1073741825, "0"},
-        { "keyCompromise", 1073741825, "1"},
-        { "cACompromise", 1073741825, "2"},
-        { "affiliationChanged", 1073741825, "3"},
-        { "superseded", 1073741825, "4"},
-        { "cessationOfOperation", 1073741825, "5"},
-        { "certificateHold", 1073741825, "6"},
-        { "removeFromCRL", 1, "8"},
-        { "id-ce-certificateIssuer", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "29"},
-        { "CertificateIssuer", 1073741826, "GeneralNames"},
-        { "id-ce-holdInstructionCode", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "23"},
-        { "HoldInstructionCode", 1073741836, NULL },
-        { "holdInstruction", 1879048204, NULL },
-        { "joint-iso-itu-t", 1073741825, "2"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "x9cm", 1073741825, "10040"},
-        { NULL, 1, "2"},
-        { "id-holdinstruction-none", 1879048204, NULL },
-        { NULL, 1073741825, "holdInstruction"},
-        { NULL, 1, "1"},
-        { "id-holdinstruction-callissuer", 1879048204, NULL },
-        { NULL, 1073741825, "holdInstruction"},
-        { NULL, 1, "2"},
-        { "id-holdinstruction-reject", 1879048204, NULL },
-        { NULL, 1073741825, "holdInstruction"},
-        { NULL, 1, "3"},
-        { "id-ce-invalidityDate", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "24"},
-        { "InvalidityDate", 1082130449, NULL },
-        { "VisibleString", 1610620935, NULL },
-        { NULL, 4360, "26"},
-        { "NumericString", 1610620935, NULL },
-        { NULL, 4360, "18"},
-        { "IA5String", 1610620935, NULL },
-        { NULL, 4360, "22"},
-        { "TeletexString", 1610620935, NULL },
-        { NULL, 4360, "20"},
-        { "PrintableString", 1610620935, NULL },
-        { NULL, 4360, "19"},
-        { "UniversalString", 1610620935, NULL },
-        { NULL, 4360, "28"},
-        { "BMPString", 1610620935, NULL },
-        { NULL, 4360, "30"},
-        { "UTF8String", 1610620935, NULL },
-        { NULL, 4360, "12"},
-        { "id-pkix", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "identified-organization", 1073741825, "3"},
-        { "dod", 1073741825, "6"},
-        { "internet", 1073741825, "1"},
-        { "security", 1073741825, "5"},
-        { "mechanisms", 1073741825, "5"},
-        { "pkix", 1, "7"},
-        { "id-pe", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "1"},
-        { "id-qt", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "2"},
-        { "id-kp", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "3"},
-        { "id-ad", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "48"},
-        { "id-qt-cps", 1879048204, NULL },
-        { NULL, 1073741825, "id-qt"},
-        { NULL, 1, "1"},
-        { "id-qt-unotice", 1879048204, NULL },
-        { NULL, 1073741825, "id-qt"},
-        { NULL, 1, "2"},
-        { "id-ad-ocsp", 1879048204, NULL },
-        { NULL, 1073741825, "id-ad"},
-        { NULL, 1, "1"},
-        { "id-ad-caIssuers", 1879048204, NULL },
-        { NULL, 1073741825, "id-ad"},
-        { NULL, 1, "2"},
-        { "Attribute", 1610612741, NULL },
-        { "type", 1073741826, "AttributeType"},
-        { "values", 536870927, NULL },
-        { NULL, 2, "AttributeValue"},
-        { "AttributeType", 1073741836, NULL },
-        { "AttributeValue", 1073741837, NULL },
-        { "AttributeTypeAndValue", 1610612741, NULL },
-        { "type", 1073741826, "AttributeType"},
-        { "value", 2, "AttributeValue"},
-        { "id-at", 1879048204, NULL },
-        { "joint-iso-ccitt", 1073741825, "2"},
-        { "ds", 1073741825, "5"},
-        { NULL, 1, "4"},
-        { "id-at-name", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "41"},
-        { "id-at-surname", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "4"},
-        { "id-at-givenName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "42"},
-        { "id-at-initials", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "43"},
-        { "id-at-generationQualifier", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "44"},
-        { "X520name", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-name", 524298, "1"},
-        { "id-at-commonName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "3"},
-        { "X520CommonName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-common-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-common-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-common-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-common-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-common-name", 524298, "1"},
-        { "id-at-localityName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "7"},
-        { "X520LocalityName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-locality-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-locality-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-locality-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-locality-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-locality-name", 524298, "1"},
-        { "id-at-stateOrProvinceName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "8"},
-        { "X520StateOrProvinceName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-state-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-state-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-state-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-state-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-state-name", 524298, "1"},
-        { "id-at-organizationName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "10"},
-        { "X520OrganizationName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-organization-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-organization-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-organization-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-organization-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-organization-name", 524298, "1"},
-        { "id-at-organizationalUnitName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "11"},
-        { "X520OrganizationalUnitName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "id-at-title", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "12"},
-        { "X520Title", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-title", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-title", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-title", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-title", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-title", 524298, "1"},
-        { "id-at-dnQualifier", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "46"},
-        { "X520dnQualifier", 1073741826, "PrintableString"},
-        { "id-at-countryName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "6"},
-        { "X520countryName", 1612709890, "PrintableString"},
-        { NULL, 1048586, "2"},
-        { "pkcs-9", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "rsadsi", 1073741825, "113549"},
-        { "pkcs", 1073741825, "1"},
-        { NULL, 1, "9"},
-        { "emailAddress", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "pkcs-9"},
-        { NULL, 1, "1"},
-        { "Pkcs9email", 1612709890, "IA5String"},
-        { "ub-emailaddress-length", 524298, "1"},
-        { "Name", 1610612754, NULL },
-        { "rdnSequence", 2, "RDNSequence"},
-        { "RDNSequence", 1610612747, NULL },
-        { NULL, 2, "RelativeDistinguishedName"},
-        { "DistinguishedName", 1073741826, "RDNSequence"},
-        { "RelativeDistinguishedName", 1612709903, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "AttributeTypeAndValue"},
-        { "DirectoryString", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "MAX", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "MAX", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "MAX", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "MAX", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "MAX", 524298, "1"},
-        { "Certificate", 1610612741, NULL },
-        { "tbsCertificate", 1073741826, "TBSCertificate"},
-        { "signatureAlgorithm", 1073741826, "AlgorithmIdentifier"},
-        { "signature", 6, NULL },
-        { "TBSCertificate", 1610612741, NULL },
-        { "version", 1610653698, "Version"},
-        { NULL, 1073741833, "v1"},
-        { NULL, 2056, "0"},
-        { "serialNumber", 1073741826, "CertificateSerialNumber"},
-        { "signature", 1073741826, "AlgorithmIdentifier"},
-        { "issuer", 1073741826, "Name"},
-        { "validity", 1073741826, "Validity"},
-        { "subject", 1073741826, "Name"},
-        { "subjectPublicKeyInfo", 1073741826, "SubjectPublicKeyInfo"},
-        { "issuerUniqueID", 1610637314, "UniqueIdentifier"},
-        { NULL, 4104, "1"},
-        { "subjectUniqueID", 1610637314, "UniqueIdentifier"},
-        { NULL, 4104, "2"},
-        { "extensions", 536895490, "Extensions"},
-        { NULL, 2056, "3"},
-        { "Version", 1610874883, NULL },
-        { "v1", 1073741825, "0"},
-        { "v2", 1073741825, "1"},
-        { "v3", 1, "2"},
-        { "CertificateSerialNumber", 1073741827, NULL },
-        { "Validity", 1610612741, NULL },
-        { "notBefore", 1073741826, "Time"},
-        { "notAfter", 2, "Time"},
-        { "Time", 1610612754, NULL },
-        { "utcTime", 1090519057, NULL },
-        { "generalTime", 8388625, NULL },
-        { "UniqueIdentifier", 1073741830, NULL },
-        { "SubjectPublicKeyInfo", 1610612741, NULL },
-        { "algorithm", 1073741826, "AlgorithmIdentifier"},
-        { "subjectPublicKey", 6, NULL },
-        { "Extensions", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "Extension"},
-        { "Extension", 1610612741, NULL },
-        { "extnID", 1073741836, NULL },
-        { "critical", 1610645508, NULL },
-        { NULL, 131081, NULL },
-        { "extnValue", 7, NULL },
-        { "CertificateList", 1610612741, NULL },
-        { "tbsCertList", 1073741826, "TBSCertList"},
-        { "signatureAlgorithm", 1073741826, "AlgorithmIdentifier"},
-        { "signature", 6, NULL },
-        { "TBSCertList", 1610612741, NULL },
-        { "version", 1073758210, "Version"},
-        { "signature", 1073741826, "AlgorithmIdentifier"},
-        { "issuer", 1073741826, "Name"},
-        { "thisUpdate", 1073741826, "Time"},
-        { "nextUpdate", 1073758210, "Time"},
-        { "revokedCertificates", 1610629131, NULL },
-        { NULL, 536870917, NULL },
-        { "userCertificate", 1073741826, "CertificateSerialNumber"},
-        { "revocationDate", 1073741826, "Time"},
-        { "crlEntryExtensions", 16386, "Extensions"},
-        { "crlExtensions", 536895490, "Extensions"},
-        { NULL, 2056, "0"},
-        { "AlgorithmIdentifier", 1610612741, NULL },
-        { "algorithm", 1073741836, NULL },
-        { "parameters", 541081613, NULL },
-        { "algorithm", 1, NULL },
-        { "pkcs-1", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "rsadsi", 1073741825, "113549"},
-        { "pkcs", 1073741825, "1"},
-        { NULL, 1, "1"},
-        { "rsaEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "1"},
-        { "md2WithRSAEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "2"},
-        { "md5WithRSAEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "4"},
-        { "sha1WithRSAEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "5"},
-        { "id-dsa-with-sha1", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "x9-57", 1073741825, "10040"},
-        { "x9algorithm", 1073741825, "4"},
-        { NULL, 1, "3"},
-        { "Dss-Sig-Value", 1610612741, NULL },
-        { "r", 1073741827, NULL },
-        { "s", 3, NULL },
-        { "dhpublicnumber", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "ansi-x942", 1073741825, "10046"},
-        { "number-type", 1073741825, "2"},
-        { NULL, 1, "1"},
-        { "DomainParameters", 1610612741, NULL },
-        { "p", 1073741827, NULL },
-        { "g", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "j", 1073758211, NULL },
-        { "validationParms", 16386, "ValidationParms"},
-        { "ValidationParms", 1610612741, NULL },
-        { "seed", 1073741830, NULL },
-        { "pgenCounter", 3, NULL },
-        { "id-dsa", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "x9-57", 1073741825, "10040"},
-        { "x9algorithm", 1073741825, "4"},
-        { NULL, 1, "1"},
-        { "Dss-Parms", 1610612741, NULL },
-        { "p", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "g", 3, NULL },
-        { "ORAddress", 1610612741, NULL },
-        { "built-in-standard-attributes", 1073741826, "BuiltInStandardAttributes"},
-        { "built-in-domain-defined-attributes", 1073758210, "BuiltInDomainDefinedAttributes"},
-        { "extension-attributes", 16386, "ExtensionAttributes"},
-        { "BuiltInStandardAttributes", 1610612741, NULL },
-        { "country-name", 1073758210, "CountryName"},
-        { "administration-domain-name", 1073758210, "AdministrationDomainName"},
-        { "network-address", 1610637314, "NetworkAddress"},
-        { NULL, 2056, "0"},
-        { "terminal-identifier", 1610637314, "TerminalIdentifier"},
-        { NULL, 2056, "1"},
-        { "private-domain-name", 1610637314, "PrivateDomainName"},
-        { NULL, 2056, "2"},
-        { "organization-name", 1610637314, "OrganizationName"},
-        { NULL, 2056, "3"},
-        { "numeric-user-identifier", 1610637314, "NumericUserIdentifier"},
-        { NULL, 2056, "4"},
-        { "personal-name", 1610637314, "PersonalName"},
-        { NULL, 2056, "5"},
-        { "organizational-unit-names", 536895490, "OrganizationalUnitNames"},
-        { NULL, 2056, "6"},
-        { "CountryName", 1610620946, NULL },
-        { NULL, 1073746952, "1"},
-        { "x121-dcc-code", 1612709890, "NumericString"},
-        { NULL, 1048586, "ub-country-name-numeric-length"},
-        { "iso-3166-alpha2-code", 538968066, "PrintableString"},
-        { NULL, 1048586, "ub-country-name-alpha-length"},
-        { "AdministrationDomainName", 1610620946, NULL },
-        { NULL, 1073744904, "2"},
-        { "numeric", 1612709890, "NumericString"},
-        { "ub-domain-name-length", 524298, "0"},
-        { "printable", 538968066, "PrintableString"},
-        { "ub-domain-name-length", 524298, "0"},
-        { "NetworkAddress", 1073741826, "X121Address"},
-        { "X121Address", 1612709890, "NumericString"},
-        { "ub-x121-address-length", 524298, "1"},
-        { "TerminalIdentifier", 1612709890, "PrintableString"},
-        { "ub-terminal-id-length", 524298, "1"},
-        { "PrivateDomainName", 1610612754, NULL },
-        { "numeric", 1612709890, "NumericString"},
-        { "ub-domain-name-length", 524298, "1"},
-        { "printable", 538968066, "PrintableString"},
-        { "ub-domain-name-length", 524298, "1"},
-        { "OrganizationName", 1612709890, "PrintableString"},
-        { "ub-organization-name-length", 524298, "1"},
-        { "NumericUserIdentifier", 1612709890, "NumericString"},
-        { "ub-numeric-user-id-length", 524298, "1"},
-        { "PersonalName", 1610612750, NULL },
-        { "surname", 1814044674, "PrintableString"},
-        { NULL, 1073745928, "0"},
-        { "ub-surname-length", 524298, "1"},
-        { "given-name", 1814061058, "PrintableString"},
-        { NULL, 1073745928, "1"},
-        { "ub-given-name-length", 524298, "1"},
-        { "initials", 1814061058, "PrintableString"},
-        { NULL, 1073745928, "2"},
-        { "ub-initials-length", 524298, "1"},
-        { "generation-qualifier", 740319234, "PrintableString"},
-        { NULL, 1073745928, "3"},
-        { "ub-generation-qualifier-length", 524298, "1"},
-        { "OrganizationalUnitNames", 1612709899, NULL },
-        { "ub-organizational-units", 1074266122, "1"},
-        { NULL, 2, "OrganizationalUnitName"},
-        { "OrganizationalUnitName", 1612709890, "PrintableString"},
-        { "ub-organizational-unit-name-length", 524298, "1"},
-        { "BuiltInDomainDefinedAttributes", 1612709899, NULL },
-        { "ub-domain-defined-attributes", 1074266122, "1"},
-        { NULL, 2, "BuiltInDomainDefinedAttribute"},
-        { "BuiltInDomainDefinedAttribute", 1610612741, NULL },
-        { "type", 1612709890, "PrintableString"},
-        { "ub-domain-defined-attribute-type-length", 524298, "1"},
-        { "value", 538968066, "PrintableString"},
-        { "ub-domain-defined-attribute-value-length", 524298, "1"},
-        { "ExtensionAttributes", 1612709903, NULL },
-        { "ub-extension-attributes", 1074266122, "1"},
-        { NULL, 2, "ExtensionAttribute"},
-        { "ExtensionAttribute", 1610612741, NULL },
-        { "extension-attribute-type", 1611145219, NULL },
-        { NULL, 1073743880, "0"},
-        { "0", 10, "ub-extension-attributes"},
-        { "extension-attribute-value", 541073421, NULL },
-        { NULL, 1073743880, "1"},
-        { "extension-attribute-type", 1, NULL },
-        { "common-name", 1342177283, "1"},
-        { "CommonName", 1612709890, "PrintableString"},
-        { "ub-common-name-length", 524298, "1"},
-        { "teletex-common-name", 1342177283, "2"},
-        { "TeletexCommonName", 1612709890, "TeletexString"},
-        { "ub-common-name-length", 524298, "1"},
-        { "teletex-organization-name", 1342177283, "3"},
-        { "TeletexOrganizationName", 1612709890, "TeletexString"},
-        { "ub-organization-name-length", 524298, "1"},
-        { "teletex-personal-name", 1342177283, "4"},
-        { "TeletexPersonalName", 1610612750, NULL },
-        { "surname", 1814044674, "TeletexString"},
-        { NULL, 1073743880, "0"},
-        { "ub-surname-length", 524298, "1"},
-        { "given-name", 1814061058, "TeletexString"},
-        { NULL, 1073743880, "1"},
-        { "ub-given-name-length", 524298, "1"},
-        { "initials", 1814061058, "TeletexString"},
-        { NULL, 1073743880, "2"},
-        { "ub-initials-length", 524298, "1"},
-        { "generation-qualifier", 740319234, "TeletexString"},
-        { NULL, 1073743880, "3"},
-        { "ub-generation-qualifier-length", 524298, "1"},
-        { "teletex-organizational-unit-names", 1342177283, "5"},
-        { "TeletexOrganizationalUnitNames", 1612709899, NULL },
-        { "ub-organizational-units", 1074266122, "1"},
-        { NULL, 2, "TeletexOrganizationalUnitName"},
-        { "TeletexOrganizationalUnitName", 1612709890, "TeletexString"},
-        { "ub-organizational-unit-name-length", 524298, "1"},
-        { "pds-name", 1342177283, "7"},
-        { "PDSName", 1612709890, "PrintableString"},
-        { "ub-pds-name-length", 524298, "1"},
-        { "physical-delivery-country-name", 1342177283, "8"},
-        { "PhysicalDeliveryCountryName", 1610612754, NULL },
-        { "x121-dcc-code", 1612709890, "NumericString"},
-        { NULL, 1048586, "ub-country-name-numeric-length"},
-        { "iso-3166-alpha2-code", 538968066, "PrintableString"},
-        { NULL, 1048586, "ub-country-name-alpha-length"},
-        { "postal-code", 1342177283, "9"},
-        { "PostalCode", 1610612754, NULL },
-        { "numeric-code", 1612709890, "NumericString"},
-        { "ub-postal-code-length", 524298, "1"},
-        { "printable-code", 538968066, "PrintableString"},
-        { "ub-postal-code-length", 524298, "1"},
-        { "physical-delivery-office-name", 1342177283, "10"},
-        { "PhysicalDeliveryOfficeName", 1073741826, "PDSParameter"},
-        { "physical-delivery-office-number", 1342177283, "11"},
-        { "PhysicalDeliveryOfficeNumber", 1073741826, "PDSParameter"},
-        { "extension-OR-address-components", 1342177283, "12"},
-        { "ExtensionORAddressComponents", 1073741826, "PDSParameter"},
-        { "physical-delivery-personal-name", 1342177283, "13"},
-        { "PhysicalDeliveryPersonalName", 1073741826, "PDSParameter"},
-        { "physical-delivery-organization-name", 1342177283, "14"},
-        { "PhysicalDeliveryOrganizationName", 1073741826, "PDSParameter"},
-        { "extension-physical-delivery-address-components", 1342177283, "15"},
-        { "ExtensionPhysicalDeliveryAddressComponents", 1073741826, "PDSParameter"},
-        { "unformatted-postal-address", 1342177283, "16"},
-        { "UnformattedPostalAddress", 1610612750, NULL },
-        { "printable-address", 1814052875, NULL },
-        { "ub-pds-physical-address-lines", 1074266122, "1"},
-        { NULL, 538968066, "PrintableString"},
-        { "ub-pds-parameter-length", 524298, "1"},
-        { "teletex-string", 740311042, "TeletexString"},
-        { "ub-unformatted-address-length", 524298, "1"},
-        { "street-address", 1342177283, "17"},
-        { "StreetAddress", 1073741826, "PDSParameter"},
-        { "post-office-box-address", 1342177283, "18"},
-        { "PostOfficeBoxAddress", 1073741826, "PDSParameter"},
-        { "poste-restante-address", 1342177283, "19"},
-        { "PosteRestanteAddress", 1073741826, "PDSParameter"},
-        { "unique-postal-name", 1342177283, "20"},
-        { "UniquePostalName", 1073741826, "PDSParameter"},
-        { "local-postal-attributes", 1342177283, "21"},
-        { "LocalPostalAttributes", 1073741826, "PDSParameter"},
-        { "PDSParameter", 1610612750, NULL },
-        { "printable-string", 1814052866, "PrintableString"},
-        { "ub-pds-parameter-length", 524298, "1"},
-        { "teletex-string", 740311042, "TeletexString"},
-        { "ub-pds-parameter-length", 524298, "1"},
-        { "extended-network-address", 1342177283, "22"},
-        { "ExtendedNetworkAddress", 1610612754, NULL },
-        { "e163-4-address", 1610612741, NULL },
-        { "number", 1612718082, "NumericString"},
-        { NULL, 1073743880, "0"},
-        { "ub-e163-4-number-length", 524298, "1"},
-        { "sub-address", 538992642, "NumericString"},
-        { NULL, 1073743880, "1"},
-        { "ub-e163-4-sub-address-length", 524298, "1"},
-        { "psap-address", 536879106, "PresentationAddress"},
-        { NULL, 2056, "0"},
-        { "PresentationAddress", 1610612741, NULL },
-        { "pSelector", 1610637319, NULL },
-        { NULL, 2056, "0"},
-        { "sSelector", 1610637319, NULL },
-        { NULL, 2056, "1"},
-        { "tSelector", 1610637319, NULL },
-        { NULL, 2056, "2"},
-        { "nAddresses", 538976271, NULL },
-        { NULL, 1073743880, "3"},
-        { "MAX", 1074266122, "1"},
-        { NULL, 7, NULL },
-        { "terminal-type", 1342177283, "23"},
-        { "TerminalType", 1611137027, NULL },
-        { "0", 10, "ub-integer-options"},
-        { "teletex-domain-defined-attributes", 1342177283, "6"},
-        { "TeletexDomainDefinedAttributes", 1612709899, NULL },
-        { "ub-domain-defined-attributes", 1074266122, "1"},
-        { NULL, 2, "TeletexDomainDefinedAttribute"},
-        { "TeletexDomainDefinedAttribute", 1610612741, NULL },
-        { "type", 1612709890, "TeletexString"},
-        { "ub-domain-defined-attribute-type-length", 524298, "1"},
-        { "value", 538968066, "TeletexString"},
-        { "ub-domain-defined-attribute-value-length", 524298, "1"},
-        { "ub-name", 1342177283, "32768"},
-        { "ub-common-name", 1342177283, "64"},
-        { "ub-locality-name", 1342177283, "128"},
-        { "ub-state-name", 1342177283, "128"},
-        { "ub-organization-name", 1342177283, "64"},
-        { "ub-organizational-unit-name", 1342177283, "64"},
-        { "ub-title", 1342177283, "64"},
-        { "ub-match", 1342177283, "128"},
-        { "ub-emailaddress-length", 1342177283, "128"},
-        { "ub-common-name-length", 1342177283, "64"},
-        { "ub-country-name-alpha-length", 1342177283, "2"},
-        { "ub-country-name-numeric-length", 1342177283, "3"},
-        { "ub-domain-defined-attributes", 1342177283, "4"},
-        { "ub-domain-defined-attribute-type-length", 1342177283, "8"},
-        { "ub-domain-defined-attribute-value-length", 1342177283, "128"},
-        { "ub-domain-name-length", 1342177283, "16"},
-        { "ub-extension-attributes", 1342177283, "256"},
-        { "ub-e163-4-number-length", 1342177283, "15"},
-        { "ub-e163-4-sub-address-length", 1342177283, "40"},
-        { "ub-generation-qualifier-length", 1342177283, "3"},
-        { "ub-given-name-length", 1342177283, "16"},
-        { "ub-initials-length", 1342177283, "5"},
-        { "ub-integer-options", 1342177283, "256"},
-        { "ub-numeric-user-id-length", 1342177283, "32"},
-        { "ub-organization-name-length", 1342177283, "64"},
-        { "ub-organizational-unit-name-length", 1342177283, "32"},
-        { "ub-organizational-units", 1342177283, "4"},
-        { "ub-pds-name-length", 1342177283, "16"},
-        { "ub-pds-parameter-length", 1342177283, "30"},
-        { "ub-pds-physical-address-lines", 1342177283, "6"},
-        { "ub-postal-code-length", 1342177283, "16"},
-        { "ub-surname-length", 1342177283, "40"},
-        { "ub-terminal-id-length", 1342177283, "24"},
-        { "ub-unformatted-address-length", 1342177283, "180"},
-        { "ub-x121-address-length", 268435459, "16"},
-        { NULL, 0, NULL }
-    };
-    
     /* Base64 PEM certificate decoding (in DER) */
     byte *certificatDer = 0;
-    byte *rootDer = 0;
     int sizeCert = pemToAsn(cert, certLen, &certificatDer);
-    int sizeRoot = pemToAsn(myGLSSocket->m_certRoot, myGLSSocket->m_certRootSize, &rootDer);
-    if (sizeCert < 0 || sizeRoot < 0) {
+    if (sizeCert < 0) {
         
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if (rootDer != NULL) {
-            free(rootDer);
-            rootDer = 0;
-        }
+        if (certificatDer != NULL) free(certificatDer);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Error Base 64\n");
-        printf("### checkCertificate() End ###\n\n");
+        printf("### verifyCertificate() End ###\n\n");
         #endif
         
-        /* return error */
-        if (sizeCert < 0) return sizeCert;
-        else return sizeRoot;
+        return sizeCert;
         
     }
     
-    /* Certificate's structure creation */
-    ASN1_TYPE certDef = ASN1_TYPE_EMPTY;
+    /* Definitions compiled once for the whole process */
+    asn1_node certDef = getAsnDefinition(GLS_ASN_PKIX);
+    asn1_node certificat = NULL;
     char errorDescription[ASN1_MAX_ERROR_DESCRIPTION_SIZE];
-    int result = asn1_array2tree(structCertificat, &certDef, errorDescription);
+    int result = ASN1_ELEMENT_NOT_FOUND;
+    if (certDef != NULL) result = asn1_create_element(certDef, "PKIX1Implicit88.Certificate", &certificat);
+    if (result == ASN1_SUCCESS) result = asn1_der_decoding(&certificat, certificatDer, sizeCert, errorDescription);
     if (result != ASN1_SUCCESS) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Problems creating structure asn1_array2tree\n");
-        int i = 0;
-        for (i = 0; i < ASN1_MAX_ERROR_DESCRIPTION_SIZE; i++) {
-            printf("%c", errorDescription[i]);
-        }
-        printf("\n");
-        #endif
-        
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if (rootDer != NULL) {
-            free(rootDer);
-            rootDer = 0;
-        }
-        asn1_delete_structure(&certDef);
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### checkCertificate() End ###\n\n");
-        #endif
-        
-        return GLS_ERROR_ASN1;
-        
-    }
-    
-    /* Certificate DER parsing to use it under certificate */
-    ASN1_TYPE certificat = ASN1_TYPE_EMPTY;
-    ASN1_TYPE root = ASN1_TYPE_EMPTY;
-    char errorDescription2[ASN1_MAX_ERROR_DESCRIPTION_SIZE];
-    asn1_create_element(certDef, "PKIX1Implicit88.Certificate", &certificat);
-    asn1_create_element(certDef, "PKIX1Implicit88.Certificate", &root);
-    result = asn1_der_decoding(&certificat, certificatDer, sizeCert, errorDescription);
-    int result2 = asn1_der_decoding(&root, rootDer, sizeRoot, errorDescription2);
-    if (result != ASN1_SUCCESS || result2 != ASN1_SUCCESS) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Problems with DER encoding\n");
-        int i = 0;
-        for (i = 0; i < ASN1_MAX_ERROR_DESCRIPTION_SIZE; i++) {
-            
-            if (result != ASN1_SUCCESS) printf("%c", errorDescription[i]);
-            else printf("%c", errorDescription2[i]);
-            
-        }
-        printf("\n");
+        printf("Problems with DER encoding : %s\n", errorDescription);
+        printf("### verifyCertificate() End ###\n\n");
         #endif
         
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if (rootDer != NULL) {
-            free(rootDer);
-            rootDer = 0;
-        }
-        asn1_delete_structure(&certDef);
+        free(certificatDer);
         asn1_delete_structure(&certificat);
-        asn1_delete_structure(&root);
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### checkCertificate() End ###\n\n");
-        #endif
         
         return GLS_ERROR_ASN1;
         
     }
     
-    /*
-     * From here we have :
-     * certificat = the certificate to check
-     * root = the root certificate
-     * certDef = the X.509 certificate definition
-     */
-    
     /*
      * Type of verification :
-     * - subjectUniqueId certificat is not in CRL
      * - Validity periode of certificate and root OK
      * - Certificate sign by root
      */
     
-    /*
-     * Check for certificate serial number not in CRL
-     */
+    int error = 0;
     
-    int len = 0;
-    int i = 0;
+    /* Serial number, kept for the CRL (a serial too long can't be in a list) */
     byte serial[1024];
-    len = sizeof (serial);
-    result = asn1_read_value(certificat, "tbsCertificate.serialNumber", serial, &len);
-    if (result != 0) {
+    int len = sizeof (serial);
+    if (asn1_read_value(certificat, "tbsCertificate.serialNumber", serial, &len) != ASN1_SUCCESS) error = GLS_ERROR_BADSERVERCERT;
+    else if (serialToCrlEntry(serial, len, verdict->m_serial) != 0) memset(verdict->m_serial, 0, GLS_SIZE_CRL_ENTRY);
+    
+    /* Issuer to find the root */
+    byte keyId[GLS_SIZE_KEY_ID];
+    int keyIdSize = 0;
+    if (error == 0 && hashCertName(certificat, certificatDer, sizeCert, "tbsCertificate.issuer", verdict->m_issuer) != 0) error = GLS_ERROR_BADSERVERCERT;
+    if (error == 0) keyIdSize = readKeyId(certificat, GLS_OID_AUTHORITY_KEY_ID, keyId);
+    
+    /* Validity of the certificate */
+    long actualTime = time(NULL);
+    long certStart = 0;
+    long certEnd = 0;
+    if (error == 0 && (readCertTime(certificat, "tbsCertificate.validity.notBefore", &certStart) != 0 || readCertTime(certificat, "tbsCertificate.validity.notAfter", &certEnd) != 0)) error = GLS_ERROR_BADSERVERCERT;
+    if (error == 0 && (actualTime > certEnd || actualTime < certStart)) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("No Certificate Serial Number\n");
+        printf("Certificate expired\n");
         #endif
         
-        /* free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if (rootDer != NULL) {
-            free(rootDer);
-            rootDer = 0;
-        }
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
-        asn1_delete_structure(&root);
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### checkCertificate() End ###\n\n");
-        #endif
+        error = GLS_ERROR_BADSERVERCERT;
         
-        return GLS_ERROR_BADSERVERCERT;
     }
     
-    /* Debug Only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Result : %d\n", result);
-    printf("Serial length : %d\n", len);
-    printf("Serial : ");
-    for (i = 0; i < len; i++) {
-        printf("%2X ", serial[i]);
-    }
-    printf("\n\n");
-    #endif
+    /* Signature by one of the roots with this name */
+    GLSRootCert found[GLS_MAX_ROOT_MATCH];
+    GLSRootCert* root = 0;
+    int nbFound = 0;
+    if (error == 0) nbFound = findRootCerts(roots, verdict->m_issuer, keyId, keyIdSize, found, GLS_MAX_ROOT_MATCH);
     
-    /* Check serial in CRL */
-    int serialIsOk = 1;
-    for (i = 0; i < myGLSSocket->m_sizeCrl; i++) {
-        
-        byte* mySerial = (byte*) myGLSSocket->m_crl[i];
-        
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("CRL Serial (%d) : ", mySerial[0]);
-        int z = 0;
-        for (z = 0; z < mySerial[0]; z++) {
-            printf("%2X ", mySerial[z + 1]);
-        }
-        printf("\n\n");
-        #endif
-        
-        int lenght = mySerial[0];
-        
-        int y = 0;
-        for (y = 0; y < lenght && y < len; y++) {
-            
-            if (serial[y] != mySerial[y + 1]) break;
-            
-        }
+    int i = 0;
+    for (i = 0; i < nbFound && root == NULL; i++) {
         
-        if (y == len) {
-            serialIsOk = 0;
-            break;
-        }
-        else {
-            serialIsOk = 1;
-        }
+        int signature = verifyCertSignature(certificat, certificatDer, sizeCert, found[i].m_publicKey);
+        if (signature == 0) root = &found[i];
+        else if (signature != GLS_ERROR_BADSERVERCERT) error = signature;
         
     }
     
-    if (serialIsOk == 0) {
+    if (error == 0 && root == NULL) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Error - Certificate in CRL\n");
+        printf("Error Certificate not valide (%d roots with this issuer)\n", nbFound);
         #endif
         
-        /* free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if (rootDer != NULL) {
-            free(rootDer);
-            rootDer = 0;
-        }
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
-        asn1_delete_structure(&root);
+        error = GLS_ERROR_BADSERVERCERT;
+        
+    }
+    
+    /* Validity of the root */
+    if (error == 0 && (actualTime > root->m_notAfter || actualTime < root->m_notBefore)) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### checkCertificate() End ###\n\n");
+        printf("Root Certificate expired\n");
         #endif
         
-        return GLS_ERROR_BADSERVERCERT;
+        error = GLS_ERROR_BADROOTCERT;
+        
     }
     
-    
-    /*
-     * Certificate and Root validity date check
-     */
-    
-    /* Getting validity times */
-    byte rootDateStart[1024];
-    byte certDateStart[1024];
-    byte rootDateEnd[1024];
-    byte certDateEnd[1024];
-    len = sizeof (rootDateStart);
-    result = asn1_read_value(root, "tbsCertificate.validity.notBefore.utcTime", rootDateStart, &len);
-    len = sizeof (rootDateEnd);
-    result2 = asn1_read_value(root, "tbsCertificate.validity.notAfter.utcTime", rootDateEnd, &len);
-    len = sizeof (certDateStart);
-    int result3 = asn1_read_value(certificat, "tbsCertificate.validity.notBefore.utcTime", certDateStart, &len);
-    len = sizeof (certDateEnd);
-    int result4 = asn1_read_value(certificat, "tbsCertificate.validity.notAfter.utcTime", certDateEnd, &len);
-    if (result != 0 || result2 != 0 || result3 != 0 || result4 != 0) {
+    /* The verdict is valid while both certificates are */
+    if (error == 0) {
         
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("No Certificate Serial Number : ");
-        if (result != 0 || result2 != 0) printf("Root error\n");
-        else printf("Certificate error\n");
-        #endif
-        
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if (rootDer != NULL) {
-            free(rootDer);
-            rootDer = 0;
-        }
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
-        asn1_delete_structure(&root);
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### checkCertificate() End ###\n\n");
-        #endif
-        
-        if (result != 0 || result2 != 0) return GLS_ERROR_BADROOTCERT;
-        else return GLS_ERROR_BADSERVERCERT;
+        memcpy(verdict->m_root, root->m_fingerprint, GLS_SIZE_FINGERPRINT);
+        verdict->m_notBefore = root->m_notBefore > certStart ? root->m_notBefore : certStart;
+        verdict->m_notAfter = root->m_notAfter < certEnd ? root->m_notAfter : certEnd;
         
     }
     
-    /* Getting actual time */
-    long actualTime = time(NULL);
-    
-    /* Converting time strings in long decimal */
-    struct tm *tm = malloc(sizeof(struct tm));
-    /* aparently strptime doesn't fill all the structure 
-     and mktime don't like it so we do a memset 0 */
-    memset(tm, 0, sizeof(struct tm));
-    strptime((char*)rootDateStart, "%y%m%d%H%M%SZ", tm);
-    long rootStart = mktime(tm);
-    strptime((char*)rootDateEnd, "%y%m%d%H%M%SZ", tm);
-    long rootEnd = mktime(tm);
-    strptime((char*)certDateStart, "%y%m%d%H%M%SZ", tm);
-    long certStart = mktime(tm);
-    strptime((char*)certDateEnd, "%y%m%d%H%M%SZ", tm);
-    long certEnd = mktime(tm); 
-    free(tm);
+    /* Free memory */
+    free(certificatDer);
+    asn1_delete_structure(&certificat);
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Root Validity : %s - %s\n", rootDateStart, rootDateEnd);
-    printf("%s ", ctime(&rootStart));
-    printf("- %s\n", ctime(&rootEnd));
-    printf("Certificate Validity : %s - %s\n", certDateStart, certDateEnd);
-    printf("%s ", ctime(&certStart));
-    printf("- %s\n", ctime(&certEnd));
-    printf("Actual Time : %ld - %s\n\n", actualTime, ctime(&actualTime));
+    printf("Result : %d\n", error);
+    printf("### verifyCertificate() End ###\n\n");
     #endif
     
-    /* Check if validity is ok or return Error */
-    if (actualTime > rootEnd || actualTime < rootStart || actualTime > certEnd || actualTime < certStart) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        if (actualTime > rootEnd || actualTime < rootStart) printf("Root Certificate expired\n");
-        else printf("Certificate expired\n");
-        #endif
-        
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if (rootDer != NULL) {
-            free(rootDer);
-            rootDer = 0;
-        }
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
-        asn1_delete_structure(&root);
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### checkCertificate() End ###\n\n");
-        #endif
-        
-        if (actualTime > rootEnd || actualTime < rootStart) return GLS_ERROR_BADROOTCERT;
-        else return GLS_ERROR_BADSERVERCERT;
-        
-    }
+    return error;
     
-    /*
-     * Check the certificate signature (by the root certificate) and also 
-     * the root certificate signature by himself (with his private key).
-     */
-    
-    /* We check if the signing algorithme is sha1 with RSA */
-    byte str[1024], str2[1024];
-    len = sizeof (str);
-    result = asn1_read_value(certificat, "signatureAlgorithm.algorithm", str, &len);
-    len = sizeof (str2);
-    result2 = asn1_read_value(certDef, "PKIX1Implicit88.sha1WithRSAEncryption", str2, &len);
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Check the certificate validity, return 0 for OK or a
+ negative number for an error.
+ 
+ A certificate already verified is found in the cache
+ (SHA-256) and skips the signature if its root is in the
+ list of the socket. The CRL of the socket is checked
+ every time.
+ 
+ ---------------------------------------------------------*/
+
+int checkCertificate(GLSSock* myGLSSocket, const byte *cert, const int certLen) {
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Signature Algo certificat : %s\n", str);
-    printf("Definition SHA1 + RSA : %s\n", str2);
+    printf("### checkCertificate() Start ###\n");
     #endif
     
-    /* if it's SHA1 + RSA (strcmp return 0 if the chars are the same) */
-    if (!strcmp((char *) str, (char *) str2) && result == 0 && result2 == 0) {				
-        
-        /* Get the certificate position */
-        int start = 0;
-        int end = 0;
-        int rootStart = 0;
-        int rootEnd = 0;
-        result = asn1_der_decoding_startEnd(certificat, certificatDer, sizeCert, "tbsCertificate", &start, &end);
-        result2 = asn1_der_decoding_startEnd(root, rootDer, sizeRoot, "tbsCertificate", &rootStart, &rootEnd);
-        if (result != ASN1_SUCCESS || result2 != ASN1_SUCCESS) {
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("Impossible to locate the certificate\n");
-            #endif
-            
-            /* Free memory */
-            if (certificatDer != NULL) {
-                free(certificatDer);
-                certificatDer = 0;
-            }
-            if (rootDer != NULL) {
-                free(rootDer);
-                rootDer = 0;
-            }
-            asn1_delete_structure(&certDef);
-            asn1_delete_structure(&certificat);
-            asn1_delete_structure(&root);
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### checkCertificate() End ###\n\n");
-            #endif
-            
-            return GLS_ERROR_ASN1;
-            
-        }
-        
-        /* Getting certificate for verification */
-        byte* tbsCert = malloc(sizeof(byte) * (end + 1 - start));
-        byte* tbsRootCert = malloc(sizeof(byte) * (rootEnd + 1 - rootStart));
-        if (tbsCert == NULL || tbsRootCert == NULL) {
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("No memory\n");
-            #endif
-            
-            /* Free memory */
-            if (certificatDer != NULL) {
-                free(certificatDer);
-                certificatDer = 0;
-            }
-            if (rootDer != NULL) {
-                free(rootDer);
-                rootDer = 0;
-            }
-            if (tbsCert != NULL) {
-                free(tbsCert);
-                tbsCert = 0;
-            }
-            if (tbsRootCert != NULL) {
-                free(tbsRootCert);
-                tbsRootCert = 0;
-            }
-            asn1_delete_structure(&certDef);
-            asn1_delete_structure(&certificat);
-            asn1_delete_structure(&root);
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### checkCertificate() End ###\n\n");
-            #endif
-            
-            return GLS_ERROR_NOMEM;
-        }
-        int i = 0;
-        for (i = 0; i < (end + 1 - start); i++) {
-            
-            tbsCert[i] = certificatDer[start + i];
-            
-        }
-        for (i = 0; i < (rootEnd + 1 - rootStart); i++) {
-            
-            tbsRootCert[i] = rootDer[rootStart + i];
-            
-        }
-        
-        /* Get the public key from the DER root certificate */
-        int lenPubKeyDer = 2048;
-        byte pubKeyDer[2048];
-        result = asn1_read_value(root, "tbsCertificate.subjectPublicKeyInfo.subjectPublicKey", pubKeyDer, &lenPubKeyDer);
-        
-        /* Get the certificate's signature to check */
-        int lenSignature = 2048;
-        byte signature[2048];
-        result2 = asn1_read_value(certificat, "signature", signature, &lenSignature);
-        
-        /* Get the root certificate's signature to check */
-        int lenSignatureRoot = 2048;
-        byte signatureRoot[2048];
-        int result3 = asn1_read_value(root, "signature", signatureRoot, &lenSignatureRoot);
-        
-        /* Error check */
-        if (result != ASN1_SUCCESS || result2 != ASN1_SUCCESS || result3 != ASN1_SUCCESS) {
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            if (result != ASN1_SUCCESS) printf("Impossible to extract key from Root Certificate\n");
-            else if (result2 != ASN1_SUCCESS) printf("Impossible to extract signature from certificate\n");
-            else printf("Impossible to extract signature from ROOT certificate\n");
-            #endif
-            
-            /* free memory */
-            if (certificatDer != NULL) {
-                free(certificatDer);
-                certificatDer = 0;
-            }
-            if (rootDer != NULL) {
-                free(rootDer);
-                rootDer = 0;
-            }
-            if (tbsCert != NULL) {
-                free(tbsCert);
-                tbsCert = 0;
-            }
-            if (tbsRootCert != NULL) {
-                free(tbsRootCert);
-                tbsRootCert = 0;
-            }
-            asn1_delete_structure(&certDef);
-            asn1_delete_structure(&certificat);
-            asn1_delete_structure(&root);
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### checkCertificate() End ###\n\n");
-            #endif
-            
-            return GLS_ERROR_ASN1;
-            
-        }
-        
-        /* Hash the certificates to compare the signatures */
-        byte MAC[20];
-        byte MACROOT[20];
-        gcry_md_hash_buffer(GCRY_MD_SHA1, MAC, tbsCert, (end + 1 - start));
-        gcry_md_hash_buffer(GCRY_MD_SHA1, MACROOT, tbsRootCert, (rootEnd + 1 - rootStart));
-        
-        /* Convertion public key DER in byte */
-        gcry_sexp_t gcryPubKey = 0;
-        int error = getPublicRsaFromDer(pubKeyDer, lenPubKeyDer, &gcryPubKey);
-        if (error < 0) {
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("Impossible to convert DER public key to byte\n");
-            #endif
-            
-            /* Free memory */
-            if (certificatDer != NULL) {
-                free(certificatDer);
-                certificatDer = 0;
-            }
-            if (rootDer != NULL) {
-                free(rootDer);
-                rootDer = 0;
-            }
-            if (tbsCert != NULL) {
-                free(tbsCert);
-                tbsCert = 0;
-            }
-            if (tbsRootCert != NULL) {
-                free(tbsRootCert);
-                tbsRootCert = 0;
-            }
-            if(gcryPubKey != 0){
-                gcry_sexp_release(gcryPubKey);
-                gcryPubKey = 0;
-            }
-            asn1_delete_structure(&certDef);
-            asn1_delete_structure(&certificat);
-            asn1_delete_structure(&root);
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### checkCertificate() End ###\n\n");
-            #endif
-            
-            return error;
-            
-        }
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        char signBufferPublickKey[2048];
-        int sizeSignPK = (int) gcry_sexp_sprint(gcryPubKey, GCRYSEXP_FMT_ADVANCED, signBufferPublickKey, 2048);
-        printf("gcryPubKey : ");
-        i = 0;
-        for (i = 0; i < sizeSignPK; i++) {
-            printf("%c", signBufferPublickKey[i]);
-        }
-        printf("\n");
-        #endif
-        
-        /* Creating the S-Exp for gcrypt */
-        gcry_sexp_t gcrySignature;
-        gcry_sexp_t gcrySignatureRoot;
-        gcry_sexp_t gcryCert;
-        gcry_sexp_t gcryCertRoot;
-        error = gcry_sexp_build(&gcrySignature, NULL, "(sig-val(rsa(s %b)))", (lenSignature / 8), signature);
-        error += gcry_sexp_build(&gcrySignatureRoot, NULL, "(sig-val(rsa(s %b)))", (lenSignatureRoot / 8), signatureRoot);
-        error += gcry_sexp_build(&gcryCert, NULL, "(data(flags pkcs1)(hash sha1 %b))", 20, MAC);
-        error += gcry_sexp_build(&gcryCertRoot, NULL, "(data(flags pkcs1)(hash sha1 %b))", 20, MACROOT);
-        if (error != 0) {
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("Error creating S-Exp for signature check\n");
-            #endif
-            
-            /* Free memory */
-            if (certificatDer != NULL) {
-                free(certificatDer);
-                certificatDer = 0;
-            }
-            if (rootDer != NULL) {
-                free(rootDer);
-                rootDer = 0;
-            }
-            if (tbsCert != NULL) {
-                free(tbsCert);
-                tbsCert = 0;
-            }
-            if (tbsRootCert != NULL) {
-                free(tbsRootCert);
-                tbsRootCert = 0;
-            }
-            if(gcryPubKey != 0){
-                gcry_sexp_release(gcryPubKey);
-                gcryPubKey = 0;
-            }
-            gcry_sexp_release(gcrySignature);
-            gcry_sexp_release(gcrySignatureRoot);
-            gcry_sexp_release(gcryCert);
-            gcry_sexp_release(gcryCertRoot);
-            asn1_delete_structure(&certDef);
-            asn1_delete_structure(&certificat);
-            asn1_delete_structure(&root);
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### checkCertificate() End ###\n\n");
-            #endif
-            
-            return GLS_ERROR_CRYPTO;
-            
-        }
+    /* Check for a root certificate */
+    if (myGLSSocket->m_roots == NULL) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("SHA1 certificat : ");
-        i = 0;
-        for (i = 0; i < 20; i++) {
-            printf("%2X",  MAC[i]);
-        }
-        printf("\n");
-        printf("SHA1 root certificat : ");
-        i = 0;
-        for (i = 0; i < 20; i++) {
-            printf("%2X",  MACROOT[i]);
-        }
-        printf("\n");
-        char keyBuffer[2048];
-        int sizePubKey = (int) gcry_sexp_sprint(gcryPubKey, GCRYSEXP_FMT_ADVANCED, keyBuffer, 2048);
-        printf("Root Public Key : ");
-        for (i = 0; i < sizePubKey; i++) {
-            printf("%c", keyBuffer[i]);
-        }
-        printf("\n");
-        char hashBuffer[2048];
-        int sizeHashBuffer = (int) gcry_sexp_sprint(gcryCert, GCRYSEXP_FMT_ADVANCED, hashBuffer, 2048);
-        printf("Hash certificate : ");
-        for (i = 0; i < sizeHashBuffer; i++) {
-            printf("%c", hashBuffer[i]);
-        }
-        printf("\n");
-        char hashBufferRoot[2048];
-        int sizeHashBufferRoot = (int) gcry_sexp_sprint(gcryCertRoot, GCRYSEXP_FMT_ADVANCED, hashBufferRoot, 2048);
-        printf("Hash root certificate : ");
-        for (i = 0; i < sizeHashBufferRoot; i++) {
-            printf("%c", hashBufferRoot[i]);
-        }
-        printf("\n");
-        char signBuffer[2048];
-        int sizeSign = (int) gcry_sexp_sprint(gcrySignature, GCRYSEXP_FMT_ADVANCED, signBuffer, 2048);
-        printf("Signature certificate : ");
-        for (i = 0; i < sizeSign; i++) {
-            printf("%c", signBuffer[i]);
-        }
-        printf("\n");
-        printf("Size Signature : %d bytes\n", (lenSignature/8));
-        char signBufferRoot[2048];
-        int sizeSignRoot = (int) gcry_sexp_sprint(gcrySignatureRoot, GCRYSEXP_FMT_ADVANCED, signBufferRoot, 2048);
-        printf("Signature certificate ROOT : ");
-        for (i = 0; i < sizeSignRoot; i++) {
-            printf("%c", signBufferRoot[i]);
-        }
-        printf("\n");
-        printf("Size Signature ROOT : %d bytes\n", (lenSignatureRoot/8));
+        printf("No root certificate");
+        printf("### checkCertificate() End ###\n\n");
         #endif
         
-        /* signature check */
-        error = gcry_pk_verify(gcrySignature, gcryCert, gcryPubKey);
-        int error2 = gcry_pk_verify(gcrySignatureRoot, gcryCertRoot, gcryPubKey);        
+        return GLS_ERROR_NOCERT;
         
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Error Verify Certificate: %d\n", error);
-        printf("%s\n", gcry_strerror(error));
-        printf("Validation Root Certificate : %d\n", error2);
-        printf("%s\n", gcry_strerror(error2));
-        #endif
+    }
+    
+    GLSCertVerdict verdict;
+    memset(&verdict, 0, sizeof(GLSCertVerdict));
+    int isFingerprint = certFingerprint(cert, certLen, verdict.m_fingerprint) == 0;
+    
+    /* Full verification if not in the cache or if the root isn't trusted by this socket */
+    if (isFingerprint == 0 || findCertVerdict(&verdict) == 0 || hasRootCert(myGLSSocket->m_roots, verdict.m_issuer, verdict.m_root) == 0) {
         
-        if (error != 0 || error2 != 0) {
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            if (error != 0) printf("Error Certificate not valide\n");
-            else printf("Error Root Certificate not valide\n");
-            #endif
-            
-            /* Free memory */
-            if (certificatDer != NULL) {
-                free(certificatDer);
-                certificatDer = 0;
-            }
-            if (rootDer != NULL) {
-                free(rootDer);
-                rootDer = 0;
-            }
-            if (tbsCert != NULL) {
-                free(tbsCert);
-                tbsCert = 0;
-            }
-            if (tbsRootCert != NULL) {
-                free(tbsRootCert);
-                tbsRootCert = 0;
-            }
-            if(gcryPubKey != 0){
-                gcry_sexp_release(gcryPubKey);
-                gcryPubKey = 0;
-            }
-            gcry_sexp_release(gcrySignature);
-            gcry_sexp_release(gcrySignatureRoot);
-            gcry_sexp_release(gcryCert);
-            gcry_sexp_release(gcryCertRoot);
-            asn1_delete_structure(&certDef);
-            asn1_delete_structure(&certificat);
-            asn1_delete_structure(&root);
+        int result = verifyCertificate(myGLSSocket->m_roots, cert, certLen, &verdict);
+        if (result != 0) {
             
             /* Debug Only */
             #if defined (GLS_DEBUG_MODE_ENABLE)
             printf("### checkCertificate() End ###\n\n");
             #endif
             
-            if (error != 0) return GLS_ERROR_BADSERVERCERT;
-            else return GLS_ERROR_BADROOTCERT;
+            return result;
+            
         }
         
-        /* Free memory for if condition */
-        if (tbsCert != NULL) {
-            free(tbsCert);
-            tbsCert = 0;
-        }
-        if (tbsRootCert != NULL) {
-            free(tbsRootCert);
-            tbsRootCert = 0;
-        }
-        if(gcryPubKey != 0){
-            gcry_sexp_release(gcryPubKey);
-            gcryPubKey = 0;
-        }
-        gcry_sexp_release(gcrySignature);
-        gcry_sexp_release(gcrySignatureRoot);
-        gcry_sexp_release(gcryCert);
-        gcry_sexp_release(gcryCertRoot);
+        if (isFingerprint == 1) storeCertVerdict(&verdict);
         
     }
-    else {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Certificate signature != SHA1+RSA\n");
-        #endif
-        
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if (rootDer != NULL) {
-            free(rootDer);
-            rootDer = 0;
-        }
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
-        asn1_delete_structure(&root);
+    
+    /* Check serial in CRL (binary search) */
+    if (myGLSSocket->m_crl != NULL && isEntryInCrl(myGLSSocket->m_crl, verdict.m_serial) == 1) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error - Certificate in CRL\n");
         printf("### checkCertificate() End ###\n\n");
         #endif
         
@@ -3124,19 +1560,6 @@ int checkCertificate(GLSSock* myGLSSocket, const byte *cert, const int certLen)
         
     }
     
-    /* Free memory */
-    if (certificatDer != NULL) {
-        free(certificatDer);
-        certificatDer = 0;
-    }
-    if (rootDer != NULL) {
-        free(rootDer);
-        rootDer = 0;
-    }
-    asn1_delete_structure(&certDef);
-    asn1_delete_structure(&certificat);
-    asn1_delete_structure(&root);
-    
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
     printf("### checkCertificate() End ###\n\n");
@@ -3153,894 +1576,26 @@ int checkCertificate(GLSSock* myGLSSocket, const byte *cert, const int certLen)
  
  PRIVATE
  
- Extract Certificate Public key size. Return the size of key or a 
- negative number for an error.
+ Extract the public key of a certificate in a gcry_sexp_t,
+ parsed one time to encrypt all the chunks of a message.
+ The caller releases publicKey with gcry_sexp_release().
+ 
+ Return the modulus size in bits or a negative number for
+ an error.
  
  ---------------------------------------------------------*/
 
-int getModulusSize(const byte *cert, const int certLen) {
+int getPublicKeyFromCert(const byte *cert, const int certLen, gcry_sexp_t *publicKey) {
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### getModulusSize() Start ###\n");
+    printf("### getPublicKeyFromCert() Start ###\n");
     #endif
     
     /* argument check */
     if (certLen <= 0 || cert == NULL) return GLS_ERROR_NOCERT;
     
     /* Certificate structure definition */
-    ASN1_ARRAY_TYPE structCertificat[] = {
-        { "PKIX1Implicit88", 536875024, NULL },
-        { NULL, 1610612748, NULL },
-        { "iso", 1073741825, "1"},
-        { "identified-organization", 1073741825, "3"},
-        { "dod", 1073741825, "6"},
-        { "internet", 1073741825, "1"},
-        { "security", 1073741825, "5"},
-        { "mechanisms", 1073741825, "5"},
-        { "pkix", 1073741825, "7"},
-        { "id-mod", 1073741825, "0"},
-        { "id-pkix1-implicit-88", 1, "2"},
-        { "id-ce", 1879048204, NULL },
-        { "joint-iso-ccitt", 1073741825, "2"},
-        { "ds", 1073741825, "5"},
-        { NULL, 1, "29"},
-        { "id-ce-authorityKeyIdentifier", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "35"},
-        { "AuthorityKeyIdentifier", 1610612741, NULL },
-        { "keyIdentifier", 1610637314, "KeyIdentifier"},
-        { NULL, 4104, "0"},
-        { "authorityCertIssuer", 1610637314, "GeneralNames"},
-        { NULL, 4104, "1"},
-        { "authorityCertSerialNumber", 536895490, "CertificateSerialNumber"},
-        { NULL, 4104, "2"},
-        { "KeyIdentifier", 1073741831, NULL },
-        { "id-ce-subjectKeyIdentifier", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "14"},
-        { "SubjectKeyIdentifier", 1073741826, "KeyIdentifier"},
-        { "id-ce-keyUsage", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "15"},
-        { "KeyUsage", 1610874886, NULL },
-        { "digitalSignature", 1073741825, "0"},
-        { "nonRepudiation", 1073741825, "1"},
-        { "keyEncipherment", 1073741825, "2"},
-        { "dataEncipherment", 1073741825, "3"},
-        { "keyAgreement", 1073741825, "4"},
-        { "keyCertSign", 1073741825, "5"},
-        { "cRLSign", 1073741825, "6"},
-        { "encipherOnly", 1073741825, "7"},
-        { "decipherOnly", 1, "8"},
-        { "id-ce-privateKeyUsagePeriod", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "16"},
-        { "PrivateKeyUsagePeriod", 1610612741, NULL },
-        { "notBefore", 1619025937, NULL },
-        { NULL, 4104, "0"},
-        { "notAfter", 545284113, NULL },
-        { NULL, 4104, "1"},
-        { "id-ce-certificatePolicies", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "32"},
-        { "CertificatePolicies", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "PolicyInformation"},
-        { "PolicyInformation", 1610612741, NULL },
-        { "policyIdentifier", 1073741826, "CertPolicyId"},
-        { "policyQualifiers", 538984459, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "PolicyQualifierInfo"},
-        { "CertPolicyId", 1073741836, NULL },
-        { "PolicyQualifierInfo", 1610612741, NULL },
-        { "policyQualifierId", 1073741826, "PolicyQualifierId"},
-        { "qualifier", 541065229, NULL },
-        { "policyQualifierId", 1, NULL },
-        { "PolicyQualifierId", 1073741836, NULL },
-        { "CPSuri", 1073741826, "IA5String"},
-        { "UserNotice", 1610612741, NULL },
-        { "noticeRef", 1073758210, "NoticeReference"},
-        { "explicitText", 16386, "DisplayText"},
-        { "NoticeReference", 1610612741, NULL },
-        { "organization", 1073741826, "DisplayText"},
-        { "noticeNumbers", 536870923, NULL },
-        { NULL, 3, NULL },
-        { "DisplayText", 1610612754, NULL },
-        { "visibleString", 1612709890, "VisibleString"},
-        { "200", 524298, "1"},
-        { "bmpString", 1612709890, "BMPString"},
-        { "200", 524298, "1"},
-        { "utf8String", 538968066, "UTF8String"},
-        { "200", 524298, "1"},
-        { "id-ce-policyMappings", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "33"},
-        { "PolicyMappings", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 536870917, NULL },
-        { "issuerDomainPolicy", 1073741826, "CertPolicyId"},
-        { "subjectDomainPolicy", 2, "CertPolicyId"},
-        { "id-ce-subjectAltName", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "17"},
-        { "SubjectAltName", 1073741826, "GeneralNames"},
-        { "GeneralNames", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "GeneralName"},
-        { "GeneralName", 1610612754, NULL },
-        { "otherName", 1610620930, "AnotherName"},
-        { NULL, 4104, "0"},
-        { "rfc822Name", 1610620930, "IA5String"},
-        { NULL, 4104, "1"},
-        { "dNSName", 1610620930, "IA5String"},
-        { NULL, 4104, "2"},
-        { "x400Address", 1610620930, "ORAddress"},
-        { NULL, 4104, "3"},
-        { "directoryName", 1610620930, "Name"},
-        { NULL, 4104, "4"},
-        { "ediPartyName", 1610620930, "EDIPartyName"},
-        { NULL, 4104, "5"},
-        { "uniformResourceIdentifier", 1610620930, "IA5String"},
-        { NULL, 4104, "6"},
-        { "iPAddress", 1610620935, NULL },
-        { NULL, 4104, "7"},
-        { "registeredID", 536879116, NULL },
-        { NULL, 4104, "8"},
-        { "AnotherName", 1610612741, NULL },
-        { "type-id", 1073741836, NULL },
-        { "value", 541073421, NULL },
-        { NULL, 1073743880, "0"},
-        { "type-id", 1, NULL },
-        { "EDIPartyName", 1610612741, NULL },
-        { "nameAssigner", 1610637314, "DirectoryString"},
-        { NULL, 4104, "0"},
-        { "partyName", 536879106, "DirectoryString"},
-        { NULL, 4104, "1"},
-        { "id-ce-issuerAltName", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "18"},
-        { "IssuerAltName", 1073741826, "GeneralNames"},
-        { "id-ce-subjectDirectoryAttributes", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "9"},
-        { "SubjectDirectoryAttributes", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "Attribute"},
-        { "id-ce-basicConstraints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "19"},
-        { "BasicConstraints", 1610612741, NULL },
-        { "cA", 1610645508, NULL },
-        { NULL, 131081, NULL },
-        { "pathLenConstraint", 537411587, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-nameConstraints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "30"},
-        { "NameConstraints", 1610612741, NULL },
-        { "permittedSubtrees", 1610637314, "GeneralSubtrees"},
-        { NULL, 4104, "0"},
-        { "excludedSubtrees", 536895490, "GeneralSubtrees"},
-        { NULL, 4104, "1"},
-        { "GeneralSubtrees", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "GeneralSubtree"},
-        { "GeneralSubtree", 1610612741, NULL },
-        { "base", 1073741826, "GeneralName"},
-        { "minimum", 1610653698, "BaseDistance"},
-        { NULL, 1073741833, "0"},
-        { NULL, 4104, "0"},
-        { "maximum", 536895490, "BaseDistance"},
-        { NULL, 4104, "1"},
-        { "BaseDistance", 1611137027, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-policyConstraints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "36"},
-        { "PolicyConstraints", 1610612741, NULL },
-        { "requireExplicitPolicy", 1610637314, "SkipCerts"},
-        { NULL, 4104, "0"},
-        { "inhibitPolicyMapping", 536895490, "SkipCerts"},
-        { NULL, 4104, "1"},
-        { "SkipCerts", 1611137027, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-cRLDistributionPoints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "31"},
-        { "CRLDistPointsSyntax", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "DistributionPoint"},
-        { "DistributionPoint", 1610612741, NULL },
-        { "distributionPoint", 1610637314, "DistributionPointName"},
-        { NULL, 4104, "0"},
-        { "reasons", 1610637314, "ReasonFlags"},
-        { NULL, 4104, "1"},
-        { "cRLIssuer", 536895490, "GeneralNames"},
-        { NULL, 4104, "2"},
-        { "DistributionPointName", 1610612754, NULL },
-        { "fullName", 1610620930, "GeneralNames"},
-        { NULL, 4104, "0"},
-        { "nameRelativeToCRLIssuer", 536879106, "RelativeDistinguishedName"},
-        { NULL, 4104, "1"},
-        { "ReasonFlags", 1610874886, NULL },
-        { "unused", 1073741825, "0"},
-        { "keyCompromise", 1073741825, "1"},
-        { "cACompromise", 1073741825, "2"},
-        { "affiliationChanged", 1073741825, "3"},
-        { "superseded", 1073741825, "4"},
-        { "cessationOfOperation", 1073741825, "5"},
-        { "certificateHold", 1, "6"},
-        { "id-ce-extKeyUsage", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "37"},
-        { "ExtKeyUsageSyntax", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "KeyPurposeId"},
-        { "KeyPurposeId", 1073741836, NULL },
-        { "id-kp-serverAuth", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "1"},
-        { "id-kp-clientAuth", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "2"},
-        { "id-kp-codeSigning", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "3"},
-        { "id-kp-emailProtection", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "4"},
-        { "id-kp-ipsecEndSystem", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "5"},
-        { "id-kp-ipsecTunnel", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "6"},
-        { "id-kp-ipsecUser", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "7"},
-        { "id-kp-timeStamping", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "8"},
-        { "id-pe-authorityInfoAccess", 1879048204, NULL },
-        { NULL, 1073741825, "id-pe"},
-        { NULL, 1, "1"},
-        { "AuthorityInfoAccessSyntax", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "AccessDescription"},
-        { "AccessDescription", 1610612741, NULL },
-        { "accessMethod", 1073741836, NULL },
-        { "accessLocation", 2, "GeneralName"},
-        { "id-ce-cRLNumber", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "20"},
-        { "CRLNumber", 1611137027, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-issuingDistributionPoint", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "28"},
-        { "IssuingDistributionPoint", 1610612741, NULL },
-        { "distributionPoint", 1610637314, "DistributionPointName"},
-        { NULL, 4104, "0"},
-        { "onlyContainsUserCerts", 1610653700, NULL },
-        { NULL, 1073872905, NULL },
-        { NULL, 4104, "1"},
-        { "onlyContainsCACerts", 1610653700, NULL },
-        { NULL, 1073872905, NULL },
-        { NULL, 4104, "2"},
-        { "onlySomeReasons", 1610637314, "ReasonFlags"},
-        { NULL, 4104, "3"},
-        { "indirectCRL", 536911876, NULL },
-        { NULL, 1073872905, NULL },
-        { NULL, 4104, "4"},
-        { "id-ce-deltaCRLIndicator", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "27"},
-        { "BaseCRLNumber", 1073741826, "CRLNumber"},
-        { "id-ce-cRLReasons", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "21"},
-        { "CRLReason", 1610874901, NULL },
-        { "unspecified", 1073741825, "0"},
-        { "keyCompromise", 1073741825, "1"},
-        { "cACompromise", 1073741825, "2"},
-        { "affiliationChanged", 1073741825, "3"},
-        { "superseded", 1073741825, "4"},
-        { "cessationOfOperation", 1073741825, "5"},
-        { "certificateHold", 1073741825, "6"},
-        { "removeFromCRL", 1, "8"},
-        { "id-ce-certificateIssuer", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "29"},
-        { "CertificateIssuer", 1073741826, "GeneralNames"},
-        { "id-ce-holdInstructionCode", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "23"},
-        { "HoldInstructionCode", 1073741836, NULL },
-        { "holdInstruction", 1879048204, NULL },
-        { "joint-iso-itu-t", 1073741825, "2"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "x9cm", 1073741825, "10040"},
-        { NULL, 1, "2"},
-        { "id-holdinstruction-none", 1879048204, NULL },
-        { NULL, 1073741825, "holdInstruction"},
-        { NULL, 1, "1"},
-        { "id-holdinstruction-callissuer", 1879048204, NULL },
-        { NULL, 1073741825, "holdInstruction"},
-        { NULL, 1, "2"},
-        { "id-holdinstruction-reject", 1879048204, NULL },
-        { NULL, 1073741825, "holdInstruction"},
-        { NULL, 1, "3"},
-        { "id-ce-invalidityDate", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "24"},
-        { "InvalidityDate", 1082130449, NULL },
-        { "VisibleString", 1610620935, NULL },
-        { NULL, 4360, "26"},
-        { "NumericString", 1610620935, NULL },
-        { NULL, 4360, "18"},
-        { "IA5String", 1610620935, NULL },
-        { NULL, 4360, "22"},
-        { "TeletexString", 1610620935, NULL },
-        { NULL, 4360, "20"},
-        { "PrintableString", 1610620935, NULL },
-        { NULL, 4360, "19"},
-        { "UniversalString", 1610620935, NULL },
-        { NULL, 4360, "28"},
-        { "BMPString", 1610620935, NULL },
-        { NULL, 4360, "30"},
-        { "UTF8String", 1610620935, NULL },
-        { NULL, 4360, "12"},
-        { "id-pkix", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "identified-organization", 1073741825, "3"},
-        { "dod", 1073741825, "6"},
-        { "internet", 1073741825, "1"},
-        { "security", 1073741825, "5"},
-        { "mechanisms", 1073741825, "5"},
-        { "pkix", 1, "7"},
-        { "id-pe", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "1"},
-        { "id-qt", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "2"},
-        { "id-kp", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "3"},
-        { "id-ad", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "48"},
-        { "id-qt-cps", 1879048204, NULL },
-        { NULL, 1073741825, "id-qt"},
-        { NULL, 1, "1"},
-        { "id-qt-unotice", 1879048204, NULL },
-        { NULL, 1073741825, "id-qt"},
-        { NULL, 1, "2"},
-        { "id-ad-ocsp", 1879048204, NULL },
-        { NULL, 1073741825, "id-ad"},
-        { NULL, 1, "1"},
-        { "id-ad-caIssuers", 1879048204, NULL },
-        { NULL, 1073741825, "id-ad"},
-        { NULL, 1, "2"},
-        { "Attribute", 1610612741, NULL },
-        { "type", 1073741826, "AttributeType"},
-        { "values", 536870927, NULL },
-        { NULL, 2, "AttributeValue"},
-        { "AttributeType", 1073741836, NULL },
-        { "AttributeValue", 1073741837, NULL },
-        { "AttributeTypeAndValue", 1610612741, NULL },
-        { "type", 1073741826, "AttributeType"},
-        { "value", 2, "AttributeValue"},
-        { "id-at", 1879048204, NULL },
-        { "joint-iso-ccitt", 1073741825, "2"},
-        { "ds", 1073741825, "5"},
-        { NULL, 1, "4"},
-        { "id-at-name", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "41"},
-        { "id-at-surname", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "4"},
-        { "id-at-givenName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "42"},
-        { "id-at-initials", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "43"},
-        { "id-at-generationQualifier", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "44"},
-        { "X520name", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-name", 524298, "1"},
-        { "id-at-commonName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "3"},
-        { "X520CommonName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-common-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-common-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-common-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-common-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-common-name", 524298, "1"},
-        { "id-at-localityName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "7"},
-        { "X520LocalityName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-locality-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-locality-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-locality-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-locality-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-locality-name", 524298, "1"},
-        { "id-at-stateOrProvinceName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "8"},
-        { "X520StateOrProvinceName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-state-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-state-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-state-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-state-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-state-name", 524298, "1"},
-        { "id-at-organizationName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "10"},
-        { "X520OrganizationName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-organization-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-organization-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-organization-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-organization-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-organization-name", 524298, "1"},
-        { "id-at-organizationalUnitName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "11"},
-        { "X520OrganizationalUnitName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "id-at-title", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "12"},
-        { "X520Title", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-title", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-title", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-title", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-title", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-title", 524298, "1"},
-        { "id-at-dnQualifier", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "46"},
-        { "X520dnQualifier", 1073741826, "PrintableString"},
-        { "id-at-countryName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "6"},
-        { "X520countryName", 1612709890, "PrintableString"},
-        { NULL, 1048586, "2"},
-        { "pkcs-9", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "rsadsi", 1073741825, "113549"},
-        { "pkcs", 1073741825, "1"},
-        { NULL, 1, "9"},
-        { "emailAddress", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "pkcs-9"},
-        { NULL, 1, "1"},
-        { "Pkcs9email", 1612709890, "IA5String"},
-        { "ub-emailaddress-length", 524298, "1"},
-        { "Name", 1610612754, NULL },
-        { "rdnSequence", 2, "RDNSequence"},
-        { "RDNSequence", 1610612747, NULL },
-        { NULL, 2, "RelativeDistinguishedName"},
-        { "DistinguishedName", 1073741826, "RDNSequence"},
-        { "RelativeDistinguishedName", 1612709903, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "AttributeTypeAndValue"},
-        { "DirectoryString", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "MAX", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "MAX", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "MAX", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "MAX", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "MAX", 524298, "1"},
-        { "Certificate", 1610612741, NULL },
-        { "tbsCertificate", 1073741826, "TBSCertificate"},
-        { "signatureAlgorithm", 1073741826, "AlgorithmIdentifier"},
-        { "signature", 6, NULL },
-        { "TBSCertificate", 1610612741, NULL },
-        { "version", 1610653698, "Version"},
-        { NULL, 1073741833, "v1"},
-        { NULL, 2056, "0"},
-        { "serialNumber", 1073741826, "CertificateSerialNumber"},
-        { "signature", 1073741826, "AlgorithmIdentifier"},
-        { "issuer", 1073741826, "Name"},
-        { "validity", 1073741826, "Validity"},
-        { "subject", 1073741826, "Name"},
-        { "subjectPublicKeyInfo", 1073741826, "SubjectPublicKeyInfo"},
-        { "issuerUniqueID", 1610637314, "UniqueIdentifier"},
-        { NULL, 4104, "1"},
-        { "subjectUniqueID", 1610637314, "UniqueIdentifier"},
-        { NULL, 4104, "2"},
-        { "extensions", 536895490, "Extensions"},
-        { NULL, 2056, "3"},
-        { "Version", 1610874883, NULL },
-        { "v1", 1073741825, "0"},
-        { "v2", 1073741825, "1"},
-        { "v3", 1, "2"},
-        { "CertificateSerialNumber", 1073741827, NULL },
-        { "Validity", 1610612741, NULL },
-        { "notBefore", 1073741826, "Time"},
-        { "notAfter", 2, "Time"},
-        { "Time", 1610612754, NULL },
-        { "utcTime", 1090519057, NULL },
-        { "generalTime", 8388625, NULL },
-        { "UniqueIdentifier", 1073741830, NULL },
-        { "SubjectPublicKeyInfo", 1610612741, NULL },
-        { "algorithm", 1073741826, "AlgorithmIdentifier"},
-        { "subjectPublicKey", 6, NULL },
-        { "Extensions", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "Extension"},
-        { "Extension", 1610612741, NULL },
-        { "extnID", 1073741836, NULL },
-        { "critical", 1610645508, NULL },
-        { NULL, 131081, NULL },
-        { "extnValue", 7, NULL },
-        { "CertificateList", 1610612741, NULL },
-        { "tbsCertList", 1073741826, "TBSCertList"},
-        { "signatureAlgorithm", 1073741826, "AlgorithmIdentifier"},
-        { "signature", 6, NULL },
-        { "TBSCertList", 1610612741, NULL },
-        { "version", 1073758210, "Version"},
-        { "signature", 1073741826, "AlgorithmIdentifier"},
-        { "issuer", 1073741826, "Name"},
-        { "thisUpdate", 1073741826, "Time"},
-        { "nextUpdate", 1073758210, "Time"},
-        { "revokedCertificates", 1610629131, NULL },
-        { NULL, 536870917, NULL },
-        { "userCertificate", 1073741826, "CertificateSerialNumber"},
-        { "revocationDate", 1073741826, "Time"},
-        { "crlEntryExtensions", 16386, "Extensions"},
-        { "crlExtensions", 536895490, "Extensions"},
-        { NULL, 2056, "0"},
-        { "AlgorithmIdentifier", 1610612741, NULL },
-        { "algorithm", 1073741836, NULL },
-        { "parameters", 541081613, NULL },
-        { "algorithm", 1, NULL },
-        { "pkcs-1", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "rsadsi", 1073741825, "113549"},
-        { "pkcs", 1073741825, "1"},
-        { NULL, 1, "1"},
-        { "rsaEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "1"},
-        { "md2WithRSAEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "2"},
-        { "md5WithRSAEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "4"},
-        { "sha1WithRSAEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "5"},
-        { "id-dsa-with-sha1", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "x9-57", 1073741825, "10040"},
-        { "x9algorithm", 1073741825, "4"},
-        { NULL, 1, "3"},
-        { "Dss-Sig-Value", 1610612741, NULL },
-        { "r", 1073741827, NULL },
-        { "s", 3, NULL },
-        { "dhpublicnumber", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "ansi-x942", 1073741825, "10046"},
-        { "number-type", 1073741825, "2"},
-        { NULL, 1, "1"},
-        { "DomainParameters", 1610612741, NULL },
-        { "p", 1073741827, NULL },
-        { "g", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "j", 1073758211, NULL },
-        { "validationParms", 16386, "ValidationParms"},
-        { "ValidationParms", 1610612741, NULL },
-        { "seed", 1073741830, NULL },
-        { "pgenCounter", 3, NULL },
-        { "id-dsa", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "x9-57", 1073741825, "10040"},
-        { "x9algorithm", 1073741825, "4"},
-        { NULL, 1, "1"},
-        { "Dss-Parms", 1610612741, NULL },
-        { "p", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "g", 3, NULL },
-        { "ORAddress", 1610612741, NULL },
-        { "built-in-standard-attributes", 1073741826, "BuiltInStandardAttributes"},
-        { "built-in-domain-defined-attributes", 1073758210, "BuiltInDomainDefinedAttributes"},
-        { "extension-attributes", 16386, "ExtensionAttributes"},
-        { "BuiltInStandardAttributes", 1610612741, NULL },
-        { "country-name", 1073758210, "CountryName"},
-        { "administration-domain-name", 1073758210, "AdministrationDomainName"},
-        { "network-address", 1610637314, "NetworkAddress"},
-        { NULL, 2056, "0"},
-        { "terminal-identifier", 1610637314, "TerminalIdentifier"},
-        { NULL, 2056, "1"},
-        { "private-domain-name", 1610637314, "PrivateDomainName"},
-        { NULL, 2056, "2"},
-        { "organization-name", 1610637314, "OrganizationName"},
-        { NULL, 2056, "3"},
-        { "numeric-user-identifier", 1610637314, "NumericUserIdentifier"},
-        { NULL, 2056, "4"},
-        { "personal-name", 1610637314, "PersonalName"},
-        { NULL, 2056, "5"},
-        { "organizational-unit-names", 536895490, "OrganizationalUnitNames"},
-        { NULL, 2056, "6"},
-        { "CountryName", 1610620946, NULL },
-        { NULL, 1073746952, "1"},
-        { "x121-dcc-code", 1612709890, "NumericString"},
-        { NULL, 1048586, "ub-country-name-numeric-length"},
-        { "iso-3166-alpha2-code", 538968066, "PrintableString"},
-        { NULL, 1048586, "ub-country-name-alpha-length"},
-        { "AdministrationDomainName", 1610620946, NULL },
-        { NULL, 1073744904, "2"},
-        { "numeric", 1612709890, "NumericString"},
-        { "ub-domain-name-length", 524298, "0"},
-        { "printable", 538968066, "PrintableString"},
-        { "ub-domain-name-length", 524298, "0"},
-        { "NetworkAddress", 1073741826, "X121Address"},
-        { "X121Address", 1612709890, "NumericString"},
-        { "ub-x121-address-length", 524298, "1"},
-        { "TerminalIdentifier", 1612709890, "PrintableString"},
-        { "ub-terminal-id-length", 524298, "1"},
-        { "PrivateDomainName", 1610612754, NULL },
-        { "numeric", 1612709890, "NumericString"},
-        { "ub-domain-name-length", 524298, "1"},
-        { "printable", 538968066, "PrintableString"},
-        { "ub-domain-name-length", 524298, "1"},
-        { "OrganizationName", 1612709890, "PrintableString"},
-        { "ub-organization-name-length", 524298, "1"},
-        { "NumericUserIdentifier", 1612709890, "NumericString"},
-        { "ub-numeric-user-id-length", 524298, "1"},
-        { "PersonalName", 1610612750, NULL },
-        { "surname", 1814044674, "PrintableString"},
-        { NULL, 1073745928, "0"},
-        { "ub-surname-length", 524298, "1"},
-        { "given-name", 1814061058, "PrintableString"},
-        { NULL, 1073745928, "1"},
-        { "ub-given-name-length", 524298, "1"},
-        { "initials", 1814061058, "PrintableString"},
-        { NULL, 1073745928, "2"},
-        { "ub-initials-length", 524298, "1"},
-        { "generation-qualifier", 740319234, "PrintableString"},
-        { NULL, 1073745928, "3"},
-        { "ub-generation-qualifier-length", 524298, "1"},
-        { "OrganizationalUnitNames", 1612709899, NULL },
-        { "ub-organizational-units", 1074266122, "1"},
-        { NULL, 2, "OrganizationalUnitName"},
-        { "OrganizationalUnitName", 1612709890, "PrintableString"},
-        { "ub-organizational-unit-name-length", 524298, "1"},
-        { "BuiltInDomainDefinedAttributes", 1612709899, NULL },
-        { "ub-domain-defined-attributes", 1074266122, "1"},
-        { NULL, 2, "BuiltInDomainDefinedAttribute"},
-        { "BuiltInDomainDefinedAttribute", 1610612741, NULL },
-        { "type", 1612709890, "PrintableString"},
-        { "ub-domain-defined-attribute-type-length", 524298, "1"},
-        { "value", 538968066, "PrintableString"},
-        { "ub-domain-defined-attribute-value-length", 524298, "1"},
-        { "ExtensionAttributes", 1612709903, NULL },
-        { "ub-extension-attributes", 1074266122, "1"},
-        { NULL, 2, "ExtensionAttribute"},
-        { "ExtensionAttribute", 1610612741, NULL },
-        { "extension-attribute-type", 1611145219, NULL },
-        { NULL, 1073743880, "0"},
-        { "0", 10, "ub-extension-attributes"},
-        { "extension-attribute-value", 541073421, NULL },
-        { NULL, 1073743880, "1"},
-        { "extension-attribute-type", 1, NULL },
-        { "common-name", 1342177283, "1"},
-        { "CommonName", 1612709890, "PrintableString"},
-        { "ub-common-name-length", 524298, "1"},
-        { "teletex-common-name", 1342177283, "2"},
-        { "TeletexCommonName", 1612709890, "TeletexString"},
-        { "ub-common-name-length", 524298, "1"},
-        { "teletex-organization-name", 1342177283, "3"},
-        { "TeletexOrganizationName", 1612709890, "TeletexString"},
-        { "ub-organization-name-length", 524298, "1"},
-        { "teletex-personal-name", 1342177283, "4"},
-        { "TeletexPersonalName", 1610612750, NULL },
-        { "surname", 1814044674, "TeletexString"},
-        { NULL, 1073743880, "0"},
-        { "ub-surname-length", 524298, "1"},
-        { "given-name", 1814061058, "TeletexString"},
-        { NULL, 1073743880, "1"},
-        { "ub-given-name-length", 524298, "1"},
-        { "initials", 1814061058, "TeletexString"},
-        { NULL, 1073743880, "2"},
-        { "ub-initials-length", 524298, "1"},
-        { "generation-qualifier", 740319234, "TeletexString"},
-        { NULL, 1073743880, "3"},
-        { "ub-generation-qualifier-length", 524298, "1"},
-        { "teletex-organizational-unit-names", 1342177283, "5"},
-        { "TeletexOrganizationalUnitNames", 1612709899, NULL },
-        { "ub-organizational-units", 1074266122, "1"},
-        { NULL, 2, "TeletexOrganizationalUnitName"},
-        { "TeletexOrganizationalUnitName", 1612709890, "TeletexString"},
-        { "ub-organizational-unit-name-length", 524298, "1"},
-        { "pds-name", 1342177283, "7"},
-        { "PDSName", 1612709890, "PrintableString"},
-        { "ub-pds-name-length", 524298, "1"},
-        { "physical-delivery-country-name", 1342177283, "8"},
-        { "PhysicalDeliveryCountryName", 1610612754, NULL },
-        { "x121-dcc-code", 1612709890, "NumericString"},
-        { NULL, 1048586, "ub-country-name-numeric-length"},
-        { "iso-3166-alpha2-code", 538968066, "PrintableString"},
-        { NULL, 1048586, "ub-country-name-alpha-length"},
-        { "postal-code", 1342177283, "9"},
-        { "PostalCode", 1610612754, NULL },
-        { "numeric-code", 1612709890, "NumericString"},
-        { "ub-postal-code-length", 524298, "1"},
-        { "printable-code", 538968066, "PrintableString"},
-        { "ub-postal-code-length", 524298, "1"},
-        { "physical-delivery-office-name", 1342177283, "10"},
-        { "PhysicalDeliveryOfficeName", 1073741826, "PDSParameter"},
-        { "physical-delivery-office-number", 1342177283, "11"},
-        { "PhysicalDeliveryOfficeNumber", 1073741826, "PDSParameter"},
-        { "extension-OR-address-components", 1342177283, "12"},
-        { "ExtensionORAddressComponents", 1073741826, "PDSParameter"},
-        { "physical-delivery-personal-name", 1342177283, "13"},
-        { "PhysicalDeliveryPersonalName", 1073741826, "PDSParameter"},
-        { "physical-delivery-organization-name", 1342177283, "14"},
-        { "PhysicalDeliveryOrganizationName", 1073741826, "PDSParameter"},
-        { "extension-physical-delivery-address-components", 1342177283, "15"},
-        { "ExtensionPhysicalDeliveryAddressComponents", 1073741826, "PDSParameter"},
-        { "unformatted-postal-address", 1342177283, "16"},
-        { "UnformattedPostalAddress", 1610612750, NULL },
-        { "printable-address", 1814052875, NULL },
-        { "ub-pds-physical-address-lines", 1074266122, "1"},
-        { NULL, 538968066, "PrintableString"},
-        { "ub-pds-parameter-length", 524298, "1"},
-        { "teletex-string", 740311042, "TeletexString"},
-        { "ub-unformatted-address-length", 524298, "1"},
-        { "street-address", 1342177283, "17"},
-        { "StreetAddress", 1073741826, "PDSParameter"},
-        { "post-office-box-address", 1342177283, "18"},
-        { "PostOfficeBoxAddress", 1073741826, "PDSParameter"},
-        { "poste-restante-address", 1342177283, "19"},
-        { "PosteRestanteAddress", 1073741826, "PDSParameter"},
-        { "unique-postal-name", 1342177283, "20"},
-        { "UniquePostalName", 1073741826, "PDSParameter"},
-        { "local-postal-attributes", 1342177283, "21"},
-        { "LocalPostalAttributes", 1073741826, "PDSParameter"},
-        { "PDSParameter", 1610612750, NULL },
-        { "printable-string", 1814052866, "PrintableString"},
-        { "ub-pds-parameter-length", 524298, "1"},
-        { "teletex-string", 740311042, "TeletexString"},
-        { "ub-pds-parameter-length", 524298, "1"},
-        { "extended-network-address", 1342177283, "22"},
-        { "ExtendedNetworkAddress", 1610612754, NULL },
-        { "e163-4-address", 1610612741, NULL },
-        { "number", 1612718082, "NumericString"},
-        { NULL, 1073743880, "0"},
-        { "ub-e163-4-number-length", 524298, "1"},
-        { "sub-address", 538992642, "NumericString"},
-        { NULL, 1073743880, "1"},
-        { "ub-e163-4-sub-address-length", 524298, "1"},
-        { "psap-address", 536879106, "PresentationAddress"},
-        { NULL, 2056, "0"},
-        { "PresentationAddress", 1610612741, NULL },
-        { "pSelector", 1610637319, NULL },
-        { NULL, 2056, "0"},
-        { "sSelector", 1610637319, NULL },
-        { NULL, 2056, "1"},
-        { "tSelector", 1610637319, NULL },
-        { NULL, 2056, "2"},
-        { "nAddresses", 538976271, NULL },
-        { NULL, 1073743880, "3"},
-        { "MAX", 1074266122, "1"},
-        { NULL, 7, NULL },
-        { "terminal-type", 1342177283, "23"},
-        { "TerminalType", 1611137027, NULL },
-        { "0", 10, "ub-integer-options"},
-        { "teletex-domain-defined-attributes", 1342177283, "6"},
-        { "TeletexDomainDefinedAttributes", 1612709899, NULL },
-        { "ub-domain-defined-attributes", 1074266122, "1"},
-        { NULL, 2, "TeletexDomainDefinedAttribute"},
-        { "TeletexDomainDefinedAttribute", 1610612741, NULL },
-        { "type", 1612709890, "TeletexString"},
-        { "ub-domain-defined-attribute-type-length", 524298, "1"},
-        { "value", 538968066, "TeletexString"},
-        { "ub-domain-defined-attribute-value-length", 524298, "1"},
-        { "ub-name", 1342177283, "32768"},
-        { "ub-common-name", 1342177283, "64"},
-        { "ub-locality-name", 1342177283, "128"},
-        { "ub-state-name", 1342177283, "128"},
-        { "ub-organization-name", 1342177283, "64"},
-        { "ub-organizational-unit-name", 1342177283, "64"},
-        { "ub-title", 1342177283, "64"},
-        { "ub-match", 1342177283, "128"},
-        { "ub-emailaddress-length", 1342177283, "128"},
-        { "ub-common-name-length", 1342177283, "64"},
-        { "ub-country-name-alpha-length", 1342177283, "2"},
-        { "ub-country-name-numeric-length", 1342177283, "3"},
-        { "ub-domain-defined-attributes", 1342177283, "4"},
-        { "ub-domain-defined-attribute-type-length", 1342177283, "8"},
-        { "ub-domain-defined-attribute-value-length", 1342177283, "128"},
-        { "ub-domain-name-length", 1342177283, "16"},
-        { "ub-extension-attributes", 1342177283, "256"},
-        { "ub-e163-4-number-length", 1342177283, "15"},
-        { "ub-e163-4-sub-address-length", 1342177283, "40"},
-        { "ub-generation-qualifier-length", 1342177283, "3"},
-        { "ub-given-name-length", 1342177283, "16"},
-        { "ub-initials-length", 1342177283, "5"},
-        { "ub-integer-options", 1342177283, "256"},
-        { "ub-numeric-user-id-length", 1342177283, "32"},
-        { "ub-organization-name-length", 1342177283, "64"},
-        { "ub-organizational-unit-name-length", 1342177283, "32"},
-        { "ub-organizational-units", 1342177283, "4"},
-        { "ub-pds-name-length", 1342177283, "16"},
-        { "ub-pds-parameter-length", 1342177283, "30"},
-        { "ub-pds-physical-address-lines", 1342177283, "6"},
-        { "ub-postal-code-length", 1342177283, "16"},
-        { "ub-surname-length", 1342177283, "40"},
-        { "ub-terminal-id-length", 1342177283, "24"},
-        { "ub-unformatted-address-length", 1342177283, "180"},
-        { "ub-x121-address-length", 268435459, "16"},
-        { NULL, 0, NULL }
-    };
-    
     /* PEM certificate decoding (to DER) */
     byte *certificatDer = 0;
     int sizeCert = pemToAsn(cert, certLen, &certificatDer);
@@ -4055,7 +1610,7 @@ int getModulusSize(const byte *cert, const int certLen) {
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Error Base 64\n");
-        printf("### getModulusSize() End ###\n\n");
+        printf("### getPublicKeyFromCert() End ###\n\n");
         #endif
         
         /* Return error */
@@ -4063,20 +1618,15 @@ int getModulusSize(const byte *cert, const int certLen) {
         
     }
     
-    /* Certificate structure creation */
-    ASN1_TYPE certDef = ASN1_TYPE_EMPTY;
+    /* Definitions compiled once for the whole process */
+    asn1_node certDef = getAsnDefinition(GLS_ASN_PKIX);
     char errorDescription[ASN1_MAX_ERROR_DESCRIPTION_SIZE];
-    int result = asn1_array2tree(structCertificat, &certDef, errorDescription);
-    if (result != ASN1_SUCCESS) {
+    int result = ASN1_SUCCESS;
+    if (certDef == NULL) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Problems creating structure asn1_array2tree\n");
-        int i = 0;
-        for (i = 0; i < ASN1_MAX_ERROR_DESCRIPTION_SIZE; i++) {
-            printf("%c", errorDescription[i]);
-        }
-        printf("\n");
+        printf("ASN1 definitions not available\n");
         #endif
         
         /* Free memory */
@@ -4084,11 +1634,10 @@ int getModulusSize(const byte *cert, const int certLen) {
             free(certificatDer);
             certificatDer = 0;
         }
-        asn1_delete_structure(&certDef);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### getModulusSize() End ###\n\n");
+        printf("### getPublicKeyFromCert() End ###\n\n");
         #endif
         
         return GLS_ERROR_ASN1;
@@ -4096,7 +1645,7 @@ int getModulusSize(const byte *cert, const int certLen) {
     }
     
     /* Certificate DER parsing for utilisation */
-    ASN1_TYPE certificat = ASN1_TYPE_EMPTY;
+    asn1_node certificat = NULL;
     asn1_create_element(certDef, "PKIX1Implicit88.Certificate", &certificat);
     result = asn1_der_decoding(&certificat, certificatDer, sizeCert, errorDescription);
     if (result != ASN1_SUCCESS) {
@@ -4119,12 +1668,11 @@ int getModulusSize(const byte *cert, const int certLen) {
             certificatDer = 0;
         }
         
-        asn1_delete_structure(&certDef);
         asn1_delete_structure(&certificat);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### getModulusSize() End ###\n\n");
+        printf("### getPublicKeyFromCert() End ###\n\n");
         #endif
         
         return GLS_ERROR_ASN1;
@@ -4156,12 +1704,11 @@ int getModulusSize(const byte *cert, const int certLen) {
             certificatDer = 0;
         }
         
-        asn1_delete_structure(&certDef);
         asn1_delete_structure(&certificat);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### getModulusSize() End ###\n\n");
+        printf("### getPublicKeyFromCert() End ###\n\n");
         #endif
         
         return GLS_ERROR_ASN1;
@@ -4187,12 +1734,11 @@ int getModulusSize(const byte *cert, const int certLen) {
             gcry_sexp_release(gcryPubKey);
             gcryPubKey = 0;
         }
-        asn1_delete_structure(&certDef);
         asn1_delete_structure(&certificat);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### getModulusSize() End ###\n\n");
+        printf("### getPublicKeyFromCert() End ###\n\n");
         #endif
         
         return error;
@@ -4217,20 +1763,45 @@ int getModulusSize(const byte *cert, const int certLen) {
         free(certificatDer);
         certificatDer = 0;
     }
-    if(gcryPubKey != NULL){
-        gcry_sexp_release(gcryPubKey);
-        gcryPubKey = 0;
-    }
-    asn1_delete_structure(&certDef);
     asn1_delete_structure(&certificat);
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### getModulusSize() End ###\n\n");
+    printf("### getPublicKeyFromCert() End ###\n\n");
     #endif
     
-    if (sizeModulus <= 0) return GLS_ERROR_BADSERVERCERT;
-    else return sizeModulus;
+    if (sizeModulus <= 0) {
+        
+        gcry_sexp_release(gcryPubKey);
+        return GLS_ERROR_BADSERVERCERT;
+        
+    }
+    
+    (*publicKey) = gcryPubKey;
+    
+    return sizeModulus;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Extract Certificate Public key size. Return the size of key or a 
+ negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int getModulusSize(const byte *cert, const int certLen) {
+    
+    gcry_sexp_t publicKey = 0;
+    int sizeModulus = getPublicKeyFromCert(cert, certLen, &publicKey);
+    if (publicKey != NULL) gcry_sexp_release(publicKey);
+    
+    return sizeModulus;
     
 }
 
@@ -0,0 +1,554 @@
+/*
+ *  Crl.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+#include "GLSHeaders.h"
+
+
+
+
+/*-------------------------------------------------------
+
+ Create an empty revocation list, it can be shared by
+ many sockets with setCrlList().
+
+ Return the list or NULL if no memory.
+
+ ---------------------------------------------------------*/
+
+GLSCrl* GLSCrlList() {
+
+    GLSCrl* crl = malloc(sizeof(GLSCrl));
+    if (crl == NULL) return 0;
+
+    crl->m_serials = 0;
+    crl->m_nbSerial = 0;
+    crl->m_maxSerial = 0;
+    crl->m_isSorted = 1;
+    crl->m_nbRef = 1;
+    pthread_mutex_init(&crl->m_mutex, NULL);
+
+    return crl;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Release the revocation list, it's freed when the last
+ socket using it is freed.
+
+ ---------------------------------------------------------*/
+
+void freeGLSCrlList(GLSCrl* crl) {
+
+    if (crl != NULL) releaseCrl(crl);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Add a serial number (hexadecimal) to a revocation list.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int addToCrlList(GLSCrl* crl, const char* serial) {
+
+    /* Argument check */
+    if (crl == NULL || serial == NULL) return GLS_ERROR_INVAL;
+
+    byte entry[GLS_SIZE_CRL_ENTRY];
+    int error = hexToCrlEntry(serial, (int) strlen(serial), entry);
+    if (error != 0) return error;
+
+    pthread_mutex_lock(&crl->m_mutex);
+    error = addCrlEntry(crl, entry);
+    pthread_mutex_unlock(&crl->m_mutex);
+
+    return error;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Add the serial numbers of a file to a revocation list :
+ a DER X.509 CRL or a text file with one hexadecimal
+ serial number by line (empty lines and lines starting
+ with # are ignored).
+
+ Return the number of serial numbers read or a negative
+ number for an error.
+
+ ---------------------------------------------------------*/
+
+int loadCrlList(GLSCrl* crl, const char* fileName) {
+
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### loadCrlList() Start ###\n");
+    #endif
+
+    /* Argument check */
+    if (crl == NULL || fileName == NULL) return GLS_ERROR_INVAL;
+
+    /* The whole file, it can be binary */
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return GLS_ERROR_NOFILE;
+
+    fseek(file, 0, SEEK_END);
+    long sizeFile = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (sizeFile <= 0 || sizeFile > INT_MAX) {
+
+        fclose(file);
+        return GLS_ERROR_NOFILE;
+
+    }
+
+    byte* content = malloc(sizeFile);
+    if (content == NULL) {
+
+        fclose(file);
+        return GLS_ERROR_NOMEM;
+
+    }
+
+    int sizeContent = (int) fread(content, 1, sizeFile, file);
+    fclose(file);
+
+    /* A DER CRL starts with a SEQUENCE longer than 127 bytes (length in
+       long form), a text file starting with '0' (0x30) is only ASCII */
+    int nbSerial = 0;
+    if (sizeContent > 1 && content[0] == 0x30 && (content[1] & 0x80)) nbSerial = loadCrlDer(crl, content, sizeContent);
+    else nbSerial = loadCrlHex(crl, (const char*) content, sizeContent);
+
+    free(content);
+
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Serials loaded : %d\n", nbSerial);
+    printf("### loadCrlList() End ###\n\n");
+    #endif
+
+    return nbSerial;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Use a shared revocation list for the certificates of the
+ socket instead of its own list.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int setCrlList(GLSSock* myGLSSocket, GLSCrl* crl) {
+
+    /* Argument check */
+    if (myGLSSocket == NULL || crl == NULL) return GLS_ERROR_INVAL;
+
+    retainCrl(crl);
+    if (myGLSSocket->m_crl != NULL) releaseCrl(myGLSSocket->m_crl);
+    myGLSSocket->m_crl = crl;
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Read the serial numbers of a text file, one by line.
+
+ Return the number of serial numbers or a negative number
+ for an error.
+
+ ---------------------------------------------------------*/
+
+int loadCrlHex(GLSCrl* crl, const char* content, const int sizeContent) {
+
+    int nbSerial = 0;
+    int error = 0;
+    int start = 0;
+
+    pthread_mutex_lock(&crl->m_mutex);
+
+    while (start < sizeContent && error == 0) {
+
+        int end = start;
+        while (end < sizeContent && content[end] != '\n') end++;
+
+        /* Line without the spaces and the \r at the end */
+        int sizeLine = end - start;
+        while (sizeLine > 0 && isspace((unsigned char) content[start + sizeLine - 1])) sizeLine--;
+        while (sizeLine > 0 && isspace((unsigned char) content[start])) {
+
+            start++;
+            sizeLine--;
+
+        }
+
+        if (sizeLine > 0 && content[start] != '#') {
+
+            byte entry[GLS_SIZE_CRL_ENTRY];
+            error = hexToCrlEntry(content + start, sizeLine, entry);
+            if (error == 0) error = addCrlEntry(crl, entry);
+            if (error == 0) nbSerial++;
+
+        }
+
+        start = end + 1;
+
+    }
+
+    pthread_mutex_unlock(&crl->m_mutex);
+
+    if (error != 0) return error;
+
+    return nbSerial;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Read the revoked serial numbers of a DER X.509 CRL. The
+ signature of the CRL is not checked.
+
+ Return the number of serial numbers or a negative number
+ for an error.
+
+ ---------------------------------------------------------*/
+
+int loadCrlDer(GLSCrl* crl, const byte* der, const int sizeDer) {
+
+    asn1_node certDef = getAsnDefinition(GLS_ASN_PKIX);
+    if (certDef == NULL) return GLS_ERROR_ASN1;
+
+    asn1_node crlDer = NULL;
+    char errorDescription[ASN1_MAX_ERROR_DESCRIPTION_SIZE];
+    int result = asn1_create_element(certDef, "PKIX1Implicit88.CertificateList", &crlDer);
+    if (result == ASN1_SUCCESS) result = asn1_der_decoding(&crlDer, der, sizeDer, errorDescription);
+    if (result != ASN1_SUCCESS) {
+
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Bad CRL : %s\n", errorDescription);
+        #endif
+
+        asn1_delete_structure(&crlDer);
+
+        return GLS_ERROR_ASN1;
+
+    }
+
+    /* A CRL without revoked certificate has no list */
+    int nbSerial = 0;
+    if (asn1_number_of_elements(crlDer, "tbsCertList.revokedCertificates", &nbSerial) != ASN1_SUCCESS) nbSerial = 0;
+
+    int error = 0;
+    int i = 0;
+
+    pthread_mutex_lock(&crl->m_mutex);
+
+    for (i = 1; i <= nbSerial && error == 0; i++) {
+
+        char name[64];
+        byte serial[GLS_SIZE_CRL_ENTRY * 2];
+        int len = sizeof(serial);
+        snprintf(name, sizeof(name), "tbsCertList.revokedCertificates.?%d.userCertificate", i);
+        if (asn1_read_value(crlDer, name, serial, &len) != ASN1_SUCCESS) {
+
+            error = GLS_ERROR_ASN1;
+            break;
+
+        }
+
+        byte entry[GLS_SIZE_CRL_ENTRY];
+        error = serialToCrlEntry(serial, len, entry);
+        if (error == 0) error = addCrlEntry(crl, entry);
+
+    }
+
+    pthread_mutex_unlock(&crl->m_mutex);
+
+    asn1_delete_structure(&crlDer);
+
+    if (error != 0) return error;
+
+    return nbSerial;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Convert a serial number into an entry of the list : its
+ size then the serial without the leading zeros, padded
+ with zeros. Comparing two entries with memcmp() gives
+ the order of the list.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int serialToCrlEntry(const byte* serial, const int len, byte* entry) {
+
+    /* 00 01 02 and 01 02 are the same number */
+    int start = 0;
+    while (start < len - 1 && serial[start] == 0) start++;
+
+    int size = len - start;
+    if (size <= 0 || size >= GLS_SIZE_CRL_ENTRY) return GLS_ERROR_BADSIZE;
+
+    memset(entry, 0, GLS_SIZE_CRL_ENTRY);
+    entry[0] = (byte) size;
+    memcpy(entry + 1, serial + start, size);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Convert a hexadecimal serial number (':' and spaces are
+ ignored) into an entry of the list.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int hexToCrlEntry(const char* hex, const int sizeHex, byte* entry) {
+
+    byte serial[GLS_SIZE_CRL_ENTRY * 2];
+    int len = 0;
+    int half = -1;
+    int i = 0;
+
+    for (i = 0; i < sizeHex; i++) {
+
+        char c = hex[i];
+        if (c == ':' || c == ' ') continue;
+        if (!isxdigit((unsigned char) c)) return GLS_ERROR_INVAL;
+
+        int digit = (c <= '9') ? c - '0' : (toupper((unsigned char) c) - 'A' + 10);
+
+        /* Two digits by byte */
+        if (half < 0) half = digit;
+        else {
+
+            if (len >= (int) sizeof(serial)) return GLS_ERROR_BADSIZE;
+            serial[len] = (byte) (half * 16 + digit);
+            len++;
+            half = -1;
+
+        }
+
+    }
+
+    if (half >= 0 || len == 0) return GLS_ERROR_BADSIZE;
+
+    return serialToCrlEntry(serial, len, entry);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Add an entry at the end of the list, the list is sorted
+ again by the next search. Called with the mutex of the
+ list.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int addCrlEntry(GLSCrl* crl, const byte* entry) {
+
+    /* The array doubles, no copy for each serial */
+    if (crl->m_nbSerial == crl->m_maxSerial) {
+
+        int maxSerial = (crl->m_maxSerial == 0) ? 64 : crl->m_maxSerial * 2;
+        byte* serials = realloc(crl->m_serials, (size_t) maxSerial * GLS_SIZE_CRL_ENTRY);
+        if (serials == NULL) return GLS_ERROR_NOMEM;
+
+        crl->m_serials = serials;
+        crl->m_maxSerial = maxSerial;
+
+    }
+
+    memcpy(crl->m_serials + (size_t) crl->m_nbSerial * GLS_SIZE_CRL_ENTRY, entry, GLS_SIZE_CRL_ENTRY);
+    crl->m_nbSerial++;
+    crl->m_isSorted = 0;
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Order of two entries for qsort() and bsearch().
+
+ ---------------------------------------------------------*/
+
+int compareCrlEntry(const void* entry1, const void* entry2) {
+
+    return memcmp(entry1, entry2, GLS_SIZE_CRL_ENTRY);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Search an entry (serialToCrlEntry()) in a revocation list
+ with a binary search, the list is sorted first if serials
+ were added.
+
+ Return 1 if the serial is in the list, 0 otherwise.
+
+ ---------------------------------------------------------*/
+
+int isEntryInCrl(GLSCrl* crl, const byte* entry) {
+
+    pthread_mutex_lock(&crl->m_mutex);
+
+    /* Sorted and without duplicate */
+    if (crl->m_isSorted == 0) {
+
+        qsort(crl->m_serials, crl->m_nbSerial, GLS_SIZE_CRL_ENTRY, compareCrlEntry);
+
+        int nbSerial = 0;
+        int i = 0;
+        for (i = 0; i < crl->m_nbSerial; i++) {
+
+            byte* current = crl->m_serials + (size_t) i * GLS_SIZE_CRL_ENTRY;
+            byte* last = crl->m_serials + (size_t) (nbSerial - 1) * GLS_SIZE_CRL_ENTRY;
+            if (nbSerial > 0 && memcmp(current, last, GLS_SIZE_CRL_ENTRY) == 0) continue;
+
+            if (i != nbSerial) memcpy(crl->m_serials + (size_t) nbSerial * GLS_SIZE_CRL_ENTRY, current, GLS_SIZE_CRL_ENTRY);
+            nbSerial++;
+
+        }
+
+        crl->m_nbSerial = nbSerial;
+        crl->m_isSorted = 1;
+
+    }
+
+    int isFound = 0;
+    if (crl->m_nbSerial > 0) isFound = bsearch(entry, crl->m_serials, crl->m_nbSerial, GLS_SIZE_CRL_ENTRY, compareCrlEntry) != NULL;
+
+    pthread_mutex_unlock(&crl->m_mutex);
+
+    return isFound;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Add a reference to a revocation list (a new socket).
+
+ ---------------------------------------------------------*/
+
+void retainCrl(GLSCrl* crl) {
+
+    pthread_mutex_lock(&crl->m_mutex);
+    crl->m_nbRef++;
+    pthread_mutex_unlock(&crl->m_mutex);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Remove a reference to a revocation list, the last one
+ frees it.
+
+ ---------------------------------------------------------*/
+
+void releaseCrl(GLSCrl* crl) {
+
+    pthread_mutex_lock(&crl->m_mutex);
+    int nbRef = --crl->m_nbRef;
+    pthread_mutex_unlock(&crl->m_mutex);
+
+    if (nbRef > 0) return;
+
+    if (crl->m_serials != NULL) free(crl->m_serials);
+    pthread_mutex_destroy(&crl->m_mutex);
+    free(crl);
+
+}
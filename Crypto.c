@@ -58,45 +58,57 @@ int initHandler(GLSSock* myGLSSocket){
     /* Error handling */
     int error = 0;
     
-    /* If the handlers aren't created we allocated them, otherwise 
-     we only change the keys */
+    /* The handlers are created at the first call */
     if (myGLSSocket->m_isHandlerInit == 0) {
         
-        /* Serpent (CTS, 256 bit) */
-        /* Secure memory and CTS mode don't work together */
+        /* 
+         * Serpent and Twofish (CTS and ECB, 256 bit). Secure memory and CTS
+         * mode don't work together, the ECB handlers hold the same keys so
+         * they are not in the secure memory either (about 5 KB by socket).
+         */
         error += gcry_cipher_open(&myGLSSocket->m_serpentHandlerCTS, GCRY_CIPHER_SERPENT256, GCRY_CIPHER_MODE_CBC, GCRY_CIPHER_CBC_CTS);
-        error += gcry_cipher_setkey(myGLSSocket->m_serpentHandlerCTS, myGLSSocket->m_key1, 32);
-        
-        /* Twofish (CTS, 256 bit) */
         error += gcry_cipher_open(&myGLSSocket->m_twofishHandlerCTS, GCRY_CIPHER_TWOFISH, GCRY_CIPHER_MODE_CBC, GCRY_CIPHER_CBC_CTS);
-        error += gcry_cipher_setkey(myGLSSocket->m_twofishHandlerCTS, myGLSSocket->m_key2, 32);
+        error += gcry_cipher_open(&myGLSSocket->m_serpentHandlerECB, GCRY_CIPHER_SERPENT256, GCRY_CIPHER_MODE_ECB, 0);
+        error += gcry_cipher_open(&myGLSSocket->m_twofishHandlerECB, GCRY_CIPHER_TWOFISH, GCRY_CIPHER_MODE_ECB, 0);
         
-        /* Serpent (ECB, 256 bit) */
-        error += gcry_cipher_open(&myGLSSocket->m_serpentHandlerECB, GCRY_CIPHER_SERPENT256, GCRY_CIPHER_MODE_ECB, GCRY_CIPHER_SECURE);
-        error += gcry_cipher_setkey(myGLSSocket->m_serpentHandlerECB, myGLSSocket->m_key1, 32);
+        /* SHA-256 MAC, the handlers are reset for each message */
+        error += gcry_md_open(&myGLSSocket->m_macSendHandler, GCRY_MD_SHA256, 0);
+        error += gcry_md_open(&myGLSSocket->m_macRecvHandler, GCRY_MD_SHA256, 0);
         
-        /* Twofish (ECB, 256 bit) */
-        error += gcry_cipher_open(&myGLSSocket->m_twofishHandlerECB, GCRY_CIPHER_TWOFISH, GCRY_CIPHER_MODE_ECB, GCRY_CIPHER_SECURE);
-        error += gcry_cipher_setkey(myGLSSocket->m_twofishHandlerECB, myGLSSocket->m_key2, 32);
+        /* A handler who failed is NULL, the others are closed */
+        if (error != 0) {
+            
+            gcry_cipher_close(myGLSSocket->m_serpentHandlerCTS);
+            gcry_cipher_close(myGLSSocket->m_twofishHandlerCTS);
+            gcry_cipher_close(myGLSSocket->m_serpentHandlerECB);
+            gcry_cipher_close(myGLSSocket->m_twofishHandlerECB);
+            gcry_md_close(myGLSSocket->m_macSendHandler);
+            gcry_md_close(myGLSSocket->m_macRecvHandler);
+            
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("Handler initialisation error.\n");
+            printf("### initHandler() End ###\n\n");
+            #endif
+            
+            return GLS_ERROR_NOMEM;
+            
+        }
         
         myGLSSocket->m_isHandlerInit = 1;
         
     }
-    else {
-        
-        /* Serpent (CTS, 256 bit) */
-        error += gcry_cipher_setkey(myGLSSocket->m_serpentHandlerCTS, myGLSSocket->m_key1, 32);
-        
-        /* Twofish (CTS, 256 bit) */
-        error += gcry_cipher_setkey(myGLSSocket->m_twofishHandlerCTS, myGLSSocket->m_key2, 32);
-        
-        /* Serpent (ECB, 256 bit) */
-        error += gcry_cipher_setkey(myGLSSocket->m_serpentHandlerECB, myGLSSocket->m_key1, 32);
-        
-        /* Twofish (ECB, 256 bit) */
-        error += gcry_cipher_setkey(myGLSSocket->m_twofishHandlerECB, myGLSSocket->m_key2, 32);
-        
-    }
+    
+    /* Keys changed at each call, Serpent (CTS, 256 bit) */
+    error += gcry_cipher_setkey(myGLSSocket->m_serpentHandlerCTS, myGLSSocket->m_key1, 32);
+    
+    /* Twofish (CTS, 256 bit) */
+    error += gcry_cipher_setkey(myGLSSocket->m_twofishHandlerCTS, myGLSSocket->m_key2, 32);
+    
+    /* Serpent (ECB, 256 bit) */
+    error += gcry_cipher_setkey(myGLSSocket->m_serpentHandlerECB, myGLSSocket->m_key1, 32);
+    
+    /* Twofish (ECB, 256 bit) */
+    error += gcry_cipher_setkey(myGLSSocket->m_twofishHandlerECB, myGLSSocket->m_key2, 32);
     
     
     if(error != 0) {
@@ -126,19 +138,95 @@ int initHandler(GLSSock* myGLSSocket){
  
  PRIVATE
  
- Generate 128 bits initialisation vectors.
+ Key the handlers with the keys of the socket once they
+ are wiped and reset their state, nothing of the old keys
+ stays in the handlers. Return 0 for success or a
+ negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int resetHandler(GLSSock* myGLSSocket){
+    
+    if (myGLSSocket->m_isHandlerInit == 0) return 0;
+    
+    int error = 0;
+    error += gcry_cipher_setkey(myGLSSocket->m_serpentHandlerCTS, myGLSSocket->m_key1, 32);
+    error += gcry_cipher_setkey(myGLSSocket->m_twofishHandlerCTS, myGLSSocket->m_key2, 32);
+    error += gcry_cipher_setkey(myGLSSocket->m_serpentHandlerECB, myGLSSocket->m_key1, 32);
+    error += gcry_cipher_setkey(myGLSSocket->m_twofishHandlerECB, myGLSSocket->m_key2, 32);
+    error += gcry_cipher_reset(myGLSSocket->m_serpentHandlerCTS);
+    error += gcry_cipher_reset(myGLSSocket->m_twofishHandlerCTS);
+    gcry_md_reset(myGLSSocket->m_macSendHandler);
+    gcry_md_reset(myGLSSocket->m_macRecvHandler);
+    
+    if (error != 0) return GLS_ERROR_CRYPTO;
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Generate 128 bits initialisation vectors. The IVs are
+ taken from the pool of the socket, filled in one call to
+ the random generator when it's empty. The caller is the
+ sender of the socket (m_mutexGlsSend or handshake).
  
  ---------------------------------------------------------*/
 
-int getIV(byte* iv) {
+int getIV(GLSSock* myGLSSocket, byte* iv) {
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
     printf("### getIV() Start ###\n");
     #endif
     
-    /* length in byte (16 bytes = 128 bits) */
-    gcry_create_nonce(iv, 16);
+    /* Without pool, length in byte (16 bytes = 128 bits) */
+    if (myGLSSocket->m_sizeIvPool < 16) {
+        
+        gcry_create_nonce(iv, 16);
+        
+    }
+    else {
+        
+        /* First use of the pool */
+        if (myGLSSocket->m_ivPool == NULL) {
+            
+            myGLSSocket->m_ivPool = (byte*) malloc(myGLSSocket->m_sizeIvPool);
+            if (myGLSSocket->m_ivPool == NULL) {
+                
+                /* Debug Only */
+                #if defined (GLS_DEBUG_MODE_ENABLE)
+                printf("No memory for the IV pool\n");
+                printf("### getIV() End ###\n\n");
+                #endif
+                
+                return GLS_ERROR_NOMEM;
+                
+            }
+            myGLSSocket->m_posIvPool = myGLSSocket->m_sizeIvPool;
+            
+        }
+        
+        /* Empty pool */
+        if (myGLSSocket->m_posIvPool + 16 > myGLSSocket->m_sizeIvPool) {
+            
+            gcry_create_nonce(myGLSSocket->m_ivPool, myGLSSocket->m_sizeIvPool);
+            myGLSSocket->m_posIvPool = 0;
+            
+        }
+        
+        /* An IV given is removed from the pool */
+        memcpy(iv, myGLSSocket->m_ivPool + myGLSSocket->m_posIvPool, 16);
+        memset(myGLSSocket->m_ivPool + myGLSSocket->m_posIvPool, 0, 16);
+        myGLSSocket->m_posIvPool += 16;
+        
+    }
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -155,66 +243,243 @@ int getIV(byte* iv) {
  
  PRIVATE
  
- First message encryption.
- Return the ciphertext size or a negative number for an error.
+ Initialize the handler of the negotiated suite at the
+ end of the handshake. The key is derived from the two
+ encryption keys and IV3 + IV4 of the Hello Server
+ message so each connexion has its own key :
+ SHA-256(Suite + Key1 + Key2 + IV3 + IV4)
+ It's the AEAD key or the MAC key of the CTR cascade.
+ Return 0 for success or a negative number for an error.
  
  ---------------------------------------------------------*/
 
-int firstEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte** cypherText){
+int initSuiteHandler(GLSSock* myGLSSocket){
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### firstEncrypt() Start ###\n");
+    printf("### initSuiteHandler() Start ###\n");
     #endif
     
-    /* If the handlers aren't initialized or no encryption key is
-     available return an error */
-    if (myGLSSocket->m_isCryptoKey == 0 || myGLSSocket->m_isHandlerInit == 0) {
+    /* If no encryption key return an error */
+    if (myGLSSocket->m_isCryptoKey == 0) return GLS_ERROR_NOPASSWD;
+    
+    /* Cipher of the suite */
+    int algo = 0;
+    int mode = 0;
+    if (myGLSSocket->m_activeSuite == GLS_SUITE_SERPENT_TWOFISH_CTR) {
+        
+        /* Only a MAC key, the ciphers use Key1 and Key2 */
+        
+    }
+    #if defined (GLS_AEAD_ENABLE)
+    else if (myGLSSocket->m_activeSuite == GLS_SUITE_AES256_GCM) {
+        
+        algo = GCRY_CIPHER_AES256;
+        mode = GCRY_CIPHER_MODE_GCM;
+        
+    }
+    else if (myGLSSocket->m_activeSuite == GLS_SUITE_CHACHA20_POLY1305) {
+        
+        algo = GCRY_CIPHER_CHACHA20;
+        mode = GCRY_CIPHER_MODE_POLY1305;
+        
+    }
+    #endif
+    else {
         
+        /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("No initial configuration firstEncrypt.\n");
-        printf("### firstEncrypt() End ###\n\n");
+        printf("Suite not available with this libgcrypt.\n");
+        printf("### initSuiteHandler() End ###\n\n");
         #endif
         
-        return GLS_ERROR_NOPASSWD;
+        return GLS_ERROR_OPNOTSUPP;
         
     }
     
-    /* Temp and final memory allocation */
-    byte (*tempPlainText) = 0;
-    byte (*tempCypherText) = 0;
-    byte (*tempCypherTextFinal) = 0;
+    /* Error handling */
+    int error = 0;
+    
+    /* Key derivation in secure memory */
+    gcry_md_hd_t keyHandler;
+    error += gcry_md_open(&keyHandler, GCRY_MD_SHA256, GCRY_MD_FLAG_SECURE);
+    if (error != 0) return GLS_ERROR_CRYPTO;
     
-    /* Check plaintext size and allocation */
-    if (size > 0 && plainText != NULL) {
-        
-        /*
-         * Memory allocation with the additional 768 bit from the GLS
-         * protocol (IV1 + IV2 + MAC + IV3 + IV4) = 768 bits / 96 bytes
-         * CypherText = (IV1 + IV2) + (MAC + IV3 + IV4) + tempCypherText
-         */
+    byte suite = (byte) myGLSSocket->m_activeSuite;
+    gcry_md_write(keyHandler, &suite, 1);
+    gcry_md_write(keyHandler, myGLSSocket->m_key1, 32);
+    gcry_md_write(keyHandler, myGLSSocket->m_key2, 32);
+    gcry_md_write(keyHandler, myGLSSocket->m_iv3, 16);
+    gcry_md_write(keyHandler, myGLSSocket->m_iv4, 16);
+    
+    if (myGLSSocket->m_activeSuite == GLS_SUITE_SERPENT_TWOFISH_CTR) {
         
-        tempPlainText = malloc((size + 64) * sizeof(byte));
-        tempCypherText = malloc((size + 64) * sizeof(byte));;
-        tempCypherTextFinal = malloc((size + 64) * sizeof(byte));;
-        *cypherText = malloc((size + 96) * sizeof(byte));;
+        /* HMAC handlers keep the key in secure memory, gcry_md_reset() doesn't clear it */
+        if (myGLSSocket->m_isHmacInit == 0) {
+            
+            error += gcry_md_open(&myGLSSocket->m_hmacSendHandler, GCRY_MD_SHA256, GCRY_MD_FLAG_HMAC | GCRY_MD_FLAG_SECURE);
+            if (error == 0) {
+                
+                error += gcry_md_open(&myGLSSocket->m_hmacRecvHandler, GCRY_MD_SHA256, GCRY_MD_FLAG_HMAC | GCRY_MD_FLAG_SECURE);
+                if (error != 0) gcry_md_close(myGLSSocket->m_hmacSendHandler);
+                else myGLSSocket->m_isHmacInit = 1;
+                
+            }
+            
+        }
         
-        if (tempPlainText == NULL || tempCypherText == NULL || tempCypherTextFinal == NULL || *cypherText == NULL) {
+        if (error == 0) {
             
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("No memory. FirstEncrypt\n");
-            #endif
+            error += gcry_md_setkey(myGLSSocket->m_hmacSendHandler, gcry_md_read(keyHandler, GCRY_MD_SHA256), 32);
+            error += gcry_md_setkey(myGLSSocket->m_hmacRecvHandler, gcry_md_read(keyHandler, GCRY_MD_SHA256), 32);
             
-            return GLS_ERROR_NOMEM;
+        }
+        
+        /* Cipher handlers opened and keyed at their first use by ctrCascade() */
+        closeCtrHandler(myGLSSocket);
+        if (error == 0) {
+            
+            myGLSSocket->m_ctrHandler = calloc(2 * GLS_MAX_THREAD, sizeof(gcry_cipher_hd_t));
+            if (myGLSSocket->m_ctrHandler == NULL) error = GLS_ERROR_NOMEM;
             
         }
         
     }
     else {
         
+        /* A new suite on the same socket replace the old handler */
+        if (myGLSSocket->m_isAeadInit == 1) {
+            
+            gcry_cipher_close(myGLSSocket->m_aeadHandler);
+            myGLSSocket->m_isAeadInit = 0;
+            
+        }
+        
+        error += gcry_cipher_open(&myGLSSocket->m_aeadHandler, algo, mode, GCRY_CIPHER_SECURE);
+        if (error == 0) {
+            
+            myGLSSocket->m_isAeadInit = 1;
+            error += gcry_cipher_setkey(myGLSSocket->m_aeadHandler, gcry_md_read(keyHandler, GCRY_MD_SHA256), 32);
+            
+        }
+        
+    }
+    
+    /* The key is wiped by libgcrypt */
+    gcry_md_close(keyHandler);
+    
+    /* Sequence numbers of the nonces */
+    myGLSSocket->m_aeadSendSeq = 0;
+    myGLSSocket->m_aeadRecvSeq = 0;
+    
+    if (error != 0) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Suite handler initialisation error.\n");
+        printf("### initSuiteHandler() End ###\n\n");
+        #endif
+        
+        if (error == GLS_ERROR_NOMEM) return GLS_ERROR_NOMEM;
+        else return GLS_ERROR_CRYPTO;
+        
+    }
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### initSuiteHandler() End ###\n\n");
+    #endif
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ First message encryption.
+ Return the ciphertext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int firstEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte** cypherText){
+    
+    /* Check plaintext size */
+    if (size <= 0 || plainText == NULL) {
+        
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Bad argument FirstEncrypt (Size : %d).\n", size);
         if (plainText == NULL) printf("PlainText == NULL\n");
+        #endif
+        
+        return GLS_ERROR_NOMESSAGE;
+        
+    }
+    
+    /*
+     * Only one allocation with the additional 768 bit from the GLS
+     * protocol (IV1 + IV2 + MAC + IV3 + IV4) = 768 bits / 96 bytes
+     * in front of the message, everything is encrypted in place.
+     */
+    *cypherText = malloc((size + GLS_SIZE_HEADROOM) * sizeof(byte));
+    if (*cypherText == NULL) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No memory. FirstEncrypt\n");
+        #endif
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    memcpy(*cypherText + GLS_SIZE_HEADROOM, plainText, size);
+    
+    return firstEncryptInPlace(myGLSSocket, *cypherText, size);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ First message encryption in place. The message is at 
+ buffer + GLS_SIZE_HEADROOM and buffer is replaced by the
+ cipher text :
+ ECB(IV1) + ECB(IV2) + CTS(MAC + IV3 + IV4 + Data)
+ Return the ciphertext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int firstEncryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size){
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### firstEncrypt() Start ###\n");
+    #endif
+    
+    /* If the handlers aren't initialized or no encryption key is
+     available return an error */
+    if (myGLSSocket->m_isCryptoKey == 0 || myGLSSocket->m_isHandlerInit == 0) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No initial configuration firstEncrypt.\n");
+        printf("### firstEncrypt() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_NOPASSWD;
+        
+    }
+    
+    /* Check plaintext size */
+    if (size <= 0 || buffer == NULL) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Bad argument FirstEncrypt (Size : %d).\n", size);
         printf("### firstEncrypt() End ###\n\n");
         #endif
         
@@ -224,42 +489,32 @@ int firstEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, by
     
     /* Error handling */
     int error = 0;
-    int i = 0;
     
     /* Initialisation Vectors generation */
-    error += getIV(myGLSSocket->m_iv1);
-    error += getIV(myGLSSocket->m_iv2);
-    error += getIV(myGLSSocket->m_iv3);
-    error += getIV(myGLSSocket->m_iv4);
+    error += getIV(myGLSSocket, myGLSSocket->m_iv1);
+    error += getIV(myGLSSocket, myGLSSocket->m_iv2);
+    error += getIV(myGLSSocket, myGLSSocket->m_iv3);
+    error += getIV(myGLSSocket, myGLSSocket->m_iv4);
     
     /* Debug only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
+    int i = 0;
     printf("IV1 (FirstEncrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv1[i]);
     }
     printf("\n");
-    
-    /* Debug only */
     printf("IV2 (FirstEncrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv2[i]);
     }
     printf("\n");
-    
-    /* Debug only */
     printf("IV3 (FirstEncrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv3[i]);
     }
     printf("\n");
-    
-    /* Debug only */
     printf("IV4 (FirstEncrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv4[i]);
     }
@@ -272,117 +527,34 @@ int firstEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, by
     error += gcry_cipher_reset(myGLSSocket->m_twofishHandlerCTS);
     error += gcry_cipher_setiv(myGLSSocket->m_twofishHandlerCTS, myGLSSocket->m_iv2, 16);
     
-    /* Temp variable for IVS encryption */
-    byte tempIV1[16];
-    byte tempIV2[16];
-    byte tempIV1Final[16];
-    byte tempIV2Final[16];
-    
-    /* IVS Encryption (IV1 and IV2 in ECB) */
+    /* IVS Encryption (IV1 and IV2 in ECB) directly in the header */
     /* IV1 ECB */
-    error += gcry_cipher_encrypt(myGLSSocket->m_serpentHandlerECB, tempIV1, 16, myGLSSocket->m_iv1, 16);
-    error += gcry_cipher_encrypt(myGLSSocket->m_twofishHandlerECB, tempIV1Final, 16, tempIV1, 16);
+    error += gcry_cipher_encrypt(myGLSSocket->m_serpentHandlerECB, buffer, 16, myGLSSocket->m_iv1, 16);
+    error += gcry_cipher_encrypt(myGLSSocket->m_twofishHandlerECB, buffer, 16, NULL, 0);
     /* IV2 ECB */
-    error += gcry_cipher_encrypt(myGLSSocket->m_serpentHandlerECB, tempIV2, 16, myGLSSocket->m_iv2, 16);
-    error += gcry_cipher_encrypt(myGLSSocket->m_twofishHandlerECB, tempIV2Final, 16, tempIV2, 16);
-    
-    /* MAC generation (SHA-256) */
-    /* MAC = IV3 + IV4 + Data */
-    byte MAC[32];
-    byte (*tempMACText);
-    tempMACText = malloc((size + 32) * sizeof(byte));
-    if (tempMACText == NULL) {
-        
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("No memory. FirstEncrypt\n");
-        #endif
-        
-        return GLS_ERROR_NOMEM;
-        
-    }
-    /* IV3 and IV4 */
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        tempMACText[i] = myGLSSocket->m_iv3[i];
-        tempMACText[i + 16] = myGLSSocket->m_iv4[i];
-    }
-    /* Message */
-    i = 0;
-    for (i = 0; i < size; i++) {
-        tempMACText[i + 32] = plainText[i];
-    }
-    gcry_md_hash_buffer(GCRY_MD_SHA256, MAC, tempMACText, (size + 32));
-    free(tempMACText);
-    tempMACText = 0;
-    
-    /* Filling tempPlainText (according to the GLS structure) to be encrypt in CTS mode */
-    /* MAC */
-    i = 0;
-    for (i = 0; i < 32; i++) {
-        tempPlainText[i] = MAC[i];
-    }
-    /* IV3 et IV4 */
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        tempPlainText[i + 32] = myGLSSocket->m_iv3[i];
-        tempPlainText[i + 48] = myGLSSocket->m_iv4[i];
-    }
-    /* Message */
-    i = 0;
-    for (i = 0; i < size; i++) {
-        tempPlainText[i + 64] = plainText[i];
-    }
+    error += gcry_cipher_encrypt(myGLSSocket->m_serpentHandlerECB, buffer + 16, 16, myGLSSocket->m_iv2, 16);
+    error += gcry_cipher_encrypt(myGLSSocket->m_twofishHandlerECB, buffer + 16, 16, NULL, 0);
     
-    /* tempPlainText encryption  */
-    error += gcry_cipher_encrypt(myGLSSocket->m_serpentHandlerCTS, tempCypherText, (size + 64), tempPlainText, (size + 64));
-    error += gcry_cipher_encrypt(myGLSSocket->m_twofishHandlerCTS, tempCypherTextFinal, (size + 64), tempCypherText, (size + 64));
+    /* IV3 and IV4 in front of the message */
+    memcpy(buffer + 64, myGLSSocket->m_iv3, 16);
+    memcpy(buffer + 80, myGLSSocket->m_iv4, 16);
     
-    /* Debug only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Message (FirstEncrypt) : ");
-    i = 0;
-    for (i = 0; i < size; i++) {
-        printf("%c", plainText[i]);
-    }
-    printf("\n");
-    printf("Message serpent (FirstEncrypt) : ");
-    i = 0;
-    for (i = 0; i < size; i++) {
-        printf("%x", tempCypherText[i]);
-    }
-    printf("\n");
-    #endif
+    /* MAC generation (SHA-256) */
+    /* MAC = IV3 + IV4 + Data, read in place from the buffer */
+    gcry_md_reset(myGLSSocket->m_macSendHandler);
+    gcry_md_write(myGLSSocket->m_macSendHandler, buffer + 64, 32);
+    gcry_md_write(myGLSSocket->m_macSendHandler, buffer + GLS_SIZE_HEADROOM, size);
+    memcpy(buffer + 32, gcry_md_read(myGLSSocket->m_macSendHandler, GCRY_MD_SHA256), 32);
     
-    /* Filling cypherText according to the GLS structure */
-    /* IV1 and IV2 (encrypted) */
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        (*cypherText)[i] = tempIV1Final[i];
-        (*cypherText)[i + 16] = tempIV2Final[i];
-    }
-    /* MAC, IV3, IV4 and encrypted message */
-    i = 0;
-    for (i = 0; i < (size + 64); i++) {
-        (*cypherText)[i + 32] = tempCypherTextFinal[i];
-    }
+    /* MAC + IV3 + IV4 + Data encryption in place */
+    error += gcry_cipher_encrypt(myGLSSocket->m_serpentHandlerCTS, buffer + 32, (size + 64), NULL, 0);
+    error += gcry_cipher_encrypt(myGLSSocket->m_twofishHandlerCTS, buffer + 32, (size + 64), NULL, 0);
     
     if(error != 0) {
         
         /* debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Error %d : %s\n", error, gcry_strerror(error));
-        #endif
-        
-        /* Free temp memory */
-        free(tempPlainText);
-        tempPlainText = 0;
-        free(tempCypherText);
-        tempCypherText = 0;
-        free(tempCypherTextFinal);
-        tempCypherTextFinal = 0;
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("### firstEncrypt() End ###\n\n");
         #endif
         
@@ -390,20 +562,12 @@ int firstEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, by
         
     }
     
-    /* Free temp memory */
-    free(tempPlainText);
-    tempPlainText = 0;
-    free(tempCypherText);
-    tempCypherText = 0;
-    free(tempCypherTextFinal);
-    tempCypherTextFinal = 0;
-    
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
     printf("### firstEncrypt() End ###\n\n");
     #endif
     
-    return size + 96;
+    return size + GLS_SIZE_HEADROOM;
     
 }
 
@@ -421,60 +585,77 @@ int firstEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, by
 
 int firstDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, byte** plainText){
     
-    /* Debug Only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### firstDecrypt() Start ###\n");
-    #endif
-    
-    /* If the handlers aren't initialized or no encryption key is
-     available return an error */
-    if (myGLSSocket->m_isCryptoKey == 0 || myGLSSocket->m_isHandlerInit == 0) {
+    /* Check if the message's size is at least highter than the header's size */
+    if (size <= GLS_SIZE_HEADROOM || cipherText == NULL) {
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Pas de configuration initial. FirstDecrypt\n");
+        printf("Bad argument FirstDecrypt (Size : %d).\n", size);
+        if (cipherText == NULL) printf("CipherText == NULL\n");
         #endif
         
-        return GLS_ERROR_NOPASSWD;
+        return GLS_ERROR_UNKNOWN;
         
     }
     
-    /* Temp and final memory allocation */
-    byte (*cText) = 0;
-    byte (*tempCypherText) = 0;
-    byte (*tempCypherTextFinal) = 0;
-    byte (*tempPlainText) = 0;
+    /* Only one allocation, decrypted in place */
+    *plainText = malloc(sizeof(byte) * size);
+    if (*plainText == NULL) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No memory. FirstDecrypt\n");
+        #endif
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    memcpy(*plainText, cipherText, size);
     
+    /* Message at the beginning of the buffer */
+    int sizePlainText = firstDecryptInPlace(myGLSSocket, *plainText, size);
+    if (sizePlainText > 0) memmove(*plainText, *plainText + GLS_SIZE_HEADROOM, sizePlainText);
     
-    /* Check if the message's size is at least highter than the header's size */
-    if (size > 96 && cipherText != NULL) {
-        
-        /*
-         * Memory allocation with the additional 768 bit from the GLS
-         * protocol (IV1 + IV2 + MAC + IV3 + IV4) = 768 bits / 96 bytes
-         */
+    return sizePlainText;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ First message decryption in place, the message is at
+ buffer + GLS_SIZE_HEADROOM.
+ Return the plaintext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int firstDecryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size){
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### firstDecrypt() Start ###\n");
+    #endif
+    
+    /* If the handlers aren't initialized or no encryption key is
+     available return an error */
+    if (myGLSSocket->m_isCryptoKey == 0 || myGLSSocket->m_isHandlerInit == 0) {
         
-        cText = malloc(sizeof(byte) * (size - 32));
-        tempCypherText = malloc(sizeof(byte) * (size - 32));
-        tempCypherTextFinal = malloc(sizeof(byte) * (size - 32));
-        tempPlainText = malloc(sizeof(byte) * (size - 32));
-        *plainText = malloc(sizeof(byte) * (size - 96));
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Pas de configuration initial. FirstDecrypt\n");
+        printf("### firstDecrypt() End ###\n\n");
+        #endif
         
-        if (cText == NULL || tempPlainText == NULL || tempCypherText == NULL || tempCypherTextFinal == NULL || *plainText == NULL) {
-            
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("No memory. FirstDecrypt\n");
-            #endif
-            
-            return GLS_ERROR_NOMEM;
-            
-        }
+        return GLS_ERROR_NOPASSWD;
         
     }
-    else {
+    
+    /* Check if the message's size is at least highter than the header's size */
+    if (size <= GLS_SIZE_HEADROOM || buffer == NULL) {
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Bad argument FirstDecrypt (Size : %d).\n", size);
-        if (cipherText == NULL) printf("CipherText == NULL\n");
         printf("### firstDecrypt() End ###\n\n");
         #endif
         
@@ -485,32 +666,13 @@ int firstDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, b
     /* Error handling */
     int error = 0;
     
-    /* Temp variable for IVS decryption */
-    byte tempIV1[16];
-    byte tempIV2[16];
-    byte tempIV1Final[16];
-    byte tempIV2Final[16];
-    
-    /* Getting IVS, data and MAC according to the GLS structure */
-    /* Encrypted IV1 and IV2 */
-    int i = 0;
-    for (i = 0; i < 16; i++) {
-        tempIV1[i] = cipherText[i];
-        tempIV2[i] = cipherText[i + 16];
-    }
-    /* MAC, IV3, IV4 and encrypted message */
-    i = 0;
-    for (i = 0; i < (size - 32); i++) {
-        cText[i] = cipherText[i + 32];
-    }
-    
     /* IVS decryption (IV1 and IV2 in ECB) */
     /* IV1 ECB */
-    error += gcry_cipher_decrypt(myGLSSocket->m_twofishHandlerECB, tempIV1Final, 16, tempIV1, 16);
-    error += gcry_cipher_decrypt(myGLSSocket->m_serpentHandlerECB, myGLSSocket->m_iv1, 16, tempIV1Final, 16);
+    error += gcry_cipher_decrypt(myGLSSocket->m_twofishHandlerECB, buffer, 16, NULL, 0);
+    error += gcry_cipher_decrypt(myGLSSocket->m_serpentHandlerECB, myGLSSocket->m_iv1, 16, buffer, 16);
     /* IV2 ECB */
-    error += gcry_cipher_decrypt(myGLSSocket->m_twofishHandlerECB, tempIV2Final, 16, tempIV2, 16);
-    error += gcry_cipher_decrypt(myGLSSocket->m_serpentHandlerECB, myGLSSocket->m_iv2, 16, tempIV2Final, 16);
+    error += gcry_cipher_decrypt(myGLSSocket->m_twofishHandlerECB, buffer + 16, 16, NULL, 0);
+    error += gcry_cipher_decrypt(myGLSSocket->m_serpentHandlerECB, myGLSSocket->m_iv2, 16, buffer + 16, 16);
     
     /* IVS Reset and Configuration  */
     error += gcry_cipher_reset(myGLSSocket->m_serpentHandlerCTS);
@@ -518,45 +680,9 @@ int firstDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, b
     error += gcry_cipher_reset(myGLSSocket->m_twofishHandlerCTS);
     error += gcry_cipher_setiv(myGLSSocket->m_twofishHandlerCTS, myGLSSocket->m_iv2, 16);
     
-    /* Message decryption */
-    error += gcry_cipher_decrypt(myGLSSocket->m_twofishHandlerCTS, tempCypherTextFinal, (size - 32), cText, (size - 32));
-    error += gcry_cipher_decrypt(myGLSSocket->m_serpentHandlerCTS, tempPlainText, (size - 32), tempCypherTextFinal, (size - 32));
-    
-    /* MAC generation (SHA-256) */
-    /* MAC = IV3 + IV4 + Data */
-    byte MAC[32];
-    byte cipherMAC[32];
-    /* Fill MAC with the message's MAC */
-    i = 0;
-    for (i = 0; i < 32; i++) {
-        MAC[i] = tempPlainText[i];
-    }
-    byte (*tempMACText);
-    tempMACText = malloc(sizeof(byte) * (size - 64));
-    if (tempMACText == NULL) {
-        
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("No memory. FirstDecrypt\n");
-        #endif
-        
-        return GLS_ERROR_NOMEM;
-        
-    }
-    /* IV3 and IV4 */
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        tempMACText[i] = tempPlainText[i + 32];
-        tempMACText[i + 16] = tempPlainText[i + 48];
-    }
-    /* Message */
-    i = 0;
-    for (i = 0; i < (size - 96); i++) {
-        tempMACText[i + 32] = tempPlainText[i + 64];
-    }
-    /* Generating the decrypted message's MAC (SHA-256) for comparison */
-    gcry_md_hash_buffer(GCRY_MD_SHA256, cipherMAC, tempMACText, (size - 64));
-    free(tempMACText);
-    tempMACText = 0;
+    /* MAC + IV3 + IV4 + Data decryption in place */
+    error += gcry_cipher_decrypt(myGLSSocket->m_twofishHandlerCTS, buffer + 32, (size - 32), NULL, 0);
+    error += gcry_cipher_decrypt(myGLSSocket->m_serpentHandlerCTS, buffer + 32, (size - 32), NULL, 0);
     
     /* Sending an error before comparing the MAC 
      because if bad decrypting = bad MAC */
@@ -565,20 +691,6 @@ int firstDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, b
         /* debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Error %d : %s\n", error, gcry_strerror(error));
-        #endif
-        
-        /* Free temp memory */
-        free(cText);
-        cText = 0;
-        free(tempPlainText);
-        tempPlainText = 0;
-        free(tempCypherText);
-        tempCypherText = 0;
-        free(tempCypherTextFinal);
-        tempCypherTextFinal = 0;
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("### firstDecrypt() End ###\n\n");
         #endif
         
@@ -586,29 +698,17 @@ int firstDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, b
         
     }
     
+    /* MAC generation (SHA-256) */
+    /* MAC = IV3 + IV4 + Data */
+    gcry_md_reset(myGLSSocket->m_macRecvHandler);
+    gcry_md_write(myGLSSocket->m_macRecvHandler, buffer + 64, 32);
+    gcry_md_write(myGLSSocket->m_macRecvHandler, buffer + GLS_SIZE_HEADROOM, (size - GLS_SIZE_HEADROOM));
+    
     /* MAC comparison */
-    i = 0;
-    while (MAC[i] == cipherMAC[i] && i < 32) {
-        i++;
-    }
-    if (!(i == 32)) {
+    if (memcmp(buffer + 32, gcry_md_read(myGLSSocket->m_macRecvHandler, GCRY_MD_SHA256), 32) != 0) {
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Error : MAC error FirstDecrypt\n");
-        #endif
-        
-        /* Free temp memory */
-        free(cText);
-        cText = 0;
-        free(tempPlainText);
-        tempPlainText = 0;
-        free(tempCypherText);
-        tempCypherText = 0;
-        free(tempCypherTextFinal);
-        tempCypherTextFinal = 0;
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("### firstDecrypt() End ###\n\n");
         #endif
         
@@ -616,75 +716,42 @@ int firstDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, b
         
     }
     
-    /* Get IV3, IV4 and message according to the GLS structure */
-    /* IV3 and IV4 */
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        myGLSSocket->m_iv3[i] = tempPlainText[i + 32];
-        myGLSSocket->m_iv4[i] = tempPlainText[i + 48];
-    }
-    /* Message */
-    i = 0;
-    for (i = 0; i < (size - 96); i++) {
-        (*plainText)[i] = tempPlainText[i + 64];
-    }
+    /* Get IV3 and IV4 according to the GLS structure */
+    memcpy(myGLSSocket->m_iv3, buffer + 64, 16);
+    memcpy(myGLSSocket->m_iv4, buffer + 80, 16);
     
     /* Debug only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Message serpent (FirstDecrypt) : ");
-    i = 0;
-    for (i = 0; i < (size - 96); i++) {
-        printf("%x", tempCypherTextFinal[i]);
-    }
-    printf("\n");
+    int i = 0;
     printf("IV1 (FirstDecrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv1[i]);
     }
     printf("\n");
     printf("IV2 (FirstDecrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv2[i]);
     }
     printf("\n");
     printf("IV3 (FirstDecrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv3[i]);
     }
     printf("\n");
     printf("IV4 (FirstDecrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv4[i]);
     }
     printf("\n");
-        printf("Message (FirstDecrypt) : ");
-    i = 0;
-    for (i = 0; i < (size - 96); i++) {
-        printf("%c", (*plainText)[i]);
+    printf("Message (FirstDecrypt) : ");
+    for (i = 0; i < (size - GLS_SIZE_HEADROOM); i++) {
+        printf("%c", buffer[i + GLS_SIZE_HEADROOM]);
     }
     printf("\n");
-    #endif
-    
-    /* Free temp memory */
-    free(cText);
-    cText = 0;
-    free(tempPlainText);
-    tempPlainText = 0;
-    free(tempCypherText);
-    tempCypherText = 0;
-    free(tempCypherTextFinal);
-    tempCypherTextFinal = 0;
-    
-    /* Debug Only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
     printf("### firstDecrypt() End ###\n\n");
     #endif
     
-    return size - 96;
+    return size - GLS_SIZE_HEADROOM;
     
 }
 
@@ -695,8 +762,6 @@ int firstDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, b
  
  PRIVATE
  
- 
- 
  Other message encryption.
  Return the ciphertext size or a negative number for an error.
  
@@ -704,6 +769,56 @@ int firstDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, b
 
 int allEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte** cypherText){
     
+    /* Check plaintext size */
+    if (size <= 0 || plainText == NULL) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Bad argument Encrypt (Size : %d).\n", size);
+        if (plainText == NULL) printf("PlainText == NULL\n");
+        #endif
+        
+        return GLS_ERROR_NOMESSAGE;
+        
+    }
+    
+    /*
+     * Only one allocation with the additional 768 bit from the GLS
+     * protocol (IV1 + IV2 + MAC + IV3 + IV4) = 768 bits / 96 bytes
+     * in front of the message, everything is encrypted in place.
+     */
+    *cypherText = malloc(sizeof(byte) * (size + GLS_SIZE_HEADROOM));
+    if (*cypherText == NULL) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No memory. Encrypt\n");
+        #endif
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    memcpy(*cypherText + GLS_SIZE_HEADROOM, plainText, size);
+    
+    return allEncryptInPlace(myGLSSocket, *cypherText, size);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Other message encryption in place. The message is at
+ buffer + GLS_SIZE_HEADROOM and buffer is replaced by the
+ cipher text :
+ CTS(MAC + IV1 + IV2 + IV3 + IV4 + Data)
+ Return the ciphertext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int allEncryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size){
+    
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
     printf("### encrypt() Start ###\n");
@@ -722,40 +837,11 @@ int allEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte
         
     }
     
-    /* Temp and final memory allocation */
-    byte (*tempPlainText) = 0;
-    byte (*tempCypherText) = 0;
-    byte (*tempCypherTextFinal) = 0;
-    
-    /* Check plaintext size and allocation */
-    if (size > 0 && plainText != NULL) {
-        
-        /*
-         * Memory allocation with the additional 768 bit from the GLS
-         * protocol (IV1 + IV2 + MAC + IV3 + IV4) = 768 bits / 96 bytes
-         * CypherText = (MAC) + (IV1 + IV2 + IV3 + IV4) + plainText
-         */
-        tempPlainText = malloc(sizeof(byte) * (size + 64));
-        tempCypherText = malloc(sizeof(byte) * (size + 96));
-        tempCypherTextFinal = malloc(sizeof(byte) * (size + 96));
-        *cypherText = malloc(sizeof(byte) * (size + 96));
-        
-        if (tempPlainText == NULL || tempCypherText == NULL || tempCypherTextFinal == NULL || *cypherText == NULL) {
-            
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("No memory. Encrypt\n");
-            #endif
-            
-            return GLS_ERROR_NOMEM;
-            
-        }
-        
-    }
-    else {
+    /* Check plaintext size */
+    if (size <= 0 || buffer == NULL) {
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Bad argument Encrypt (Size : %d).\n", size);
-        if (plainText == NULL) printf("PlainText == NULL\n");
         printf("### encrypt() End ###\n\n");
         #endif
         
@@ -772,37 +858,32 @@ int allEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte
     #endif
     
     /* IVS rotation */
-    int i = 0;
-    for (i = 0; i < 16; i++) {
-        myGLSSocket->m_iv1[i] = myGLSSocket->m_iv3[i];
-        myGLSSocket->m_iv2[i] = myGLSSocket->m_iv4[i];
-    }
+    memcpy(myGLSSocket->m_iv1, myGLSSocket->m_iv3, 16);
+    memcpy(myGLSSocket->m_iv2, myGLSSocket->m_iv4, 16);
+    
     /* next IVS generation */
-    error += getIV(myGLSSocket->m_iv3);
-    error += getIV(myGLSSocket->m_iv4);
+    error += getIV(myGLSSocket, myGLSSocket->m_iv3);
+    error += getIV(myGLSSocket, myGLSSocket->m_iv4);
     
     /* Debug only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
+    int i = 0;
     printf("IV1 (Encrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv1[i]);
     }
     printf("\n");
     printf("IV2 (Encrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv2[i]);
     }
     printf("\n");
     printf("IV3 (Encrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv3[i]);
     }
     printf("\n");
     printf("IV4 (Encrypt) : ");
-    i = 0;
     for (i = 0; i < 16; i++) {
         printf("%2X",  myGLSSocket->m_iv4[i]);
     }
@@ -815,69 +896,40 @@ int allEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte
     error += gcry_cipher_reset(myGLSSocket->m_twofishHandlerCTS);
     error += gcry_cipher_setiv(myGLSSocket->m_twofishHandlerCTS, myGLSSocket->m_iv2, 16);
     
-    
     #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
     struct timeval eTime;
     gettimeofday(&eTime, NULL);
     double tS = sTime.tv_sec*1000000 + (sTime.tv_usec);
     double tE = eTime.tv_sec*1000000  + (eTime.tv_usec);
     printf("IVs rotation : %f microSeconds\n", tE - tS);
+    gettimeofday(&sTime, NULL);
     #endif
     
-    
+    /* IV1, IV2, IV3 and IV4 in front of the message */
+    memcpy(buffer + 32, myGLSSocket->m_iv1, 16);
+    memcpy(buffer + 48, myGLSSocket->m_iv2, 16);
+    memcpy(buffer + 64, myGLSSocket->m_iv3, 16);
+    memcpy(buffer + 80, myGLSSocket->m_iv4, 16);
     
     /* MAC generation (SHA-256) */
-    /* MAC = IV1 + IV2 + IV3 + IV4 + Data */
-    byte MAC[32];
-    /* IV1 and IV2 */
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        tempPlainText[i] = myGLSSocket->m_iv1[i];
-        tempPlainText[i + 16] = myGLSSocket->m_iv2[i];
-    }
-    /* IV3 and IV4 */
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        tempPlainText[i + 32] = myGLSSocket->m_iv3[i];
-        tempPlainText[i + 48] = myGLSSocket->m_iv4[i];
-    }
-    /* Message */
-    i = 0;
-    for (i = 0; i < size; i++) {
-        tempPlainText[i + 64] = plainText[i];
-    }
-    
-    #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
-    gettimeofday(&sTime, NULL);
-    #endif
-    
-    gcry_md_hash_buffer(GCRY_MD_SHA256, MAC, tempPlainText, (size + 64));
+    /* MAC = IV1 + IV2 + IV3 + IV4 + Data, read in place from the buffer */
+    unsigned long long timeMac = getTimeMicro();
+    gcry_md_reset(myGLSSocket->m_macSendHandler);
+    gcry_md_write(myGLSSocket->m_macSendHandler, buffer + 32, 64);
+    gcry_md_write(myGLSSocket->m_macSendHandler, buffer + GLS_SIZE_HEADROOM, size);
+    memcpy(buffer, gcry_md_read(myGLSSocket->m_macSendHandler, GCRY_MD_SHA256), 32);
+    myGLSSocket->m_statsSend.m_macTime += getTimeMicro() - timeMac;
     
     #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
     gettimeofday(&eTime, NULL);
     tS = sTime.tv_sec*1000000 + (sTime.tv_usec);
     tE = eTime.tv_sec*1000000  + (eTime.tv_usec);
     printf("Mac generation : %f microSeconds\n", tE - tS);
-    #endif
-    
-    /* Filling tempCypherText according to the GLS structure */
-    /* MAC */
-    i = 0;
-    for (i = 0; i < 32; i++) {
-        tempCypherText[i] = MAC[i];
-    }
-    /* IVs + Message */
-    i = 0;
-    for (i = 0; i < (size + 64); i++) {
-        tempCypherText[i + 32] = tempPlainText[i];
-    }
-    
-    #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
     gettimeofday(&sTime, NULL);
     #endif
     
-    /* tempPlainText encryption */
-    error += gcry_cipher_encrypt(myGLSSocket->m_serpentHandlerCTS, tempCypherTextFinal, (size + 96), tempCypherText, (size + 96));
+    /* MAC + IVs + Message encryption in place */
+    error += gcry_cipher_encrypt(myGLSSocket->m_serpentHandlerCTS, buffer, (size + GLS_SIZE_HEADROOM), NULL, 0);
     
     #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
     gettimeofday(&eTime, NULL);
@@ -887,7 +939,7 @@ int allEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte
     gettimeofday(&sTime, NULL);
     #endif
     
-    error += gcry_cipher_encrypt(myGLSSocket->m_twofishHandlerCTS, *cypherText, (size + 96), tempCypherTextFinal, (size + 96));
+    error += gcry_cipher_encrypt(myGLSSocket->m_twofishHandlerCTS, buffer, (size + GLS_SIZE_HEADROOM), NULL, 0);
     
     #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
     gettimeofday(&eTime, NULL);
@@ -896,39 +948,11 @@ int allEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte
     printf("Twofish encryption : %f microSeconds\n", tE - tS);
     #endif
     
-    /* Debug only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Message (Encrypt) : ");
-    i = 0;
-    for (i = 0; i < size; i++) {
-        printf("%c", plainText[i]);
-    }
-    printf("\n");
-    printf("Message serpent (Encrypt) : ");
-    i = 0;
-    for (i = 0; i < size; i++) {
-        printf("%x", tempCypherText[i]);
-    }
-    printf("\n");
-    #endif
-    
     if(error != 0) {
         
         /* debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Error %d : %s\n", error, gcry_strerror(error));
-        #endif
-        
-        /* Free temp memory */
-        free(tempPlainText);
-        tempPlainText = 0;
-        free(tempCypherText);
-        tempCypherText = 0;
-        free(tempCypherTextFinal);
-        tempCypherTextFinal = 0;
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("### encrypt() End ###\n\n");
         #endif
         
@@ -936,21 +960,12 @@ int allEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte
         
     }
     
-    /* Free temp memory */
-    free(tempPlainText);
-    tempPlainText = 0;
-    free(tempCypherText);
-    tempCypherText = 0;
-    free(tempCypherTextFinal);
-    tempCypherTextFinal = 0;
-    
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
     printf("### encrypt() End ###\n\n");
     #endif
     
-    return size + 96;
-    
+    return size + GLS_SIZE_HEADROOM;
     
 }
 
@@ -968,6 +983,54 @@ int allEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte
 
 int allDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, byte** plainText){
     
+    /* Check if the message's size is at least highter than the header's size */
+    if (size <= GLS_SIZE_HEADROOM || cipherText == NULL) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Bad argument Decrypt (Size : %d).\n", size);
+        if (cipherText == NULL) printf("CipherText == NULL\n");
+        #endif
+        
+        return GLS_ERROR_UNKNOWN;
+        
+    }
+    
+    /* Only one allocation, decrypted in place */
+    *plainText = malloc(sizeof(byte) * size);
+    if (*plainText == NULL) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No memory. Decrypt\n");
+        #endif
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    memcpy(*plainText, cipherText, size);
+    
+    /* Message at the beginning of the buffer */
+    int sizePlainText = allDecryptInPlace(myGLSSocket, *plainText, size);
+    if (sizePlainText > 0) memmove(*plainText, *plainText + GLS_SIZE_HEADROOM, sizePlainText);
+    
+    return sizePlainText;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Others decryption in place, the message is at 
+ buffer + GLS_SIZE_HEADROOM. 
+ Return the plaintext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int allDecryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size){
+    
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
     printf("### decrypt() Start ###\n");
@@ -986,39 +1049,11 @@ int allDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, byt
         
     }
     
-    /* Temp and final memory allocation */
-    byte (*tempCypherText) = 0;
-    byte (*tempCypherTextFinal) = 0;
-    byte (*tempPlainText) = 0;
-    
     /* Check if the message's size is at least highter than the header's size */
-    if (size > 96 && cipherText != NULL) {
-        
-        /*
-         * Memory allocation with the additional 768 bit from the GLS
-         * protocol (IV1 + IV2 + MAC + IV3 + IV4) = 768 bits / 96 bytes
-         */
-        
-        tempCypherText = malloc(sizeof(byte) * size);
-        tempCypherTextFinal = malloc(sizeof(byte) * size);
-        tempPlainText = malloc(sizeof(byte) * (size - 32));
-        *plainText = malloc(sizeof(byte) * (size - 96));
-        if (tempPlainText == NULL || tempCypherText == NULL || tempCypherTextFinal == NULL || *plainText == NULL) {
-            
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("No memory. Decrypt\n");
-            #endif
-            
-            return GLS_ERROR_NOMEM;
-            
-        }
-        
-    }
-    else {
+    if (size <= GLS_SIZE_HEADROOM || buffer == NULL) {
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Bad argument Decrypt (Size : %d).\n", size);
-        if (cipherText == NULL) printf("CipherText == NULL\n");
         printf("### decrypt() End ###\n\n");
         #endif
         
@@ -1030,11 +1065,8 @@ int allDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, byt
     int error = 0;
     
     /* IVS rotation */
-    int i = 0;
-    for (i = 0; i < 16; i++) {
-        myGLSSocket->m_iv1[i] = myGLSSocket->m_iv3[i];
-        myGLSSocket->m_iv2[i] = myGLSSocket->m_iv4[i];
-    }
+    memcpy(myGLSSocket->m_iv1, myGLSSocket->m_iv3, 16);
+    memcpy(myGLSSocket->m_iv2, myGLSSocket->m_iv4, 16);
     
     /* IVS Reset and Configuration  */
     error += gcry_cipher_reset(myGLSSocket->m_serpentHandlerCTS);
@@ -1042,26 +1074,9 @@ int allDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, byt
     error += gcry_cipher_reset(myGLSSocket->m_twofishHandlerCTS);
     error += gcry_cipher_setiv(myGLSSocket->m_twofishHandlerCTS, myGLSSocket->m_iv2, 16);
     
-    /* Message decryption */
-    error += gcry_cipher_decrypt(myGLSSocket->m_twofishHandlerCTS, tempCypherText, size, cipherText, size);
-    error += gcry_cipher_decrypt(myGLSSocket->m_serpentHandlerCTS, tempCypherTextFinal, size, tempCypherText, size);
-    
-    /* MAC generation (SHA-256) */
-    /* MAC = IV1 + IV2 + IV3 + IV4 + Data */
-    byte MAC[32];
-    byte cipherMAC[32];
-    /* Fill MAC with the message's MAC */
-    i = 0;
-    for (i = 0; i < 32; i++) {
-        MAC[i] = tempCypherTextFinal[i];
-    }
-    /* IVS + Message */
-    i = 0;
-    for (i = 0; i < (size - 32); i++) {
-        tempPlainText[i] = tempCypherTextFinal[i + 32];
-    }
-    /* Generating the decrypted message's MAC (SHA-256) for comparison */
-    gcry_md_hash_buffer(GCRY_MD_SHA256, cipherMAC, tempPlainText, (size - 32));
+    /* Message decryption in place */
+    error += gcry_cipher_decrypt(myGLSSocket->m_twofishHandlerCTS, buffer, size, NULL, 0);
+    error += gcry_cipher_decrypt(myGLSSocket->m_serpentHandlerCTS, buffer, size, NULL, 0);
     
     /* Sending an error before comparing the MAC 
      because if bad decrypting = bad MAC */
@@ -1070,153 +1085,734 @@ int allDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, byt
         /* debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Error %d : %s\n", error, gcry_strerror(error));
+        printf("### decrypt() End ###\n\n");
         #endif
         
-        /* suppression de la mémoire temporaire */
-        free(tempPlainText);
-        tempPlainText = 0;
-        free(tempCypherText);
-        tempCypherText = 0;
-        free(tempCypherTextFinal);
-        tempCypherTextFinal = 0;
+        return GLS_ERROR_CRYPTO;
+        
+    }
+    
+    /* IVS synchronisation check before MAC because IVS desync = bad MAC but
+     the contrary isn't true */
+    if (memcmp(buffer + 32, myGLSSocket->m_iv1, 16) != 0 || memcmp(buffer + 48, myGLSSocket->m_iv2, 16) != 0) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error : Chainage error Decrypt\n");
+        printf("### decrypt() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_IVDESYNC;
+        
+    }
+    
+    /* MAC generation (SHA-256) */
+    /* MAC = IV1 + IV2 + IV3 + IV4 + Data */
+    unsigned long long timeMac = getTimeMicro();
+    gcry_md_reset(myGLSSocket->m_macRecvHandler);
+    gcry_md_write(myGLSSocket->m_macRecvHandler, buffer + 32, 64);
+    gcry_md_write(myGLSSocket->m_macRecvHandler, buffer + GLS_SIZE_HEADROOM, (size - GLS_SIZE_HEADROOM));
+    int isBadMac = memcmp(buffer, gcry_md_read(myGLSSocket->m_macRecvHandler, GCRY_MD_SHA256), 32);
+    myGLSSocket->m_statsRecv.m_macTime += getTimeMicro() - timeMac;
+    
+    /* MAC comparison */
+    if (isBadMac != 0) {
         
-        /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error : MAC error Decrypt\n");
         printf("### decrypt() End ###\n\n");
         #endif
         
+        return GLS_ERROR_MAC;
+        
+    }
+    
+    /* Get IV3 and IV4 according to the GLS structure */
+    memcpy(myGLSSocket->m_iv3, buffer + 64, 16);
+    memcpy(myGLSSocket->m_iv4, buffer + 80, 16);
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    int i = 0;
+    printf("IV1 (Decrypt) : ");
+    for (i = 0; i < 16; i++) {
+        printf("%2X",  myGLSSocket->m_iv1[i]);
+    }
+    printf("\n");
+    printf("IV2 (Decrypt) : ");
+    for (i = 0; i < 16; i++) {
+        printf("%2X",  myGLSSocket->m_iv2[i]);
+    }
+    printf("\n");
+    printf("IV3 (Decrypt) : ");
+    for (i = 0; i < 16; i++) {
+        printf("%2X",  myGLSSocket->m_iv3[i]);
+    }
+    printf("\n");
+    printf("IV4 (Decrypt) : ");
+    for (i = 0; i < 16; i++) {
+        printf("%2X",  myGLSSocket->m_iv4[i]);
+    }
+    printf("\n");
+    printf("Message (Decrypt) : ");
+    for (i = 0; i < (size - GLS_SIZE_HEADROOM); i++) {
+        printf("%c", buffer[i + GLS_SIZE_HEADROOM]);
+    }
+    printf("\n");
+    printf("### decrypt() End ###\n\n");
+    #endif
+    
+    return size - GLS_SIZE_HEADROOM;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Message encryption with the AEAD suite.
+ Return the ciphertext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int aeadEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte** cypherText){
+    
+    /* Check plaintext size */
+    if (size <= 0 || plainText == NULL) return GLS_ERROR_NOMESSAGE;
+    
+    /* Only one allocation with the AEAD header in front of the message */
+    *cypherText = malloc((size + GLS_SIZE_AEAD_HEADER) * sizeof(byte));
+    if (*cypherText == NULL) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No memory. aeadEncrypt\n");
+        #endif
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    memcpy(*cypherText + GLS_SIZE_AEAD_HEADER, plainText, size);
+    
+    return aeadEncryptInPlace(myGLSSocket, *cypherText, size);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Message encryption in place with the AEAD suite. The
+ message is at buffer + GLS_SIZE_AEAD_HEADER and buffer
+ is replaced by : Sequence + Tag + Data
+ The nonce is the direction (client 0, server 1) and the
+ sequence number, so it's never used twice with a key.
+ Return the ciphertext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int aeadEncryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size){
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### aeadEncrypt() Start ###\n");
+    #endif
+    
+    /* If the handler isn't initialized return an error */
+    if (myGLSSocket->m_isAeadInit == 0) return GLS_ERROR_NOPASSWD;
+    
+    /* Check plaintext size */
+    if (size <= 0 || buffer == NULL) return GLS_ERROR_NOMESSAGE;
+    
+    #if defined (GLS_AEAD_ENABLE)
+    
+    /* Nonce = direction (4 bytes) + sequence (8 bytes) */
+    byte nonce[12];
+    unsigned long long seq = myGLSSocket->m_aeadSendSeq;
+    memset(nonce, 0, 4);
+    nonce[3] = myGLSSocket->m_isServeur ? 1 : 0;
+    int i = 0;
+    for (i = 7; i >= 0; i--) {
+        
+        nonce[4 + i] = (byte) (seq & 0xFF);
+        buffer[i] = (byte) (seq & 0xFF);
+        seq >>= 8;
+        
+    }
+    
+    /* Error handling */
+    int error = 0;
+    
+    /* Encryption and tag in one pass */
+    error += gcry_cipher_reset(myGLSSocket->m_aeadHandler);
+    error += gcry_cipher_setiv(myGLSSocket->m_aeadHandler, nonce, 12);
+    error += gcry_cipher_encrypt(myGLSSocket->m_aeadHandler, buffer + GLS_SIZE_AEAD_HEADER, size, NULL, 0);
+    error += gcry_cipher_gettag(myGLSSocket->m_aeadHandler, buffer + 8, 16);
+    
+    /* The nonce is consumed even if an error occured */
+    myGLSSocket->m_aeadSendSeq++;
+    
+    if (error != 0) {
+        
+        /* debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error %d : %s\n", error, gcry_strerror(error));
+        printf("### aeadEncrypt() End ###\n\n");
+        #endif
+        
         return GLS_ERROR_CRYPTO;
         
     }
     
-    /* IVS synchronisation check before MAC because IVS desync = bad MAC but
-     the contrary isn't true */
-    int y = 0;
-    while (myGLSSocket->m_iv1[y] == tempPlainText[y] && myGLSSocket->m_iv2[y] == tempPlainText[y + 16] && y < 16) {
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### aeadEncrypt() End ###\n\n");
+    #endif
+    
+    return size + GLS_SIZE_AEAD_HEADER;
+    
+    #else
+    
+    return GLS_ERROR_OPNOTSUPP;
+    
+    #endif
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Message decryption in place with the AEAD suite, the
+ message is at buffer + GLS_SIZE_AEAD_HEADER.
+ Return the plaintext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int aeadDecryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size){
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### aeadDecrypt() Start ###\n");
+    #endif
+    
+    /* If the handler isn't initialized return an error */
+    if (myGLSSocket->m_isAeadInit == 0) return GLS_ERROR_NOPASSWD;
+    
+    /* Check if the message's size is at least highter than the header's size */
+    if (size <= GLS_SIZE_AEAD_HEADER || buffer == NULL) return GLS_ERROR_UNKNOWN;
+    
+    #if defined (GLS_AEAD_ENABLE)
+    
+    /* The sequence needs to be the next one, like the IVS chain */
+    unsigned long long seq = 0;
+    int i = 0;
+    for (i = 0; i < 8; i++) {
         
-        y++;
+        seq = (seq << 8) | buffer[i];
         
     }
-    if (!(y == 16)) {
+    if (seq != myGLSSocket->m_aeadRecvSeq) {
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Error : Chainage error Decrypt\n");
+        printf("Error : Sequence error Decrypt (%llu / %llu)\n", seq, myGLSSocket->m_aeadRecvSeq);
+        printf("### aeadDecrypt() End ###\n\n");
         #endif
         
-        /* Free memory */
-        free(tempPlainText);
-        tempPlainText = 0;
-        free(tempCypherText);
-        tempCypherText = 0;
-        free(tempCypherTextFinal);
-        tempCypherTextFinal = 0;
+        return GLS_ERROR_IVDESYNC;
         
-        /* Debug Only */
+    }
+    
+    /* Nonce of the other side */
+    byte nonce[12];
+    memset(nonce, 0, 4);
+    nonce[3] = myGLSSocket->m_isServeur ? 0 : 1;
+    memcpy(nonce + 4, buffer, 8);
+    
+    /* Error handling */
+    int error = 0;
+    
+    /* Message decryption in place */
+    error += gcry_cipher_reset(myGLSSocket->m_aeadHandler);
+    error += gcry_cipher_setiv(myGLSSocket->m_aeadHandler, nonce, 12);
+    error += gcry_cipher_decrypt(myGLSSocket->m_aeadHandler, buffer + GLS_SIZE_AEAD_HEADER, size - GLS_SIZE_AEAD_HEADER, NULL, 0);
+    
+    if (error != 0) {
+        
+        /* debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### decrypt() End ###\n\n");
+        printf("Error %d : %s\n", error, gcry_strerror(error));
+        printf("### aeadDecrypt() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_CRYPTO;
+        
+    }
+    
+    /* Tag comparison */
+    if (gcry_cipher_checktag(myGLSSocket->m_aeadHandler, buffer + 8, 16) != 0) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error : Tag error Decrypt\n");
+        printf("### aeadDecrypt() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_MAC;
+        
+    }
+    
+    myGLSSocket->m_aeadRecvSeq++;
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### aeadDecrypt() End ###\n\n");
+    #endif
+    
+    return size - GLS_SIZE_AEAD_HEADER;
+    
+    #else
+    
+    return GLS_ERROR_OPNOTSUPP;
+    
+    #endif
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Message encryption with the cascade in counter mode.
+ Return the ciphertext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int ctrEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte** cypherText){
+    
+    /* Check plaintext size */
+    if (size <= 0 || plainText == NULL) return GLS_ERROR_NOMESSAGE;
+    
+    /* Only one allocation with the header in front of the message */
+    *cypherText = malloc((size + GLS_SIZE_HEADROOM) * sizeof(byte));
+    if (*cypherText == NULL) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No memory. ctrEncrypt\n");
+        #endif
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    memcpy(*cypherText + GLS_SIZE_HEADROOM, plainText, size);
+    
+    return ctrEncryptInPlace(myGLSSocket, *cypherText, size);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Message encryption in place with the cascade in counter
+ mode. The message is at buffer + GLS_SIZE_HEADROOM and
+ buffer is replaced by :
+ CTR(MAC + IV1 + IV2 + IV3 + IV4 + Data)
+ IV1 and IV2 are the first counters of Serpent and Twofish.
+ The data is cut in chunks of GLS_SIZE_CHUNK encrypted by
+ the worker pool, so the MAC is a HMAC of their hash :
+ HMAC(IV1 + IV2 + IV3 + IV4 + SHA-256(Chunk 1) + ...)
+ Return the ciphertext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int ctrEncryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size){
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### ctrEncrypt() Start ###\n");
+    #endif
+    
+    /* If no encryption key or MAC key return an error */
+    if (myGLSSocket->m_isCryptoKey == 0 || myGLSSocket->m_isHmacInit == 0) return GLS_ERROR_NOPASSWD;
+    
+    /* Check plaintext size */
+    if (size <= 0 || buffer == NULL) return GLS_ERROR_NOMESSAGE;
+    
+    /* Error handling */
+    int error = 0;
+    
+    /* IVS rotation */
+    memcpy(myGLSSocket->m_iv1, myGLSSocket->m_iv3, 16);
+    memcpy(myGLSSocket->m_iv2, myGLSSocket->m_iv4, 16);
+    
+    /* next IVS generation */
+    error += getIV(myGLSSocket, myGLSSocket->m_iv3);
+    error += getIV(myGLSSocket, myGLSSocket->m_iv4);
+    
+    /* IV1, IV2, IV3 and IV4 in front of the message */
+    memcpy(buffer + 32, myGLSSocket->m_iv1, 16);
+    memcpy(buffer + 48, myGLSSocket->m_iv2, 16);
+    memcpy(buffer + 64, myGLSSocket->m_iv3, 16);
+    memcpy(buffer + 80, myGLSSocket->m_iv4, 16);
+    
+    /* One task per crypto thread, each one with its handlers for a part of the chunks */
+    int nbChunk = (size + GLS_SIZE_CHUNK - 1) / GLS_SIZE_CHUNK;
+    GLSCtrJob job;
+    job.m_socket = myGLSSocket;
+    job.m_buffer = buffer;
+    job.m_size = size;
+    job.m_isEncrypt = 1;
+    job.m_nbChunk = nbChunk;
+    job.m_nbSlot = getCryptoThreads();
+    if (job.m_nbSlot > nbChunk) job.m_nbSlot = nbChunk;
+    job.m_hash = malloc(nbChunk * 32);
+    job.m_error = calloc(nbChunk, sizeof(int));
+    if (job.m_hash == NULL || job.m_error == NULL) {
+        
+        if (job.m_hash != NULL) free(job.m_hash);
+        if (job.m_error != NULL) free(job.m_error);
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    
+    /* Hash and encryption of the chunks */
+    error += runParallel(ctrChunk, &job, job.m_nbSlot);
+    int i = 0;
+    for (i = 0; i < nbChunk; i++) {
+        
+        error += job.m_error[i];
+        
+    }
+    
+    /* MAC generation and header encryption */
+    unsigned long long timeMac = getTimeMicro();
+    if (error == 0) error += ctrMac(myGLSSocket->m_hmacSendHandler, buffer + 32, job.m_hash, nbChunk, buffer);
+    myGLSSocket->m_statsSend.m_macTime += getTimeMicro() - timeMac;
+    if (error == 0) error += ctrCascade(myGLSSocket, 0, buffer, GLS_SIZE_HEADROOM, 0);
+    
+    /* Free memory */
+    free(job.m_hash);
+    free(job.m_error);
+    
+    if (error != 0) {
+        
+        /* debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error %d\n", error);
+        printf("### ctrEncrypt() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_CRYPTO;
+        
+    }
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### ctrEncrypt() End ###\n\n");
+    #endif
+    
+    return size + GLS_SIZE_HEADROOM;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Message decryption in place with the cascade in counter
+ mode, the message is at buffer + GLS_SIZE_HEADROOM.
+ Return the plaintext size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int ctrDecryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size){
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### ctrDecrypt() Start ###\n");
+    #endif
+    
+    /* If no encryption key or MAC key return an error */
+    if (myGLSSocket->m_isCryptoKey == 0 || myGLSSocket->m_isHmacInit == 0) return GLS_ERROR_NOPASSWD;
+    
+    /* Check if the message's size is at least highter than the header's size */
+    if (size <= GLS_SIZE_HEADROOM || buffer == NULL) return GLS_ERROR_UNKNOWN;
+    
+    /* IVS rotation */
+    memcpy(myGLSSocket->m_iv1, myGLSSocket->m_iv3, 16);
+    memcpy(myGLSSocket->m_iv2, myGLSSocket->m_iv4, 16);
+    
+    /* Header decryption first, no need to decrypt the data if the IVS are desynchronized */
+    if (ctrCascade(myGLSSocket, 0, buffer, GLS_SIZE_HEADROOM, 0) != 0) return GLS_ERROR_CRYPTO;
+    if (memcmp(buffer + 32, myGLSSocket->m_iv1, 16) != 0 || memcmp(buffer + 48, myGLSSocket->m_iv2, 16) != 0) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error : Chainage error Decrypt\n");
+        printf("### ctrDecrypt() End ###\n\n");
         #endif
         
         return GLS_ERROR_IVDESYNC;
         
     }
     
-    /* MAC comparison */
-    i = 0;
-    while (MAC[i] == cipherMAC[i] && i < 32) {
+    /* One task per crypto thread, each one with its handlers for a part of the chunks */
+    int sizeData = size - GLS_SIZE_HEADROOM;
+    int nbChunk = (sizeData + GLS_SIZE_CHUNK - 1) / GLS_SIZE_CHUNK;
+    GLSCtrJob job;
+    job.m_socket = myGLSSocket;
+    job.m_buffer = buffer;
+    job.m_size = sizeData;
+    job.m_isEncrypt = 0;
+    job.m_nbChunk = nbChunk;
+    job.m_nbSlot = getCryptoThreads();
+    if (job.m_nbSlot > nbChunk) job.m_nbSlot = nbChunk;
+    job.m_hash = malloc(nbChunk * 32);
+    job.m_error = calloc(nbChunk, sizeof(int));
+    if (job.m_hash == NULL || job.m_error == NULL) {
+        
+        if (job.m_hash != NULL) free(job.m_hash);
+        if (job.m_error != NULL) free(job.m_error);
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    
+    /* Decryption and hash of the chunks */
+    int error = runParallel(ctrChunk, &job, job.m_nbSlot);
+    int i = 0;
+    for (i = 0; i < nbChunk; i++) {
+        
+        error += job.m_error[i];
+        
+    }
+    
+    /* MAC generation */
+    byte cipherMAC[32];
+    unsigned long long timeMac = getTimeMicro();
+    if (error == 0) error += ctrMac(myGLSSocket->m_hmacRecvHandler, buffer + 32, job.m_hash, nbChunk, cipherMAC);
+    myGLSSocket->m_statsRecv.m_macTime += getTimeMicro() - timeMac;
+    
+    /* Free memory */
+    free(job.m_hash);
+    free(job.m_error);
+    
+    if (error != 0) {
+        
+        /* debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error %d\n", error);
+        printf("### ctrDecrypt() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_CRYPTO;
+        
+    }
+    
+    /* MAC comparison */
+    if (memcmp(buffer, cipherMAC, 32) != 0) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error : MAC error Decrypt\n");
+        printf("### ctrDecrypt() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_MAC;
+        
+    }
+    
+    /* Get IV3 and IV4 according to the GLS structure */
+    memcpy(myGLSSocket->m_iv3, buffer + 64, 16);
+    memcpy(myGLSSocket->m_iv4, buffer + 80, 16);
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### ctrDecrypt() End ###\n\n");
+    #endif
+    
+    return sizeData;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Encrypt or decrypt (the same in counter mode) size bytes
+ at offset bytes of the message with Serpent and Twofish.
+ The counters start at IV1 and IV2 + offset / 16, so each
+ part of the message can be done by a different thread
+ with the handlers of its slot (0 to GLS_MAX_THREAD - 1).
+ The handlers are opened and keyed at their first use,
+ only the counters are set here.
+ Return 0 for success or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int ctrCascade(GLSSock* myGLSSocket, const int slot, byte* buffer, const int size, const int offset) {
+    
+    if (myGLSSocket->m_ctrHandler == NULL || slot < 0 || slot >= GLS_MAX_THREAD) return GLS_ERROR_CRYPTO;
+    
+    /* Counters of this part of the message (128 bits big endian) */
+    byte counter1[16];
+    byte counter2[16];
+    unsigned int carry1 = offset / 16;
+    unsigned int carry2 = offset / 16;
+    int i = 0;
+    for (i = 15; i >= 0; i--) {
         
-        i++;
+        carry1 += myGLSSocket->m_iv1[i];
+        carry2 += myGLSSocket->m_iv2[i];
+        counter1[i] = (byte) (carry1 & 0xFF);
+        counter2[i] = (byte) (carry2 & 0xFF);
+        carry1 >>= 8;
+        carry2 >>= 8;
         
     }
-    if (!(i == 32)) {
+    
+    /* Error handling */
+    int error = 0;
+    
+    /* Serpent and Twofish (CTR, 256 bit) of the slot, keyed once */
+    gcry_cipher_hd_t* serpentHandler = &myGLSSocket->m_ctrHandler[2 * slot];
+    gcry_cipher_hd_t* twofishHandler = &myGLSSocket->m_ctrHandler[2 * slot + 1];
+    if (*serpentHandler == NULL) {
         
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Error : MAC error Decrypt\n");
-        #endif
+        error += gcry_cipher_open(serpentHandler, GCRY_CIPHER_SERPENT256, GCRY_CIPHER_MODE_CTR, 0);
+        if (error == 0) error += gcry_cipher_open(twofishHandler, GCRY_CIPHER_TWOFISH, GCRY_CIPHER_MODE_CTR, 0);
+        if (error == 0) error += gcry_cipher_setkey(*serpentHandler, myGLSSocket->m_key1, 32);
+        if (error == 0) error += gcry_cipher_setkey(*twofishHandler, myGLSSocket->m_key2, 32);
         
-        /* Free temp memory */
-        free(tempPlainText);
-        tempPlainText = 0;
-        free(tempCypherText);
-        tempCypherText = 0;
-        free(tempCypherTextFinal);
-        tempCypherTextFinal = 0;
+        /* The slot is opened again at the next call */
+        if (error != 0) {
+            
+            gcry_cipher_close(*serpentHandler);
+            gcry_cipher_close(*twofishHandler);
+            *serpentHandler = 0;
+            *twofishHandler = 0;
+            
+            return GLS_ERROR_CRYPTO;
+            
+        }
         
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### decrypt() End ###\n\n");
-        #endif
+    }
+    
+    error += gcry_cipher_setctr(*serpentHandler, counter1, 16);
+    error += gcry_cipher_encrypt(*serpentHandler, buffer, size, NULL, 0);
+    error += gcry_cipher_setctr(*twofishHandler, counter2, 16);
+    error += gcry_cipher_encrypt(*twofishHandler, buffer, size, NULL, 0);
+    
+    if (error != 0) return GLS_ERROR_CRYPTO;
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Close the handlers of the CTR cascade, their keys are
+ wiped by libgcrypt.
+ 
+ ---------------------------------------------------------*/
+
+void closeCtrHandler(GLSSock* myGLSSocket) {
+    
+    if (myGLSSocket->m_ctrHandler == NULL) return;
+    
+    int i = 0;
+    for (i = 0; i < 2 * GLS_MAX_THREAD; i++) {
         
-        return GLS_ERROR_MAC;
+        if (myGLSSocket->m_ctrHandler[i] != NULL) gcry_cipher_close(myGLSSocket->m_ctrHandler[i]);
         
     }
     
-    /* Get IV3, IV4 and message according to the GLS structure */
-    /* IV3 and IV4 */
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        myGLSSocket->m_iv3[i] = tempPlainText[i + 32];
-        myGLSSocket->m_iv4[i] = tempPlainText[i + 48];
-    }
-    /* Message */
-    i = 0;
-    for (i = 0; i < (size - 96); i++) {
-        (*plainText)[i] = tempPlainText[i + 64];
-    }
+    free(myGLSSocket->m_ctrHandler);
+    myGLSSocket->m_ctrHandler = 0;
     
-    /* Debug only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Message serpent (Decrypt) : ");
-    i = 0;
-    for (i = 0; i < (size - 96); i++) {
-        printf("%x", tempCypherTextFinal[i]);
-    }
-    printf("\n");
-    printf("IV1 (Decrypt) : ");
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        printf("%2X",  myGLSSocket->m_iv1[i]);
-    }
-    printf("\n");
-    printf("IV2 (Decrypt) : ");
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        printf("%2X",  myGLSSocket->m_iv2[i]);
-    }
-    printf("\n");
-    printf("IV3 (Decrypt) : ");
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        printf("%2X",  myGLSSocket->m_iv3[i]);
-    }
-    printf("\n");
-    printf("IV4 (Decrypt) : ");
-    i = 0;
-    for (i = 0; i < 16; i++) {
-        printf("%2X",  myGLSSocket->m_iv4[i]);
-    }
-    printf("\n");
-    printf("Message (Decrypt) : ");
-    i = 0;
-    for (i = 0; i < (size - 96); i++) {
-        printf("%c", (*plainText)[i]);
-    }
-    printf("\n");
-    #endif
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ MAC of the CTR cascade, HMAC-SHA-256 with the MAC key of
+ the connexion over the IVS and the hash of the chunks.
+ The handler is keyed once by initSuiteHandler() and only
+ reset here.
+ Return 0 for success or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int ctrMac(gcry_md_hd_t macHandler, const byte* ivs, const byte* hash, const int nbHash, byte* mac) {
     
-    /* Free temp memory */
-    free(tempPlainText);
-    tempPlainText = 0;
-    free(tempCypherText);
-    tempCypherText = 0;
-    free(tempCypherTextFinal);
-    tempCypherTextFinal = 0;
+    gcry_md_reset(macHandler);
+    gcry_md_write(macHandler, ivs, 64);
+    gcry_md_write(macHandler, hash, nbHash * 32);
+    memcpy(mac, gcry_md_read(macHandler, GCRY_MD_SHA256), 32);
     
-    /* Debug Only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### decrypt() End ###\n\n");
-    #endif
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Task of the worker pool for the CTR cascade, the chunks
+ index, index + m_nbSlot, ... of the message with the
+ handlers of the slot index. The hash is always done on
+ the plaintext.
+ 
+ ---------------------------------------------------------*/
+
+void ctrChunk(void* arg, const int index) {
+    
+    GLSCtrJob* job = (GLSCtrJob*) arg;
     
-    return size - 96;
+    int chunk = 0;
+    for (chunk = index; chunk < job->m_nbChunk; chunk += job->m_nbSlot) {
+        
+        /* Chunk position after the header */
+        int offset = chunk * GLS_SIZE_CHUNK;
+        int size = job->m_size - offset;
+        if (size > GLS_SIZE_CHUNK) size = GLS_SIZE_CHUNK;
+        byte* data = job->m_buffer + GLS_SIZE_HEADROOM + offset;
+        
+        if (job->m_isEncrypt == 1) gcry_md_hash_buffer(GCRY_MD_SHA256, job->m_hash + chunk * 32, data, size);
+        job->m_error[chunk] = ctrCascade(job->m_socket, index, data, size, GLS_SIZE_HEADROOM + offset);
+        if (job->m_isEncrypt == 0) gcry_md_hash_buffer(GCRY_MD_SHA256, job->m_hash + chunk * 32, data, size);
+        
+    }
     
 }
 
@@ -1238,8 +1834,9 @@ int encryptWithPK(const byte *cert, const int certLen, const byte* plainText, co
     if (sizePlainText <= 0 || plainText == NULL) return GLS_ERROR_NOMESSAGE;
     if (certLen <= 0 || cert == NULL) return GLS_ERROR_NOCERT;
     
-    /* Getting Key Size in bits */
-    int keySize = getModulusSize(cert, certLen);
+    /* The certificate is parsed one time for all the rounds */
+    gcry_sexp_t publicKey = 0;
+    int keySize = getPublicKeyFromCert(cert, certLen, &publicKey);
     if (keySize < 0) return keySize;
     
     /* getting OAEP Message size : ModulusSize(bytes) -2 -2 * hashTagLength */
@@ -1248,7 +1845,10 @@ int encryptWithPK(const byte *cert, const int certLen, const byte* plainText, co
     /* if the message can be encrypt with one round of PK encryption */
     if (messSize > sizePlainText) {
         
-        return _encryptWithPK(cert, certLen, plainText, sizePlainText, cypherText);
+        int sizeCipherText = _encryptWithPK(publicKey, plainText, sizePlainText, cypherText);
+        gcry_sexp_release(publicKey);
+        
+        return sizeCipherText;
         
     }
     else {
@@ -1295,104 +1895,55 @@ int encryptWithPK(const byte *cert, const int certLen, const byte* plainText, co
         printf("last packet size: %d\n\n", (sizePlainText % messSize));
         #endif
         
-        byte *tempCipherText = 0;
+        /* One allocation for all the rounds, a round is at most the modulus size */
+        byte *tempCipherText = malloc(nbTour * (keySize / 8));
         int sizeCipherText = 0;
+        if (tempCipherText == NULL) {
+            
+            gcry_sexp_release(publicKey);
+            return GLS_ERROR_NOMEM;
+            
+        }
         
         /* Rounds for PK encryptions */
         int i = 0;
         for (i = 0; i < nbTour; i++) {
             
-            /* size of the block to copy */
+            /* size of the block to encrypt */
             int sizeBlock = 0;
             if (i == (nbTour - 1) && (sizePlainText % messSize) != 0) sizeBlock = (sizePlainText % messSize);
             else sizeBlock = messSize;
             
-            byte *memtemp = malloc(messSize);
-            if (memtemp == NULL) return GLS_ERROR_NOMEM;
-            
-            /* copy of the block to encrypt */
-            int y = 0;
-            for (y = 0; y < sizeBlock; y++) {
-                
-                memtemp[y] = plainText[(messSize * i) + y];
-                
-            }
-            
-            /* encryption */
+            /* encryption of the block read in place */
             byte* cipher = 0;
-            int sizeCipher = _encryptWithPK(cert, certLen, memtemp, sizeBlock, &cipher);
-            if (sizeCipher < 0) {
+            int sizeCipher = _encryptWithPK(publicKey, plainText + (messSize * i), sizeBlock, &cipher);
+            if (sizeCipher < 0 || sizeCipher > (keySize / 8)) {
                
                 /* Free memory */
-                if (memtemp != NULL) {
-                    free(memtemp);
-                    memtemp = 0;
-                }
-                if (cipher != NULL) {
-                    free(cipher);
-                    cipher = 0;
-                }
-                
-                return sizeCipher;
-                
-            }
-            
-            /* adding cipher to temp memory */
-            byte *temp = 0;
-            temp = malloc(sizeCipherText + sizeCipher);
-            if (temp == NULL) {
-                
-                /* Free memory */
-                if (memtemp != NULL) {
-                    free(memtemp);
-                    memtemp = 0;
-                }
                 if (cipher != NULL) {
                     free(cipher);
                     cipher = 0;
                 }
+                free(tempCipherText);
+                tempCipherText = 0;
+                gcry_sexp_release(publicKey);
                 
-                return GLS_ERROR_NOMEM;
-                
-            }
-            /* copy of old memory */
-            for (y = 0; y < sizeCipherText; y++) {
-                
-                temp[y] = tempCipherText[y];
-                
-            }
-            /* copy of new memory */
-            for (y = 0; y < sizeCipher; y++) {
-                
-                temp[sizeCipherText + y] = cipher[y];
+                if (sizeCipher < 0) return sizeCipher;
+                else return GLS_ERROR_CRYPTO;
                 
             }
             
-            /* increment size */
+            /* adding cipher after the previous rounds */
+            memcpy(tempCipherText + sizeCipherText, cipher, sizeCipher);
             sizeCipherText += sizeCipher;
             
-            /* free old memory */
-            if (tempCipherText != NULL) {
-                free(tempCipherText);
-                tempCipherText = 0;
-            }
-            
-            /* swap temp to tempCipherText */
-            tempCipherText = temp;
-            temp = 0;
-            
             /* free memory */
-            if (memtemp != NULL) {
-                free(memtemp);
-                memtemp = 0;
-            }
-            if (cipher != NULL) {
-                free(cipher);
-                cipher = 0;
-            }
+            free(cipher);
+            cipher = 0;
             
         }
         
+        gcry_sexp_release(publicKey);
         (*cypherText) = tempCipherText;
         
         return sizeCipherText;
@@ -1403,1077 +1954,47 @@ int encryptWithPK(const byte *cert, const int certLen, const byte* plainText, co
 
 
 
-
-/*-------------------------------------------------------
- 
- PRIVATE
- 
- Private Key encryption, return the cipherText size or 
- a negative number for an error.
- 
- ---------------------------------------------------------*/
-
-int _encryptWithPK(const byte *cert, const int certLen, const byte* plainText, const int sizePlainText, byte** cypherText) {
-    
-    /* Debug Only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### encryptWithPK() Start ###\n");
-    #endif
-    
-    /* argument check */
-    if (sizePlainText <= 0 || plainText == NULL) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        if (plainText == NULL) printf("Plaintext == NULL\n");
-        if (sizePlainText <= 0) printf("sizePlainText <= 0\n");
-        printf("No Message to encrypt\n");
-        printf("### encryptWithPK() End ###\n\n");
-        #endif
-
-        return GLS_ERROR_NOMESSAGE;
-    
-    }
-    if (certLen <= 0 || cert == NULL) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("No certificate\n");
-        printf("### encryptWithPK() End ###\n\n");
-        #endif
-
-        return GLS_ERROR_NOCERT;
-    
-    }
-    /* Certificate structure definition */
-    ASN1_ARRAY_TYPE structCertificat[] = {
-        { "PKIX1Implicit88", 536875024, NULL },
-        { NULL, 1610612748, NULL },
-        { "iso", 1073741825, "1"},
-        { "identified-organization", 1073741825, "3"},
-        { "dod", 1073741825, "6"},
-        { "internet", 1073741825, "1"},
-        { "security", 1073741825, "5"},
-        { "mechanisms", 1073741825, "5"},
-        { "pkix", 1073741825, "7"},
-        { "id-mod", 1073741825, "0"},
-        { "id-pkix1-implicit-88", 1, "2"},
-        { "id-ce", 1879048204, NULL },
-        { "joint-iso-ccitt", 1073741825, "2"},
-        { "ds", 1073741825, "5"},
-        { NULL, 1, "29"},
-        { "id-ce-authorityKeyIdentifier", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "35"},
-        { "AuthorityKeyIdentifier", 1610612741, NULL },
-        { "keyIdentifier", 1610637314, "KeyIdentifier"},
-        { NULL, 4104, "0"},
-        { "authorityCertIssuer", 1610637314, "GeneralNames"},
-        { NULL, 4104, "1"},
-        { "authorityCertSerialNumber", 536895490, "CertificateSerialNumber"},
-        { NULL, 4104, "2"},
-        { "KeyIdentifier", 1073741831, NULL },
-        { "id-ce-subjectKeyIdentifier", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "14"},
-        { "SubjectKeyIdentifier", 1073741826, "KeyIdentifier"},
-        { "id-ce-keyUsage", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "15"},
-        { "KeyUsage", 1610874886, NULL },
-        { "digitalSignature", 1073741825, "0"},
-        { "nonRepudiation", 1073741825, "1"},
-        { "keyEncipherment", 1073741825, "2"},
-        { "dataEncipherment", 1073741825, "3"},
-        { "keyAgreement", 1073741825, "4"},
-        { "keyCertSign", 1073741825, "5"},
-        { "cRLSign", 1073741825, "6"},
-        { "encipherOnly", 1073741825, "7"},
-        { "decipherOnly", 1, "8"},
-        { "id-ce-privateKeyUsagePeriod", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "16"},
-        { "PrivateKeyUsagePeriod", 1610612741, NULL },
-        { "notBefore", 1619025937, NULL },
-        { NULL, 4104, "0"},
-        { "notAfter", 545284113, NULL },
-        { NULL, 4104, "1"},
-        { "id-ce-certificatePolicies", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "32"},
-        { "CertificatePolicies", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "PolicyInformation"},
-        { "PolicyInformation", 1610612741, NULL },
-        { "policyIdentifier", 1073741826, "CertPolicyId"},
-        { "policyQualifiers", 538984459, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "PolicyQualifierInfo"},
-        { "CertPolicyId", 1073741836, NULL },
-        { "PolicyQualifierInfo", 1610612741, NULL },
-        { "policyQualifierId", 1073741826, "PolicyQualifierId"},
-        { "qualifier", 541065229, NULL },
-        { "policyQualifierId", 1, NULL },
-        { "PolicyQualifierId", 1073741836, NULL },
-        { "CPSuri", 1073741826, "IA5String"},
-        { "UserNotice", 1610612741, NULL },
-        { "noticeRef", 1073758210, "NoticeReference"},
-        { "explicitText", 16386, "DisplayText"},
-        { "NoticeReference", 1610612741, NULL },
-        { "organization", 1073741826, "DisplayText"},
-        { "noticeNumbers", 536870923, NULL },
-        { NULL, 3, NULL },
-        { "DisplayText", 1610612754, NULL },
-        { "visibleString", 1612709890, "VisibleString"},
-        { "200", 524298, "1"},
-        { "bmpString", 1612709890, "BMPString"},
-        { "200", 524298, "1"},
-        { "utf8String", 538968066, "UTF8String"},
-        { "200", 524298, "1"},
-        { "id-ce-policyMappings", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "33"},
-        { "PolicyMappings", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 536870917, NULL },
-        { "issuerDomainPolicy", 1073741826, "CertPolicyId"},
-        { "subjectDomainPolicy", 2, "CertPolicyId"},
-        { "id-ce-subjectAltName", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "17"},
-        { "SubjectAltName", 1073741826, "GeneralNames"},
-        { "GeneralNames", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "GeneralName"},
-        { "GeneralName", 1610612754, NULL },
-        { "otherName", 1610620930, "AnotherName"},
-        { NULL, 4104, "0"},
-        { "rfc822Name", 1610620930, "IA5String"},
-        { NULL, 4104, "1"},
-        { "dNSName", 1610620930, "IA5String"},
-        { NULL, 4104, "2"},
-        { "x400Address", 1610620930, "ORAddress"},
-        { NULL, 4104, "3"},
-        { "directoryName", 1610620930, "Name"},
-        { NULL, 4104, "4"},
-        { "ediPartyName", 1610620930, "EDIPartyName"},
-        { NULL, 4104, "5"},
-        { "uniformResourceIdentifier", 1610620930, "IA5String"},
-        { NULL, 4104, "6"},
-        { "iPAddress", 1610620935, NULL },
-        { NULL, 4104, "7"},
-        { "registeredID", 536879116, NULL },
-        { NULL, 4104, "8"},
-        { "AnotherName", 1610612741, NULL },
-        { "type-id", 1073741836, NULL },
-        { "value", 541073421, NULL },
-        { NULL, 1073743880, "0"},
-        { "type-id", 1, NULL },
-        { "EDIPartyName", 1610612741, NULL },
-        { "nameAssigner", 1610637314, "DirectoryString"},
-        { NULL, 4104, "0"},
-        { "partyName", 536879106, "DirectoryString"},
-        { NULL, 4104, "1"},
-        { "id-ce-issuerAltName", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "18"},
-        { "IssuerAltName", 1073741826, "GeneralNames"},
-        { "id-ce-subjectDirectoryAttributes", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "9"},
-        { "SubjectDirectoryAttributes", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "Attribute"},
-        { "id-ce-basicConstraints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "19"},
-        { "BasicConstraints", 1610612741, NULL },
-        { "cA", 1610645508, NULL },
-        { NULL, 131081, NULL },
-        { "pathLenConstraint", 537411587, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-nameConstraints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "30"},
-        { "NameConstraints", 1610612741, NULL },
-        { "permittedSubtrees", 1610637314, "GeneralSubtrees"},
-        { NULL, 4104, "0"},
-        { "excludedSubtrees", 536895490, "GeneralSubtrees"},
-        { NULL, 4104, "1"},
-        { "GeneralSubtrees", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "GeneralSubtree"},
-        { "GeneralSubtree", 1610612741, NULL },
-        { "base", 1073741826, "GeneralName"},
-        { "minimum", 1610653698, "BaseDistance"},
-        { NULL, 1073741833, "0"},
-        { NULL, 4104, "0"},
-        { "maximum", 536895490, "BaseDistance"},
-        { NULL, 4104, "1"},
-        { "BaseDistance", 1611137027, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-policyConstraints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "36"},
-        { "PolicyConstraints", 1610612741, NULL },
-        { "requireExplicitPolicy", 1610637314, "SkipCerts"},
-        { NULL, 4104, "0"},
-        { "inhibitPolicyMapping", 536895490, "SkipCerts"},
-        { NULL, 4104, "1"},
-        { "SkipCerts", 1611137027, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-cRLDistributionPoints", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "31"},
-        { "CRLDistPointsSyntax", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "DistributionPoint"},
-        { "DistributionPoint", 1610612741, NULL },
-        { "distributionPoint", 1610637314, "DistributionPointName"},
-        { NULL, 4104, "0"},
-        { "reasons", 1610637314, "ReasonFlags"},
-        { NULL, 4104, "1"},
-        { "cRLIssuer", 536895490, "GeneralNames"},
-        { NULL, 4104, "2"},
-        { "DistributionPointName", 1610612754, NULL },
-        { "fullName", 1610620930, "GeneralNames"},
-        { NULL, 4104, "0"},
-        { "nameRelativeToCRLIssuer", 536879106, "RelativeDistinguishedName"},
-        { NULL, 4104, "1"},
-        { "ReasonFlags", 1610874886, NULL },
-        { "unused", 1073741825, "0"},
-        { "keyCompromise", 1073741825, "1"},
-        { "cACompromise", 1073741825, "2"},
-        { "affiliationChanged", 1073741825, "3"},
-        { "superseded", 1073741825, "4"},
-        { "cessationOfOperation", 1073741825, "5"},
-        { "certificateHold", 1, "6"},
-        { "id-ce-extKeyUsage", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "37"},
-        { "ExtKeyUsageSyntax", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "KeyPurposeId"},
-        { "KeyPurposeId", 1073741836, NULL },
-        { "id-kp-serverAuth", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "1"},
-        { "id-kp-clientAuth", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "2"},
-        { "id-kp-codeSigning", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "3"},
-        { "id-kp-emailProtection", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "4"},
-        { "id-kp-ipsecEndSystem", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "5"},
-        { "id-kp-ipsecTunnel", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "6"},
-        { "id-kp-ipsecUser", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "7"},
-        { "id-kp-timeStamping", 1879048204, NULL },
-        { NULL, 1073741825, "id-kp"},
-        { NULL, 1, "8"},
-        { "id-pe-authorityInfoAccess", 1879048204, NULL },
-        { NULL, 1073741825, "id-pe"},
-        { NULL, 1, "1"},
-        { "AuthorityInfoAccessSyntax", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "AccessDescription"},
-        { "AccessDescription", 1610612741, NULL },
-        { "accessMethod", 1073741836, NULL },
-        { "accessLocation", 2, "GeneralName"},
-        { "id-ce-cRLNumber", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "20"},
-        { "CRLNumber", 1611137027, NULL },
-        { "0", 10, "MAX"},
-        { "id-ce-issuingDistributionPoint", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "28"},
-        { "IssuingDistributionPoint", 1610612741, NULL },
-        { "distributionPoint", 1610637314, "DistributionPointName"},
-        { NULL, 4104, "0"},
-        { "onlyContainsUserCerts", 1610653700, NULL },
-        { NULL, 1073872905, NULL },
-        { NULL, 4104, "1"},
-        { "onlyContainsCACerts", 1610653700, NULL },
-        { NULL, 1073872905, NULL },
-        { NULL, 4104, "2"},
-        { "onlySomeReasons", 1610637314, "ReasonFlags"},
-        { NULL, 4104, "3"},
-        { "indirectCRL", 536911876, NULL },
-        { NULL, 1073872905, NULL },
-        { NULL, 4104, "4"},
-        { "id-ce-deltaCRLIndicator", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "27"},
-        { "BaseCRLNumber", 1073741826, "CRLNumber"},
-        { "id-ce-cRLReasons", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "21"},
-        { "CRLReason", 1610874901, NULL },
-        { "unspecified", 1073741825, "0"},
-        { "keyCompromise", 1073741825, "1"},
-        { "cACompromise", 1073741825, "2"},
-        { "affiliationChanged", 1073741825, "3"},
-        { "superseded", 1073741825, "4"},
-        { "cessationOfOperation", 1073741825, "5"},
-        { "certificateHold", 1073741825, "6"},
-        { "removeFromCRL", 1, "8"},
-        { "id-ce-certificateIssuer", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "29"},
-        { "CertificateIssuer", 1073741826, "GeneralNames"},
-        { "id-ce-holdInstructionCode", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "23"},
-        { "HoldInstructionCode", 1073741836, NULL },
-        { "holdInstruction", 1879048204, NULL },
-        { "joint-iso-itu-t", 1073741825, "2"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "x9cm", 1073741825, "10040"},
-        { NULL, 1, "2"},
-        { "id-holdinstruction-none", 1879048204, NULL },
-        { NULL, 1073741825, "holdInstruction"},
-        { NULL, 1, "1"},
-        { "id-holdinstruction-callissuer", 1879048204, NULL },
-        { NULL, 1073741825, "holdInstruction"},
-        { NULL, 1, "2"},
-        { "id-holdinstruction-reject", 1879048204, NULL },
-        { NULL, 1073741825, "holdInstruction"},
-        { NULL, 1, "3"},
-        { "id-ce-invalidityDate", 1879048204, NULL },
-        { NULL, 1073741825, "id-ce"},
-        { NULL, 1, "24"},
-        { "InvalidityDate", 1082130449, NULL },
-        { "VisibleString", 1610620935, NULL },
-        { NULL, 4360, "26"},
-        { "NumericString", 1610620935, NULL },
-        { NULL, 4360, "18"},
-        { "IA5String", 1610620935, NULL },
-        { NULL, 4360, "22"},
-        { "TeletexString", 1610620935, NULL },
-        { NULL, 4360, "20"},
-        { "PrintableString", 1610620935, NULL },
-        { NULL, 4360, "19"},
-        { "UniversalString", 1610620935, NULL },
-        { NULL, 4360, "28"},
-        { "BMPString", 1610620935, NULL },
-        { NULL, 4360, "30"},
-        { "UTF8String", 1610620935, NULL },
-        { NULL, 4360, "12"},
-        { "id-pkix", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "identified-organization", 1073741825, "3"},
-        { "dod", 1073741825, "6"},
-        { "internet", 1073741825, "1"},
-        { "security", 1073741825, "5"},
-        { "mechanisms", 1073741825, "5"},
-        { "pkix", 1, "7"},
-        { "id-pe", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "1"},
-        { "id-qt", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "2"},
-        { "id-kp", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "3"},
-        { "id-ad", 1879048204, NULL },
-        { NULL, 1073741825, "id-pkix"},
-        { NULL, 1, "48"},
-        { "id-qt-cps", 1879048204, NULL },
-        { NULL, 1073741825, "id-qt"},
-        { NULL, 1, "1"},
-        { "id-qt-unotice", 1879048204, NULL },
-        { NULL, 1073741825, "id-qt"},
-        { NULL, 1, "2"},
-        { "id-ad-ocsp", 1879048204, NULL },
-        { NULL, 1073741825, "id-ad"},
-        { NULL, 1, "1"},
-        { "id-ad-caIssuers", 1879048204, NULL },
-        { NULL, 1073741825, "id-ad"},
-        { NULL, 1, "2"},
-        { "Attribute", 1610612741, NULL },
-        { "type", 1073741826, "AttributeType"},
-        { "values", 536870927, NULL },
-        { NULL, 2, "AttributeValue"},
-        { "AttributeType", 1073741836, NULL },
-        { "AttributeValue", 1073741837, NULL },
-        { "AttributeTypeAndValue", 1610612741, NULL },
-        { "type", 1073741826, "AttributeType"},
-        { "value", 2, "AttributeValue"},
-        { "id-at", 1879048204, NULL },
-        { "joint-iso-ccitt", 1073741825, "2"},
-        { "ds", 1073741825, "5"},
-        { NULL, 1, "4"},
-        { "id-at-name", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "41"},
-        { "id-at-surname", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "4"},
-        { "id-at-givenName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "42"},
-        { "id-at-initials", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "43"},
-        { "id-at-generationQualifier", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "44"},
-        { "X520name", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-name", 524298, "1"},
-        { "id-at-commonName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "3"},
-        { "X520CommonName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-common-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-common-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-common-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-common-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-common-name", 524298, "1"},
-        { "id-at-localityName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "7"},
-        { "X520LocalityName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-locality-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-locality-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-locality-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-locality-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-locality-name", 524298, "1"},
-        { "id-at-stateOrProvinceName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "8"},
-        { "X520StateOrProvinceName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-state-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-state-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-state-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-state-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-state-name", 524298, "1"},
-        { "id-at-organizationName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "10"},
-        { "X520OrganizationName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-organization-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-organization-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-organization-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-organization-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-organization-name", 524298, "1"},
-        { "id-at-organizationalUnitName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "11"},
-        { "X520OrganizationalUnitName", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-organizational-unit-name", 524298, "1"},
-        { "id-at-title", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "12"},
-        { "X520Title", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "ub-title", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "ub-title", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "ub-title", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "ub-title", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "ub-title", 524298, "1"},
-        { "id-at-dnQualifier", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "46"},
-        { "X520dnQualifier", 1073741826, "PrintableString"},
-        { "id-at-countryName", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "id-at"},
-        { NULL, 1, "6"},
-        { "X520countryName", 1612709890, "PrintableString"},
-        { NULL, 1048586, "2"},
-        { "pkcs-9", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "rsadsi", 1073741825, "113549"},
-        { "pkcs", 1073741825, "1"},
-        { NULL, 1, "9"},
-        { "emailAddress", 1880096780, "AttributeType"},
-        { NULL, 1073741825, "pkcs-9"},
-        { NULL, 1, "1"},
-        { "Pkcs9email", 1612709890, "IA5String"},
-        { "ub-emailaddress-length", 524298, "1"},
-        { "Name", 1610612754, NULL },
-        { "rdnSequence", 2, "RDNSequence"},
-        { "RDNSequence", 1610612747, NULL },
-        { NULL, 2, "RelativeDistinguishedName"},
-        { "DistinguishedName", 1073741826, "RDNSequence"},
-        { "RelativeDistinguishedName", 1612709903, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "AttributeTypeAndValue"},
-        { "DirectoryString", 1610612754, NULL },
-        { "teletexString", 1612709890, "TeletexString"},
-        { "MAX", 524298, "1"},
-        { "printableString", 1612709890, "PrintableString"},
-        { "MAX", 524298, "1"},
-        { "universalString", 1612709890, "UniversalString"},
-        { "MAX", 524298, "1"},
-        { "utf8String", 1612709890, "UTF8String"},
-        { "MAX", 524298, "1"},
-        { "bmpString", 538968066, "BMPString"},
-        { "MAX", 524298, "1"},
-        { "Certificate", 1610612741, NULL },
-        { "tbsCertificate", 1073741826, "TBSCertificate"},
-        { "signatureAlgorithm", 1073741826, "AlgorithmIdentifier"},
-        { "signature", 6, NULL },
-        { "TBSCertificate", 1610612741, NULL },
-        { "version", 1610653698, "Version"},
-        { NULL, 1073741833, "v1"},
-        { NULL, 2056, "0"},
-        { "serialNumber", 1073741826, "CertificateSerialNumber"},
-        { "signature", 1073741826, "AlgorithmIdentifier"},
-        { "issuer", 1073741826, "Name"},
-        { "validity", 1073741826, "Validity"},
-        { "subject", 1073741826, "Name"},
-        { "subjectPublicKeyInfo", 1073741826, "SubjectPublicKeyInfo"},
-        { "issuerUniqueID", 1610637314, "UniqueIdentifier"},
-        { NULL, 4104, "1"},
-        { "subjectUniqueID", 1610637314, "UniqueIdentifier"},
-        { NULL, 4104, "2"},
-        { "extensions", 536895490, "Extensions"},
-        { NULL, 2056, "3"},
-        { "Version", 1610874883, NULL },
-        { "v1", 1073741825, "0"},
-        { "v2", 1073741825, "1"},
-        { "v3", 1, "2"},
-        { "CertificateSerialNumber", 1073741827, NULL },
-        { "Validity", 1610612741, NULL },
-        { "notBefore", 1073741826, "Time"},
-        { "notAfter", 2, "Time"},
-        { "Time", 1610612754, NULL },
-        { "utcTime", 1090519057, NULL },
-        { "generalTime", 8388625, NULL },
-        { "UniqueIdentifier", 1073741830, NULL },
-        { "SubjectPublicKeyInfo", 1610612741, NULL },
-        { "algorithm", 1073741826, "AlgorithmIdentifier"},
-        { "subjectPublicKey", 6, NULL },
-        { "Extensions", 1612709899, NULL },
-        { "MAX", 1074266122, "1"},
-        { NULL, 2, "Extension"},
-        { "Extension", 1610612741, NULL },
-        { "extnID", 1073741836, NULL },
-        { "critical", 1610645508, NULL },
-        { NULL, 131081, NULL },
-        { "extnValue", 7, NULL },
-        { "CertificateList", 1610612741, NULL },
-        { "tbsCertList", 1073741826, "TBSCertList"},
-        { "signatureAlgorithm", 1073741826, "AlgorithmIdentifier"},
-        { "signature", 6, NULL },
-        { "TBSCertList", 1610612741, NULL },
-        { "version", 1073758210, "Version"},
-        { "signature", 1073741826, "AlgorithmIdentifier"},
-        { "issuer", 1073741826, "Name"},
-        { "thisUpdate", 1073741826, "Time"},
-        { "nextUpdate", 1073758210, "Time"},
-        { "revokedCertificates", 1610629131, NULL },
-        { NULL, 536870917, NULL },
-        { "userCertificate", 1073741826, "CertificateSerialNumber"},
-        { "revocationDate", 1073741826, "Time"},
-        { "crlEntryExtensions", 16386, "Extensions"},
-        { "crlExtensions", 536895490, "Extensions"},
-        { NULL, 2056, "0"},
-        { "AlgorithmIdentifier", 1610612741, NULL },
-        { "algorithm", 1073741836, NULL },
-        { "parameters", 541081613, NULL },
-        { "algorithm", 1, NULL },
-        { "pkcs-1", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "rsadsi", 1073741825, "113549"},
-        { "pkcs", 1073741825, "1"},
-        { NULL, 1, "1"},
-        { "rsaEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "1"},
-        { "md2WithRSAEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "2"},
-        { "md5WithRSAEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "4"},
-        { "sha1WithRSAEncryption", 1879048204, NULL },
-        { NULL, 1073741825, "pkcs-1"},
-        { NULL, 1, "5"},
-        { "id-dsa-with-sha1", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "x9-57", 1073741825, "10040"},
-        { "x9algorithm", 1073741825, "4"},
-        { NULL, 1, "3"},
-        { "Dss-Sig-Value", 1610612741, NULL },
-        { "r", 1073741827, NULL },
-        { "s", 3, NULL },
-        { "dhpublicnumber", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "ansi-x942", 1073741825, "10046"},
-        { "number-type", 1073741825, "2"},
-        { NULL, 1, "1"},
-        { "DomainParameters", 1610612741, NULL },
-        { "p", 1073741827, NULL },
-        { "g", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "j", 1073758211, NULL },
-        { "validationParms", 16386, "ValidationParms"},
-        { "ValidationParms", 1610612741, NULL },
-        { "seed", 1073741830, NULL },
-        { "pgenCounter", 3, NULL },
-        { "id-dsa", 1879048204, NULL },
-        { "iso", 1073741825, "1"},
-        { "member-body", 1073741825, "2"},
-        { "us", 1073741825, "840"},
-        { "x9-57", 1073741825, "10040"},
-        { "x9algorithm", 1073741825, "4"},
-        { NULL, 1, "1"},
-        { "Dss-Parms", 1610612741, NULL },
-        { "p", 1073741827, NULL },
-        { "q", 1073741827, NULL },
-        { "g", 3, NULL },
-        { "ORAddress", 1610612741, NULL },
-        { "built-in-standard-attributes", 1073741826, "BuiltInStandardAttributes"},
-        { "built-in-domain-defined-attributes", 1073758210, "BuiltInDomainDefinedAttributes"},
-        { "extension-attributes", 16386, "ExtensionAttributes"},
-        { "BuiltInStandardAttributes", 1610612741, NULL },
-        { "country-name", 1073758210, "CountryName"},
-        { "administration-domain-name", 1073758210, "AdministrationDomainName"},
-        { "network-address", 1610637314, "NetworkAddress"},
-        { NULL, 2056, "0"},
-        { "terminal-identifier", 1610637314, "TerminalIdentifier"},
-        { NULL, 2056, "1"},
-        { "private-domain-name", 1610637314, "PrivateDomainName"},
-        { NULL, 2056, "2"},
-        { "organization-name", 1610637314, "OrganizationName"},
-        { NULL, 2056, "3"},
-        { "numeric-user-identifier", 1610637314, "NumericUserIdentifier"},
-        { NULL, 2056, "4"},
-        { "personal-name", 1610637314, "PersonalName"},
-        { NULL, 2056, "5"},
-        { "organizational-unit-names", 536895490, "OrganizationalUnitNames"},
-        { NULL, 2056, "6"},
-        { "CountryName", 1610620946, NULL },
-        { NULL, 1073746952, "1"},
-        { "x121-dcc-code", 1612709890, "NumericString"},
-        { NULL, 1048586, "ub-country-name-numeric-length"},
-        { "iso-3166-alpha2-code", 538968066, "PrintableString"},
-        { NULL, 1048586, "ub-country-name-alpha-length"},
-        { "AdministrationDomainName", 1610620946, NULL },
-        { NULL, 1073744904, "2"},
-        { "numeric", 1612709890, "NumericString"},
-        { "ub-domain-name-length", 524298, "0"},
-        { "printable", 538968066, "PrintableString"},
-        { "ub-domain-name-length", 524298, "0"},
-        { "NetworkAddress", 1073741826, "X121Address"},
-        { "X121Address", 1612709890, "NumericString"},
-        { "ub-x121-address-length", 524298, "1"},
-        { "TerminalIdentifier", 1612709890, "PrintableString"},
-        { "ub-terminal-id-length", 524298, "1"},
-        { "PrivateDomainName", 1610612754, NULL },
-        { "numeric", 1612709890, "NumericString"},
-        { "ub-domain-name-length", 524298, "1"},
-        { "printable", 538968066, "PrintableString"},
-        { "ub-domain-name-length", 524298, "1"},
-        { "OrganizationName", 1612709890, "PrintableString"},
-        { "ub-organization-name-length", 524298, "1"},
-        { "NumericUserIdentifier", 1612709890, "NumericString"},
-        { "ub-numeric-user-id-length", 524298, "1"},
-        { "PersonalName", 1610612750, NULL },
-        { "surname", 1814044674, "PrintableString"},
-        { NULL, 1073745928, "0"},
-        { "ub-surname-length", 524298, "1"},
-        { "given-name", 1814061058, "PrintableString"},
-        { NULL, 1073745928, "1"},
-        { "ub-given-name-length", 524298, "1"},
-        { "initials", 1814061058, "PrintableString"},
-        { NULL, 1073745928, "2"},
-        { "ub-initials-length", 524298, "1"},
-        { "generation-qualifier", 740319234, "PrintableString"},
-        { NULL, 1073745928, "3"},
-        { "ub-generation-qualifier-length", 524298, "1"},
-        { "OrganizationalUnitNames", 1612709899, NULL },
-        { "ub-organizational-units", 1074266122, "1"},
-        { NULL, 2, "OrganizationalUnitName"},
-        { "OrganizationalUnitName", 1612709890, "PrintableString"},
-        { "ub-organizational-unit-name-length", 524298, "1"},
-        { "BuiltInDomainDefinedAttributes", 1612709899, NULL },
-        { "ub-domain-defined-attributes", 1074266122, "1"},
-        { NULL, 2, "BuiltInDomainDefinedAttribute"},
-        { "BuiltInDomainDefinedAttribute", 1610612741, NULL },
-        { "type", 1612709890, "PrintableString"},
-        { "ub-domain-defined-attribute-type-length", 524298, "1"},
-        { "value", 538968066, "PrintableString"},
-        { "ub-domain-defined-attribute-value-length", 524298, "1"},
-        { "ExtensionAttributes", 1612709903, NULL },
-        { "ub-extension-attributes", 1074266122, "1"},
-        { NULL, 2, "ExtensionAttribute"},
-        { "ExtensionAttribute", 1610612741, NULL },
-        { "extension-attribute-type", 1611145219, NULL },
-        { NULL, 1073743880, "0"},
-        { "0", 10, "ub-extension-attributes"},
-        { "extension-attribute-value", 541073421, NULL },
-        { NULL, 1073743880, "1"},
-        { "extension-attribute-type", 1, NULL },
-        { "common-name", 1342177283, "1"},
-        { "CommonName", 1612709890, "PrintableString"},
-        { "ub-common-name-length", 524298, "1"},
-        { "teletex-common-name", 1342177283, "2"},
-        { "TeletexCommonName", 1612709890, "TeletexString"},
-        { "ub-common-name-length", 524298, "1"},
-        { "teletex-organization-name", 1342177283, "3"},
-        { "TeletexOrganizationName", 1612709890, "TeletexString"},
-        { "ub-organization-name-length", 524298, "1"},
-        { "teletex-personal-name", 1342177283, "4"},
-        { "TeletexPersonalName", 1610612750, NULL },
-        { "surname", 1814044674, "TeletexString"},
-        { NULL, 1073743880, "0"},
-        { "ub-surname-length", 524298, "1"},
-        { "given-name", 1814061058, "TeletexString"},
-        { NULL, 1073743880, "1"},
-        { "ub-given-name-length", 524298, "1"},
-        { "initials", 1814061058, "TeletexString"},
-        { NULL, 1073743880, "2"},
-        { "ub-initials-length", 524298, "1"},
-        { "generation-qualifier", 740319234, "TeletexString"},
-        { NULL, 1073743880, "3"},
-        { "ub-generation-qualifier-length", 524298, "1"},
-        { "teletex-organizational-unit-names", 1342177283, "5"},
-        { "TeletexOrganizationalUnitNames", 1612709899, NULL },
-        { "ub-organizational-units", 1074266122, "1"},
-        { NULL, 2, "TeletexOrganizationalUnitName"},
-        { "TeletexOrganizationalUnitName", 1612709890, "TeletexString"},
-        { "ub-organizational-unit-name-length", 524298, "1"},
-        { "pds-name", 1342177283, "7"},
-        { "PDSName", 1612709890, "PrintableString"},
-        { "ub-pds-name-length", 524298, "1"},
-        { "physical-delivery-country-name", 1342177283, "8"},
-        { "PhysicalDeliveryCountryName", 1610612754, NULL },
-        { "x121-dcc-code", 1612709890, "NumericString"},
-        { NULL, 1048586, "ub-country-name-numeric-length"},
-        { "iso-3166-alpha2-code", 538968066, "PrintableString"},
-        { NULL, 1048586, "ub-country-name-alpha-length"},
-        { "postal-code", 1342177283, "9"},
-        { "PostalCode", 1610612754, NULL },
-        { "numeric-code", 1612709890, "NumericString"},
-        { "ub-postal-code-length", 524298, "1"},
-        { "printable-code", 538968066, "PrintableString"},
-        { "ub-postal-code-length", 524298, "1"},
-        { "physical-delivery-office-name", 1342177283, "10"},
-        { "PhysicalDeliveryOfficeName", 1073741826, "PDSParameter"},
-        { "physical-delivery-office-number", 1342177283, "11"},
-        { "PhysicalDeliveryOfficeNumber", 1073741826, "PDSParameter"},
-        { "extension-OR-address-components", 1342177283, "12"},
-        { "ExtensionORAddressComponents", 1073741826, "PDSParameter"},
-        { "physical-delivery-personal-name", 1342177283, "13"},
-        { "PhysicalDeliveryPersonalName", 1073741826, "PDSParameter"},
-        { "physical-delivery-organization-name", 1342177283, "14"},
-        { "PhysicalDeliveryOrganizationName", 1073741826, "PDSParameter"},
-        { "extension-physical-delivery-address-components", 1342177283, "15"},
-        { "ExtensionPhysicalDeliveryAddressComponents", 1073741826, "PDSParameter"},
-        { "unformatted-postal-address", 1342177283, "16"},
-        { "UnformattedPostalAddress", 1610612750, NULL },
-        { "printable-address", 1814052875, NULL },
-        { "ub-pds-physical-address-lines", 1074266122, "1"},
-        { NULL, 538968066, "PrintableString"},
-        { "ub-pds-parameter-length", 524298, "1"},
-        { "teletex-string", 740311042, "TeletexString"},
-        { "ub-unformatted-address-length", 524298, "1"},
-        { "street-address", 1342177283, "17"},
-        { "StreetAddress", 1073741826, "PDSParameter"},
-        { "post-office-box-address", 1342177283, "18"},
-        { "PostOfficeBoxAddress", 1073741826, "PDSParameter"},
-        { "poste-restante-address", 1342177283, "19"},
-        { "PosteRestanteAddress", 1073741826, "PDSParameter"},
-        { "unique-postal-name", 1342177283, "20"},
-        { "UniquePostalName", 1073741826, "PDSParameter"},
-        { "local-postal-attributes", 1342177283, "21"},
-        { "LocalPostalAttributes", 1073741826, "PDSParameter"},
-        { "PDSParameter", 1610612750, NULL },
-        { "printable-string", 1814052866, "PrintableString"},
-        { "ub-pds-parameter-length", 524298, "1"},
-        { "teletex-string", 740311042, "TeletexString"},
-        { "ub-pds-parameter-length", 524298, "1"},
-        { "extended-network-address", 1342177283, "22"},
-        { "ExtendedNetworkAddress", 1610612754, NULL },
-        { "e163-4-address", 1610612741, NULL },
-        { "number", 1612718082, "NumericString"},
-        { NULL, 1073743880, "0"},
-        { "ub-e163-4-number-length", 524298, "1"},
-        { "sub-address", 538992642, "NumericString"},
-        { NULL, 1073743880, "1"},
-        { "ub-e163-4-sub-address-length", 524298, "1"},
-        { "psap-address", 536879106, "PresentationAddress"},
-        { NULL, 2056, "0"},
-        { "PresentationAddress", 1610612741, NULL },
-        { "pSelector", 1610637319, NULL },
-        { NULL, 2056, "0"},
-        { "sSelector", 1610637319, NULL },
-        { NULL, 2056, "1"},
-        { "tSelector", 1610637319, NULL },
-        { NULL, 2056, "2"},
-        { "nAddresses", 538976271, NULL },
-        { NULL, 1073743880, "3"},
-        { "MAX", 1074266122, "1"},
-        { NULL, 7, NULL },
-        { "terminal-type", 1342177283, "23"},
-        { "TerminalType", 1611137027, NULL },
-        { "0", 10, "ub-integer-options"},
-        { "teletex-domain-defined-attributes", 1342177283, "6"},
-        { "TeletexDomainDefinedAttributes", 1612709899, NULL },
-        { "ub-domain-defined-attributes", 1074266122, "1"},
-        { NULL, 2, "TeletexDomainDefinedAttribute"},
-        { "TeletexDomainDefinedAttribute", 1610612741, NULL },
-        { "type", 1612709890, "TeletexString"},
-        { "ub-domain-defined-attribute-type-length", 524298, "1"},
-        { "value", 538968066, "TeletexString"},
-        { "ub-domain-defined-attribute-value-length", 524298, "1"},
-        { "ub-name", 1342177283, "32768"},
-        { "ub-common-name", 1342177283, "64"},
-        { "ub-locality-name", 1342177283, "128"},
-        { "ub-state-name", 1342177283, "128"},
-        { "ub-organization-name", 1342177283, "64"},
-        { "ub-organizational-unit-name", 1342177283, "64"},
-        { "ub-title", 1342177283, "64"},
-        { "ub-match", 1342177283, "128"},
-        { "ub-emailaddress-length", 1342177283, "128"},
-        { "ub-common-name-length", 1342177283, "64"},
-        { "ub-country-name-alpha-length", 1342177283, "2"},
-        { "ub-country-name-numeric-length", 1342177283, "3"},
-        { "ub-domain-defined-attributes", 1342177283, "4"},
-        { "ub-domain-defined-attribute-type-length", 1342177283, "8"},
-        { "ub-domain-defined-attribute-value-length", 1342177283, "128"},
-        { "ub-domain-name-length", 1342177283, "16"},
-        { "ub-extension-attributes", 1342177283, "256"},
-        { "ub-e163-4-number-length", 1342177283, "15"},
-        { "ub-e163-4-sub-address-length", 1342177283, "40"},
-        { "ub-generation-qualifier-length", 1342177283, "3"},
-        { "ub-given-name-length", 1342177283, "16"},
-        { "ub-initials-length", 1342177283, "5"},
-        { "ub-integer-options", 1342177283, "256"},
-        { "ub-numeric-user-id-length", 1342177283, "32"},
-        { "ub-organization-name-length", 1342177283, "64"},
-        { "ub-organizational-unit-name-length", 1342177283, "32"},
-        { "ub-organizational-units", 1342177283, "4"},
-        { "ub-pds-name-length", 1342177283, "16"},
-        { "ub-pds-parameter-length", 1342177283, "30"},
-        { "ub-pds-physical-address-lines", 1342177283, "6"},
-        { "ub-postal-code-length", 1342177283, "16"},
-        { "ub-surname-length", 1342177283, "40"},
-        { "ub-terminal-id-length", 1342177283, "24"},
-        { "ub-unformatted-address-length", 1342177283, "180"},
-        { "ub-x121-address-length", 268435459, "16"},
-        { NULL, 0, NULL }
-    };
-    
-    /* Base64 PEM certificate decoding (in DER) */
-    byte *certificatDer = 0;
-    int sizeCert = pemToAsn(cert, certLen, &certificatDer);
-    if (sizeCert < 0) {
-        
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Error Base 64\n");
-        printf("### encryptWithPK() End ###\n\n");
-        #endif
-        
-        /* return error */
-        return sizeCert;
-        
-    }
-    
-    /* Certificate structure creation */
-    ASN1_TYPE certDef = ASN1_TYPE_EMPTY;
-    char errorDescription[ASN1_MAX_ERROR_DESCRIPTION_SIZE];
-    int result = asn1_array2tree(structCertificat, &certDef, errorDescription);
-    if (result != ASN1_SUCCESS) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Problems creating structure asn1_array2tree\n");
-        int i = 0;
-        for (i = 0; i < ASN1_MAX_ERROR_DESCRIPTION_SIZE; i++) {
-            printf("%c", errorDescription[i]);
-        }
-        printf("\n");
-        #endif
-        
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        asn1_delete_structure(&certDef);
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### encryptWithPK() End ###\n\n");
-        #endif
-        
-        return GLS_ERROR_ASN1;
-        
-    }
-    
-    /* DER certificate parsing */
-    ASN1_TYPE certificat = ASN1_TYPE_EMPTY;
-    asn1_create_element(certDef, "PKIX1Implicit88.Certificate", &certificat);
-    result = asn1_der_decoding(&certificat, certificatDer, sizeCert, errorDescription);
-    if (result != ASN1_SUCCESS) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Problems with DER encoding\n");
-        int i = 0;
-        for (i = 0; i < ASN1_MAX_ERROR_DESCRIPTION_SIZE; i++) {
-            
-            printf("%c", errorDescription[i]);
-            
-        }
-        printf("\n");
-        #endif
-        
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### encryptWithPK() End ###\n\n");
-        #endif
-        
-        return GLS_ERROR_ASN1;
-        
-    }
-    
-    /*
-     * From here we have :
-     * certificat = The certificate used to encrypt
-     * certDef = X.509 certificate definition
-     */
-    
-    /* Get the DER certificate public key */
-    int lenPubKeyDer = 2048;
-    byte pubKeyDer[2048];
-    result = asn1_read_value(certificat, "tbsCertificate.subjectPublicKeyInfo.subjectPublicKey", pubKeyDer, &lenPubKeyDer);
-    
-    /* Check for error */
-    if (result != ASN1_SUCCESS) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Impossible to extract key from Certificate\n");
-        #endif
-        
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### encryptWithPK() End ###\n\n");
-        #endif
-        
-        return GLS_ERROR_ASN1;
-        
-    }
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Public key encryption of one round with the key given by
+ getPublicKeyFromCert(). Return the cipherText size or a
+ negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int _encryptWithPK(gcry_sexp_t publicKey, const byte* plainText, const int sizePlainText, byte** cypherText) {
     
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### encryptWithPK() Start ###\n");
+    #endif
     
-    /* Public key convertion from DER to bytes */
-    gcry_sexp_t gcryPubKey = 0;
-    int error = getPublicRsaFromDer(pubKeyDer, lenPubKeyDer, &gcryPubKey);
-    if (error < 0) {
+    /* argument check */
+    if (sizePlainText <= 0 || plainText == NULL) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Impossible to convert DER public key to byte\n");
+        if (plainText == NULL) printf("Plaintext == NULL\n");
+        if (sizePlainText <= 0) printf("sizePlainText <= 0\n");
+        printf("No Message to encrypt\n");
+        printf("### encryptWithPK() End ###\n\n");
         #endif
-        
-        /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if(gcryPubKey != NULL){
-            gcry_sexp_release(gcryPubKey);
-            gcryPubKey = 0;
-        }
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
+
+        return GLS_ERROR_NOMESSAGE;
+    
+    }
+    if (publicKey == NULL) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No public key\n");
         printf("### encryptWithPK() End ###\n\n");
         #endif
         
-        return error;
+        return GLS_ERROR_NOCERT;
         
     }
     
@@ -2481,7 +2002,7 @@ int _encryptWithPK(const byte *cert, const int certLen, const byte* plainText, c
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
     char keyBuffer[2048];
-    int sizePubKey = (int) gcry_sexp_sprint(gcryPubKey, GCRYSEXP_FMT_ADVANCED, keyBuffer, 2048);
+    int sizePubKey = (int) gcry_sexp_sprint(publicKey, GCRYSEXP_FMT_ADVANCED, keyBuffer, 2048);
     printf("Public Key : ");
     for (i = 0; i < sizePubKey; i++) {
         printf("%c", keyBuffer[i]);
@@ -2491,7 +2012,7 @@ int _encryptWithPK(const byte *cert, const int certLen, const byte* plainText, c
     
     /* Creating S-Exp for gcrypt */
     gcry_sexp_t gcryPlainText = 0;
-    error = gcry_sexp_build(&gcryPlainText, NULL, "(data(flags oaep)(value %b))", sizePlainText, plainText);
+    int error = gcry_sexp_build(&gcryPlainText, NULL, "(data(flags oaep)(value %b))", sizePlainText, plainText);
     if (error != 0) {
         
         /* Debug Only */
@@ -2500,17 +2021,7 @@ int _encryptWithPK(const byte *cert, const int certLen, const byte* plainText, c
         #endif
         
         /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if(gcryPubKey != 0){
-            gcry_sexp_release(gcryPubKey);
-            gcryPubKey = 0;
-        }
         gcry_sexp_release(gcryPlainText);
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -2534,7 +2045,7 @@ int _encryptWithPK(const byte *cert, const int certLen, const byte* plainText, c
     
     /* Buffer encryption */
     gcry_sexp_t gcryCipherText = 0;
-    error = gcry_pk_encrypt(&gcryCipherText, gcryPlainText, gcryPubKey);
+    error = gcry_pk_encrypt(&gcryCipherText, gcryPlainText, publicKey);
     if (error != 0) {
         
         /* Debug Only */
@@ -2545,18 +2056,8 @@ int _encryptWithPK(const byte *cert, const int certLen, const byte* plainText, c
         #endif
         
         /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if(gcryPubKey != 0){
-            gcry_sexp_release(gcryPubKey);
-            gcryPubKey = 0;
-        }
         gcry_sexp_release(gcryPlainText);
         gcry_sexp_release(gcryCipherText);
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -2593,22 +2094,12 @@ int _encryptWithPK(const byte *cert, const int certLen, const byte* plainText, c
         #endif
         
         /* Free memory */
-        if (certificatDer != NULL) {
-            free(certificatDer);
-            certificatDer = 0;
-        }
-        if(gcryPubKey != 0){
-            gcry_sexp_release(gcryPubKey);
-            gcryPubKey = 0;
-        }
         if ((*cypherText) != NULL) {
             free(*cypherText);
             *cypherText = 0;
         }
         gcry_sexp_release(gcryPlainText);
         gcry_sexp_release(gcryCipherText);
-        asn1_delete_structure(&certDef);
-        asn1_delete_structure(&certificat);
         gcry_sexp_release(valueTemp);
         gcry_sexp_release(valueTemp2);
         
@@ -2642,16 +2133,6 @@ int _encryptWithPK(const byte *cert, const int certLen, const byte* plainText, c
     #endif
     
     /* Free memory */
-    if (certificatDer != NULL) {
-        free(certificatDer);
-        certificatDer = 0;
-    }
-    if(gcryPubKey != 0){
-        gcry_sexp_release(gcryPubKey);
-        gcryPubKey = 0;
-    }
-    asn1_delete_structure(&certDef);
-    asn1_delete_structure(&certificat);
     gcry_sexp_release(gcryPlainText);
     gcry_sexp_release(gcryCipherText);
     gcry_sexp_release(valueTemp);
@@ -2683,115 +2164,77 @@ int decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeCi
     /* argument check */
     if (sizeCipherText <= 0 || cipherText == NULL) return GLS_ERROR_NOMESSAGE;
     
-    /* Getting Key Size in bits */
-    int keySize = getModulusSize(myGLSSocket->m_publicCert, myGLSSocket->m_publicCertSize);
-    if (keySize < 0) return keySize;
+    /* Key Size in bits, read once with the server certificate */
+    if (myGLSSocket->m_serverCert == NULL) return GLS_ERROR_NOCERT;
+    int keySize = myGLSSocket->m_serverCert->m_modulusSize;
     
     /* if the message can be decrypt with one round of PK decryption */
     if ((keySize / 8) > sizeCipherText) {
         
-        return _decryptWithPK(myGLSSocket, cipherText, sizeCipherText, plainText);
+        return _decryptWithPK(myGLSSocket, cipherText, sizeCipherText, plainText, 0);
         
     }
     else {
         
-        /* number of rounds to do */
+        /* number of rounds to do, one task of the worker pool each */
         int nbTour = sizeCipherText / (keySize / 8);
         
-        byte *tempPlainText = 0;
-        int sizeTempPlainText = 0;
+        GLSPkJob job;
+        job.m_socket = myGLSSocket;
+        job.m_cipherText = cipherText;
+        job.m_sizeBlock = keySize / 8;
+        job.m_plain = calloc(nbTour, sizeof(byte*));
+        job.m_sizePlain = calloc(nbTour, sizeof(int));
+        if (job.m_plain == NULL || job.m_sizePlain == NULL) {
+            
+            if (job.m_plain != NULL) free(job.m_plain);
+            if (job.m_sizePlain != NULL) free(job.m_sizePlain);
+            return GLS_ERROR_NOMEM;
+            
+        }
+        
+        runParallel(pkChunk, &job, nbTour);
         
+        /* Error of a round or total size */
+        int sizeTempPlainText = 0;
         int i = 0;
         for (i = 0; i < nbTour; i++) {
             
-            /* size of the block to copy */
-            int sizeBlock = (keySize / 8);
-            
-            byte *memtemp = malloc(sizeBlock);
-            if (memtemp == NULL) return GLS_ERROR_NOMEM;
-            
-            /* copy of the block to decrypt */
-            int y = 0;
-            for (y = 0; y < sizeBlock; y++) {
+            if (job.m_sizePlain[i] < 0) {
                 
-                memtemp[y] = cipherText[(sizeBlock * i) + y];
+                sizeTempPlainText = job.m_sizePlain[i];
+                break;
                 
             }
+            sizeTempPlainText += job.m_sizePlain[i];
             
-            /* decryption */
-            byte* plain = 0;
-            int sizePlain = _decryptWithPK(myGLSSocket, memtemp, sizeBlock, &plain);
-            if (sizePlain < 0) {
-                
-                /* Free memory */
-                if (memtemp != NULL) {
-                    free(memtemp);
-                    memtemp = 0;
-                }
-                if (plain != NULL) {
-                    free(plain);
-                    plain = 0;
-                }
-                
-                return sizePlain;
-                
-            }
+        }
+        
+        /* Rounds put together in order */
+        byte *tempPlainText = 0;
+        if (sizeTempPlainText > 0) {
             
-            /* adding plain to temp memory */
-            byte *temp = 0;
-            temp = malloc(sizeTempPlainText + sizePlain);
-            if (temp == NULL) {
-                
-                /* Free memory */
-                if (memtemp != NULL) {
-                    free(memtemp);
-                    memtemp = 0;
-                }
-                if (plain != NULL) {
-                    free(plain);
-                    plain = 0;
-                }
-                
-                return GLS_ERROR_NOMEM;
-                
-            }
-            /* copy of old memory */
-            for (y = 0; y < sizeTempPlainText; y++) {
-                
-                temp[y] = tempPlainText[y];
-                
-            }
-            /* copy of new memory */
-            for (y = 0; y < sizePlain; y++) {
-                
-                temp[sizeTempPlainText + y] = plain[y];
-                
-            }
+            tempPlainText = malloc(sizeTempPlainText);
+            if (tempPlainText == NULL) sizeTempPlainText = GLS_ERROR_NOMEM;
             
-            /* increment size */
-            sizeTempPlainText += sizePlain;
+        }
+        
+        int position = 0;
+        for (i = 0; i < nbTour; i++) {
             
-            /* free old memory */
             if (tempPlainText != NULL) {
-                free(tempPlainText);
-                tempPlainText = 0;
-            }
-            
-            /* swap temp to tempCipherText */
-            tempPlainText = temp;
-            temp = 0;
-            
-            /* free memory */
-            if (memtemp != NULL) {
-                free(memtemp);
-                memtemp = 0;
-            }
-            if (plain != NULL) {
-                free(plain);
-                plain = 0;
+                
+                memcpy(tempPlainText + position, job.m_plain[i], job.m_sizePlain[i]);
+                position += job.m_sizePlain[i];
+                
             }
+            if (job.m_plain[i] != NULL) free(job.m_plain[i]);
             
         }
+        free(job.m_plain);
+        free(job.m_sizePlain);
+        
+        if (sizeTempPlainText < 0) return sizeTempPlainText;
         
         (*plainText) = tempPlainText;
         
@@ -2808,12 +2251,34 @@ int decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeCi
  
  PRIVATE
  
- Private Key decryption, return the plainText size or a 
- negative number for an error.
+ Task of the worker pool for decryptWithPK(), one round
+ of private key decryption. The private key of the shared
+ server certificate is only read.
+ 
+ ---------------------------------------------------------*/
+
+void pkChunk(void* arg, const int index) {
+    
+    GLSPkJob* job = (GLSPkJob*) arg;
+    
+    job->m_sizePlain[index] = _decryptWithPK(job->m_socket, job->m_cipherText + job->m_sizeBlock * index, job->m_sizeBlock, &job->m_plain[index], 0);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Private Key decryption, with isSecure = 1 the plainText
+ is a key put in secure memory (freeSecure() with its size).
+ Return the plainText size or a negative number for an error.
  
  ---------------------------------------------------------*/
 
-int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeCipherText, byte** plainText) {
+int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeCipherText, byte** plainText, const int isSecure) {
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -2824,7 +2289,7 @@ int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeC
     if (sizeCipherText <= 0 || cipherText == NULL) return GLS_ERROR_NOMESSAGE;
     
     /* Check if private key is set */
-    if (myGLSSocket->m_privateKey == NULL) {
+    if (myGLSSocket->m_serverCert == NULL || myGLSSocket->m_serverCert->m_privateKey == NULL) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -2836,56 +2301,9 @@ int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeC
         
     }
     
-    /* Base64 PEM certificate decoding (to DER) */
-    byte *privateKeyDer = 0;
-    int sizePriv = pemToAsn(myGLSSocket->m_privateKey, myGLSSocket->m_privateKeySize, &privateKeyDer);
-    if (sizePriv < 0) {
-        
-        /* Free memory */
-        if (privateKeyDer != NULL) {
-            free(privateKeyDer);
-            privateKeyDer = 0;
-        }
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Error Base 64\n");
-        printf("### decryptWithPK() End ###\n\n");
-        #endif
-        
-        /* Return error */
-        return sizePriv;
-        
-    }
-    
-    /* DER Private key convertion to bytes */
-    gcry_sexp_t gcryPrivKey = 0;
-    int error = getPrivateRsaFromDer(privateKeyDer, sizePriv, &gcryPrivKey);
-    if (error < 0) {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Impossible to convert DER private key to byte\n");
-        #endif
-        
-        /* Free memory */
-        if (privateKeyDer != NULL) {
-            free(privateKeyDer);
-            privateKeyDer = 0;
-        }
-        if(gcryPrivKey != NULL){
-            gcry_sexp_release(gcryPrivKey);
-            gcryPrivKey = 0;
-        }
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### decryptWithPK() End ###\n\n");
-        #endif
-        
-        return error;
-        
-    }
+    /* Private key parsed once for all the clients of the server */
+    gcry_sexp_t gcryPrivKey = myGLSSocket->m_serverCert->m_privateKey;
+    int error = 0;
     
     int i = 0;
     /* Debug Only */
@@ -2915,14 +2333,6 @@ int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeC
         #endif
         
         /* Free memory */
-        if (privateKeyDer != NULL) {
-            free(privateKeyDer);
-            privateKeyDer = 0;
-        }
-        if(gcryPrivKey != NULL){
-            gcry_sexp_release(gcryPrivKey);
-            gcryPrivKey = 0;
-        }
         gcry_sexp_release(gcryCipherText);
         
         /* Debug Only */
@@ -2947,14 +2357,6 @@ int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeC
         #endif
         
         /* Free memory */
-        if (privateKeyDer != NULL) {
-            free(privateKeyDer);
-            privateKeyDer = 0;
-        }
-        if(gcryPrivKey != NULL){
-            gcry_sexp_release(gcryPrivKey);
-            gcryPrivKey = 0;
-        }
         gcry_sexp_release(gcryPlainText);
         gcry_sexp_release(gcryCipherText);
         
@@ -2970,7 +2372,8 @@ int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeC
     /* Plaintext extraction */
     size_t valueSize = 0;
     const char *value = gcry_sexp_nth_data(gcryPlainText, 1, &valueSize);
-    (*plainText) = malloc(valueSize);
+    if (isSecure == 1) (*plainText) = mallocSecure(valueSize);
+    else (*plainText) = malloc(valueSize);
     if ((*plainText) == NULL || value == NULL) {
         
         /* Debug Only */
@@ -2979,16 +2382,9 @@ int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeC
         #endif
         
         /* Free memory */
-        if (privateKeyDer != NULL) {
-            free(privateKeyDer);
-            privateKeyDer = 0;
-        }
-        if(gcryPrivKey != NULL){
-            gcry_sexp_release(gcryPrivKey);
-            gcryPrivKey = 0;
-        }
         if((*plainText) != NULL){
-            free(*plainText);
+            if (isSecure == 1) freeSecure(*plainText, valueSize);
+            else free(*plainText);
             (*plainText) = 0;
         }
         gcry_sexp_release(gcryPlainText);
@@ -3026,14 +2422,6 @@ int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeC
     #endif
     
     /* Free memory */
-    if (privateKeyDer != NULL) {
-        free(privateKeyDer);
-        privateKeyDer = 0;
-    }
-    if(gcryPrivKey != NULL){
-        gcry_sexp_release(gcryPrivKey);
-        gcryPrivKey = 0;
-    }
     gcry_sexp_release(gcryPlainText);
     gcry_sexp_release(gcryCipherText);
     
@@ -3048,3 +2436,225 @@ int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeC
 
 
 
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Register message encryption (GLS/1.2). Only a random
+ session key (key1 + key2) is encrypted with the public
+ key of the certificate, the message is encrypted with
+ the session key like the first message of a connexion :
+ 
+ RSA-OAEP(key1 + key2) + ECB(IV1) + ECB(IV2) + CTS(MAC + IV3 + IV4 + Data)
+ 
+ The RSA part is padded to the size of the modulus. The
+ keys of the socket are restored at the end.
+ 
+ Return the cypherText size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int encryptWithKem(GLSSock* myGLSSocket, const byte *cert, const int certLen, const byte* plainText, const int sizePlainText, byte** cypherText) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### encryptWithKem() Start ###\n");
+    #endif
+    
+    /* argument check */
+    if (sizePlainText <= 0 || plainText == NULL) return GLS_ERROR_NOMESSAGE;
+    if (certLen <= 0 || cert == NULL) return GLS_ERROR_NOCERT;
+    
+    /* Public key and its size in bits */
+    gcry_sexp_t publicKey = 0;
+    int keySize = getPublicKeyFromCert(cert, certLen, &publicKey);
+    if (keySize < 0) return keySize;
+    int sizeRsa = keySize / 8;
+    
+    /* Session key and copy of the keys of the socket in secure memory */
+    byte *sessionKey = mallocSecure(GLS_SIZE_REGISTER_KEY);
+    byte *savedKey = mallocSecure(GLS_SIZE_REGISTER_KEY);
+    if (sessionKey == NULL || savedKey == NULL) {
+        
+        /* Free memory */
+        freeSecure(sessionKey, GLS_SIZE_REGISTER_KEY);
+        freeSecure(savedKey, GLS_SIZE_REGISTER_KEY);
+        gcry_sexp_release(publicKey);
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No secure memory\n");
+        printf("### encryptWithKem() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    gcry_randomize(sessionKey, GLS_SIZE_REGISTER_KEY, GCRY_STRONG_RANDOM);
+    memcpy(savedKey, myGLSSocket->m_key1, 32);
+    memcpy(savedKey + 32, myGLSSocket->m_key2, 32);
+    int isCryptoKey = myGLSSocket->m_isCryptoKey;
+    
+    /* Only the session key is encrypted with the public key */
+    byte *rsaKey = 0;
+    int sizeRsaKey = _encryptWithPK(publicKey, sessionKey, GLS_SIZE_REGISTER_KEY, &rsaKey);
+    gcry_sexp_release(publicKey);
+    
+    /* One allocation, the message is encrypted in place after the RSA part */
+    byte *buffer = 0;
+    int error = sizeRsaKey;
+    if (sizeRsaKey > 0 && sizeRsaKey <= sizeRsa) {
+        
+        buffer = malloc(sizeRsa + GLS_SIZE_HEADROOM + sizePlainText);
+        if (buffer == NULL) error = GLS_ERROR_NOMEM;
+        
+    }
+    else if (sizeRsaKey > sizeRsa) error = GLS_ERROR_CRYPTO;
+    
+    if (buffer != NULL) {
+        
+        /* RSA part with the leading zeros removed by the MPI */
+        memset(buffer, 0, sizeRsa - sizeRsaKey);
+        memcpy(buffer + sizeRsa - sizeRsaKey, rsaKey, sizeRsaKey);
+        memcpy(buffer + sizeRsa + GLS_SIZE_HEADROOM, plainText, sizePlainText);
+        
+        /* The session key replaces the keys of the socket for one message */
+        memcpy(myGLSSocket->m_key1, sessionKey, 32);
+        memcpy(myGLSSocket->m_key2, sessionKey + 32, 32);
+        myGLSSocket->m_isCryptoKey = 1;
+        
+        error = initHandler(myGLSSocket);
+        if (error == 0) error = firstEncryptInPlace(myGLSSocket, buffer + sizeRsa, sizePlainText);
+        
+        /* Keys of the socket restored */
+        memcpy(myGLSSocket->m_key1, savedKey, 32);
+        memcpy(myGLSSocket->m_key2, savedKey + 32, 32);
+        myGLSSocket->m_isCryptoKey = isCryptoKey;
+        if (isCryptoKey == 1) initHandler(myGLSSocket);
+        
+    }
+    
+    /* Wipe and free memory */
+    freeSecure(sessionKey, GLS_SIZE_REGISTER_KEY);
+    freeSecure(savedKey, GLS_SIZE_REGISTER_KEY);
+    if (rsaKey != NULL) {
+        free(rsaKey);
+        rsaKey = 0;
+    }
+    
+    if (error < 0) {
+        
+        if (buffer != NULL) {
+            free(buffer);
+            buffer = 0;
+        }
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Register encryption error : %d\n", error);
+        printf("### encryptWithKem() End ###\n\n");
+        #endif
+        
+        return error;
+        
+    }
+    
+    (*cypherText) = buffer;
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### encryptWithKem() End ###\n\n");
+    #endif
+    
+    return sizeRsa + error;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Register message decryption (GLS/1.2), one private key
+ operation for the session key whatever the size of the
+ message. The socket keeps no key after it.
+ 
+ Return the plainText size or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int decryptWithKem(GLSSock* myGLSSocket, const byte* cipherText, const int sizeCipherText, byte** plainText) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### decryptWithKem() Start ###\n");
+    #endif
+    
+    /* argument check */
+    if (sizeCipherText <= 0 || cipherText == NULL) return GLS_ERROR_NOMESSAGE;
+    if (myGLSSocket->m_serverCert == NULL) return GLS_ERROR_NOCERT;
+    
+    /* RSA part with the size of the modulus, then the first message format */
+    int sizeRsa = myGLSSocket->m_serverCert->m_modulusSize / 8;
+    if (sizeCipherText <= sizeRsa + GLS_SIZE_HEADROOM) return GLS_ERROR_MSGSIZE;
+    
+    /* Session key in secure memory */
+    byte *sessionKey = 0;
+    int sizeSessionKey = _decryptWithPK(myGLSSocket, cipherText, sizeRsa, &sessionKey, 1);
+    if (sizeSessionKey != GLS_SIZE_REGISTER_KEY) {
+        
+        /* Wipe and free memory */
+        if (sessionKey != NULL) {
+            freeSecure(sessionKey, sizeSessionKey);
+            sessionKey = 0;
+        }
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Bad session key : %d\n", sizeSessionKey);
+        printf("### decryptWithKem() End ###\n\n");
+        #endif
+        
+        if (sizeSessionKey < 0) return sizeSessionKey;
+        else return GLS_ERROR_CRYPTO;
+        
+    }
+    
+    memcpy(myGLSSocket->m_key1, sessionKey, 32);
+    memcpy(myGLSSocket->m_key2, sessionKey + 32, 32);
+    freeSecure(sessionKey, GLS_SIZE_REGISTER_KEY);
+    sessionKey = 0;
+    myGLSSocket->m_isCryptoKey = 1;
+    
+    /* Message decryption with the session key */
+    int sizePlainText = initHandler(myGLSSocket);
+    if (sizePlainText == 0) sizePlainText = firstDecrypt(myGLSSocket, cipherText + sizeRsa, sizeCipherText - sizeRsa, plainText);
+    
+    /* Session key wiped, in the keys and in the handlers */
+    memset(myGLSSocket->m_key1, 0, 32);
+    memset(myGLSSocket->m_key2, 0, 32);
+    myGLSSocket->m_isCryptoKey = 0;
+    if (resetHandler(myGLSSocket) != 0 && sizePlainText >= 0) {
+        
+        /* Free memory */
+        free(*plainText);
+        (*plainText) = 0;
+        
+        sizePlainText = GLS_ERROR_CRYPTO;
+        
+    }
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### decryptWithKem() End ###\n\n");
+    #endif
+    
+    return sizePlainText;
+    
+}
@@ -35,6 +35,7 @@
 #include <winsock2.h>
 #include <windows.h> 
 typedef int socklen_t;
+#define poll WSAPoll
 
 /* Compilation on Linux */
 #elif defined (linux)
@@ -46,12 +47,19 @@ typedef int socklen_t;
 #include <sys/types.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
+#include <sys/uio.h>
 #include <unistd.h>
+#include <sys/epoll.h>
+#include <netinet/tcp.h>
 #define INVALID_SOCKET -1
 #define SOCKET_ERROR -1
 typedef struct sockaddr SOCKADDR;
 #define closesocket(s) close(s)
 
+/* Event loop server (glsServerRun()) with epoll */
+#define GLS_EVENT_ENABLE
+
 /* Compilation on OS X */
 #elif defined (osx)
 
@@ -62,6 +70,8 @@ typedef struct sockaddr SOCKADDR;
 #include <netinet/in.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #define INVALID_SOCKET -1
 #define SOCKET_ERROR -1
@@ -78,6 +88,8 @@ typedef struct sockaddr SOCKADDR;
 #include <netinet/in.h>
 #include <fcntl.h>
 #include <errno.h>
+#include <poll.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #define INVALID_SOCKET -1
 #define SOCKET_ERROR -1
@@ -88,7 +100,9 @@ typedef struct sockaddr SOCKADDR;
 
 /* Standard C files */
 #include <stdio.h>
+#include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include <sys/stat.h>
 
 /* Library ASN.1 */
@@ -117,9 +131,316 @@ typedef struct sockaddr SOCKADDR;
 /* Size maximum of a network packet, encoded in 2 bytes (GLS_SIZE_PACKET < 65535) */
 #define GLS_SIZE_PACKET 60000
 
+/* Number of packets given to the kernel in one system call by sendPacket() */
+#define GLS_IOV_PACKET 32
+
+/* More data is coming after this send (Linux only) */
+#if defined (MSG_MORE)
+#define GLS_MSG_MORE MSG_MORE
+#else
+#define GLS_MSG_MORE 0
+#endif
+
+/* Send of the event loop clients, without waiting nor SIGPIPE when the client is gone */
+#if defined (MSG_NOSIGNAL)
+#define GLS_MSG_EVENT (MSG_DONTWAIT | MSG_NOSIGNAL)
+#else
+#define GLS_MSG_EVENT MSG_DONTWAIT
+#endif
+
 /* Timeout between send & recv packet */
 #define GLS_TIMEOUT_PACKET 3
 
+/* Time given to a client to finish the handshake with the server (seconds) */
+#define GLS_TIMEOUT_HANDSHAKE 10
+
+/* Maximum number of handshakes in progress in waitForClient() */
+#define GLS_MAX_PENDING 256
+
+/* Maximum number of closed clients kept by a server for the next ones */
+#define GLS_SIZE_POOL 64
+
+/* Entry of a revocation list : size and serial number (20 bytes in RFC 5280) */
+#define GLS_SIZE_CRL_ENTRY 32
+
+/* Verified certificates kept by checkCertificate() (SHA-256 fingerprints) */
+#define GLS_SIZE_CERT_CACHE 256
+#define GLS_SIZE_FINGERPRINT 32
+
+/* Key identifier of a root certificate, roots with the same subject searched */
+#define GLS_SIZE_KEY_ID 32
+#define GLS_MAX_ROOT_MATCH 8
+
+/* Object identifiers of the key identifier extensions */
+#define GLS_OID_SUBJECT_KEY_ID "2.5.29.14"
+#define GLS_OID_AUTHORITY_KEY_ID "2.5.29.35"
+
+/* States of the server side handshake (_stepAcceptConnexion()) */
+#define GLS_ACCEPT_ACCEPTED 0
+#define GLS_ACCEPT_HELLO_PLAIN 1
+#define GLS_ACCEPT_HELLO_CIPHER 2
+#define GLS_ACCEPT_READY 3
+
+/* States of the client side handshake (glsConnectPoll()) */
+#define GLS_CONNECT_RESOLVING 10
+#define GLS_CONNECT_CONNECTING 11
+#define GLS_CONNECT_HELLO_SERVER 12
+
+/* Names resolved by connexion() and sendRegister(), kept GLS_DNS_TTL seconds */
+#define GLS_SIZE_DNS_CACHE 256
+#define GLS_SIZE_DNS_NAME 256
+#define GLS_SIZE_DNS_PORT 32
+#ifndef GLS_DNS_TTL
+#define GLS_DNS_TTL 60
+#endif
+
+/* Unknown names are kept less time, the other errors are not kept */
+#ifndef GLS_DNS_NEGATIVE_TTL
+#define GLS_DNS_NEGATIVE_TTL 10
+#endif
+
+/* Threads calling getaddrinfo() for glsConnectStart() */
+#define GLS_NB_RESOLVER 4
+
+/* States of a name in the cache */
+#define GLS_DNS_FREE 0
+#define GLS_DNS_QUEUED 1
+#define GLS_DNS_RESOLVING 2
+#define GLS_DNS_DONE 3
+
+/* Maximum number of messages in flight with glsSetSendWindow() */
+#define GLS_MAX_WINDOW 64
+
+/* Size of a pipelined acknowledgement (status + 4 bytes sequence number) */
+#define GLS_SIZE_ACK 5
+
+/* AES-256-GCM and ChaCha20-Poly1305 are only in libgcrypt >= 1.7 */
+#if GCRYPT_VERSION_NUMBER >= 0x010700
+#define GLS_AEAD_ENABLE
+#endif
+
+/* Header of an AEAD message (8 bytes sequence number + 16 bytes tag) */
+#define GLS_SIZE_AEAD_HEADER 24
+
+/* Part of a message given to a thread by the CTR cascade (multiple of 16) */
+#define GLS_SIZE_CHUNK 262144
+
+/* Maximum number of threads for glsSetCryptoThreads() */
+#define GLS_MAX_THREAD 64
+
+/* Default and maximum size of the IV pool of a socket (multiple of 16) */
+#define GLS_SIZE_IV_POOL 4096
+#define GLS_MAX_IV_POOL 65536
+
+/* Number of events taken by a thread of the event loop in one epoll_wait() */
+#define GLS_EVENT_BATCH 8
+
+/* Session key of a GLS/1.2 register message (key1 + key2) */
+#define GLS_SIZE_REGISTER_KEY 64
+
+/* ASN.1 grammars compiled once by getAsnDefinition() */
+#define GLS_ASN_GLS 0
+#define GLS_ASN_PKIX 1
+#define GLS_NB_ASN 2
+
+/* Job shared by the threads of the worker pool */
+struct glsJobStr {
+
+    void (*m_task)(void* arg, const int index);
+    void* m_arg;
+    int m_nbTask;
+    int m_nextTask;
+    int m_nbDone;
+    struct glsJobStr* m_next;
+
+};
+
+/* Message encrypted by the CTR cascade, one task per crypto thread (handler slot) */
+struct glsCtrJobStr {
+
+    GLSSock* m_socket;
+    byte* m_buffer;
+    int m_size;
+    int m_isEncrypt;
+    int m_nbChunk;
+    int m_nbSlot;
+    byte* m_hash;
+    int* m_error;
+
+};
+
+/* Register message decrypted with the private key, one task per round */
+struct glsPkJobStr {
+
+    GLSSock* m_socket;
+    const byte* m_cipherText;
+    int m_sizeBlock;
+    byte** m_plain;
+    int* m_sizePlain;
+
+};
+
+/* Handshake of the server side, the packets are received without blocking */
+struct glsHandShakeStr {
+
+    int m_state;
+    time_t m_deadline;
+    unsigned long long m_timePhase;
+    int m_typeMessage;
+
+    /* Name of the server and pipe written when resolved (client side) */
+    char* m_address;
+    char* m_port;
+    int m_notify;
+    byte* m_firstMessage;
+    int m_sizeFirstMessage;
+
+    /* Message in progress (m_sizePacket = -1 while reading a header) */
+    byte m_header[2];
+    int m_sizeHeader;
+    int m_sizePacket;
+    int m_sizeRecv;
+    byte* m_message;
+    int m_size;
+    int m_capacity;
+
+    /* Attempts of the message in progress once connected (_recvNoWait()) */
+    int m_nbMacError;
+    int m_nbDiscard;
+
+};
+
+/* 
+ * Client of the event loop server, closed by eventExpire() after
+ * m_deadline (0 = none) : handshake too long, or answers not read
+ * or not acknowledged by the peer
+ */
+struct glsEventConnStr {
+
+    GLSSock* m_client;
+    int m_isConnected;
+    time_t m_deadline;
+    struct glsEventConnStr* m_prev;
+    struct glsEventConnStr* m_next;
+
+};
+
+/* Server certificate and private key parsed once, shared by the clients */
+struct glsServerCertStr {
+
+    byte* m_publicCert;
+    int m_publicCertSize;
+    int m_modulusSize;
+    gcry_sexp_t m_privateKey;
+    int m_nbRef;
+    pthread_mutex_t m_mutexRef;
+
+};
+
+/* 
+ * Revocation list shared by the sockets. Entries of GLS_SIZE_CRL_ENTRY
+ * bytes (size then serial), sorted before a search if serials were added.
+ */
+struct glsCrlStr {
+
+    byte* m_serials;
+    int m_nbSerial;
+    int m_maxSerial;
+    int m_isSorted;
+    int m_nbRef;
+    pthread_mutex_t m_mutex;
+
+};
+
+/* 
+ * Certificate verified with a root : the serial number is kept as a
+ * CRL entry (zeros if too long) and the verdict is valid between
+ * notBefore and notAfter (validity of both certificates) if the root
+ * (SHA-256 of its subject and of the certificate) is still trusted.
+ */
+struct glsCertVerdictStr {
+
+    byte m_fingerprint[GLS_SIZE_FINGERPRINT];
+    byte m_issuer[GLS_SIZE_FINGERPRINT];
+    byte m_root[GLS_SIZE_FINGERPRINT];
+    byte m_serial[GLS_SIZE_CRL_ENTRY];
+    long m_notBefore;
+    long m_notAfter;
+    int m_isUsed;
+
+};
+
+/* 
+ * Root certificate parsed and checked when added to a list, the
+ * subject is the SHA-256 of the DER name.
+ */
+struct glsRootCertStr {
+
+    byte m_subject[GLS_SIZE_FINGERPRINT];
+    byte m_fingerprint[GLS_SIZE_FINGERPRINT];
+    byte m_keyId[GLS_SIZE_KEY_ID];
+    int m_keyIdSize;
+    gcry_sexp_t m_publicKey;
+    long m_notBefore;
+    long m_notAfter;
+
+};
+
+/* 
+ * Root certificates shared by the sockets, sorted by subject.
+ */
+struct glsRootListStr {
+
+    struct glsRootCertStr* m_roots;
+    int m_nbRoot;
+    int m_maxRoot;
+    int m_nbRef;
+    pthread_mutex_t m_mutex;
+
+};
+
+/* 
+ * First address given by getaddrinfo() for a name.
+ */
+struct glsAddressStr {
+
+    int m_family;
+    int m_protocol;
+    socklen_t m_size;
+    struct sockaddr_storage m_addr;
+
+};
+
+/* 
+ * Name in the DNS cache : the address or the error (m_error) until
+ * m_expire. The pipes of m_waiters are written when a name queued
+ * for the resolver threads is resolved.
+ */
+struct glsDnsEntryStr {
+
+    char m_address[GLS_SIZE_DNS_NAME];
+    char m_port[GLS_SIZE_DNS_PORT];
+    int m_state;
+    int m_error;
+    time_t m_expire;
+    struct glsAddressStr m_result;
+    int* m_waiters;
+    int m_nbWaiter;
+    int m_maxWaiter;
+
+};
+
+typedef struct glsJobStr GLSJob;
+typedef struct glsCtrJobStr GLSCtrJob;
+typedef struct glsPkJobStr GLSPkJob;
+typedef struct glsHandShakeStr GLSHandShake;
+typedef struct glsEventConnStr GLSEventConn;
+typedef struct glsServerCertStr GLSServerCert;
+typedef struct glsCertVerdictStr GLSCertVerdict;
+typedef struct glsRootCertStr GLSRootCert;
+typedef struct glsAddressStr GLSAddress;
+typedef struct glsDnsEntryStr GLSDnsEntry;
+
 /* Gcrypt library */
 #define GCRYPT_NO_DEPRECATED
 GCRY_THREAD_OPTION_PTHREAD_IMPL;
@@ -193,7 +514,21 @@ GCRY_THREAD_OPTION_PTHREAD_IMPL;
 : -1)
 
 
-int _acceptConnexion(GLSSock* myGLSSocket, const int socketServer);
+/* Server side of the handshake, resumed when the socket is ready */
+GLSHandShake* newHandShake(const int state);
+int _startAcceptConnexion(GLSSock* myGLSSocket);
+int _stepAcceptConnexion(GLSSock* myGLSSocket);
+int _recvNoWait(GLSSock* myGLSSocket, byte** buffer);
+int _startEventClient(GLSSock* myGLSSocket);
+int acceptFirstMessage(GLSSock* myGLSSocket, byte* firstMessage, const int sizeFirstMessage);
+int acceptSecondMessage(GLSSock* myGLSSocket, byte* secondMessage, const int sizeSecondMessage);
+int _finishHandShake(GLSSock* myGLSSocket);
+
+/* Client side of the handshake (glsConnectStart()) */
+int connectAddress(GLSSock* myGLSSocket, const GLSAddress* address);
+void _stopConnexion(GLSSock* myGLSSocket);
+int sendHelloMessages(GLSSock* myGLSSocket);
+int readHelloServer(GLSSock* myGLSSocket, const byte* firstMessage, const int sizeFirstMessage);
 
 /* Encryption / Decryption function for standard connexion */
 int firstEncrypt(GLSSock* myGLSSocket, const byte* plaintext, const int size, byte** cypherText);
@@ -201,27 +536,145 @@ int firstDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, b
 int allEncrypt(GLSSock* myGLSSocket, const byte* plaintext, const int size, byte** cypherText);
 int allDecrypt(GLSSock* myGLSSocket, const byte* cipherText, const int size, byte** plainText);
 
+/* Same functions working in place, the message is at buffer + GLS_SIZE_HEADROOM */
+int firstEncryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size);
+int firstDecryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size);
+int allEncryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size);
+int allDecryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size);
+
+/* AEAD suites, the message is at buffer + GLS_SIZE_AEAD_HEADER */
+int aeadEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte** cypherText);
+int aeadEncryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size);
+int aeadDecryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size);
+
+/* Cascade in counter mode, the message is at buffer + GLS_SIZE_HEADROOM */
+int ctrEncrypt(GLSSock* myGLSSocket, const byte* plainText, const int size, byte** cypherText);
+int ctrEncryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size);
+int ctrDecryptInPlace(GLSSock* myGLSSocket, byte* buffer, const int size);
+int ctrCascade(GLSSock* myGLSSocket, const int slot, byte* buffer, const int size, const int offset);
+void closeCtrHandler(GLSSock* myGLSSocket);
+int ctrMac(gcry_md_hd_t macHandler, const byte* ivs, const byte* hash, const int nbHash, byte* mac);
+void ctrChunk(void* arg, const int index);
+
+/* Worker pool */
+int runParallel(void (*task)(void* arg, const int index), void* arg, const int nbTask);
+void* workerLoop(void* arg);
+int getCryptoThreads(void);
+
+/* Event loop server */
+GLSSock* _newClient(GLSServerSock* myGLSServerSock);
+void _releaseClient(GLSServerSock* myGLSServerSock, GLSSock* myClient);
+void* eventLoop(void* arg);
+int eventAccept(GLSServerSock* myGLSServerSock);
+int eventClient(GLSServerSock* myGLSServerSock, GLSEventConn* conn);
+void eventClose(GLSServerSock* myGLSServerSock, GLSEventConn* conn, const int error);
+void eventExpire(GLSServerSock* myGLSServerSock);
+void eventDeadline(GLSServerSock* myGLSServerSock, GLSEventConn* conn, const int isWaiting);
+
 /* Send and receive packet from network */
 int sendPacket(GLSSock* myGLSSocket, const byte* buffer, const int size);
 int recvPacket(GLSSock* myGLSSocket, byte** buffer, const int withTimeout);
+int recvPacketNoWait(GLSSock* myGLSSocket, byte** buffer);
+int recvPacketFinish(GLSSock* myGLSSocket, byte** buffer, const int withTimeout);
+int flushOutBuffer(GLSSock* myGLSSocket);
+
+/* Acknowledgement management for the pipelined send */
+int sendAck(GLSSock* myGLSSocket, const byte status);
+int processAck(GLSSock* myGLSSocket, const byte* ack, const int size);
+int waitAck(GLSSock* myGLSSocket);
+int recvAck(GLSSock* myGLSSocket, byte** ack);
+int isAckPending(GLSSock* myGLSSocket);
+int readCipherText(GLSSock* myGLSSocket, byte* cipherMessage, const int sizeCipherMessage);
+int pushRecvQueue(GLSSock* myGLSSocket, byte* message, const int size);
+int popRecvQueue(GLSSock* myGLSSocket, byte** buffer);
+int sendCipherText(GLSSock* myGLSSocket, byte* cipherText, const int sizeCipherText, const int isOwner);
 
 /* GLS message parsing function */
 int getTypeGLS(const byte* message, const int size);
 int getVersionGLS(const byte* message, const int size);
 int setIdGLS(GLSSock* myGLSSocket, const byte* message, const int size);
 int getNumError(const byte* message, const int size);
+int getSuiteGLS(const byte* message, const int size);
 
 /* Key management function */
 int addKeyToArray(const byte* key, byte** (*array), int* size);
 
+/* Socket reused by the server for a new client */
+void initGLSSocketVariables(GLSSock* myGLSSocket);
+void clearGLSSocket(GLSSock* myGLSSocket);
+int recycleGLSSocket(GLSSock* myGLSSocket);
+byte* newKeyBuffer(GLSSock* myGLSSocket);
+void freeKeys(GLSSock* myGLSSocket);
+
 /* Encryption initialisation function */
-int getIV(byte* iv);
+int getIV(GLSSock* myGLSSocket, byte* iv);
 int initHandler(GLSSock* myGLSSocket);
+int resetHandler(GLSSock* myGLSSocket);
+int initSuiteHandler(GLSSock* myGLSSocket);
 
 /* Fonction recv() and send() with timeout and header */
-ssize_t recvWithTimeout(const int socket, byte *buffer, const ssize_t size, const int flag, const int timeout);
+ssize_t recvHeader(const int socket, const int flag, const int timeout);
+ssize_t recvAll(const int socket, byte *buffer, const size_t size, const int flag);
 ssize_t	sendWithHeader(const int socket, const byte *buffer, const ssize_t size, const int flag);
-ssize_t	recvWithHeader(const int socket, byte *buffer, const size_t size, const int flag);
+ssize_t sendIov(const int socket, struct iovec *iov, int iovcnt, const int flag);
+ssize_t queueIov(GLSSock* myGLSSocket, struct iovec *iov, int iovcnt, const int flag);
+int getSendError(const int numError);
+int getRecvError(const int numError);
+int getAcceptError(const int numError);
+int getConnectError(const int numError);
+int getAddrInfoError(const int numError);
+
+/* Statistics */
+unsigned long long getTimeMicro(void);
+void addStats(GLSStats* total, const GLSStats* stats);
+void addHistogram(unsigned long long* histogram, const unsigned long long time);
+
+/* Secure memory accounting (glsGetSecureMemory()) */
+void setSecurePool(const int size);
+byte* mallocSecure(const int size);
+void freeSecure(byte* buffer, const int size);
+
+/* Revocation list */
+int loadCrlHex(GLSCrl* crl, const char* content, const int sizeContent);
+int loadCrlDer(GLSCrl* crl, const byte* der, const int sizeDer);
+int serialToCrlEntry(const byte* serial, const int len, byte* entry);
+int hexToCrlEntry(const char* hex, const int sizeHex, byte* entry);
+int addCrlEntry(GLSCrl* crl, const byte* entry);
+int compareCrlEntry(const void* entry1, const void* entry2);
+int isEntryInCrl(GLSCrl* crl, const byte* entry);
+void retainCrl(GLSCrl* crl);
+void releaseCrl(GLSCrl* crl);
+
+/* Root certificates */
+int parseRootCert(const byte* der, const int sizeDer, GLSRootCert* root);
+int addRootCert(GLSRoots* roots, GLSRootCert* root);
+int findRootCerts(GLSRoots* roots, const byte* subject, const byte* keyId, const int keyIdSize, GLSRootCert* found, const int maxFound);
+int hasRootCert(GLSRoots* roots, const byte* subject, const byte* fingerprint);
+int hashCertName(asn1_node cert, const byte* der, const int sizeDer, const char* name, byte* hash);
+int readCertTime(asn1_node cert, const char* name, long* time);
+int readKeyId(asn1_node cert, const char* oid, byte* keyId);
+int verifyCertSignature(asn1_node cert, const byte* der, const int sizeDer, gcry_sexp_t publicKey);
+void retainRootList(GLSRoots* roots);
+void releaseRootList(GLSRoots* roots);
+
+/* Cache of the verified certificates */
+int certFingerprint(const byte* cert, const int certLen, byte* fingerprint);
+int findCertVerdict(GLSCertVerdict* verdict);
+void storeCertVerdict(const GLSCertVerdict* verdict);
+
+/* Name resolution */
+int lookupAddress(const char* address, const char* port, GLSAddress* result, const int notify);
+int resolveAddress(const char* address, const char* port, GLSAddress* result);
+int getAddress(const char* address, const char* port, const int flags, GLSAddress* result);
+void stopResolveWait(const int notify);
+GLSDnsEntry* findDnsEntry(const char* address, const char* port);
+GLSDnsEntry* newDnsEntry(const char* address, const char* port);
+void setDnsResult(GLSDnsEntry* entry, const int error, const GLSAddress* result);
+void* resolverLoop(void* arg);
+
+/* ASN.1 definition trees shared by all the sockets */
+void buildAsnDefinitions(void);
+asn1_node getAsnDefinition(const int grammar);
 
 /* Certificate management function */
 int base64Decode(byte* buffer, int bufferSize, const byte* src, int srcSize);
@@ -229,14 +682,21 @@ int pemToAsn(const byte *pem, const int pemLen, byte** asn);
 int getPublicRsaFromDer(const byte *der, const int sizeDerInBits, gcry_sexp_t *publicKey);
 int byteToHex(const byte *buffer, const int sizeBuffer, char **hex);
 int charFromFile(const char* fileName, char **content);
-int _encryptWithPK(const byte *cert, const int certLen, const byte* plainText, const int sizePlainText, byte** cypherText);
-int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeCipherText, byte** plainText);
+int _encryptWithPK(gcry_sexp_t publicKey, const byte* plainText, const int sizePlainText, byte** cypherText);
+int _decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeCipherText, byte** plainText, const int isSecure);
 int getModulusSize(const byte *cert, const int certLen);
+int getPublicKeyFromCert(const byte *cert, const int certLen, gcry_sexp_t *publicKey);
+int verifyCertificate(GLSRoots* roots, const byte *cert, const int certLen, GLSCertVerdict* verdict);
 int checkCertificate(GLSSock* myGLSSocket, const byte *cert, const int certLen);
 int encryptWithPK(const byte *cert, const int certLen, const byte* plainText, const int sizePlainText, byte** cypherText);
 int decryptWithPK(GLSSock* myGLSSocket, const byte* cipherText, const int sizeCipherText, byte** plainText);
+void pkChunk(void* arg, const int index);
+int encryptWithKem(GLSSock* myGLSSocket, const byte *cert, const int certLen, const byte* plainText, const int sizePlainText, byte** cypherText);
+int decryptWithKem(GLSSock* myGLSSocket, const byte* cipherText, const int sizeCipherText, byte** plainText);
 int getPrivateRsaFromDer(const byte *der, const int sizeDer, gcry_sexp_t *privateKey);
-int _addServerCertificate(GLSSock* myGLSSocket, const char* publicCert, const char* privateKey);
-int _addServerCertificateFromFile(GLSSock* myGLSSocket, const char* publicCertFileName, const char* privateKeyFileName);
+int newServerCert(const char* publicCert, const char* privateKey, GLSServerCert** serverCert);
+int newServerCertFromFile(const char* publicCertFileName, const char* privateKeyFileName, GLSServerCert** serverCert);
+void retainServerCert(GLSServerCert* serverCert);
+void releaseServerCert(GLSServerCert* serverCert);
                    
 #endif
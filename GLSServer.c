@@ -57,6 +57,22 @@ GLSServerSock* GLSServerSecure(const int secureMem, const int sizeMem){
         myGLSServerSock->m_privateKeyFile = 0;
         myGLSServerSock->m_publicKey = 0;
         myGLSServerSock->m_publicKeyFile = 0;
+        myGLSServerSock->m_serverCert = 0;
+        myGLSServerSock->m_pending = 0;
+        myGLSServerSock->m_nbPending = 0;
+        myGLSServerSock->m_pool = 0;
+        myGLSServerSock->m_nbPool = 0;
+        myGLSServerSock->m_epoll = -1;
+        myGLSServerSock->m_wakePipe[0] = -1;
+        myGLSServerSock->m_wakePipe[1] = -1;
+        myGLSServerSock->m_isRunning = 0;
+        myGLSServerSock->m_callbacks = 0;
+        myGLSServerSock->m_userData = 0;
+        myGLSServerSock->m_conns = 0;
+        myGLSServerSock->m_lastExpire = 0;
+        memset(&myGLSServerSock->m_stats, 0, sizeof(GLSStats));
+        pthread_mutex_init(&myGLSServerSock->m_mutexConns, NULL);
+        pthread_mutex_init(&myGLSServerSock->m_mutexPool, NULL);
         
     }
     
@@ -143,6 +159,46 @@ void freeGLSServer(GLSServerSock* myGLSServerSock){
         
     }
     
+    /* Closing the clients still in handshake in waitForClient() */
+    if (myGLSServerSock->m_pending != NULL) {
+        
+        int i = 0;
+        for (i = 0; i < myGLSServerSock->m_nbPending; i++) {
+            
+            freeGLSSocket(myGLSServerSock->m_pending[i]);
+            
+        }
+        
+        free(myGLSServerSock->m_pending);
+        myGLSServerSock->m_pending = 0;
+        myGLSServerSock->m_nbPending = 0;
+        
+    }
+    
+    /* Freeing the clients kept for the next ones */
+    if (myGLSServerSock->m_pool != NULL) {
+        
+        int i = 0;
+        for (i = 0; i < myGLSServerSock->m_nbPool; i++) {
+            
+            freeGLSSocket(myGLSServerSock->m_pool[i]);
+            
+        }
+        
+        free(myGLSServerSock->m_pool);
+        myGLSServerSock->m_pool = 0;
+        myGLSServerSock->m_nbPool = 0;
+        
+    }
+    
+    /* Releasing the parsed certificate, the clients keep their reference */
+    if (myGLSServerSock->m_serverCert != NULL) {
+        
+        releaseServerCert(myGLSServerSock->m_serverCert);
+        myGLSServerSock->m_serverCert = 0;
+        
+    }
+    
     /* Compilation on Windows */
     #if defined (WIN32)
     
@@ -457,70 +513,890 @@ int initServer(GLSServerSock* myGLSServerSock, const char *port, const int waitQ
 
 int waitForClient(GLSServerSock* myGLSServerSock, GLSSock** myClient) {
     
-    if (myGLSServerSock->isServer == 1) {
+    *myClient = 0;
+    
+    if (myGLSServerSock->isServer != 1) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Server not init.\n");
+        #endif
+        
+        return GLS_ERROR_NOTSOCK;
+        
+    }
+    
+    if (myGLSServerSock->m_sock == INVALID_SOCKET || myGLSServerSock->sock_err == SOCKET_ERROR) {
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No socket for listening.\n");
+        #endif
+        
+        return GLS_ERROR_NOTSOCK;
+        
+    }
+    
+    /* Handshakes in progress, kept from one call to the next */
+    if (myGLSServerSock->m_pending == NULL) {
         
-        if(myGLSServerSock->m_sock != INVALID_SOCKET && myGLSServerSock->sock_err != SOCKET_ERROR) {
+        myGLSServerSock->m_pending = malloc(GLS_MAX_PENDING * sizeof(GLSSock*));
+        if (myGLSServerSock->m_pending == NULL) return GLS_ERROR_NOMEM;
+        myGLSServerSock->m_nbPending = 0;
+        
+    }
+    GLSSock* (*pending) = myGLSServerSock->m_pending;
+    
+    /* The listening socket is only read when a client is waiting */
+    int flags = fcntl(myGLSServerSock->m_sock, F_GETFL, 0);
+    fcntl(myGLSServerSock->m_sock, F_SETFL, flags | O_NONBLOCK);
+    
+    struct pollfd fds[GLS_MAX_PENDING + 1];
+    int error = 0;
+    
+    while (*myClient == NULL && error == 0) {
+        
+        /* 
+         * Waiting for a new client or for the next bytes of a handshake,
+         * until the first deadline. No new client when the list is full.
+         */
+        int nbPolled = myGLSServerSock->m_nbPending;
+        int timeout = -1;
+        time_t now = time(NULL);
+        
+        fds[0].fd = (nbPolled < GLS_MAX_PENDING) ? myGLSServerSock->m_sock : -1;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        
+        int i = 0;
+        for (i = 0; i < nbPolled; i++) {
+            
+            GLSHandShake* handShake = pending[i]->m_handShake;
+            fds[i + 1].fd = pending[i]->m_sock;
+            fds[i + 1].events = POLLIN;
+            fds[i + 1].revents = 0;
             
-            int error = -1;
-            *myClient = 0;
+            /* A finished handshake doesn't wait */
+            int left = (int) (handShake->m_deadline - now + 1) * 1000;
+            if (handShake->m_state == GLS_ACCEPT_READY || left < 0) left = 0;
+            if (timeout < 0 || left < timeout) timeout = left;
+            
+        }
+        
+        int nbReady = poll(fds, nbPolled + 1, timeout);
+        if (nbReady < 0 && errno == EINTR) continue;
+        if (nbReady < 0) {
+            
+            error = GLS_ERROR_UNKNOWN;
+            break;
+            
+        }
+        
+        /* New clients, their handshake starts below */
+        while ((fds[0].revents & POLLIN) != 0 && myGLSServerSock->m_nbPending < GLS_MAX_PENDING) {
             
-            while(error != 0) {
+            struct sockaddr infoClient;
+            socklen_t addr_size = sizeof(infoClient);
+            int sock = accept(myGLSServerSock->m_sock, &infoClient, &addr_size);
+            if (sock < 0) {
                 
-                if (*myClient != NULL) {
-                    
-                    freeGLSSocket(*myClient);
+                /* No more client, a client gone before accept() is not an error */
+                if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED) error = getAcceptError(errno);
+                break;
                 
-                }
+            }
+            
+            GLSSock* client = _newClient(myGLSServerSock);
+            if (client == NULL) {
                 
-                *myClient = 0;
-                *myClient = GLSSocketSecure(myGLSServerSock->secureMem, myGLSServerSock->sizeMem);
+                closesocket(sock);
+                error = GLS_ERROR_NOMEM;
+                break;
                 
-                if (*myClient == NULL) {
-                    
-                    return GLS_ERROR_NOMEM;
+            }
+            client->m_sock = sock;
+            memcpy(&client->m_infoClient, &infoClient, sizeof(client->m_infoClient));
+            
+            /* The acknowledgement and the answer are sent one after the other */
+            int noDelay = 1;
+            setsockopt(client->m_sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            
+            error = _startAcceptConnexion(client);
+            if (error != 0) {
                 
-                }
+                _releaseClient(myGLSServerSock, client);
+                break;
                 
-                /* adding server certificate */
-                if (myGLSServerSock->m_publicKey != NULL && myGLSServerSock->m_privateKey != NULL) {
-                    
-                    _addServerCertificate(*myClient, myGLSServerSock->m_publicKey, myGLSServerSock->m_privateKey);
-                    
-                }
-                else if(myGLSServerSock->m_publicKeyFile != NULL && myGLSServerSock->m_privateKeyFile != NULL) {
-                    
-                    _addServerCertificateFromFile(*myClient, myGLSServerSock->m_publicKeyFile, myGLSServerSock->m_privateKeyFile);
-                    
-                }
+            }
+            
+            pending[myGLSServerSock->m_nbPending] = client;
+            myGLSServerSock->m_nbPending++;
+            
+        }
+        
+        /* 
+         * Handshakes going on, from the end of the list to move the last
+         * one in the place of a removed one. A new client is tried at once,
+         * its Hello message can already be there.
+         */
+        now = time(NULL);
+        for (i = myGLSServerSock->m_nbPending - 1; i >= 0; i--) {
+            
+            GLSHandShake* handShake = pending[i]->m_handShake;
+            if (i < nbPolled && fds[i + 1].revents == 0 && handShake->m_state != GLS_ACCEPT_READY && now <= handShake->m_deadline) continue;
+            
+            /* A second finished handshake waits for the next call */
+            int state = _stepAcceptConnexion(pending[i]);
+            if (state == GLS_ERROR_AGAIN || (state == 0 && *myClient != NULL)) continue;
+            
+            GLSSock* client = pending[i];
+            myGLSServerSock->m_nbPending--;
+            pending[i] = pending[myGLSServerSock->m_nbPending];
+            
+            /* The handshake is over for the statistics of the server */
+            pthread_mutex_lock(&myGLSServerSock->m_mutexConns);
+            addStats(&myGLSServerSock->m_stats, &client->m_statsHandShake);
+            pthread_mutex_unlock(&myGLSServerSock->m_mutexConns);
+            
+            /* A client in error is closed without stopping the others */
+            if (state == 0) *myClient = client;
+            else _releaseClient(myGLSServerSock, client);
+            
+        }
+        
+    }
+    
+    fcntl(myGLSServerSock->m_sock, F_SETFL, flags);
+    
+    if (*myClient != NULL) return 0;
+    
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Error waitForClient (%d)\n", error);
+    #endif
+    
+    return error;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Convert an accept() errno into a GLS error.
+ 
+ ---------------------------------------------------------*/
+
+int getAcceptError(const int numError) {
+    
+    switch (numError) {
+            
+        case EAGAIN :
+            return GLS_ERROR_AGAIN;
+            break;
+            
+        case EBADF :
+            return GLS_ERROR_BADF;
+            break;
+            
+        case ECONNABORTED :
+            return GLS_ERROR_CONNABORTED;
+            break;
+            
+        case EINTR :
+            return GLS_ERROR_INTR;
+            break;
+            
+        case EINVAL :
+            return GLS_ERROR_INVAL;
+            break;
+            
+        case EMFILE :
+            return GLS_ERROR_MFILE;
+            break;
+            
+        case ENFILE :
+            return GLS_ERROR_NFILE;
+            break;
+            
+        case ENOBUFS :
+            return GLS_ERROR_NOBUFS;
+            break;
+            
+        case ENOMEM :
+            return GLS_ERROR_NOMEM;
+            break;
+            
+        case ENOTSOCK :
+            return GLS_ERROR_NOTSOCK;
+            break;
+            
+        case EOPNOTSUPP :
+            return GLS_ERROR_OPNOTSUPP;
+            break;
+            
+        case EPROTO :
+            return GLS_ERROR_PROTO;
+            break;
+            
+        case EPERM :
+            return GLS_ERROR_PERM;
+            break;
+            
+        case ENOSR :
+            return GLS_ERROR_NOSR;
+            break;
+            
+        case ESOCKTNOSUPPORT :
+            return GLS_ERROR_SOCKTNOSUPPORT;
+            break;
+            
+        case EPROTONOSUPPORT :
+            return GLS_ERROR_PROTONOSUPPORT;
+            break;
+            
+        case ETIMEDOUT :
+            return GLS_ERROR_TIMEDOUT;
+            break;
+            
+        default:
+            return GLS_ERROR_UNKNOWN;
+            break;
+            
+    }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Allocate the GLSSocket of a new client with the server
+ certificate, a closed client of the pool is taken first.
+ The certificate is parsed with the first client
+ (libgcrypt is initialised by GLSSocketSecure()) and
+ shared by reference with the next ones.
+ Return the socket or NULL for an error.
+ 
+ ---------------------------------------------------------*/
+
+GLSSock* _newClient(GLSServerSock* myGLSServerSock) {
+    
+    GLSSock* myClient = 0;
+    
+    pthread_mutex_lock(&myGLSServerSock->m_mutexPool);
+    if (myGLSServerSock->m_nbPool > 0) {
+        
+        myGLSServerSock->m_nbPool--;
+        myClient = myGLSServerSock->m_pool[myGLSServerSock->m_nbPool];
+        
+    }
+    pthread_mutex_unlock(&myGLSServerSock->m_mutexPool);
+    
+    if (myClient == NULL) myClient = GLSSocketSecure(myGLSServerSock->secureMem, myGLSServerSock->sizeMem);
+    
+    if (myClient == NULL) return 0;
+    
+    /* 
+     * Parsing the server certificate once, an error leaves the client without
+     * it. The event loop threads accept in parallel, the pool mutex keeps a
+     * single parse and a complete pointer.
+     */
+    pthread_mutex_lock(&myGLSServerSock->m_mutexPool);
+    if (myGLSServerSock->m_serverCert == NULL) {
+        
+        if (myGLSServerSock->m_publicKey != NULL && myGLSServerSock->m_privateKey != NULL) {
+            
+            newServerCert(myGLSServerSock->m_publicKey, myGLSServerSock->m_privateKey, &myGLSServerSock->m_serverCert);
+            
+        }
+        else if(myGLSServerSock->m_publicKeyFile != NULL && myGLSServerSock->m_privateKeyFile != NULL) {
+            
+            newServerCertFromFile(myGLSServerSock->m_publicKeyFile, myGLSServerSock->m_privateKeyFile, &myGLSServerSock->m_serverCert);
+            
+        }
+        
+    }
+    
+    /* adding server certificate */
+    if (myGLSServerSock->m_serverCert != NULL) {
+        
+        retainServerCert(myGLSServerSock->m_serverCert);
+        myClient->m_serverCert = myGLSServerSock->m_serverCert;
+        
+    }
+    pthread_mutex_unlock(&myGLSServerSock->m_mutexPool);
+    
+    return myClient;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Close a client and keep it in the pool of the server for
+ _newClient(), or free it when the pool is full.
+ 
+ ---------------------------------------------------------*/
+
+void _releaseClient(GLSServerSock* myGLSServerSock, GLSSock* myClient) {
+    
+    /* Nothing of the connexion stays in the socket */
+    if (recycleGLSSocket(myClient) != 0) {
+        
+        freeGLSSocket(myClient);
+        return;
+        
+    }
+    
+    pthread_mutex_lock(&myGLSServerSock->m_mutexPool);
+    
+    if (myGLSServerSock->m_pool == NULL) {
+        
+        myGLSServerSock->m_pool = malloc(GLS_SIZE_POOL * sizeof(GLSSock*));
+        myGLSServerSock->m_nbPool = 0;
+        
+    }
+    
+    if (myGLSServerSock->m_pool != NULL && myGLSServerSock->m_nbPool < GLS_SIZE_POOL) {
+        
+        myGLSServerSock->m_pool[myGLSServerSock->m_nbPool] = myClient;
+        myGLSServerSock->m_nbPool++;
+        myClient = 0;
+        
+    }
+    
+    pthread_mutex_unlock(&myGLSServerSock->m_mutexPool);
+    
+    /* Pool full */
+    if (myClient != NULL) freeGLSSocket(myClient);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ Close a client of waitForClient() and keep its socket
+ 
+ ---------------------------------------------------------*/
+
+void glsServerReleaseClient(GLSServerSock* myGLSServerSock, GLSSock* myClient) {
+    
+    if (myGLSServerSock == NULL || myClient == NULL) return;
+    
+    _releaseClient(myGLSServerSock, myClient);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+            Event Loop (Server)
+ 
+ ---------------------------------------------------------*/
+
+int glsServerRun(GLSServerSock* myGLSServerSock, const GLSServerCallback* callbacks, void* userData, const int nbThread) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsServerRun() Start ###\n");
+    #endif
+    
+    #if defined (GLS_EVENT_ENABLE)
+    
+    /* Arguments check */
+    if (myGLSServerSock->isServer != 1 || myGLSServerSock->m_sock == INVALID_SOCKET) return GLS_ERROR_NOTSOCK;
+    if (callbacks == NULL || myGLSServerSock->m_isRunning == 1) return GLS_ERROR_INVAL;
+    if (nbThread < 1 || nbThread > GLS_MAX_THREAD) return GLS_ERROR_BADSIZE;
+    
+    myGLSServerSock->m_callbacks = callbacks;
+    myGLSServerSock->m_userData = userData;
+    
+    /* epoll and the pipe which wakes up the threads for glsServerStop() */
+    myGLSServerSock->m_epoll = epoll_create1(0);
+    if (myGLSServerSock->m_epoll < 0) return GLS_ERROR_NOMEM;
+    if (pipe(myGLSServerSock->m_wakePipe) != 0) {
+        
+        close(myGLSServerSock->m_epoll);
+        myGLSServerSock->m_epoll = -1;
+        
+        return GLS_ERROR_MFILE;
+        
+    }
+    
+    /* The listening socket is only read when a client is waiting */
+    int flags = fcntl(myGLSServerSock->m_sock, F_GETFL, 0);
+    fcntl(myGLSServerSock->m_sock, F_SETFL, flags | O_NONBLOCK);
+    
+    /* 
+     * EPOLLONESHOT : a socket is given to one thread and added again
+     * when this thread is done with it. The pipe wakes up all the threads.
+     */
+    int error = 0;
+    struct epoll_event event;
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.ptr = myGLSServerSock;
+    error += epoll_ctl(myGLSServerSock->m_epoll, EPOLL_CTL_ADD, myGLSServerSock->m_sock, &event);
+    event.events = EPOLLIN;
+    event.data.ptr = myGLSServerSock->m_wakePipe;
+    error += epoll_ctl(myGLSServerSock->m_epoll, EPOLL_CTL_ADD, myGLSServerSock->m_wakePipe[0], &event);
+    
+    myGLSServerSock->m_isRunning = 1;
+    
+    /* Threads of the event loop, the calling thread is the last one */
+    pthread_t threads[GLS_MAX_THREAD];
+    int nbStarted = 0;
+    while (error == 0 && nbStarted < nbThread - 1) {
+        
+        if (pthread_create(&threads[nbStarted], NULL, eventLoop, myGLSServerSock) != 0) break;
+        nbStarted++;
+        
+    }
+    
+    if (error == 0) eventLoop(myGLSServerSock);
+    else glsServerStop(myGLSServerSock);
+    
+    int i = 0;
+    for (i = 0; i < nbStarted; i++) {
+        
+        pthread_join(threads[i], NULL);
+        
+    }
+    
+    /* All the threads are stopped, closing the remaining clients */
+    while (myGLSServerSock->m_conns != NULL) {
+        
+        eventClose(myGLSServerSock, myGLSServerSock->m_conns, 0);
+        
+    }
+    
+    epoll_ctl(myGLSServerSock->m_epoll, EPOLL_CTL_DEL, myGLSServerSock->m_sock, NULL);
+    fcntl(myGLSServerSock->m_sock, F_SETFL, flags);
+    close(myGLSServerSock->m_epoll);
+    close(myGLSServerSock->m_wakePipe[0]);
+    close(myGLSServerSock->m_wakePipe[1]);
+    myGLSServerSock->m_epoll = -1;
+    myGLSServerSock->m_wakePipe[0] = -1;
+    myGLSServerSock->m_wakePipe[1] = -1;
+    myGLSServerSock->m_callbacks = 0;
+    myGLSServerSock->m_userData = 0;
+    myGLSServerSock->m_isRunning = 0;
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsServerRun() End ###\n\n");
+    #endif
+    
+    if (error != 0) return GLS_ERROR_UNKNOWN;
+    
+    return 0;
+    
+    #else
+    
+    return GLS_ERROR_OPNOTSUPP;
+    
+    #endif
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+            Stop the Event Loop (Server)
+ 
+ ---------------------------------------------------------*/
+
+int glsServerStop(GLSServerSock* myGLSServerSock) {
+    
+    #if defined (GLS_EVENT_ENABLE)
+    
+    if (myGLSServerSock->m_isRunning == 0 || myGLSServerSock->m_wakePipe[1] < 0) return GLS_ERROR_INVAL;
+    
+    /* The byte is never read so all the threads see it */
+    byte stop = 1;
+    if (write(myGLSServerSock->m_wakePipe[1], &stop, 1) != 1) return GLS_ERROR_UNKNOWN;
+    
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Event loop stopped\n");
+    #endif
+    
+    return 0;
+    
+    #else
+    
+    return GLS_ERROR_OPNOTSUPP;
+    
+    #endif
+    
+}
+
+
+
+
+#if defined (GLS_EVENT_ENABLE)
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Thread of the event loop, waits for the ready sockets
+ until glsServerStop().
+ 
+ ---------------------------------------------------------*/
+
+void* eventLoop(void* arg) {
+    
+    GLSServerSock* myGLSServerSock = (GLSServerSock*) arg;
+    struct epoll_event events[GLS_EVENT_BATCH];
+    
+    while (1) {
+        
+        /* Wakes up every second for the handshakes too long */
+        int nbEvent = epoll_wait(myGLSServerSock->m_epoll, events, GLS_EVENT_BATCH, 1000);
+        if (nbEvent < 0 && errno == EINTR) continue;
+        if (nbEvent < 0) return NULL;
+        
+        eventExpire(myGLSServerSock);
+        
+        int i = 0;
+        for (i = 0; i < nbEvent; i++) {
+            
+            /* Stop, the sockets of the other events are closed by glsServerRun() */
+            if (events[i].data.ptr == myGLSServerSock->m_wakePipe) return NULL;
+            
+            /* New clients */
+            if (events[i].data.ptr == myGLSServerSock) {
+                
+                eventAccept(myGLSServerSock);
+                
+                struct epoll_event event;
+                event.events = EPOLLIN | EPOLLONESHOT;
+                event.data.ptr = myGLSServerSock;
+                epoll_ctl(myGLSServerSock->m_epoll, EPOLL_CTL_MOD, myGLSServerSock->m_sock, &event);
                 
-                error = _acceptConnexion(*myClient, myGLSServerSock->m_sock);
+                continue;
+                
+            }
+            
+            /* 
+             * Packets waiting for the socket first, the messages of the
+             * client are read once they are all sent
+             */
+            GLSEventConn* conn = (GLSEventConn*) events[i].data.ptr;
+            int state = 0;
+            if ((events[i].events & EPOLLOUT) != 0) state = flushOutBuffer(conn->m_client);
+            if (state == 0) state = eventClient(myGLSServerSock, conn);
+            if (state == 0) state = flushOutBuffer(conn->m_client);
+            if (state < 0) {
+                
+                eventClose(myGLSServerSock, conn, state);
+                continue;
+                
+            }
+            
+            eventDeadline(myGLSServerSock, conn, state);
+            
+            /* Waiting for the socket to send the rest or for the next message */
+            struct epoll_event event;
+            event.events = ((state == 1) ? EPOLLOUT : EPOLLIN) | EPOLLONESHOT;
+            event.data.ptr = conn;
+            if (epoll_ctl(myGLSServerSock->m_epoll, EPOLL_CTL_MOD, conn->m_client->m_sock, &event) != 0) {
+                
+                eventClose(myGLSServerSock, conn, GLS_ERROR_UNKNOWN);
                 
             }
             
         }
-        else {
+        
+    }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Accept the waiting clients of the event loop. The Hello
+ message is read when the socket is ready.
+ Return the number of clients or a negative number for an
+ error.
+ 
+ ---------------------------------------------------------*/
+
+int eventAccept(GLSServerSock* myGLSServerSock) {
+    
+    int nbClient = 0;
+    
+    while (1) {
+        
+        /* The listening socket is non blocking, no more client gives EAGAIN */
+        struct sockaddr infoClient;
+        socklen_t addr_size = sizeof(infoClient);
+        int sock = accept(myGLSServerSock->m_sock, &infoClient, &addr_size);
+        if (sock < 0) return nbClient;
+        
+        GLSSock* myClient = _newClient(myGLSServerSock);
+        if (myClient == NULL) {
             
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("No socket for listening.\n");
-            #endif
+            closesocket(sock);
             
-            return GLS_ERROR_NOTSOCK;
+            return GLS_ERROR_NOMEM;
             
         }
+        myClient->m_sock = sock;
+        memcpy(&myClient->m_infoClient, &infoClient, sizeof(myClient->m_infoClient));
+        
+        /* 
+         * The messages are read and sent without blocking, the timeouts
+         * only limit the calls which still wait (glsRecv())
+         */
+        struct timeval timeout;
+        timeout.tv_sec = GLS_TIMEOUT_PACKET;
+        timeout.tv_usec = 0;
+        setsockopt(myClient->m_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(myClient->m_sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        
+        /* The acknowledgement and the answer of a callback are sent one after the other */
+        int noDelay = 1;
+        setsockopt(myClient->m_sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        
+        GLSEventConn* conn = malloc(sizeof(GLSEventConn));
+        if (conn == NULL) {
+            
+            _releaseClient(myGLSServerSock, myClient);
+            
+            return GLS_ERROR_NOMEM;
+            
+        }
+        /* The Hello message is read without blocking, a byte at a time if needed */
+        if (_startEventClient(myClient) != 0 || _startAcceptConnexion(myClient) != 0) {
+            
+            _releaseClient(myGLSServerSock, myClient);
+            free(conn);
+            
+            return GLS_ERROR_NOMEM;
+            
+        }
+        
+        conn->m_client = myClient;
+        conn->m_isConnected = 0;
+        conn->m_deadline = myClient->m_handShake->m_deadline;
+        conn->m_prev = 0;
+        
+        /* List of the clients for glsServerRun() */
+        pthread_mutex_lock(&myGLSServerSock->m_mutexConns);
+        conn->m_next = myGLSServerSock->m_conns;
+        if (conn->m_next != NULL) conn->m_next->m_prev = conn;
+        myGLSServerSock->m_conns = conn;
+        pthread_mutex_unlock(&myGLSServerSock->m_mutexConns);
+        
+        struct epoll_event event;
+        event.events = EPOLLIN | EPOLLONESHOT;
+        event.data.ptr = conn;
+        if (epoll_ctl(myGLSServerSock->m_epoll, EPOLL_CTL_ADD, myClient->m_sock, &event) != 0) {
+            
+            eventClose(myGLSServerSock, conn, GLS_ERROR_UNKNOWN);
+            
+            return GLS_ERROR_UNKNOWN;
+            
+        }
+        
+        nbClient++;
         
     }
-    else {
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ A client of the event loop is ready : Hello message and
+ handshake or a message from a connected client.
+ Return 0 to keep the client or a negative number to
+ close it.
+ 
+ ---------------------------------------------------------*/
+
+int eventClient(GLSServerSock* myGLSServerSock, GLSEventConn* conn) {
+    
+    const GLSServerCallback* callbacks = myGLSServerSock->m_callbacks;
+    GLSSock* myClient = conn->m_client;
+    
+    /* 
+     * Messages from a connected client, read without blocking until the
+     * socket is empty, a part of message waits for the next event
+     */
+    while (conn->m_isConnected == 1) {
         
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Server not init.\n");
-        #endif
+        /* The peer reads its answers before sending more */
+        if (myClient->m_posOutBuffer < myClient->m_sizeOutBuffer) return 0;
         
-        return GLS_ERROR_NOTSOCK;
+        byte (*message) = 0;
+        int sizeMessage = _recvNoWait(myClient, &message);
+        if (sizeMessage == GLS_ERROR_AGAIN) return 0;
+        if (sizeMessage < 0) return sizeMessage;
+        
+        if (callbacks->onMessage != NULL) callbacks->onMessage(myClient, message, sizeMessage, myGLSServerSock->m_userData);
+        
+        free(message);
         
     }
     
+    /* Hello or Register message, waiting for the socket again until it's complete */
+    int error = _stepAcceptConnexion(myClient);
+    if (error == GLS_ERROR_AGAIN) return 0;
+    if (error != 0) return error;
+    
+    /* No deadline for eventExpire() after the handshake */
+    pthread_mutex_lock(&myGLSServerSock->m_mutexConns);
+    conn->m_isConnected = 1;
+    conn->m_deadline = 0;
+    pthread_mutex_unlock(&myGLSServerSock->m_mutexConns);
+    
+    int answer = 0;
+    if (callbacks->onHandShake != NULL) answer = callbacks->onHandShake(myClient, myGLSServerSock->m_userData);
+    
+    /* Nothing more after a register message */
+    if (getTypeConnexion(myClient) == GLS_CONNEXION_REGISTER) return GLS_ERROR_CONNABORTED;
+    if (answer != 0) return GLS_ERROR_CONNREFUSED;
+    
+    error = finishHandShake(myClient);
+    if (error != 0) return error;
+    
+    if (callbacks->onConnect != NULL) callbacks->onConnect(myClient, myGLSServerSock->m_userData);
+    
     return 0;
+    
+}
+
 
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Close the clients of the event loop which didn't finish
+ their handshake in GLS_TIMEOUT_HANDSHAKE seconds or which
+ didn't read or acknowledge our messages in
+ GLS_TIMEOUT_PACKET seconds (eventDeadline()), once a
+ second. Their socket is shut down, the thread which gets
+ its event closes the client.
+ 
+ ---------------------------------------------------------*/
+
+void eventExpire(GLSServerSock* myGLSServerSock) {
+    
+    time_t now = time(NULL);
+    
+    pthread_mutex_lock(&myGLSServerSock->m_mutexConns);
+    
+    if (now != myGLSServerSock->m_lastExpire) {
+        
+        myGLSServerSock->m_lastExpire = now;
+        
+        GLSEventConn* conn = myGLSServerSock->m_conns;
+        while (conn != NULL) {
+            
+            if (conn->m_deadline != 0 && now > conn->m_deadline) shutdown(conn->m_client->m_sock, SHUT_RDWR);
+            conn = conn->m_next;
+            
+        }
+        
+    }
+    
+    pthread_mutex_unlock(&myGLSServerSock->m_mutexConns);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Deadline of a connected client for eventExpire() after
+ its event : GLS_TIMEOUT_PACKET seconds from now while
+ packets wait for the socket (isWaiting = 1) or messages
+ for their acknowledgement, none otherwise. The handshake
+ keeps its own deadline.
+ 
+ ---------------------------------------------------------*/
+
+void eventDeadline(GLSServerSock* myGLSServerSock, GLSEventConn* conn, const int isWaiting) {
+    
+    if (conn->m_isConnected == 0) return;
+    
+    GLSSock* myClient = conn->m_client;
+    time_t deadline = 0;
+    if (isWaiting == 1 || myClient->m_ackSeq != myClient->m_sendSeq) deadline = time(NULL) + GLS_TIMEOUT_PACKET;
+    
+    /* The list is only locked when the deadline changes */
+    if (deadline == conn->m_deadline) return;
+    
+    pthread_mutex_lock(&myGLSServerSock->m_mutexConns);
+    conn->m_deadline = deadline;
+    pthread_mutex_unlock(&myGLSServerSock->m_mutexConns);
+    
 }
 
 
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Remove a client from the event loop and free it.
+ 
+ ---------------------------------------------------------*/
+
+void eventClose(GLSServerSock* myGLSServerSock, GLSEventConn* conn, const int error) {
+    
+    /* The statistics of the client stay in the server */
+    pthread_mutex_lock(&myGLSServerSock->m_mutexConns);
+    if (conn->m_prev != NULL) conn->m_prev->m_next = conn->m_next;
+    else myGLSServerSock->m_conns = conn->m_next;
+    if (conn->m_next != NULL) conn->m_next->m_prev = conn->m_prev;
+    addStats(&myGLSServerSock->m_stats, &conn->m_client->m_statsHandShake);
+    addStats(&myGLSServerSock->m_stats, &conn->m_client->m_statsSend);
+    addStats(&myGLSServerSock->m_stats, &conn->m_client->m_statsRecv);
+    pthread_mutex_unlock(&myGLSServerSock->m_mutexConns);
+    
+    epoll_ctl(myGLSServerSock->m_epoll, EPOLL_CTL_DEL, conn->m_client->m_sock, NULL);
+    
+    /* Last chance for the packets still waiting (error message of the handshake) */
+    flushOutBuffer(conn->m_client);
+    
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Event loop client closed (%d)\n", error);
+    #endif
+    
+    if (myGLSServerSock->m_callbacks->onClose != NULL) myGLSServerSock->m_callbacks->onClose(conn->m_client, error, myGLSServerSock->m_userData);
+    
+    _releaseClient(myGLSServerSock, conn->m_client);
+    free(conn);
+    
+}
+
+#endif
@@ -28,14 +28,150 @@
 
 
 
+/* Global variables for gcrypt */
+pthread_mutex_t m_mutexCryptoInit = PTHREAD_MUTEX_INITIALIZER;
+int m_isCryptoInit = 0;
+
+
+
+
 /*-------------------------------------------------------
  
- Create a GLS socket
+ Initialise libgcrypt and the ASN.1 definitions, only the
+ first call does the work. The other threads wait on the
+ mutex for the end of the initialisation and never sleep.
+ 
+ Return 0 for success, a negative number for an error.
  
  ---------------------------------------------------------*/
 
-/* Global variable for gcrypt */
-int m_isCryptoInit = 0;
+int glsGlobalInit(const int secureMem, const int sizeMem) {
+    
+    pthread_mutex_lock(&m_mutexCryptoInit);
+    
+    /* Already done */
+    if (m_isCryptoInit == 1) {
+        
+        pthread_mutex_unlock(&m_mutexCryptoInit);
+        return 0;
+        
+    }
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsGlobalInit() Start ###\n");
+    #endif
+    
+    /* 
+     * In case of the library is loaded in a application who also uses libgcrypt,
+     * we check if the library is already initialised 
+     */
+    if (!gcry_control(GCRYCTL_INITIALIZATION_FINISHED_P)) {
+        
+        /* Threads management init */
+        gcry_control(GCRYCTL_SET_THREAD_CBS, &gcry_threads_pthread);
+        
+        /* Version check should be the very first call because it
+         makes sure that important subsystems are intialized. */
+        if (!gcry_check_version (GCRYPT_VERSION)) {
+            
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("libgcrypt version mismatch\n");
+            printf("### glsGlobalInit() End ###\n\n");
+            #endif
+            
+            pthread_mutex_unlock(&m_mutexCryptoInit);
+            return GLS_ERROR_CRYPTO;
+            
+        }
+        
+        /*
+         * You can activate the libgcrypt debug but very verbose 
+         */
+        /*
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        gcry_control (GCRYCTL_SET_DEBUG_FLAGS);
+        #endif
+        */
+        
+        if (secureMem == 1) {
+            
+            /* We don’t want to see any warnings, e.g. because we have not yet
+             parsed program options which might be used to suppress such
+             warnings. */
+            gcry_control (GCRYCTL_SUSPEND_SECMEM_WARN);
+            
+            /* ... If required, other initialization goes here.  Note that the
+             process might still be running with increased privileges and that
+             the secure memory has not been intialized.  */
+            /* Allocate a pool of 16k secure memory.  This make the secure memory
+             available and also drops privileges where needed.  */
+            gcry_control (GCRYCTL_INIT_SECMEM, sizeMem, 0);
+            setSecurePool(sizeMem);
+            
+            /* It is now okay to let Libgcrypt complain when there was/is
+             a problem with the secure memory. */
+            gcry_control (GCRYCTL_RESUME_SECMEM_WARN);
+            
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("Secure Memory initialized\n");
+            #endif
+            
+        }
+        
+        /* ... If required, other initialization goes here.  */
+        /* Tell Libgcrypt that initialization has completed. */
+        gcry_control (GCRYCTL_INITIALIZATION_FINISHED, 0);
+        
+        if (!gcry_control(GCRYCTL_INITIALIZATION_FINISHED_P)) {
+            
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("libgcrypt has not been initialized\n");
+            #endif
+            abort(); 
+            
+        }
+        
+        /* Test libgcrypt algorithme */
+        int err = gcry_control(GCRYCTL_SELFTEST);
+        if (err != 0) {
+            
+            /* Debug only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("Error %d : %s\n", err, gcry_strerror(err));
+            printf("libgcrypt algo test failed\n");
+            #endif
+            abort(); 
+            
+        }
+        
+    }
+    
+    /* ASN.1 definitions compiled before the first certificate */
+    getAsnDefinition(GLS_ASN_PKIX);
+    
+    /* The other threads can go on */
+    m_isCryptoInit = 1;
+    
+    pthread_mutex_unlock(&m_mutexCryptoInit);
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsGlobalInit() End ###\n\n");
+    #endif
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ Create a GLS socket
+ 
+ ---------------------------------------------------------*/
 
 GLSSock* GLSSocket() {
     
@@ -50,37 +186,17 @@ GLSSock* GLSSocketSecure(const int secureMem, const int sizeMem){
     printf("### GLSSocket() Start ###\n");
     #endif
     
+    /* libgcrypt initialised by the first socket only */
+    if (glsGlobalInit(secureMem, sizeMem) != 0) return 0;
+    
     GLSSock* myGLSSocket = malloc(sizeof(GLSSock));
     
     /* If no memory return NULL */
     if (myGLSSocket == NULL) return myGLSSocket;
     
-    /* Variable init */
-    myGLSSocket->m_sock = 0;
-    myGLSSocket->m_isSocketConfig = 0;
-    myGLSSocket->m_isCryptoKey = 0;
+    /* Variable init, the handlers are created by initHandler() */
+    initGLSSocketVariables(myGLSSocket);
     myGLSSocket->m_isHandlerInit = 0;
-    myGLSSocket->m_isUserConfig = 0;
-    myGLSSocket->m_connexionType = 0;
-    myGLSSocket->m_messageHelloEncrypt = 0;
-    myGLSSocket->m_idUser = 0;
-    myGLSSocket->m_sizeIdUser = 0;
-    myGLSSocket->m_sizeMessageHelloEncrypt = 0;
-    myGLSSocket->m_isHandShakeFinish = 0;
-    myGLSSocket->m_sizeKeys = 0;
-    myGLSSocket->m_keys = 0;
-    myGLSSocket->m_infoClient = 0;
-    myGLSSocket->m_infoConnexion = 0;
-    myGLSSocket->m_certRoot = 0;
-    myGLSSocket->m_certRootSize = 0;
-    myGLSSocket->m_publicCert = 0;
-    myGLSSocket->m_publicCertSize = 0;
-    myGLSSocket->m_privateKey = 0;
-    myGLSSocket->m_privateKeySize = 0;
-    myGLSSocket->m_crl = 0;
-    myGLSSocket->m_sizeCrl = 0;
-    myGLSSocket->m_sizeMessageRegister = 0;
-    myGLSSocket->m_messageRegister = 0;
     
     /* Mutexs init */
     pthread_mutex_init(&myGLSSocket->m_mutexSendPacket, NULL);
@@ -88,119 +204,10 @@ GLSSock* GLSSocketSecure(const int secureMem, const int sizeMem){
     pthread_mutex_init(&myGLSSocket->m_mutexGlsSend, NULL);
     pthread_mutex_init(&myGLSSocket->m_mutexGlsRecv, NULL);
     
-    /* Debug Only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    myGLSSocket->m_isServeur = 0;
-    #endif
-    
-    /* library gcrypt initialisation */
-    
-    if(m_isCryptoInit == 0) {
-        
-        /* We block other thread to prevent multiple initialisation */
-        m_isCryptoInit = 1;
-        
-        /* 
-         * In case of the library is loaded in a application who also uses libgcrypt,
-         * we check if the library is already initialised 
-         */
-        if (!gcry_control(GCRYCTL_INITIALIZATION_FINISHED_P)) {
-
-            /* Threads management init */
-            gcry_control(GCRYCTL_SET_THREAD_CBS, &gcry_threads_pthread);
-            
-            /* Version check should be the very first call because it
-             makes sure that important subsystems are intialized. */
-            if (!gcry_check_version (GCRYPT_VERSION)) {
-                
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("libgcrypt version mismatch\n");
-                #endif
-                
-                free(myGLSSocket);
-                return 0; 
-            
-            }
-            
-            /*
-             * You can activate the libgcrypt debug but very verbose 
-             */
-            /*
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            gcry_control (GCRYCTL_SET_DEBUG_FLAGS);
-            #endif
-            */
-            
-            if (secureMem == 1) {
-            
-                /* We don’t want to see any warnings, e.g. because we have not yet
-                 parsed program options which might be used to suppress such
-                 warnings. */
-                gcry_control (GCRYCTL_SUSPEND_SECMEM_WARN);
-                
-                /* ... If required, other initialization goes here.  Note that the
-                 process might still be running with increased privileges and that
-                 the secure memory has not been intialized.  */
-                /* Allocate a pool of 16k secure memory.  This make the secure memory
-                 available and also drops privileges where needed.  */
-                gcry_control (GCRYCTL_INIT_SECMEM, sizeMem, 0);
-                
-                /* It is now okay to let Libgcrypt complain when there was/is
-                 a problem with the secure memory. */
-                gcry_control (GCRYCTL_RESUME_SECMEM_WARN);
-                
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Secure Memory initialized\n");
-                #endif
-            
-            }
-                
-            /* ... If required, other initialization goes here.  */
-            /* Tell Libgcrypt that initialization has completed. */
-            gcry_control (GCRYCTL_INITIALIZATION_FINISHED, 0);
-            
-            if (!gcry_control(GCRYCTL_INITIALIZATION_FINISHED_P)) {
-                
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("libgcrypt has not been initialized\n");
-                #endif
-                abort(); 
-                m_isCryptoInit = 0;
-                
-            }
-            
-            /* Test libgcrypt algorithme */
-            int err = gcry_control(GCRYCTL_SELFTEST);
-            if (err != 0) {
-                
-                /* Debug only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Error %d : %s\n", err, gcry_strerror(err));
-                printf("libgcrypt algo test failed\n");
-                #endif
-                abort(); 
-                m_isCryptoInit = 0;
-                
-            }
-            
-            
-        }
-        
-    }
-    else {
-        
-        /* We wait for the first thread to init the libgcrypt library */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("libgcrypt has been initialized\n");
-        #endif
-        sleep(1);
-        
-    }
-    
-    /* Init key1 and key2 into secure memory */
-    myGLSSocket->m_key1 = (byte*) gcry_malloc_secure(32);
-    myGLSSocket->m_key2 = (byte*) gcry_malloc_secure(32);
-    if (myGLSSocket->m_key1 == NULL || myGLSSocket->m_key2 == NULL) {
+    /* Init key1, key2 and the first key into one buffer of secure memory */
+    myGLSSocket->m_key1 = mallocSecure(GLS_SIZE_SECRET);
+    myGLSSocket->m_key2 = myGLSSocket->m_key1 + 32;
+    if (myGLSSocket->m_key1 == NULL) {
         
         /* Debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -289,21 +296,96 @@ int addKeyToArray(const byte* key, byte** (*array), int* size) {
 
 /*-------------------------------------------------------
  
- GLSSocket destructor
+ PRIVATE
+ 
+ Set the variables of a new or recycled socket. The keys,
+ the handlers and the mutexs are not changed.
  
  ---------------------------------------------------------*/
 
-void freeGLSSocket(GLSSock* myGLSSocket){
+void initGLSSocketVariables(GLSSock* myGLSSocket) {
     
-    /* Debug only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### CloseGLSSocket() Start ###\n");
-    printf("Deleting socket...\n");
-    #endif
+    myGLSSocket->m_sock = 0;
+    myGLSSocket->m_isSocketConfig = 0;
+    myGLSSocket->m_isCryptoKey = 0;
+    myGLSSocket->m_isUserConfig = 0;
+    myGLSSocket->m_connexionType = 0;
+    myGLSSocket->m_messageHelloEncrypt = 0;
+    myGLSSocket->m_idUser = 0;
+    myGLSSocket->m_sizeIdUser = 0;
+    myGLSSocket->m_sizeMessageHelloEncrypt = 0;
+    myGLSSocket->m_isHandShakeFinish = 0;
+    myGLSSocket->m_sizeKeys = 0;
+    myGLSSocket->m_keys = 0;
+    myGLSSocket->m_infoClient = 0;
+    myGLSSocket->m_roots = 0;
+    myGLSSocket->m_serverCert = 0;
+    myGLSSocket->m_crl = 0;
+    myGLSSocket->m_sizeMessageRegister = 0;
+    myGLSSocket->m_messageRegister = 0;
+    myGLSSocket->m_sizeMessageRegisterEncrypt = 0;
+    myGLSSocket->m_messageRegisterEncrypt = 0;
+    myGLSSocket->m_handShake = 0;
+    myGLSSocket->m_sendWindow = 1;
+    myGLSSocket->m_sendSeq = 0;
+    myGLSSocket->m_ackSeq = 0;
+    myGLSSocket->m_recvSeq = 0;
+    myGLSSocket->m_nbRetry = 0;
+    myGLSSocket->m_isRecvRecovery = 0;
+    myGLSSocket->m_inFlight = 0;
+    myGLSSocket->m_sizeInFlight = 0;
+    myGLSSocket->m_recvQueue = 0;
+    myGLSSocket->m_sizeRecvQueue = 0;
+    myGLSSocket->m_firstRecvQueue = 0;
+    myGLSSocket->m_nbRecvQueue = 0;
+    myGLSSocket->m_maxRecvQueue = 0;
+    myGLSSocket->m_cipherSuite = GLS_SUITE_SERPENT_TWOFISH;
+    myGLSSocket->m_activeSuite = GLS_SUITE_SERPENT_TWOFISH;
+    myGLSSocket->m_peerVersion = 0;
+    myGLSSocket->m_isAeadInit = 0;
+    myGLSSocket->m_aeadSendSeq = 0;
+    myGLSSocket->m_aeadRecvSeq = 0;
+    myGLSSocket->m_isHmacInit = 0;
+    myGLSSocket->m_ctrHandler = 0;
+    myGLSSocket->m_ivPool = 0;
+    myGLSSocket->m_sizeIvPool = GLS_SIZE_IV_POOL;
+    myGLSSocket->m_posIvPool = 0;
+    myGLSSocket->m_timeInFlight = 0;
+    myGLSSocket->m_maxInFlight = 0;
+    myGLSSocket->m_isEventLoop = 0;
+    myGLSSocket->m_outBuffer = 0;
+    myGLSSocket->m_sizeOutBuffer = 0;
+    myGLSSocket->m_posOutBuffer = 0;
+    myGLSSocket->m_maxOutBuffer = 0;
+    memset(&myGLSSocket->m_statsHandShake, 0, sizeof(GLSStats));
+    memset(&myGLSSocket->m_statsSend, 0, sizeof(GLSStats));
+    memset(&myGLSSocket->m_statsRecv, 0, sizeof(GLSStats));
+    
+    /* The side of the connexion is used by the AEAD nonces */
+    myGLSSocket->m_isServeur = 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Close the connexion of a socket and free everything
+ belonging to it, the keys are wiped. The keys buffers,
+ the handlers and the mutexs stay for freeGLSSocket() or
+ for a new connexion (recycleGLSSocket()).
+ 
+ ---------------------------------------------------------*/
+
+void clearGLSSocket(GLSSock* myGLSSocket) {
     
     /* Closing socket */
     shutdown(myGLSSocket->m_sock, SHUT_RDWR);
     closesocket(myGLSSocket->m_sock);
+    myGLSSocket->m_sock = INVALID_SOCKET;
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -325,34 +407,7 @@ void freeGLSSocket(GLSSock* myGLSSocket){
         #endif
         
         /* Key iteration and wipe */
-        int i = 0;
-        for(i = 0; i < myGLSSocket->m_sizeKeys; i++)
-        {
-            byte* myKey = (byte*) myGLSSocket->m_keys[i];
-            
-            int y = 0;
-            for (y = 0; y < 64; y++) {
-                
-                myKey[y] = 0; 
-                myKey[y] = 1; 
-                myKey[y] = 2; 
-                
-            }
-            
-            gcry_free(myKey);
-            
-        }
-        
-        if (myGLSSocket->m_keys != NULL) {
-            
-            free(myGLSSocket->m_keys);
-            
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("Free m_keys\n");
-            #endif
-            
-        }
-        
+        freeKeys(myGLSSocket);
         myGLSSocket->m_isCryptoKey = 0;
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -361,45 +416,53 @@ void freeGLSSocket(GLSSock* myGLSSocket){
     
     }
     
-    /* Wipe de key1 */
+    /* Wipe de key1 and key2, kept for the next connexion */
     int i = 0;
     for (i = 0; i < 32; i++) {
         myGLSSocket->m_key1[i] = 0;
         myGLSSocket->m_key1[i] = 1;
         myGLSSocket->m_key1[i] = 2;
-    }
-    gcry_free(myGLSSocket->m_key1);
-    myGLSSocket->m_key1 = 0;
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Wiping key1\n");
-    #endif
-    
-    /* Wipe de key2 */
-    for (i = 0; i < 32; i++) {
         myGLSSocket->m_key2[i] = 0;
         myGLSSocket->m_key2[i] = 1;
         myGLSSocket->m_key2[i] = 2;
     }
-    gcry_free(myGLSSocket->m_key2);
-    myGLSSocket->m_key2 = 0;
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Wiping key2\n");
+    printf("Wiping key1 and key2\n");
     #endif
     
-    if (myGLSSocket->m_isHandlerInit) {
+    /* Closing AEAD handler */
+    if (myGLSSocket->m_isAeadInit) {
         
-        /* Closing handlers */
-        gcry_cipher_close(myGLSSocket->m_serpentHandlerCTS);
-        gcry_cipher_close(myGLSSocket->m_twofishHandlerCTS);
-        gcry_cipher_close(myGLSSocket->m_serpentHandlerECB);
-        gcry_cipher_close(myGLSSocket->m_twofishHandlerECB);
+        gcry_cipher_close(myGLSSocket->m_aeadHandler);
+        myGLSSocket->m_isAeadInit = 0;
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Delete handler OK\n");
+        printf("Delete AEAD handler OK\n");
         #endif
         
     }
     
+    /* Closing HMAC handlers of the CTR cascade (the key is wiped by libgcrypt) */
+    if (myGLSSocket->m_isHmacInit) {
+        
+        gcry_md_close(myGLSSocket->m_hmacSendHandler);
+        gcry_md_close(myGLSSocket->m_hmacRecvHandler);
+        myGLSSocket->m_isHmacInit = 0;
+        
+    }
+    
+    /* Closing cipher handlers of the CTR cascade */
+    closeCtrHandler(myGLSSocket);
+    
+    /* Wipe IV pool */
+    if (myGLSSocket->m_ivPool != NULL) {
+        
+        memset(myGLSSocket->m_ivPool, 0, myGLSSocket->m_sizeIvPool);
+        free(myGLSSocket->m_ivPool);
+        myGLSSocket->m_ivPool = 0;
+        
+    }
+    
     /* If user set */
     if (myGLSSocket->m_isUserConfig) {
         
@@ -429,7 +492,29 @@ void freeGLSSocket(GLSSock* myGLSSocket){
         
     }
     
-    /* if encrypted register message still in memory */
+    /* if the handshake never finished */
+    if (myGLSSocket->m_handShake != NULL) {
+        
+        if (myGLSSocket->m_handShake->m_notify != INVALID_SOCKET) stopResolveWait(myGLSSocket->m_handShake->m_notify);
+        if (myGLSSocket->m_handShake->m_address != NULL) free(myGLSSocket->m_handShake->m_address);
+        if (myGLSSocket->m_handShake->m_port != NULL) free(myGLSSocket->m_handShake->m_port);
+        if (myGLSSocket->m_handShake->m_firstMessage != NULL) free(myGLSSocket->m_handShake->m_firstMessage);
+        if (myGLSSocket->m_handShake->m_message != NULL) free(myGLSSocket->m_handShake->m_message);
+        free(myGLSSocket->m_handShake);
+        myGLSSocket->m_handShake = 0;
+        
+    }
+    
+    /* if encrypted register message never read */
+    if (myGLSSocket->m_messageRegisterEncrypt != NULL) {
+        
+        free(myGLSSocket->m_messageRegisterEncrypt);
+        myGLSSocket->m_messageRegisterEncrypt = 0;
+        myGLSSocket->m_sizeMessageRegisterEncrypt = 0;
+        
+    }
+    
+    /* if decrypted register message still in memory */
     if (myGLSSocket->m_messageRegister != NULL) {
         
         free(myGLSSocket->m_messageRegister);
@@ -441,85 +526,225 @@ void freeGLSSocket(GLSSock* myGLSSocket){
         #endif
         
     }
-    
-    /* deleting addrInfo (client mode) */
-    if (myGLSSocket->m_infoConnexion != NULL) {
         
-        freeaddrinfo(myGLSSocket->m_infoConnexion);
-        myGLSSocket->m_infoConnexion = 0;
+    /* Release CRL (client mode), it can be shared with other sockets */
+    if (myGLSSocket->m_crl != NULL) {
+        
+        releaseCrl(myGLSSocket->m_crl);
+        myGLSSocket->m_crl = 0;
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Delete infoConnexion OK\n");
+        printf("Delete CRL OK\n");
         #endif
         
     }
+    
+    /* Freeing root certificates */
+    if (myGLSSocket->m_roots != NULL) {
         
-    /* Delete CRL (client mode) */
-    if (myGLSSocket->m_sizeCrl > 0) {
+        releaseRootList(myGLSSocket->m_roots);
+        myGLSSocket->m_roots = 0;
+    
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Delete Root Certificate OK\n");
+        #endif
         
-        /* ID iteration and wipe wipe */
-        int i = 0;
-        for(i = 0; i < myGLSSocket->m_sizeCrl; i++)
-        {
-            byte* myKey = (byte*) myGLSSocket->m_crl[i];
-            
-            free(myKey);
-            
-        }
+    }
+
+    /* Server certificate and private key shared with the server */
+    if (myGLSSocket->m_serverCert != NULL) {
         
-        if (myGLSSocket->m_crl != NULL) {
-            
-            free(myGLSSocket->m_crl);
+        releaseServerCert(myGLSSocket->m_serverCert);
+        myGLSSocket->m_serverCert = 0;
+        
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Release Server Certificate OK\n");
+        #endif
+        
+    }
+    
+    /* Freeing messages waiting for an acknowledgement */
+    if (myGLSSocket->m_inFlight != NULL) {
+        
+        for (i = 0; i < myGLSSocket->m_maxInFlight; i++) {
             
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("Free m_crl\n");
-            #endif
+            if (myGLSSocket->m_inFlight[i] != NULL) free(myGLSSocket->m_inFlight[i]);
             
         }
         
-        myGLSSocket->m_sizeCrl = 0;
+        free(myGLSSocket->m_inFlight);
+        myGLSSocket->m_inFlight = 0;
+        free(myGLSSocket->m_sizeInFlight);
+        myGLSSocket->m_sizeInFlight = 0;
+        free(myGLSSocket->m_timeInFlight);
+        myGLSSocket->m_timeInFlight = 0;
+        myGLSSocket->m_maxInFlight = 0;
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Delete CRL OK\n");
+        printf("Delete In Flight Messages OK\n");
         #endif
         
     }
     
-    /* Freeing root certificate */
-    if (myGLSSocket->m_certRoot != NULL) {
+    /* Freeing the packets never sent to an event loop client */
+    if (myGLSSocket->m_outBuffer != NULL) {
         
-        free(myGLSSocket->m_certRoot);
-        myGLSSocket->m_certRoot = 0;
-        myGLSSocket->m_certRootSize = 0;
+        free(myGLSSocket->m_outBuffer);
+        myGLSSocket->m_outBuffer = 0;
+        myGLSSocket->m_sizeOutBuffer = 0;
+        myGLSSocket->m_posOutBuffer = 0;
+        myGLSSocket->m_maxOutBuffer = 0;
+        
+    }
     
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Delete Root Certificate OK\n");
-        #endif
+    /* Freeing messages read by glsSend() and never given to glsRecv() */
+    if (myGLSSocket->m_recvQueue != NULL) {
+        
+        for (i = 0; i < myGLSSocket->m_nbRecvQueue; i++) {
+            
+            free(myGLSSocket->m_recvQueue[myGLSSocket->m_firstRecvQueue + i]);
+            
+        }
+        
+        free(myGLSSocket->m_recvQueue);
+        myGLSSocket->m_recvQueue = 0;
+        free(myGLSSocket->m_sizeRecvQueue);
+        myGLSSocket->m_sizeRecvQueue = 0;
+        myGLSSocket->m_firstRecvQueue = 0;
+        myGLSSocket->m_nbRecvQueue = 0;
+        myGLSSocket->m_maxRecvQueue = 0;
         
     }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Prepare a socket for a new connexion like a socket of
+ GLSSocketSecure(). The handlers are kept but their keys
+ are replaced by the wiped keys and their state is reset,
+ nothing of the old connexion stays in the handlers.
+ 
+ Return 0 for success, a negative number for an error
+ (the socket must then be freed).
+ 
+ ---------------------------------------------------------*/
+
+int recycleGLSSocket(GLSSock* myGLSSocket) {
+    
+    clearGLSSocket(myGLSSocket);
+    
+    if (resetHandler(myGLSSocket) != 0) return GLS_ERROR_CRYPTO;
+    
+    initGLSSocketVariables(myGLSSocket);
+    myGLSSocket->m_sock = INVALID_SOCKET;
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Return a buffer of 64 bytes for the next key of m_keys,
+ the first key is in the secure buffer of key1 and key2.
+ 
+ Return NULL if the secure memory is full.
+ 
+ ---------------------------------------------------------*/
+
+byte* newKeyBuffer(GLSSock* myGLSSocket) {
+    
+    if (myGLSSocket->m_sizeKeys == 0) return myGLSSocket->m_key1 + 64;
+    
+    return mallocSecure(64);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Wipe and free the keys of m_keys and the array.
+ 
+ ---------------------------------------------------------*/
 
-    /* Freeing public certificate */
-    if (myGLSSocket->m_publicCert != NULL) {
+void freeKeys(GLSSock* myGLSSocket) {
+    
+    int i = 0;
+    for(i = 0; i < myGLSSocket->m_sizeKeys; i++) {
+        
+        byte* myKey = (byte*) myGLSSocket->m_keys[i];
+        
+        /* The first key stays with key1 and key2 */
+        if (myKey == myGLSSocket->m_key1 + 64) memset(myKey, 0, 64);
+        else freeSecure(myKey, 64);
+        
+    }
+    
+    if (myGLSSocket->m_keys != NULL) {
         
-        free(myGLSSocket->m_publicCert);
-        myGLSSocket->m_publicCert = 0;
-        myGLSSocket->m_publicCertSize = 0;
+        free(myGLSSocket->m_keys);
+        myGLSSocket->m_keys = 0;
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Delete Public Certificate OK\n");
+        printf("Free m_keys\n");
         #endif
         
     }
     
-    /* Freeing private key */
-    if (myGLSSocket->m_privateKey != NULL) {
+    myGLSSocket->m_sizeKeys = 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ GLSSocket destructor
+ 
+ ---------------------------------------------------------*/
+
+void freeGLSSocket(GLSSock* myGLSSocket){
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### CloseGLSSocket() Start ###\n");
+    printf("Deleting socket...\n");
+    #endif
+    
+    /* Connexion closed and keys wiped */
+    clearGLSSocket(myGLSSocket);
+    
+    freeSecure(myGLSSocket->m_key1, GLS_SIZE_SECRET);
+    myGLSSocket->m_key1 = 0;
+    myGLSSocket->m_key2 = 0;
+    
+    if (myGLSSocket->m_isHandlerInit) {
         
-        gcry_free(myGLSSocket->m_privateKey);
-        myGLSSocket->m_privateKey = 0;
-        myGLSSocket->m_privateKeySize = 0;
+        /* Closing handlers */
+        gcry_cipher_close(myGLSSocket->m_serpentHandlerCTS);
+        gcry_cipher_close(myGLSSocket->m_twofishHandlerCTS);
+        gcry_cipher_close(myGLSSocket->m_serpentHandlerECB);
+        gcry_cipher_close(myGLSSocket->m_twofishHandlerECB);
+        gcry_md_close(myGLSSocket->m_macSendHandler);
+        gcry_md_close(myGLSSocket->m_macRecvHandler);
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Delete Private Key OK\n");
+        printf("Delete handler OK\n");
         #endif
         
     }
@@ -608,8 +833,8 @@ int getTypeGLS(const byte* message, const int size) {
         /* If message is hello type, checking for hello server Type */
         if (i == 5) {
             
-            /* If message size is the same as Hello Server type */
-            if (size == 22) {
+            /* If message size is the same as Hello Server type (with or without suite) */
+            if (size == 22 || size == 31) {
                 
                 /* Debug Only */
                 #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -1020,6 +1245,57 @@ int getNumError(const byte* message, const int size) {
 
 
 
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Return the cipher suite chosen by the server in the
+ Hello Server message (GLS/1.2 HELLO SERVER + SUITE x),
+ GLS_SUITE_SERPENT_TWOFISH if there isn't any or a
+ negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int getSuiteGLS(const byte* message, const int size) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### getSuiteGLS() Start ###\n");
+    #endif
+    
+    /* Hello Server message without suite */
+    if (size == 22) return GLS_SUITE_SERPENT_TWOFISH;
+    
+    /* Size of the Hello Server message with suite */
+    if (size != 31) return GLS_ERROR_MSGSIZE;
+    
+    /* bytes check */
+    char suite[7] = "SUITE ";
+    int i = 0;
+    for (i = 0; i < 6; i++) {
+        
+        if (toupper(message[i + 22]) != suite[i]) return GLS_ERROR_UNKNOWN;
+        
+    }
+    if (message[29] != 13 || message[30] != 10) return GLS_ERROR_UNKNOWN;
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Suite : %c\n", message[28]);
+    printf("### getSuiteGLS() End ###\n\n");
+    #endif
+    
+    /* Suites known by this version */
+    if (message[28] == '1') return GLS_SUITE_AES256_GCM;
+    else if (message[28] == '2') return GLS_SUITE_CHACHA20_POLY1305;
+    else if (message[28] == '3') return GLS_SUITE_SERPENT_TWOFISH_CTR;
+    else return GLS_ERROR_OPNOTSUPP;
+    
+}
+
+
+
+
 /*-------------------------------------------------------
  
  PRIVATE
@@ -1028,7 +1304,7 @@ int getNumError(const byte* message, const int size) {
  information from a GLS message. Return 0 for success, 
  a negative number for an error. 
  
- Used by _acceptConnexion(). Do not confuse with setUserId()
+ Used by acceptSecondMessage(). Do not confuse with setUserId()
  and getUserId().
  
  ---------------------------------------------------------*/
@@ -1118,510 +1394,368 @@ int setIdGLS(GLSSock* myGLSSocket, const byte* message, const int size) {
  
  PRIVATE
  
- Accept connexion from the socket server and configure the
- GLSSocket according to the GLS negociation.
+ New handshake in progress (client or server side), it
+ must finish before GLS_TIMEOUT_HANDSHAKE seconds.
+ Return the handshake or NULL if no memory.
+ 
+ ---------------------------------------------------------*/
+
+GLSHandShake* newHandShake(const int state) {
+    
+    GLSHandShake* handShake = malloc(sizeof(GLSHandShake));
+    if (handShake == NULL) return 0;
+    
+    handShake->m_state = state;
+    handShake->m_deadline = time(NULL) + GLS_TIMEOUT_HANDSHAKE;
+    handShake->m_timePhase = getTimeMicro();
+    handShake->m_typeMessage = 0;
+    handShake->m_address = 0;
+    handShake->m_port = 0;
+    handShake->m_notify = INVALID_SOCKET;
+    handShake->m_firstMessage = 0;
+    handShake->m_sizeFirstMessage = 0;
+    handShake->m_sizeHeader = 0;
+    handShake->m_sizePacket = -1;
+    handShake->m_sizeRecv = 0;
+    handShake->m_message = 0;
+    handShake->m_size = 0;
+    handShake->m_capacity = 0;
+    handShake->m_nbMacError = 0;
+    handShake->m_nbDiscard = 0;
+    
+    return handShake;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Start the server side handshake of a connexion already
+ accepted in m_sock. Nothing is read here, the handshake
+ goes on with _stepAcceptConnexion() when the socket is
+ ready.
  Return 0 for success, a negative number for an error.
  
  ---------------------------------------------------------*/
 
-int _acceptConnexion(GLSSock* myGLSSocket, const int socketServer){
+int _startAcceptConnexion(GLSSock* myGLSSocket) {
+    
+    /* The socket is already connected */
+    if (myGLSSocket->m_isSocketConfig != 0 || myGLSSocket->m_handShake != NULL) return GLS_ERROR_ISCONN;
+    
+    GLSHandShake* handShake = newHandShake(GLS_ACCEPT_ACCEPTED);
+    if (handShake == NULL) return GLS_ERROR_NOMEM;
+    
+    /* Server side of the connexion */
+    myGLSSocket->m_isServeur = 1;
+    myGLSSocket->m_handShake = handShake;
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Go on with the handshake of _startAcceptConnexion() with
+ the bytes waiting on the socket, without blocking :
+ ACCEPTED -> HELLO_PLAIN -> HELLO_CIPHER -> READY.
+ The GLSSocket is configured according to the GLS
+ negociation at the READY state.
+ Return 0 when the handshake is finished, GLS_ERROR_AGAIN
+ to wait for the socket or another negative number for
+ an error.
+ 
+ ---------------------------------------------------------*/
+
+int _stepAcceptConnexion(GLSSock* myGLSSocket) {
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### acceptConnexion() Start ###\n");
+    printf("### stepAcceptConnexion() Start ###\n");
     #endif
     
-    if (myGLSSocket->m_isSocketConfig == 0) {
+    GLSHandShake* handShake = myGLSSocket->m_handShake;
+    if (handShake == NULL) return GLS_ERROR_INVAL;
+    if (handShake->m_state == GLS_ACCEPT_READY) return 0;
+    
+    /* A slow client can't keep its place forever */
+    if (time(NULL) > handShake->m_deadline) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        myGLSSocket->m_isServeur = 1;
+        printf("Handshake too long\n");
+        printf("### stepAcceptConnexion() End ###\n\n");
         #endif
         
-        /* Accept the client connexion */
-        socklen_t addr_size = sizeof(myGLSSocket->m_infoClient);
-        myGLSSocket->m_sock = accept(socketServer, (struct sockaddr*) &myGLSSocket->m_infoClient, &addr_size);
-        if (myGLSSocket->m_sock < 0) {
-            
-            /* Getting socket error */
-            int numError = errno;
+        myGLSSocket->m_statsHandShake.m_nbHandShakeError++;
+        
+        return GLS_ERROR_TIMEDOUT;
+        
+    }
+    
+    if (handShake->m_state == GLS_ACCEPT_ACCEPTED) handShake->m_state = GLS_ACCEPT_HELLO_PLAIN;
+    
+    /* The second message can already be on the socket after the first one */
+    while (handShake->m_state != GLS_ACCEPT_READY) {
+        
+        byte (*message) = 0;
+        int sizeMessage = recvPacketNoWait(myGLSSocket, &message);
+        if (sizeMessage < 0) {
             
-            /* Debug only */
+            /* Debug Only */
             #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("Error accept()\n");
-            printf("### acceptConnexion() End ###\n\n");
+            if (sizeMessage != GLS_ERROR_AGAIN) printf("Error handshake (%d)\n", sizeMessage);
+            printf("### stepAcceptConnexion() End ###\n\n");
             #endif
             
-            /* Return accept() error */
-            switch (numError) {
-                    
-                case EAGAIN :
-                    return GLS_ERROR_AGAIN;
-                    break;
-                    
-                case EBADF :
-                    return GLS_ERROR_BADF;
-                    break;
-                    
-                case ECONNABORTED :
-                    return GLS_ERROR_CONNABORTED;
-                    break;
-                    
-                case EINTR :
-                    return GLS_ERROR_INTR;
-                    break;
-                    
-                case EINVAL :
-                    return GLS_ERROR_INVAL;
-                    break;
-                    
-                case EMFILE :
-                    return GLS_ERROR_MFILE;
-                    break;
-                    
-                case ENFILE :
-                    return GLS_ERROR_NFILE;
-                    break;
-                    
-                case ENOBUFS :
-                    return GLS_ERROR_NOBUFS;
-                    break;
-                    
-                case ENOMEM :
-                    return GLS_ERROR_NOMEM;
-                    break;
-                    
-                case ENOTSOCK :
-                    return GLS_ERROR_NOTSOCK;
-                    break;
-                    
-                case EOPNOTSUPP :
-                    return GLS_ERROR_OPNOTSUPP;
-                    break;
-                    
-                case EPROTO :
-                    return GLS_ERROR_PROTO;
-                    break;
-                    
-                case EPERM :
-                    return GLS_ERROR_PERM;
-                    break;
-                    
-                case ENOSR :
-                    return GLS_ERROR_NOSR;
-                    break;
-                    
-                case ESOCKTNOSUPPORT :
-                    return GLS_ERROR_SOCKTNOSUPPORT;
-                    break;
-                    
-                case EPROTONOSUPPORT :
-                    return GLS_ERROR_PROTONOSUPPORT;
-                    break;
-                    
-                case ETIMEDOUT :
-                    return GLS_ERROR_TIMEDOUT;
-                    break;
-                    
-                default:
-                    return GLS_ERROR_UNKNOWN;
-                    break;
-                    
-            }
+            if (sizeMessage != GLS_ERROR_AGAIN) myGLSSocket->m_statsHandShake.m_nbHandShakeError++;
+            
+            return sizeMessage;
             
         }
         
-        /* Receiving the first message from client in plaintext */
-        byte (*firstMessage) = 0;
-        int sizeFirstMessage = recvPacket(myGLSSocket, &firstMessage, 0);
-        /* if error return it */
-        if (sizeFirstMessage < 0) {
-            
-            if (firstMessage != NULL) {
-                
-                free(firstMessage);
-                firstMessage = 0;
+        int error = 0;
+        int phase = GLS_PHASE_HELLO;
+        if (handShake->m_state == GLS_ACCEPT_HELLO_PLAIN) {
             
-            }
+            /* Hello or Register message in plaintext */
+            error = acceptFirstMessage(myGLSSocket, message, sizeMessage);
+            if (error == 0) handShake->m_state = GLS_ACCEPT_HELLO_CIPHER;
             
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### acceptConnexion() End ###\n\n");
-            #endif
+        }
+        else {
             
-            return sizeFirstMessage;
+            /* Hello or Register message in ciphertext */
+            phase = GLS_PHASE_HELLO_CIPHER;
+            error = acceptSecondMessage(myGLSSocket, message, sizeMessage);
+            if (error == 0) handShake->m_state = GLS_ACCEPT_READY;
             
         }
         
-        /* Getting GLS Client version */
-        int version = getVersionGLS(firstMessage, sizeFirstMessage);
-        if (version < 11) {
-            
-            /* If the version is less than 1.1 => send an error message */
-            byte error[24] = "GLS/1.1 ERROR 200 1.1  ";
-            error[21] = 13;
-            error[22] = 10;
-            /* Sending 23 bytes to remove the '\0' from the string */
-            sendPacket(myGLSSocket, error, 23);
-            
-            /* Freeing memory */
-            if (firstMessage != NULL) {
-                
-                free(firstMessage);
-                firstMessage = 0;
-                
-            }
+        if (error != 0) {
             
             /* Debug Only */
             #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### acceptConnexion() End ###\n\n");
+            printf("### stepAcceptConnexion() End ###\n\n");
             #endif
             
-            return GLS_ERROR_VERSION;
+            myGLSSocket->m_statsHandShake.m_nbHandShakeError++;
+            
+            return error;
             
         }
         
-        /* Message type check to know how to handle it */
-        int typeMessage = getTypeGLS(firstMessage, sizeFirstMessage);
+        /* Duration of the phase, from the accept() or the previous message */
+        unsigned long long timePhase = getTimeMicro();
+        myGLSSocket->m_statsHandShake.m_handShakeTime[phase] += timePhase - handShake->m_timePhase;
+        handShake->m_timePhase = timePhase;
         
-        if (typeMessage == GLS_TYPE_HELLO) {
-            
-            /* Cleaning memory */
-            if (myGLSSocket->m_messageHelloEncrypt != NULL) free(myGLSSocket->m_messageHelloEncrypt);
-            
-            /* Receiving second message from client in ciphertext */
-            int sizeSecondMessage = recvPacket(myGLSSocket, &myGLSSocket->m_messageHelloEncrypt, 1);
-            /* Return the error if exist */
-            if (sizeSecondMessage < 0) {
-                
-                if (myGLSSocket->m_messageHelloEncrypt != NULL) {
-                    
-                    free(myGLSSocket->m_messageHelloEncrypt);
-                    myGLSSocket->m_messageHelloEncrypt = 0;
-                
-                }
-                
-                if (firstMessage != NULL) {
-                    
-                    free(firstMessage);
-                    firstMessage = 0;
-                    
-                }
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### acceptConnexion() End ###\n\n");
-                #endif
-                
-                /* return error */
-                return sizeSecondMessage;
-                
-            }
-            else myGLSSocket->m_sizeMessageHelloEncrypt = sizeSecondMessage;
-            
-            /* Configure user's id with the first message in plaintext */
-            int numError = setIdGLS(myGLSSocket, firstMessage, sizeFirstMessage);
-            if (numError != 0) {
-                
-                /* If no ID in the message send an error */
-                byte error[20] = "GLS/1.1 ERROR 401  ";
-                error[17] = 13;
-                error[18] = 10;
-                /* sending 19 bytes to remove the '\0' from the string */
-                sendPacket(myGLSSocket, error, 19);
-                
-                if (firstMessage != NULL) {
-                    
-                    free(firstMessage);
-                    firstMessage = 0;
-                
-                }
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### acceptConnexion() End ###\n\n");
-                #endif
-                
-                /* return error */
-                return numError;
-                
-            }
-            
-            /* Configure the socket with the connexion type */
-            myGLSSocket->m_connexionType = GLS_CONNEXION_STANDARD;
-            myGLSSocket->m_isSocketConfig = 1;
-            
+    }
+    
+    myGLSSocket->m_statsHandShake.m_nbHandShake++;
+    
+    /* The first message is not needed anymore */
+    if (handShake->m_firstMessage != NULL) {
+        
+        free(handShake->m_firstMessage);
+        handShake->m_firstMessage = 0;
+        handShake->m_sizeFirstMessage = 0;
+        
+    }
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### stepAcceptConnexion() End ###\n\n");
+    #endif
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ First message of the handshake in plaintext (Hello or
+ Register). The message is kept by the socket for the
+ second one, the certificate is sent for a Register
+ message.
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int acceptFirstMessage(GLSSock* myGLSSocket, byte* firstMessage, const int sizeFirstMessage) {
+    
+    GLSHandShake* handShake = myGLSSocket->m_handShake;
+    handShake->m_firstMessage = firstMessage;
+    handShake->m_sizeFirstMessage = sizeFirstMessage;
+    
+    /* Getting GLS Client version */
+    int version = getVersionGLS(firstMessage, sizeFirstMessage);
+    if (version < 11) {
+        
+        /* If the version is less than 1.1 => send an error message */
+        byte error[24] = "GLS/1.1 ERROR 200 1.1  ";
+        error[21] = 13;
+        error[22] = 10;
+        /* Sending 23 bytes to remove the '\0' from the string */
+        sendPacket(myGLSSocket, error, 23);
+        
+        return GLS_ERROR_VERSION;
+        
+    }
+    
+    /* The client offers the AEAD suites since GLS/1.2 */
+    myGLSSocket->m_peerVersion = version;
+    
+    /* Message type check to know how to handle it */
+    handShake->m_typeMessage = getTypeGLS(firstMessage, sizeFirstMessage);
+    
+    if (handShake->m_typeMessage == GLS_TYPE_HELLO) {
+        
+        /* The encrypted Hello message comes next */
+        return 0;
+        
+    }
+    else if (handShake->m_typeMessage == GLS_TYPE_REGISTER) {
+        
+        /* Creating [Regiser Server + certificat] message */
+        byte registerServer[26] = "GLS/1.1 REGISTER SERVER  ";
+        registerServer[23] = 13;
+        registerServer[24] = 10;
+        
+        /* GLS/1.2 encrypts the register message with a session key */
+        if (version >= 12) registerServer[6] = '2';
+        int sizePublicCert = 0;
+        if (myGLSSocket->m_serverCert != NULL) sizePublicCert = myGLSSocket->m_serverCert->m_publicCertSize;
+        int sizeRegisterServerCertificate = 25 + sizePublicCert;
+        byte *registerServerCertificate = 0;
+        registerServerCertificate = malloc(sizeRegisterServerCertificate);
+        if (registerServerCertificate == NULL) return GLS_ERROR_NOMEM;
+        
+        int i = 0;
+        for (i = 0; i < 25; i++) {
+            registerServerCertificate[i] = registerServer[i];
         }
-        else if (typeMessage == GLS_TYPE_REGISTER) {
-            
-            /* Creating [Regiser Server + certificat] message */
-            byte registerServer[26] = "GLS/1.1 REGISTER SERVER  ";
-            registerServer[23] = 13;
-            registerServer[24] = 10;
-            int sizeRegisterServerCertificate = 25 + myGLSSocket->m_publicCertSize;
-            byte *registerServerCertificate = 0;
-            registerServerCertificate = malloc(sizeRegisterServerCertificate);
-            if (registerServerCertificate == NULL) {
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### acceptConnexion() End ###\n\n");
-                #endif
-                
-                /* Freeing memory */
-                if (firstMessage != NULL) {
-                    
-                    free(firstMessage);
-                    firstMessage = 0;
-                    
-                }
-                
-                /* return error */
-                return GLS_ERROR_NOMEM;
-                
-            }
-            int i = 0;
-            for (i = 0; i < 25; i++) {
-                registerServerCertificate[i] = registerServer[i];
-            }
-            for (i = 0; i < myGLSSocket->m_publicCertSize; i++) {
-                registerServerCertificate[i + 25] = myGLSSocket->m_publicCert[i];
-            }
-            
-            /* sending Register Server with certificat */
-            int error = sendPacket(myGLSSocket, registerServerCertificate, sizeRegisterServerCertificate);
-            if (error < 0) {
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### acceptConnexion() End ###\n\n");
-                #endif
-                
-                /* Freeing memory */
-                if (firstMessage != NULL) {
-                    
-                    free(firstMessage);
-                    firstMessage = 0;
-                    
-                }
-                if (registerServerCertificate != NULL) {
-                    
-                    free(registerServerCertificate);
-                    registerServerCertificate = 0;
-                    
-                }
-                
-                /* Return error */
-                return GLS_ERROR_NOMEM;
-                
-            }
-            
-            /* Getting encrypted register message from client */
-            byte (*secondMessage) = 0;
-            int sizeSecondMessage = recvPacket(myGLSSocket, &secondMessage, 1);
-            /* If error using the recvPacket() */
-            if (sizeSecondMessage < 0) {
-                
-                /* freeing memory */
-                if (firstMessage != NULL) {
-                    
-                    free(firstMessage);
-                    firstMessage = 0;
-                    
-                }
-                if (registerServerCertificate != NULL) {
-                    
-                    free(registerServerCertificate);
-                    registerServerCertificate = 0;
-                    
-                }
-                if (secondMessage != NULL) {
-                    
-                    free(secondMessage);
-                    secondMessage = 0;
-                    
-                }
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### acceptConnexion() End ###\n\n");
-                #endif
-                
-                /* return error */
-                return sizeSecondMessage;
-                
-            }
-            
-            /* Sending Register Server OK */
-            byte registerServerOk[29] = "GLS/1.1 REGISTER SERVER OK  ";
-            registerServerOk[26] = 13;
-            registerServerOk[27] = 10;
-            /* sending 28 bytes to remove the '\0' from the string */
-            error = sendPacket(myGLSSocket, registerServerOk, 28);
-            if (error < 0) {
-                
-                /* Freeing memory */
-                if (firstMessage != NULL) {
-                    
-                    free(firstMessage);
-                    firstMessage = 0;
-                    
-                }
-                if (registerServerCertificate != NULL) {
-                    
-                    free(registerServerCertificate);
-                    registerServerCertificate = 0;
-                    
-                }
-                if (secondMessage != NULL) {
-                    
-                    free(secondMessage);
-                    secondMessage = 0;
-                    
-                }
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### acceptConnexion() End ###\n\n");
-                #endif
-                
-                /* return error */
-                return error;
-                
-            }
-            
-            /* Closing socket */
-            shutdown(myGLSSocket->m_sock, SHUT_RDWR);
-            closesocket(myGLSSocket->m_sock);
-            
-            /*
-             * The next part cause a DOS when too many message are 
-             * decrypted in _acceptConnexion() because you can't 
-             * thread it, the decryption part will be moved on the 
-             * getRegisterMessage() function to prevent it. I initialy
-             * put this part here to prevent false positive and only
-             * give a working socket to the user with waitForClient().
-             */
-            
-            /* We decrypt the message after closing the connexion to prevent timings attacks */
-            byte *decryptMessage = 0;
-            int sizeDecryptMessage = decryptWithPK(myGLSSocket, secondMessage, sizeSecondMessage, &decryptMessage);
-            if (sizeDecryptMessage < 0) {
-                
-                /* On vide la mémoire */
-                if (firstMessage != NULL) {
-                    
-                    free(firstMessage);
-                    firstMessage = 0;
-                    
-                }
-                if (registerServerCertificate != NULL) {
-                    
-                    free(registerServerCertificate);
-                    registerServerCertificate = 0;
-                    
-                }
-                if (secondMessage != NULL) {
-                    
-                    free(secondMessage);
-                    secondMessage = 0;
-                    
-                }
-                if (decryptMessage != NULL) {
-                    
-                    free(decryptMessage);
-                    decryptMessage = 0;
-                    
-                }
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### acceptConnexion() End ###\n\n");
-                #endif
-                
-                /* return error */
-                return sizeDecryptMessage;
-            }
-            
-            /* add plaintext register message to the GLS socket */
-            myGLSSocket->m_messageRegister = decryptMessage;
-            myGLSSocket->m_sizeMessageRegister = sizeDecryptMessage;
-            
-            /* Configure the socket with the connexion type */
-            myGLSSocket->m_connexionType = GLS_CONNEXION_REGISTER;
-            myGLSSocket->m_isHandShakeFinish = 1;
-            
-            /* freeing memory */
-            if (registerServerCertificate != NULL) {
-                
-                free(registerServerCertificate);
-                registerServerCertificate = 0;
-                
-            }
-            if (secondMessage != NULL) {
-                
-                free(secondMessage);
-                secondMessage = 0;
-                
-            }
-            /* decryptMessage is used in the socket, FreeGLSSocket() free it */
-            decryptMessage = 0;
-            
+        for (i = 0; i < sizePublicCert; i++) {
+            registerServerCertificate[i + 25] = myGLSSocket->m_serverCert->m_publicCert[i];
         }
-        else {
+        
+        /* sending Register Server with certificat */
+        int error = sendPacket(myGLSSocket, registerServerCertificate, sizeRegisterServerCertificate);
+        
+        free(registerServerCertificate);
+        registerServerCertificate = 0;
+        
+        if (error < 0) return error;
+        
+        /* The encrypted Register message comes next */
+        return 0;
+        
+    }
+    else {
+        
+        /* If message doesn't corespond to any type => send error */
+        byte error[20] = "GLS/1.1 ERROR 400  ";
+        error[17] = 13;
+        error[18] = 10;
+        /* Sending 19 bytes to remove the '\0' from the string */
+        sendPacket(myGLSSocket, error, 19);
+        
+        return GLS_ERROR_UNKNOWN;
+        
+    }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Second message of the handshake in ciphertext, given to
+ the socket. The Hello message is decrypted by
+ finishHandShake() and the Register message by
+ getRegisterMessage().
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int acceptSecondMessage(GLSSock* myGLSSocket, byte* secondMessage, const int sizeSecondMessage) {
+    
+    GLSHandShake* handShake = myGLSSocket->m_handShake;
+    
+    if (handShake->m_typeMessage == GLS_TYPE_HELLO) {
+        
+        /* Cleaning memory */
+        if (myGLSSocket->m_messageHelloEncrypt != NULL) free(myGLSSocket->m_messageHelloEncrypt);
+        myGLSSocket->m_messageHelloEncrypt = secondMessage;
+        myGLSSocket->m_sizeMessageHelloEncrypt = sizeSecondMessage;
+        
+        /* Configure user's id with the first message in plaintext */
+        int numError = setIdGLS(myGLSSocket, handShake->m_firstMessage, handShake->m_sizeFirstMessage);
+        if (numError != 0) {
             
-            /* If message doesn't corespond to any type => send error */
-            byte error[20] = "GLS/1.1 ERROR 400  ";
+            /* If no ID in the message send an error */
+            byte error[20] = "GLS/1.1 ERROR 401  ";
             error[17] = 13;
             error[18] = 10;
-            /* Sending 19 bytes to remove the '\0' from the string */
+            /* sending 19 bytes to remove the '\0' from the string */
             sendPacket(myGLSSocket, error, 19);
             
-            /* Freeing memory and returning error */
-            if (firstMessage != NULL) {
-                
-                free(firstMessage);
-                firstMessage = 0;
-                
-            }
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### acceptConnexion() End ###\n\n");
-            #endif
-            
-            return GLS_ERROR_UNKNOWN;
-            
-        }
-        
-        /* Freeing memory */
-        if (firstMessage != NULL) {
-            
-            free(firstMessage);
-            firstMessage = 0;
+            return numError;
             
         }
         
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### acceptConnexion() End ###\n\n");
-        #endif
+        /* Configure the socket with the connexion type */
+        myGLSSocket->m_connexionType = GLS_CONNEXION_STANDARD;
+        myGLSSocket->m_isSocketConfig = 1;
         
-        /* Everything worked fine, return 0 */
         return 0;
         
     }
-    else {
-        
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### acceptConnexion() End ###\n\n");
-        #endif
-        
-        /* The socket is already connected, return error */
-        return GLS_ERROR_ISCONN;
-
-    }
+    
+    /*
+     * The message is decrypted later by getRegisterMessage(), on
+     * the thread of the user, to keep the private key operations
+     * away from the accepting thread (DOS with many registrations).
+     */
+    if (myGLSSocket->m_messageRegisterEncrypt != NULL) free(myGLSSocket->m_messageRegisterEncrypt);
+    myGLSSocket->m_messageRegisterEncrypt = secondMessage;
+    myGLSSocket->m_sizeMessageRegisterEncrypt = sizeSecondMessage;
+    
+    /* Sending Register Server OK */
+    byte registerServerOk[29] = "GLS/1.1 REGISTER SERVER OK  ";
+    registerServerOk[26] = 13;
+    registerServerOk[27] = 10;
+    /* sending 28 bytes to remove the '\0' from the string */
+    int error = sendPacket(myGLSSocket, registerServerOk, 28);
+    if (error < 0) return error;
+    
+    /* Closing socket, its number can be given to the next client */
+    shutdown(myGLSSocket->m_sock, SHUT_RDWR);
+    closesocket(myGLSSocket->m_sock);
+    myGLSSocket->m_sock = INVALID_SOCKET;
+    
+    /* Configure the socket with the connexion type */
+    myGLSSocket->m_connexionType = GLS_CONNEXION_REGISTER;
+    myGLSSocket->m_isHandShakeFinish = 1;
+    
+    return 0;
     
 }
 
@@ -1658,20 +1792,44 @@ int getTypeConnexion(GLSSock* myGLSSocket) {
 
 int finishHandShake(GLSSock* myGLSSocket) {
     
-    /* Debug Only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### finishHandShake() Start ###\n");
-    #endif
+    unsigned long long timeStart = getTimeMicro();
+    int error = _finishHandShake(myGLSSocket);
     
-    /* check if the handshake needs to be done and the encryption keys are present */
-    if (myGLSSocket->m_isHandShakeFinish == 0 && myGLSSocket->m_isSocketConfig == 1 && myGLSSocket->m_isCryptoKey == 1) {
+    myGLSSocket->m_statsHandShake.m_handShakeTime[GLS_PHASE_FINISH] += getTimeMicro() - timeStart;
+    if (error != 0) myGLSSocket->m_statsHandShake.m_nbHandShakeError++;
     
-        if (myGLSSocket->m_connexionType == GLS_CONNEXION_STANDARD) {
-            
-            /* We decrypt the hello message */
-            byte (*plainTextHelloMessage) = 0;
-            int sizePlainTextMessage = firstDecrypt(myGLSSocket, myGLSSocket->m_messageHelloEncrypt, myGLSSocket->m_sizeMessageHelloEncrypt, &plainTextHelloMessage);
-            if (sizePlainTextMessage < 0) {
+    return error;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Decrypt the Hello message with the keys of the user and
+ answer the client, used by finishHandShake().
+ 
+ ---------------------------------------------------------*/
+
+int _finishHandShake(GLSSock* myGLSSocket) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### finishHandShake() Start ###\n");
+    #endif
+    
+    /* check if the handshake needs to be done and the encryption keys are present */
+    if (myGLSSocket->m_isHandShakeFinish == 0 && myGLSSocket->m_isSocketConfig == 1 && myGLSSocket->m_isCryptoKey == 1) {
+    
+        if (myGLSSocket->m_connexionType == GLS_CONNEXION_STANDARD) {
+            
+            /* We decrypt the hello message */
+            byte (*plainTextHelloMessage) = 0;
+            int sizePlainTextMessage = firstDecrypt(myGLSSocket, myGLSSocket->m_messageHelloEncrypt, myGLSSocket->m_sizeMessageHelloEncrypt, &plainTextHelloMessage);
+            if (sizePlainTextMessage < 0) {
                 
                 #if defined (GLS_DEBUG_MODE_ENABLE)
                 printf("GLS/1.1 ERROR 100\n");
@@ -1900,12 +2058,27 @@ int finishHandShake(GLSSock* myGLSSocket) {
                 printf("Authentication OK\n");
                 #endif
                 
-                byte helloServer[23] = "GLS/1.1 HELLO SERVER  ";
+                /* The server chooses the suite if the client offers them (GLS/1.2) */
+                int suite = GLS_SUITE_SERPENT_TWOFISH;
+                if (myGLSSocket->m_peerVersion >= 12) suite = myGLSSocket->m_cipherSuite;
+                
+                byte helloServer[32] = "GLS/1.1 HELLO SERVER  SUITE 0  ";
+                int sizeHelloServer = 22;
                 helloServer[20] = 13;
                 helloServer[21] = 10;
-                /* Sending 75 bytes to remove the '\0' from the string */
+                if (suite != GLS_SUITE_SERPENT_TWOFISH) {
+                    
+                    /* GLS/1.2 HELLO SERVER + SUITE x */
+                    helloServer[6] = '2';
+                    helloServer[28] = '0' + suite;
+                    helloServer[29] = 13;
+                    helloServer[30] = 10;
+                    sizeHelloServer = 31;
+                    
+                }
+                /* Sending 22 or 31 bytes to remove the '\0' from the string */
                 byte (*cihperMessage) = 0;
-                int sizeCipherMessage = allEncrypt(myGLSSocket, helloServer, 22, &cihperMessage);
+                int sizeCipherMessage = allEncrypt(myGLSSocket, helloServer, sizeHelloServer, &cihperMessage);
                 if (sizeCipherMessage < 0) {
                     
                     /* If the encryption doesn't work we send a internal error */
@@ -1984,6 +2157,15 @@ int finishHandShake(GLSSock* myGLSSocket) {
                 if (error != 0) return error;
                 else { 
                     
+                    /* The next messages use the negotiated suite, its key needs IV3 and IV4 of the Hello Server */
+                    if (suite != GLS_SUITE_SERPENT_TWOFISH) {
+                        
+                        myGLSSocket->m_activeSuite = suite;
+                        error = initSuiteHandler(myGLSSocket);
+                        if (error != 0) return error;
+                        
+                    }
+                    
                     /* Socket configuration to say everything is OK */
                     myGLSSocket->m_isHandShakeFinish = 1;
                     
@@ -2216,7 +2398,7 @@ int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, co
     printf("### sendRegister() Start ###\n");
     #endif
     
-    if (myGLSSocket->m_certRoot != NULL && myGLSSocket->m_isSocketConfig == 0 && myGLSSocket->m_isHandShakeFinish == 0) {
+    if (myGLSSocket->m_roots != NULL && myGLSSocket->m_isSocketConfig == 0 && myGLSSocket->m_isHandShakeFinish == 0) {
         
         /* Debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -2234,20 +2416,15 @@ int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, co
         if(errorWindows == 0) {
             
             /* Creating register message */
-            char messageRegister[18] = "GLS/1.1 REGISTER  ";
+            char messageRegister[18] = "GLS/1.2 REGISTER  ";
             /* Insertion CR at size -2 */
             messageRegister[16] = 13;
             /* Insertion LF at size -1 */
             messageRegister[17] = 10;
             
-            /* addrinfo configuration for getaddrinfo() */
-            struct addrinfo hints;
-            memset(&hints, 0, sizeof(struct addrinfo));
-            hints.ai_family = AF_UNSPEC;
-            hints.ai_socktype = SOCK_STREAM;
-            
-            /* Server address configuration */
-            int error = getaddrinfo(address, port, &hints, &myGLSSocket->m_infoConnexion);
+            /* Server address, from the DNS cache for a name */
+            GLSAddress infoConnexion;
+            int error = resolveAddress(address, port, &infoConnexion);
             if (error != 0){
                 
                 /* No memory to clean */
@@ -2258,62 +2435,15 @@ int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, co
                 printf("### sendRegister() End ###\n\n");
                 #endif
                 
-                /* return getaddrinfo error */
-                switch (error) {
-                        
-                    case EAI_ADDRFAMILY :
-                        return GLS_ERROR_AI_ADDRFAMILY;
-                        break;
-                        
-                    case EAI_AGAIN :
-                        return GLS_ERROR_AI_AGAIN;
-                        break;
-                        
-                    case EAI_BADFLAGS :
-                        return GLS_ERROR_AI_BADFLAGS;
-                        break;
-                        
-                    case EAI_FAIL :
-                        return GLS_ERROR_AI_FAIL;
-                        break;
-                        
-                    case EAI_FAMILY :
-                        return GLS_ERROR_AI_FAMILY;
-                        break;
-                        
-                    case EAI_MEMORY :
-                        return GLS_ERROR_AI_MEMORY;
-                        break;
-                        
-                    case EAI_NODATA :
-                        return GLS_ERROR_AI_NODATA;
-                        break;
-                        
-                    case EAI_NONAME :
-                        return GLS_ERROR_AI_NONAME;
-                        break;
-                        
-                    case EAI_SERVICE :
-                        return GLS_ERROR_AI_SERVICE;
-                        break;
-                        
-                    case EAI_SOCKTYPE :
-                        return GLS_ERROR_AI_SOCKTYPE;
-                        break;
-                        
-                    default:
-                        return GLS_ERROR_AI_SYSTEM;
-                        break;
-                        
-                }
+                return error;
                 
             }
             
             /* Socket creation */
-            myGLSSocket->m_sock = socket(myGLSSocket->m_infoConnexion->ai_family, myGLSSocket->m_infoConnexion->ai_socktype, myGLSSocket->m_infoConnexion->ai_protocol);
+            myGLSSocket->m_sock = socket(infoConnexion.m_family, SOCK_STREAM, infoConnexion.m_protocol);
             
             /* If connection impossible */
-            if(connect(myGLSSocket->m_sock, myGLSSocket->m_infoConnexion->ai_addr, myGLSSocket->m_infoConnexion->ai_addrlen) == SOCKET_ERROR) {
+            if(connect(myGLSSocket->m_sock, (struct sockaddr*)&infoConnexion.m_addr, infoConnexion.m_size) == SOCKET_ERROR) {
                 
                 /* get error number */
                 int numError = errno;
@@ -2528,9 +2658,11 @@ int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, co
                     
                 }
                 
-                /* buffer encryption */
+                /* buffer encryption, a GLS/1.2 server only needs one private key operation */
                 byte *cipherText = 0;
-                int sizeCipherText = encryptWithPK(serverCertificate, sizeServerCertificate, buffer, sizeBuffer, &cipherText);
+                int sizeCipherText = 0;
+                if (getVersionGLS(registerServer, sizeRegisterServer) >= 12) sizeCipherText = encryptWithKem(myGLSSocket, serverCertificate, sizeServerCertificate, buffer, sizeBuffer, &cipherText);
+                else sizeCipherText = encryptWithPK(serverCertificate, sizeServerCertificate, buffer, sizeBuffer, &cipherText);
                 if (sizeCipherText <= 0) {
                     
                     /* Free memory */
@@ -2843,7 +2975,7 @@ int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, co
         
         /* Debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        if (myGLSSocket->m_certRoot == NULL) printf("No root certificate.\n");
+        if (myGLSSocket->m_roots == NULL) printf("No root certificate.\n");
         if (myGLSSocket->m_isSocketConfig == 1) printf("Socket already configured.\n");
         if (myGLSSocket->m_isHandShakeFinish == 1) printf("HandShake done.\n");
         #endif
@@ -2853,7 +2985,7 @@ int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, co
         printf("### sendRegister() End ###\n\n");
         #endif
         
-        if (myGLSSocket->m_certRoot == NULL) return GLS_ERROR_NOCERT;
+        if (myGLSSocket->m_roots == NULL) return GLS_ERROR_NOCERT;
         else if (myGLSSocket->m_isSocketConfig == 1 || myGLSSocket->m_isHandShakeFinish == 1) return GLS_ERROR_ISCONN;
         else return GLS_ERROR_UNKNOWN;
         
@@ -2866,7 +2998,8 @@ int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, co
 
 /*-------------------------------------------------------
  
- Set a pointer to a copy of the register message
+ Set a pointer to a copy of the register message, the
+ message is decrypted at the first call.
  
  Return the size of the message or a negative number for 
  an error
@@ -2875,24 +3008,66 @@ int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, co
 
 int getRegisterMessage(GLSSock* myGLSSocket, byte** message) {
     
-    if (myGLSSocket->m_messageRegister != NULL && myGLSSocket->m_sizeMessageRegister > 0) {
+    pthread_mutex_lock(&myGLSSocket->m_mutexGlsRecv);
+    
+    /* Decryption after the connexion is closed, away from the accepting thread */
+    if (myGLSSocket->m_messageRegister == NULL && myGLSSocket->m_messageRegisterEncrypt != NULL) {
         
-        byte *temp = malloc(myGLSSocket->m_sizeMessageRegister);
-        if (temp == NULL) return GLS_ERROR_NOMEM;
+        byte *decryptMessage = 0;
+        int sizeDecryptMessage = 0;
+        if (myGLSSocket->m_peerVersion >= 12) sizeDecryptMessage = decryptWithKem(myGLSSocket, myGLSSocket->m_messageRegisterEncrypt, myGLSSocket->m_sizeMessageRegisterEncrypt, &decryptMessage);
+        else sizeDecryptMessage = decryptWithPK(myGLSSocket, myGLSSocket->m_messageRegisterEncrypt, myGLSSocket->m_sizeMessageRegisterEncrypt, &decryptMessage);
         
-        int i = 0;
-        for (i = 0; i < myGLSSocket->m_sizeMessageRegister; i++) {
+        /* The encrypted message is only decrypted one time */
+        free(myGLSSocket->m_messageRegisterEncrypt);
+        myGLSSocket->m_messageRegisterEncrypt = 0;
+        myGLSSocket->m_sizeMessageRegisterEncrypt = 0;
+        
+        if (sizeDecryptMessage < 0) {
+            
+            /* Free memory */
+            if (decryptMessage != NULL) {
+                
+                free(decryptMessage);
+                decryptMessage = 0;
+                
+            }
+            
+            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+            
+            /* Debug Only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("Register message decryption error : %d\n", sizeDecryptMessage);
+            #endif
             
-            temp[i] = myGLSSocket->m_messageRegister[i];
+            return sizeDecryptMessage;
             
         }
-                
-        (*message) = temp;
         
-        return myGLSSocket->m_sizeMessageRegister;
+        /* decryptMessage is used in the socket, FreeGLSSocket() free it */
+        myGLSSocket->m_messageRegister = decryptMessage;
+        myGLSSocket->m_sizeMessageRegister = sizeDecryptMessage;
         
     }
-    else return GLS_ERROR_NOMESSAGE;
+    
+    int size = GLS_ERROR_NOMESSAGE;
+    if (myGLSSocket->m_messageRegister != NULL && myGLSSocket->m_sizeMessageRegister > 0) {
+        
+        byte *temp = malloc(myGLSSocket->m_sizeMessageRegister);
+        if (temp != NULL) {
+            
+            memcpy(temp, myGLSSocket->m_messageRegister, myGLSSocket->m_sizeMessageRegister);
+            (*message) = temp;
+            size = myGLSSocket->m_sizeMessageRegister;
+            
+        }
+        else size = GLS_ERROR_NOMEM;
+        
+    }
+    
+    pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+    
+    return size;
     
 }
 
@@ -2914,636 +3089,1861 @@ int connexion(GLSSock* myGLSSocket, const char* address, const char* port) {
     printf("### connexion() Start ###\n");
     #endif
     
-     if (myGLSSocket->m_isSocketConfig == 0 && myGLSSocket->m_isHandShakeFinish == 0 && myGLSSocket->m_isUserConfig == 1 && myGLSSocket->m_isCryptoKey == 1) {
-         
+    #if defined (win32)
+    WSADATA WSAData;
+    if (WSAStartup(MAKEWORD(2,2), &WSAData) != 0) return GLS_ERROR_UNKNOWN;
+    #endif
+    
+    /* The same handshake as glsConnectStart(), waiting for the socket here */
+    int error = glsConnectStart(myGLSSocket, address, port);
+    while (error > 0) {
+        
+        struct pollfd fds;
+        fds.fd = myGLSSocket->m_sock;
+        fds.events = (error == GLS_WAIT_WRITE) ? POLLOUT : POLLIN;
+        fds.revents = 0;
+        
+        /* Timeout to check the deadline of the handshake */
+        poll(&fds, 1, 1000);
+        
+        error = glsConnectPoll(myGLSSocket);
+        
+    }
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Result : %d\n", error);
+    printf("### connexion() End ###\n\n");
+    #endif
+    
+    return error;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ Start the connexion to a socket server without blocking
+ (except for the name resolution), the handshake goes on
+ with glsConnectPoll() when the socket is ready.
+ 
+ Return 0 if connected, GLS_WAIT_READ or GLS_WAIT_WRITE
+ to wait for the socket or a negative number for an
+ error.
+ 
+ ---------------------------------------------------------*/
+
+int glsConnectStart(GLSSock* myGLSSocket, const char* address, const char* port) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsConnectStart() Start ###\n");
+    #endif
+    
+    if (myGLSSocket->m_isSocketConfig != 0 || myGLSSocket->m_isHandShakeFinish != 0 || myGLSSocket->m_handShake != NULL || myGLSSocket->m_isUserConfig == 0 || myGLSSocket->m_isCryptoKey == 0) {
+        
         /* Debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        myGLSSocket->m_isServeur = 0;
+        if (myGLSSocket->m_isSocketConfig == 1) printf("Socket already config.\n");
+        if (myGLSSocket->m_isHandShakeFinish == 1) printf("HandShake done.\n");
+        if (myGLSSocket->m_handShake != NULL) printf("HandShake in progress.\n");
+        if (myGLSSocket->m_isCryptoKey == 0) printf("No encryption key.\n");
+        if (myGLSSocket->m_isUserConfig == 0) printf("No user id\n");
+        printf("### glsConnectStart() End ###\n\n");
         #endif
-         
-        #if defined (win32)
-        WSADATA WSAData;
-        int erreur = WSAStartup(MAKEWORD(2,2), &WSAData);
-        #else
-        int erreur = 0;
+        
+        if (myGLSSocket->m_isSocketConfig == 1 || myGLSSocket->m_isHandShakeFinish == 1 || myGLSSocket->m_handShake != NULL) return GLS_ERROR_ISCONN;
+        else if (myGLSSocket->m_isCryptoKey == 0) return GLS_ERROR_NOPASSWD;
+        else return GLS_ERROR_USERNOTCONF;
+        
+    }
+    
+    /* Replaced by the pipe or the socket of the connexion */
+    myGLSSocket->m_sock = INVALID_SOCKET;
+    
+    GLSHandShake* handShake = newHandShake(GLS_CONNECT_RESOLVING);
+    if (handShake == NULL) return GLS_ERROR_NOMEM;
+    
+    /* Client side of the connexion */
+    myGLSSocket->m_isServeur = 0;
+    myGLSSocket->m_handShake = handShake;
+    
+    /* Numeric address or name in the DNS cache */
+    GLSAddress infoConnexion;
+    int error = lookupAddress(address, port, &infoConnexion, INVALID_SOCKET);
+    if (error == GLS_WAIT_READ) {
+        
+        /* Name resolved by a thread of the library, waiting for its pipe */
+        int notify[2];
+        handShake->m_address = malloc(strlen(address) + 1);
+        handShake->m_port = malloc(strlen(port) + 1);
+        if (handShake->m_address == NULL || handShake->m_port == NULL) error = GLS_ERROR_NOMEM;
+        else if (pipe(notify) != 0) error = getAcceptError(errno);
+        else {
+            
+            strcpy(handShake->m_address, address);
+            strcpy(handShake->m_port, port);
+            fcntl(notify[0], F_SETFL, fcntl(notify[0], F_GETFL, 0) | O_NONBLOCK);
+            fcntl(notify[1], F_SETFL, fcntl(notify[1], F_GETFL, 0) | O_NONBLOCK);
+            myGLSSocket->m_sock = notify[0];
+            handShake->m_notify = notify[1];
+            error = 0;
+            
+        }
+        
+    }
+    else if (error == 0) error = connectAddress(myGLSSocket, &infoConnexion);
+    
+    if (error != 0) {
+        
+        /* Debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Impossible to connect.\n");
+        printf("Num error : %d\n", error);
+        printf("### glsConnectStart() End ###\n\n");
         #endif
+        
+        _stopConnexion(myGLSSocket);
+        
+        return error;
+        
+    }
     
-        /* If windows's socket works */
-        if(erreur == 0) {
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsConnectStart() End ###\n\n");
+    #endif
+    
+    /* Maybe already resolved or connected (local server) */
+    return glsConnectPoll(myGLSSocket);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ Go on with the handshake of glsConnectStart() without
+ blocking : CONNECTING (Hello messages sent when
+ connected) -> HELLO_SERVER (answer of the server). The
+ socket is blocking again when connected.
+ 
+ Return 0 if connected, GLS_WAIT_READ or GLS_WAIT_WRITE
+ to wait for the socket (glsGetSocket()) or a negative
+ number for an error, the socket is closed.
+ 
+ ---------------------------------------------------------*/
+
+int glsConnectPoll(GLSSock* myGLSSocket) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsConnectPoll() Start ###\n");
+    #endif
+    
+    GLSHandShake* handShake = myGLSSocket->m_handShake;
+    if (handShake == NULL || handShake->m_state < GLS_CONNECT_RESOLVING) {
+        
+        if (myGLSSocket->m_isHandShakeFinish == 1 && myGLSSocket->m_isServeur == 0) return 0;
+        
+        return GLS_ERROR_NOTCONN;
+        
+    }
+    
+    int error = 0;
+    
+    /* The server can't keep the client waiting forever */
+    if (time(NULL) > handShake->m_deadline) error = GLS_ERROR_TIMEDOUT;
+    
+    /* Name of the server */
+    if (error == 0 && handShake->m_state == GLS_CONNECT_RESOLVING) {
+        
+        /* 
+         * Result of the resolver in the pipe, written once. An error not
+         * kept by the cache is only known from there.
+         */
+        int dnsError = 0;
+        if (read(myGLSSocket->m_sock, &dnsError, sizeof(int)) != sizeof(int)) dnsError = 0;
+        
+        GLSAddress infoConnexion;
+        if (dnsError != 0) error = dnsError;
+        else error = lookupAddress(handShake->m_address, handShake->m_port, &infoConnexion, handShake->m_notify);
+        if (error == GLS_WAIT_READ) {
             
-            /* Get user's ID */
-            char (*userId) = 0;
-            int sizeUserId = getUserId(myGLSSocket, &userId);
-            if (sizeUserId < 1) {
-                
-                /* free memory if error */
-                if (userId != NULL) {
-                    
-                    free(userId);
-                    userId = 0;
-                    
-                }
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### connexion() End ###\n\n");
-                #endif
-                
-                /* return error */
-                return GLS_ERROR_USERNOTCONF;
-                
-            }
+            /* Debug Only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("### glsConnectPoll() End ###\n\n");
+            #endif
             
-            /* Memory allocation for Hello message (-1 for '\0') */
-            byte (*messageHello) = malloc((16 + sizeUserId - 1) * sizeof(byte));
+            return GLS_WAIT_READ;
             
-            /* Fill Hello message */
-            char header[15] = "GLS/1.1 HELLO ";
-            int i = 0;
-            for (i = 0; i < 14; i++) {
-                
-                messageHello[i] = header[i];
-                
-            }
-            i = 0;
-            for (i = 0; i < (sizeUserId - 1); i++) {
-                
-                messageHello[i + 14] = userId[i];
-                
-            }
-            /* Insertion CR at size -2 */
-            messageHello[16 + (sizeUserId - 1) - 2] = 13;
-            /* Insertion LF at size -1 */
-            messageHello[16 + (sizeUserId - 1) - 1] = 10;
+        }
+        
+        /* Resolved, the pipe is replaced by the socket */
+        stopResolveWait(handShake->m_notify);
+        handShake->m_notify = INVALID_SOCKET;
+        free(handShake->m_address);
+        free(handShake->m_port);
+        handShake->m_address = 0;
+        handShake->m_port = 0;
+        
+        if (error == 0) error = connectAddress(myGLSSocket, &infoConnexion);
+        
+    }
+    
+    /* TCP connexion */
+    if (error == 0 && handShake->m_state == GLS_CONNECT_CONNECTING) {
+        
+        struct pollfd fds;
+        fds.fd = myGLSSocket->m_sock;
+        fds.events = POLLOUT;
+        fds.revents = 0;
+        if (poll(&fds, 1, 0) == 0) {
             
-            /* Encryption message hello */
-            byte (*cipherText) = 0;
-            int sizeCipherText = firstEncrypt(myGLSSocket, messageHello, (16 + sizeUserId - 1), &cipherText);
-            if (sizeCipherText < 0) {
-                
-                /* Free memory */
-                if (userId != NULL) {
-                    
-                    free(userId);
-                    userId = 0;
-                    
-                }
-                if (messageHello != NULL) {
-                    
-                    free(messageHello);
-                    messageHello = 0;
-                    
-                }
-                if (cipherText != NULL) {
-                    
-                    free(cipherText);
-                    cipherText = 0;
-                    
-                }
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### connexion() End ###\n\n");
-                #endif
-                
-                return sizeCipherText;
-                
-            }
+            /* Debug Only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("### glsConnectPoll() End ###\n\n");
+            #endif
             
-            /* addrinfo configuration for getaddrinfo() */
-            struct addrinfo hints;
-            memset(&hints, 0, sizeof(struct addrinfo));
-            hints.ai_family = AF_UNSPEC;
-            hints.ai_socktype = SOCK_STREAM;
+            return GLS_WAIT_WRITE;
             
-            /* Server address config */
-            int erreur = getaddrinfo(address, port, &hints, &myGLSSocket->m_infoConnexion);
-            if (erreur != 0){
-                
-                /* Free memory */
-                if (userId != NULL) {
-                    
-                    free(userId);
-                    userId = 0;
-                    
-                }
-                if (messageHello != NULL) {
-                    
-                    free(messageHello);
-                    messageHello = 0;
-                    
-                }
-                if (cipherText != NULL) {
-                    
-                    free(cipherText);
-                    cipherText = 0;
-                    
-                }
+        }
+        
+        int numError = 0;
+        socklen_t sizeError = sizeof(numError);
+        if (getsockopt(myGLSSocket->m_sock, SOL_SOCKET, SO_ERROR, &numError, &sizeError) != 0) numError = errno;
+        
+        if (numError != 0) error = getConnectError(numError);
+        else {
+            
+            /* Blocking again for the messages */
+            int flags = fcntl(myGLSSocket->m_sock, F_GETFL, 0);
+            fcntl(myGLSSocket->m_sock, F_SETFL, flags & ~O_NONBLOCK);
+            
+            /* Connexion to the server done */
+            unsigned long long timeNow = getTimeMicro();
+            myGLSSocket->m_statsHandShake.m_handShakeTime[GLS_PHASE_HELLO] += timeNow - handShake->m_timePhase;
+            handShake->m_timePhase = timeNow;
+            
+            error = sendHelloMessages(myGLSSocket);
+            
+            /* Hello messages sent */
+            timeNow = getTimeMicro();
+            myGLSSocket->m_statsHandShake.m_handShakeTime[GLS_PHASE_HELLO_CIPHER] += timeNow - handShake->m_timePhase;
+            handShake->m_timePhase = timeNow;
+            handShake->m_state = GLS_CONNECT_HELLO_SERVER;
+            
+        }
+        
+    }
+    
+    /* Answer of the server */
+    if (error == 0) {
+        
+        byte (*firstMessage) = 0;
+        int sizeFirstMessage = recvPacketNoWait(myGLSSocket, &firstMessage);
+        if (sizeFirstMessage == GLS_ERROR_AGAIN) {
+            
+            /* Debug Only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("### glsConnectPoll() End ###\n\n");
+            #endif
+            
+            return GLS_WAIT_READ;
+            
+        }
+        
+        if (sizeFirstMessage < 0) error = sizeFirstMessage;
+        else error = readHelloServer(myGLSSocket, firstMessage, sizeFirstMessage);
+        
+        if (firstMessage != NULL) free(firstMessage);
+        
+    }
+    
+    /* If no error, configuring the socket to say everything is ok */
+    if (error == 0) {
+        
+        myGLSSocket->m_isHandShakeFinish = 1;
+        myGLSSocket->m_isSocketConfig = 1;
+        myGLSSocket->m_statsHandShake.m_handShakeTime[GLS_PHASE_FINISH] += getTimeMicro() - handShake->m_timePhase;
+        myGLSSocket->m_statsHandShake.m_nbHandShake++;
+        
+        free(handShake);
+        myGLSSocket->m_handShake = 0;
+        
+    }
+    else _stopConnexion(myGLSSocket);
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Result : %d\n", error);
+    printf("### glsConnectPoll() End ###\n\n");
+    #endif
+    
+    return error;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ Return the file descriptor of the socket, to wait for
+ it with select(), poll() or epoll.
+ 
+ ---------------------------------------------------------*/
+
+int glsGetSocket(GLSSock* myGLSSocket) {
+    
+    return myGLSSocket->m_sock;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Start the TCP connexion (non blocking) to the address of
+ the server. The socket takes the descriptor of the pipe
+ of the name resolution if any, the number of
+ glsGetSocket() doesn't change.
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int connectAddress(GLSSock* myGLSSocket, const GLSAddress* address) {
+    
+    int sock = socket(address->m_family, SOCK_STREAM, address->m_protocol);
+    if (sock == INVALID_SOCKET) return getConnectError(errno);
+    
+    int flags = fcntl(sock, F_GETFL, 0);
+    fcntl(sock, F_SETFL, flags | O_NONBLOCK);
+    
+    /* 
+     * The acknowledgement of a message and the next message are sent one
+     * after the other, Nagle would hold the second one until the delayed
+     * ACK of the server (40 ms)
+     */
+    int noDelay = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    
+    if (myGLSSocket->m_sock == INVALID_SOCKET) myGLSSocket->m_sock = sock;
+    else {
+        
+        int numError = (dup2(sock, myGLSSocket->m_sock) < 0) ? errno : 0;
+        closesocket(sock);
+        if (numError != 0) return getConnectError(numError);
+        
+    }
+    
+    myGLSSocket->m_handShake->m_state = GLS_CONNECT_CONNECTING;
+    
+    if (connect(myGLSSocket->m_sock, (struct sockaddr*)&address->m_addr, address->m_size) == SOCKET_ERROR && errno != EINPROGRESS) return getConnectError(errno);
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Stop a connexion of glsConnectStart() after an error,
+ the socket is closed.
+ 
+ ---------------------------------------------------------*/
+
+void _stopConnexion(GLSSock* myGLSSocket) {
+    
+    if (myGLSSocket->m_handShake != NULL) {
+        
+        if (myGLSSocket->m_handShake->m_notify != INVALID_SOCKET) stopResolveWait(myGLSSocket->m_handShake->m_notify);
+        if (myGLSSocket->m_handShake->m_address != NULL) free(myGLSSocket->m_handShake->m_address);
+        if (myGLSSocket->m_handShake->m_port != NULL) free(myGLSSocket->m_handShake->m_port);
+        if (myGLSSocket->m_handShake->m_message != NULL) free(myGLSSocket->m_handShake->m_message);
+        free(myGLSSocket->m_handShake);
+        myGLSSocket->m_handShake = 0;
+        
+    }
+    
+    closesocket(myGLSSocket->m_sock);
+    myGLSSocket->m_sock = INVALID_SOCKET;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Send the Hello message in plaintext then encrypted, the
+ server reads them as separate packets.
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int sendHelloMessages(GLSSock* myGLSSocket) {
+    
+    /* Get user's ID */
+    char (*userId) = 0;
+    int sizeUserId = getUserId(myGLSSocket, &userId);
+    if (sizeUserId < 1) {
+        
+        /* free memory if error */
+        if (userId != NULL) free(userId);
+        
+        return GLS_ERROR_USERNOTCONF;
+        
+    }
+    
+    /* Memory allocation for Hello message (-1 for '\0') */
+    int sizeMessageHello = 16 + sizeUserId - 1;
+    byte (*messageHello) = malloc(sizeMessageHello * sizeof(byte));
+    if (messageHello == NULL) {
+        
+        free(userId);
+        
+        return GLS_ERROR_NOMEM;
+        
+    }
+    
+    /* Fill Hello message */
+    char header[15] = "GLS/1.1 HELLO ";
+    
+    /* GLS/1.2 offers the AEAD suites to the server */
+    if (myGLSSocket->m_cipherSuite != GLS_SUITE_SERPENT_TWOFISH) header[6] = '2';
+    
+    memcpy(messageHello, header, 14);
+    memcpy(messageHello + 14, userId, sizeUserId - 1);
+    /* Insertion CR at size -2 */
+    messageHello[sizeMessageHello - 2] = 13;
+    /* Insertion LF at size -1 */
+    messageHello[sizeMessageHello - 1] = 10;
+    free(userId);
+    
+    /* Encryption message hello */
+    byte (*cipherText) = 0;
+    int sizeCipherText = firstEncrypt(myGLSSocket, messageHello, sizeMessageHello, &cipherText);
+    
+    /* Sending hello message, then the encrypted one */
+    int error = sizeCipherText;
+    if (sizeCipherText >= 0) error = sendPacket(myGLSSocket, messageHello, sizeMessageHello);
+    if (error >= 0) error = sendPacket(myGLSSocket, cipherText, sizeCipherText);
+    
+    /* Free memory */
+    free(messageHello);
+    if (cipherText != NULL) free(cipherText);
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    if (error < 0) printf("Impossible to send the Hello messages (%d).\n", error);
+    #endif
+    
+    if (error < 0) return error;
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Read the answer of the server to the Hello messages :
+ Hello Server (the suite chosen by the server is set) or
+ an error message in plaintext.
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int readHelloServer(GLSSock* myGLSSocket, const byte* firstMessage, const int sizeFirstMessage) {
+    
+    /* Message decryption */
+    int error = 0;
+    byte (*helloServer) = 0;
+    int sizeHelloServer = allDecrypt(myGLSSocket, firstMessage, sizeFirstMessage, &helloServer);
+    if (sizeHelloServer < 0) {
+        
+        error = -1;
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error Decrypt Connexion\n");
+        #endif
+        
+    }
+    /*
+     * Check message type, if impossible to decrypt, it's used like
+     * a plaintext message (error message).
+     */
+    int messageType = 0;
+    if (error == 0) messageType = getTypeGLS(helloServer, sizeHelloServer);
+    else messageType = getTypeGLS(firstMessage, sizeFirstMessage);
+    
+    if (messageType == GLS_TYPE_HELLO_SERVER) {
+        
+        /* Suite chosen by the server, only if we offered it */
+        int suite = getSuiteGLS(helloServer, sizeHelloServer);
+        if (suite > GLS_SUITE_SERPENT_TWOFISH && myGLSSocket->m_cipherSuite == GLS_SUITE_SERPENT_TWOFISH) suite = GLS_ERROR_PROTO;
+        
+        /* The next messages use the negotiated suite, its key needs IV3 and IV4 of the Hello Server */
+        if (suite > GLS_SUITE_SERPENT_TWOFISH) {
+            
+            myGLSSocket->m_activeSuite = suite;
+            suite = initSuiteHandler(myGLSSocket);
+            
+        }
+        
+        if (suite < 0) {
+            
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("Bad suite from server Connexion\n");
+            #endif
+            
+            /* The connexion can't be used, the server already uses the suite */
+            myGLSSocket->m_activeSuite = GLS_SUITE_SERPENT_TWOFISH;
+            error = -1;
+            
+        }
+        
+    }
+    else if (messageType == GLS_TYPE_ERROR) {
+        
+        /* Get the error (considering encryption) */
+        int messageError = 1;
+        if (error == 0) messageError = getNumError(helloServer, sizeHelloServer);
+        else messageError = getNumError(firstMessage, sizeFirstMessage);
+        
+        /* Free memory */
+        if (helloServer != NULL) {
+            
+            free(helloServer);
+            helloServer = 0;
+            
+        }
+        
+        /* Return GLS error */
+        switch (messageError) {
+                
+            case 100:
+                return GLS_ERROR_BADPASSWD;
+                break;
+                
+            case 200:
+                return GLS_ERROR_VERSION;
+                break;
+                
+            default:
+                return GLS_ERROR_UNKNOWN;
+                break;
+        }
+        
+    }
+    else error = -1;
+    
+    /* free memory */
+    if (helloServer != NULL) {
+        
+        free(helloServer);
+        helloServer = 0;
+        
+    }
+    
+    /* return error if one or 0 if success */
+    if (error != 0) return GLS_ERROR_UNKNOWN;
+    else return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Convert a getaddrinfo() error into a GLS error.
+ 
+ ---------------------------------------------------------*/
+
+int getAddrInfoError(const int numError) {
+    
+    switch (numError) {
+            
+        case EAI_ADDRFAMILY :
+            return GLS_ERROR_AI_ADDRFAMILY;
+            break;
+            
+        case EAI_AGAIN :
+            return GLS_ERROR_AI_AGAIN;
+            break;
+            
+        case EAI_BADFLAGS :
+            return GLS_ERROR_AI_BADFLAGS;
+            break;
+            
+        case EAI_FAIL :
+            return GLS_ERROR_AI_FAIL;
+            break;
+            
+        case EAI_FAMILY :
+            return GLS_ERROR_AI_FAMILY;
+            break;
+            
+        case EAI_MEMORY :
+            return GLS_ERROR_AI_MEMORY;
+            break;
+            
+        case EAI_NODATA :
+            return GLS_ERROR_AI_NODATA;
+            break;
+            
+        case EAI_NONAME :
+            return GLS_ERROR_AI_NONAME;
+            break;
+            
+        case EAI_SERVICE :
+            return GLS_ERROR_AI_SERVICE;
+            break;
+            
+        case EAI_SOCKTYPE :
+            return GLS_ERROR_AI_SOCKTYPE;
+            break;
+            
+        default:
+            return GLS_ERROR_AI_SYSTEM;
+            break;
+            
+    }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Convert a socket() or connect() errno into a GLS error.
+ 
+ ---------------------------------------------------------*/
+
+int getConnectError(const int numError) {
+    
+    switch (numError) {
+            
+        case EACCES :
+            return GLS_ERROR_ACCES;
+            break;
+            
+        case EPERM :
+            return GLS_ERROR_PERM;
+            break;
+            
+        case EADDRINUSE :
+            return GLS_ERROR_ADDRINUSE;
+            break;
+            
+        case EAFNOSUPPORT :
+            return GLS_ERROR_AFNOSUPPORT;
+            break;
+            
+        case EAGAIN :
+            return GLS_ERROR_AGAIN;
+            break;
+            
+        case EALREADY :
+            return GLS_ERROR_ALREADY;
+            break;
+            
+        case EBADF :
+            return GLS_ERROR_BADF;
+            break;
+            
+        case ECONNREFUSED :
+            return GLS_ERROR_CONNREFUSED;
+            break;
+            
+        case EHOSTDOWN :
+            return GLS_ERROR_HOSTDOWN;
+            break;
+            
+        case EFAULT :
+            return GLS_ERROR_FAULT;
+            break;
+            
+        case EINPROGRESS :
+            return GLS_ERROR_INPROGRESS;
+            break;
+            
+        case EINTR :
+            return GLS_ERROR_INTR;
+            break;
+            
+        case EISCONN :
+            return GLS_ERROR_ISCONN;
+            break;
+            
+        case ENETUNREACH :
+            return GLS_ERROR_NETUNREACH;
+            break;
+            
+        case ENOTSOCK :
+            return GLS_ERROR_NOTSOCK;
+            break;
+            
+        case ETIMEDOUT :
+            return GLS_ERROR_TIMEDOUT;
+            break;
+            
+        case EMFILE :
+            return GLS_ERROR_MFILE;
+            break;
+            
+        case ENFILE :
+            return GLS_ERROR_NFILE;
+            break;
+            
+        case ENOBUFS :
+            return GLS_ERROR_NOBUFS;
+            break;
+            
+        default:
+            return GLS_ERROR_UNKNOWN;
+            break;
+            
+    }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Send packet over the network with size = GLS_SIZE_PACKET
+ (configurable in GLSHeaders.h). The packets of an event
+ loop client are queued when its socket is full.
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int sendPacket(GLSSock* myGLSSocket, const byte* buffer, const int size) {
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### sendPacket() Start ###\n");
+    if (myGLSSocket->m_isServeur) printf("Serveur - sendPacket() %d bytes\n", size);
+    else printf("Client - sendPacket() %d bytes\n", size);
+    #endif
+    
+    /* Argument check */
+    if (size <= 0 || buffer == NULL) {
+        
+        /* Debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Erreur d'argument sendPacket\n");
+        printf("### sendPacket() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_BADSIZE;
+        
+    }
+    
+    /* 
+     * Number of packets, a message bigger than GLS_SIZE_PACKET finishing
+     * with a full packet is followed by an EOF packet
+     */
+    int nbPacket = size / GLS_SIZE_PACKET;
+    int sizeLast = size % GLS_SIZE_PACKET;
+    int isEof = 0;
+    if (sizeLast > 0) nbPacket++;
+    else isEof = 1;
+    
+    /* 
+     * Each packet is sent without copy with a header + a slice of
+     * the buffer, GLS_IOV_PACKET packets by system call
+     */
+    struct iovec iov[2 * GLS_IOV_PACKET];
+    byte headers[GLS_IOV_PACKET][2];
+    int nbIov = 0;
+    int packet = 0;
+    ssize_t sock_size = 0;
+    
+    /* Block other send in other threads */
+    pthread_mutex_lock(&myGLSSocket->m_mutexSendPacket);
+    
+    for (packet = 0; packet < nbPacket + isEof; packet++) {
+        
+        /* Packet size and position */
+        const byte* data = 0;
+        int sizePacket = 0;
+        if (packet < nbPacket) {
+            
+            data = buffer + (packet * GLS_SIZE_PACKET);
+            if (packet == nbPacket - 1 && sizeLast > 0) sizePacket = sizeLast;
+            else sizePacket = GLS_SIZE_PACKET;
+            
+        }
+        else {
+            
+            /* Last packet, send EOF (only when packet = GLS_SIZE_PACKET) */
+            data = (const byte*) "EOF";
+            sizePacket = 4;
+            
+            /* Debug only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            if (myGLSSocket->m_isServeur) printf("Serveur - sendPacket() EOF\n");
+            else printf("Client - sendPacket() EOF\n");
+            #endif
+            
+        }
+        
+        /* Packet size encoding (big-endian for network) in 2 bytes */
+        int index = nbIov / 2;
+        headers[index][0] = (byte) (sizePacket >> 8);
+        headers[index][1] = (byte) sizePacket;
+        iov[nbIov].iov_base = headers[index];
+        iov[nbIov].iov_len = 2;
+        iov[nbIov + 1].iov_base = (void*) data;
+        iov[nbIov + 1].iov_len = sizePacket;
+        nbIov += 2;
+        
+        /* Send when the batch is full or with the last packet */
+        int isLast = (packet == nbPacket + isEof - 1);
+        if (nbIov == 2 * GLS_IOV_PACKET || isLast) {
+            
+            /* Tell the kernel more data is coming to fill the TCP segments */
+            if (myGLSSocket->m_isEventLoop == 1) sock_size = queueIov(myGLSSocket, iov, nbIov, isLast ? 0 : GLS_MSG_MORE);
+            else sock_size = sendIov(myGLSSocket->m_sock, iov, nbIov, isLast ? 0 : GLS_MSG_MORE);
+            nbIov = 0;
+            
+            if (sock_size == SOCKET_ERROR) {
+                
+                /* get error */
+                int numError = errno;
                 
                 /* Debug only */
                 #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Impossible to config infoConnexion.\n");
-                printf("### connexion() End ###\n\n");
+                printf("Erreur de transmission sendPacket (packet %d)\n", packet);
                 #endif
                 
-                /* return getaddrinfo error */
-                switch (erreur) {
-                        
-                    case EAI_ADDRFAMILY :
-                        return GLS_ERROR_AI_ADDRFAMILY;
-                        break;
-                    
-                    case EAI_AGAIN :
-                        return GLS_ERROR_AI_AGAIN;
-                        break;
-                    
-                    case EAI_BADFLAGS :
-                        return GLS_ERROR_AI_BADFLAGS;
-                        break;
-                    
-                    case EAI_FAIL :
-                        return GLS_ERROR_AI_FAIL;
-                        break;
-                    
-                    case EAI_FAMILY :
-                        return GLS_ERROR_AI_FAMILY;
-                        break;
-                    
-                    case EAI_MEMORY :
-                        return GLS_ERROR_AI_MEMORY;
-                        break;
-                    
-                    case EAI_NODATA :
-                        return GLS_ERROR_AI_NODATA;
-                        break;
-                    
-                    case EAI_NONAME :
-                        return GLS_ERROR_AI_NONAME;
-                        break;
-                    
-                    case EAI_SERVICE :
-                        return GLS_ERROR_AI_SERVICE;
-                        break;
-                    
-                    case EAI_SOCKTYPE :
-                        return GLS_ERROR_AI_SOCKTYPE;
-                        break;
-                        
-                    default:
-                        return GLS_ERROR_AI_SYSTEM;
-                        break;
-                        
-                }
+                /* deblock mutex to let other thread to use the funciton */
+                pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
+                
+                /* Debug Only */
+                #if defined (GLS_DEBUG_MODE_ENABLE)
+                printf("### sendPacket() End ###\n\n");
+                #endif
+                
+                /* return send error */
+                return getSendError(numError);
+                
+            }
+            
+        }
+        
+    }
+    
+    /* Unlock the mutex allowing the socket use */
+    pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    if (myGLSSocket->m_isServeur) printf("Serveur - sendPacket() END\n");
+    else printf("Client - sendPacket() END\n");
+    printf("### sendPacket() End ###\n\n");
+    #endif
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Send without blocking the packets queued for an event
+ loop client (queueIov()), the buffer is freed once
+ empty.
+ 
+ Return 1 if packets are still waiting for the socket,
+ 0 if everything is sent or a negative number for an
+ error.
+ 
+ ---------------------------------------------------------*/
+
+int flushOutBuffer(GLSSock* myGLSSocket) {
+    
+    int isWaiting = 0;
+    
+    pthread_mutex_lock(&myGLSSocket->m_mutexSendPacket);
+    
+    while (myGLSSocket->m_posOutBuffer < myGLSSocket->m_sizeOutBuffer) {
+        
+        ssize_t sock_size = send(myGLSSocket->m_sock, myGLSSocket->m_outBuffer + myGLSSocket->m_posOutBuffer, myGLSSocket->m_sizeOutBuffer - myGLSSocket->m_posOutBuffer, GLS_MSG_EVENT);
+        if (sock_size < 0 && errno == EINTR) continue;
+        if (sock_size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            
+            isWaiting = 1;
+            break;
+            
+        }
+        if (sock_size <= 0) {
+            
+            int numError = errno;
+            pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
+            
+            return getSendError(numError);
+            
+        }
+        
+        myGLSSocket->m_posOutBuffer += sock_size;
+        
+    }
+    
+    /* Nothing kept for the clients which don't wait */
+    if (isWaiting == 0 && myGLSSocket->m_outBuffer != NULL) {
+        
+        free(myGLSSocket->m_outBuffer);
+        myGLSSocket->m_outBuffer = 0;
+        myGLSSocket->m_sizeOutBuffer = 0;
+        myGLSSocket->m_posOutBuffer = 0;
+        myGLSSocket->m_maxOutBuffer = 0;
+        
+    }
+    
+    pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
+    
+    return isWaiting;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Convert a send() errno into a GLS error.
+ 
+ ---------------------------------------------------------*/
+
+int getSendError(const int numError) {
+    
+    switch (numError) {
+            
+        case EACCES :
+            return GLS_ERROR_ACCES;
+            break;
+            
+        case EAGAIN :
+            return GLS_ERROR_AGAIN;
+            break;
+            
+        case EBADF :
+            return GLS_ERROR_BADF;
+            break;
+            
+        case ECONNRESET :
+            return GLS_ERROR_CONNRESET;
+            break;
+            
+        case EDESTADDRREQ :
+            return GLS_ERROR_DESTADDRREQ;
+            break;
+            
+        case EFAULT :
+            return GLS_ERROR_FAULT;
+            break;
+            
+        case EINTR :
+            return GLS_ERROR_INTR;
+            break;
+            
+        case EINVAL :
+            return GLS_ERROR_INVAL;
+            break;
+            
+        case EISCONN :
+            return GLS_ERROR_ISCONN;
+            break;
+            
+        case EMSGSIZE :
+            return GLS_ERROR_MSGSIZE;
+            break;
+            
+        case ENOBUFS :
+            return GLS_ERROR_NOBUFS;
+            break;
+            
+        case ENOMEM :
+            return GLS_ERROR_NOMEM;
+            break;
+            
+        case ENOTCONN :
+            return GLS_ERROR_NOTCONN;
+            break;
+            
+        case ENOTSOCK :
+            return GLS_ERROR_NOTSOCK;
+            break;
+            
+        case EOPNOTSUPP :
+            return GLS_ERROR_OPNOTSUPP;
+            break;
+            
+        case EPIPE :
+            return GLS_ERROR_PIPE;
+            break;
+            
+        default:
+            return GLS_ERROR_UNKNOWN;
+            break;
+            
+    }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Receive packet from the network by GLS_SIZE_PACKET bytes
+ (configurable in GLSHeaders.h). The packets are received
+ directly at their final place in the buffer, growing it
+ by doubling its size when needed.
+
+ Return the message size, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int recvPacket(GLSSock* myGLSSocket, byte** buffer, const int withTimeout) {
+        
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### recvPacket() Start ###\n");
+    if (myGLSSocket->m_isServeur) printf("Server - recvPacket()\n");
+    else printf("Client - recvPacket()\n");
+    #endif
+    
+    /* Lock the mutex */
+    pthread_mutex_lock(&myGLSSocket->m_mutexRecvPacket);
+    
+    /* 
+     * A message started by _recvNoWait() is in the buffer of m_handShake,
+     * the rest of it is read there
+     */
+    GLSHandShake* handShake = myGLSSocket->m_handShake;
+    if (handShake != NULL && handShake->m_state == GLS_ACCEPT_READY && (handShake->m_sizeHeader > 0 || handShake->m_sizePacket >= 0 || handShake->m_size > 0)) {
+        
+        pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
+        
+        return recvPacketFinish(myGLSSocket, buffer, withTimeout);
+        
+    }
+    
+    /* Variables init */
+    ssize_t sock_size = 0;
+    int size = 0;
+    int capacity = 0;
+    int error = 0;
+    *buffer = 0;
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    if (myGLSSocket->m_isServeur) printf("Server - recvPacket() - Waiting...\n");
+    else printf("Client - recvPacket() - Waiting...\n");
+    #endif
+    
+    /* First packet, with a timeout for the waiting period if needed */
+    if (withTimeout == 1) sock_size = recvHeader(myGLSSocket->m_sock, 0, GLS_TIMEOUT_PACKET);
+    else sock_size = recvHeader(myGLSSocket->m_sock, 0, 0);
+    
+    /* 
+     * A single packet message gets a buffer of its exact size, a bigger
+     * one starts with room for a few packets
+     */
+    if (sock_size > 0 && sock_size < GLS_SIZE_PACKET) capacity = (int) sock_size;
+    else if (sock_size > 0) capacity = 4 * GLS_SIZE_PACKET;
+    
+    /* While we are receiving full packets there are others to receive */
+    while (sock_size > 0) {
+        
+        /* Debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Size recv recvPacket : %ld\n", (long) sock_size);
+        #endif
+        
+        /* Grow the buffer (geometrically to stay linear) */
+        if (*buffer == NULL || size + sock_size > capacity) {
+            
+            while (size + sock_size > capacity) capacity *= 2;
+            
+            byte (*bufferTemp) = realloc(*buffer, capacity * sizeof(byte));
+            if (bufferTemp == NULL) {
+                
+                #if defined (GLS_DEBUG_MODE_ENABLE)
+                printf("No memory recvPacket\n");
+                #endif
+                
+                error = GLS_ERROR_NOMEM;
+                break;
                 
             }
+            *buffer = bufferTemp;
             
-            /* Socket creation */
-            myGLSSocket->m_sock = socket(myGLSSocket->m_infoConnexion->ai_family, myGLSSocket->m_infoConnexion->ai_socktype, myGLSSocket->m_infoConnexion->ai_protocol);
+        }
+        
+        /* Packet received directly at its place */
+        int sizePacket = (int) sock_size;
+        sock_size = recvAll(myGLSSocket->m_sock, *buffer + size, sizePacket, 0);
+        if (sock_size == SOCKET_ERROR) break;
+        
+        /* If the packet's size is 4 bytes after a full packet we check
+         for a EOF signal */
+        if (sizePacket == 4 && size > 0 && memcmp(*buffer + size, "EOF", 4) == 0) {
+            
+            /* Debug only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            if (myGLSSocket->m_isServeur) printf("Server - recvPacket() EOF\n");
+            else printf("Client - recvPacket() EOF\n");
+            #endif
+            
+            break;
+            
+        }
+        
+        /* Total actual buffer size */
+        size += sizePacket;
+        
+        /* Last packet of the message */
+        if (sizePacket < GLS_SIZE_PACKET) break;
+        
+        /* Next packet */
+        sock_size = recvHeader(myGLSSocket->m_sock, 0, GLS_TIMEOUT_PACKET);
+        
+    }
+    
+    /* Error handling */
+    if (error == 0 && sock_size == GLS_ERROR_TIMEDOUT) error = GLS_ERROR_TIMEDOUT;
+    else if (error == 0 && sock_size == 0) error = GLS_ERROR_NOMESSAGE;
+    else if (error == 0 && sock_size < 0) error = getRecvError(errno);
+    
+    if (error < 0) {
+        
+        /* Debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Error transmission recvPacket (%d)\n", error);
+        #endif
+        
+        /* Free memory */
+        if (*buffer != NULL) {
+            free(*buffer);
+            *buffer = 0;
+        }
+        
+        /* Unlock the mutex */
+        pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("### recvPacket() End ###\n\n");
+        #endif
+        
+        return error;
+        
+    }
+    
+    /* Unlock mutex */
+    pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    if (myGLSSocket->m_isServeur == 1) printf("Server - recvPacket() END\n");
+    else printf("Client - recvPacket() END\n");
+    printf("### recvPacket() End ###\n\n");
+    #endif
+    
+    return size;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Same as recvPacket() without blocking, for the handshake
+ of the server. The bytes waiting on the socket are added
+ to the message of m_handShake, which is given to buffer
+ when its last packet is received.
+ 
+ Return the message size, GLS_ERROR_AGAIN when the message
+ is not complete or another negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int recvPacketNoWait(GLSSock* myGLSSocket, byte** buffer) {
+    
+    GLSHandShake* handShake = myGLSSocket->m_handShake;
+    ssize_t sock_size = 0;
+    int error = 0;
+    *buffer = 0;
+    
+    /* Lock the mutex */
+    pthread_mutex_lock(&myGLSSocket->m_mutexRecvPacket);
+    
+    while (error == 0) {
+        
+        /* 2 bytes header of the next packet, maybe in 2 times */
+        if (handShake->m_sizePacket < 0) {
             
-            /* If connexion impossible */
-            if(connect(myGLSSocket->m_sock, myGLSSocket->m_infoConnexion->ai_addr, myGLSSocket->m_infoConnexion->ai_addrlen) == SOCKET_ERROR) {
+            sock_size = recv(myGLSSocket->m_sock, handShake->m_header + handShake->m_sizeHeader, 2 - handShake->m_sizeHeader, MSG_DONTWAIT);
+            if (sock_size < 0 && errno == EINTR) continue;
+            if (sock_size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
                 
-                /* get error */
-                int numError = errno;
+                pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
                 
-                /* free memory */
-                if (userId != NULL) {
-                    
-                    free(userId);
-                    userId = 0;
-                    
-                }
-                if (messageHello != NULL) {
-                    
-                    free(messageHello);
-                    messageHello = 0;
-                    
-                }
-                if (cipherText != NULL) {
-                    
-                    free(cipherText);
-                    cipherText = 0;
-                    
-                }
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Impossible de se connecter.\n");
-                printf("Num error : %d\n", numError);
-                printf("### connexion() End ###\n\n");
-                #endif
+                return GLS_ERROR_AGAIN;
                 
-                /* return connect error */
-                switch (numError) {
-                        
-                    case EACCES :
-                        return GLS_ERROR_ACCES;
-                        break;
-                        
-                    case EPERM :
-                        return GLS_ERROR_PERM;
-                        break;
-                        
-                    case EADDRINUSE :
-                        return GLS_ERROR_ADDRINUSE;
-                        break;
-                        
-                    case EAFNOSUPPORT :
-                        return GLS_ERROR_AFNOSUPPORT;
-                        break;
-                        
-                    case EAGAIN :
-                        return GLS_ERROR_AGAIN;
-                        break;
-                        
-                    case EALREADY :
-                        return GLS_ERROR_ALREADY;
-                        break;
-                        
-                    case EBADF :
-                        return GLS_ERROR_BADF;
-                        break;
-                        
-                    case ECONNREFUSED :
-                        return GLS_ERROR_CONNREFUSED;
-                        break;
-                        
-                    case EHOSTDOWN :
-                        return GLS_ERROR_HOSTDOWN;
-                        break;
-                        
-                    case EFAULT :
-                        return GLS_ERROR_FAULT;
-                        break;
-                        
-                    case EINPROGRESS :
-                        return GLS_ERROR_INPROGRESS;
-                        break;
-                    
-                    case EINTR :
-                        return GLS_ERROR_INTR;
-                        break;
-                        
-                    case EISCONN :
-                        return GLS_ERROR_ISCONN;
-                        break;
-                        
-                    case ENETUNREACH :
-                        return GLS_ERROR_NETUNREACH;
-                        break;
-                        
-                    case ENOTSOCK :
-                        return GLS_ERROR_NOTSOCK;
-                        break;
-                        
-                    case ETIMEDOUT :
-                        return GLS_ERROR_TIMEDOUT;
-                        break;
-                        
-                    default:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                }
-                                
             }
             
-            /* Sending hello message */
-            int error = sendPacket(myGLSSocket, messageHello, (16 + sizeUserId - 1));
+            /* Connexion closed by the other side */
+            if (sock_size == 0) error = GLS_ERROR_NOTCONN;
+            else if (sock_size < 0) error = getRecvError(errno);
+            if (error != 0) break;
             
-            /* If impossible to send the message, return error */
-            if (error < 0) {
+            handShake->m_sizeHeader += (int) sock_size;
+            if (handShake->m_sizeHeader < 2) continue;
+            
+            /* Packet size (big-endian) */
+            handShake->m_sizeHeader = 0;
+            handShake->m_sizeRecv = 0;
+            handShake->m_sizePacket = (handShake->m_header[0] << 8) | handShake->m_header[1];
+            if (handShake->m_sizePacket == 0) {
                 
-                /* free memory */
-                if (userId != NULL) {
-                    
-                    free(userId);
-                    userId = 0;
-                    
-                }
-                if (messageHello != NULL) {
-                    
-                    free(messageHello);
-                    messageHello = 0;
-                    
-                }
-                if (cipherText != NULL) {
+                error = GLS_ERROR_NOMESSAGE;
+                break;
+                
+            }
+            
+            /* Grow the buffer like recvPacket() */
+            if (handShake->m_size + handShake->m_sizePacket > handShake->m_capacity) {
+                
+                int capacity = handShake->m_capacity;
+                if (capacity == 0 && handShake->m_sizePacket < GLS_SIZE_PACKET) capacity = handShake->m_sizePacket;
+                else if (capacity == 0) capacity = 4 * GLS_SIZE_PACKET;
+                while (handShake->m_size + handShake->m_sizePacket > capacity) capacity *= 2;
+                
+                byte (*bufferTemp) = realloc(handShake->m_message, capacity * sizeof(byte));
+                if (bufferTemp == NULL) {
                     
-                    free(cipherText);
-                    cipherText = 0;
+                    error = GLS_ERROR_NOMEM;
+                    break;
                     
                 }
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Impossible to send the packet.\n");
-                printf("### connexion() End ###\n\n");
-                #endif
-
-                /* return error */
-                return error;
+                handShake->m_message = bufferTemp;
+                handShake->m_capacity = capacity;
                 
             }
             
+        }
+        
+        /* Packet received directly at its place */
+        sock_size = recv(myGLSSocket->m_sock, handShake->m_message + handShake->m_size + handShake->m_sizeRecv, handShake->m_sizePacket - handShake->m_sizeRecv, MSG_DONTWAIT);
+        if (sock_size < 0 && errno == EINTR) continue;
+        if (sock_size < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            
+            pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
+            
+            return GLS_ERROR_AGAIN;
+            
+        }
+        
+        if (sock_size == 0) error = GLS_ERROR_NOTCONN;
+        else if (sock_size < 0) error = getRecvError(errno);
+        if (error != 0) break;
+        
+        handShake->m_sizeRecv += (int) sock_size;
+        if (handShake->m_sizeRecv < handShake->m_sizePacket) continue;
+        
+        /* Packet complete, the next one starts with a header */
+        int sizePacket = handShake->m_sizePacket;
+        handShake->m_sizePacket = -1;
+        
+        /* EOF signal after a full packet */
+        int isEof = (sizePacket == 4 && handShake->m_size > 0 && memcmp(handShake->m_message + handShake->m_size, "EOF", 4) == 0);
+        if (isEof == 0) handShake->m_size += sizePacket;
+        
+        /* Not the last packet of the message */
+        if (isEof == 0 && sizePacket == GLS_SIZE_PACKET) continue;
+        
+        /* Message given to the caller */
+        int size = handShake->m_size;
+        *buffer = handShake->m_message;
+        handShake->m_message = 0;
+        handShake->m_size = 0;
+        handShake->m_capacity = 0;
+        
+        pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
+        
+        return size;
+        
+    }
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Error transmission recvPacketNoWait (%d)\n", error);
+    #endif
+    
+    /* Free memory */
+    if (handShake->m_message != NULL) {
+        
+        free(handShake->m_message);
+        handShake->m_message = 0;
+        
+    }
+    handShake->m_size = 0;
+    handShake->m_capacity = 0;
+    
+    /* Unlock the mutex */
+    pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
+    
+    return error;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Finish with recvPacketNoWait() a message already started
+ in m_handShake, waiting for the socket between its parts
+ (GLS_TIMEOUT_PACKET seconds at most with withTimeout).
+ 
+ Return the message size or a negative number for an
+ error.
+ 
+ ---------------------------------------------------------*/
+
+int recvPacketFinish(GLSSock* myGLSSocket, byte** buffer, const int withTimeout) {
+    
+    while (1) {
+        
+        int size = recvPacketNoWait(myGLSSocket, buffer);
+        if (size != GLS_ERROR_AGAIN) return size;
+        
+        struct pollfd fds;
+        fds.fd = myGLSSocket->m_sock;
+        fds.events = POLLIN;
+        fds.revents = 0;
+        
+        int error = poll(&fds, 1, (withTimeout == 1) ? GLS_TIMEOUT_PACKET * 1000 : -1);
+        if (error < 0 && errno == EINTR) continue;
+        if (error == 0) return GLS_ERROR_TIMEDOUT;
+        if (error < 0) return GLS_ERROR_UNKNOWN;
+        
+    }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Convert a recv() errno into a GLS error.
+ 
+ ---------------------------------------------------------*/
+
+int getRecvError(const int numError) {
+    
+    switch (numError) {
+            
+        case EAGAIN :
+            return GLS_ERROR_AGAIN;
+            break;
+            
+        case EBADF :
+            return GLS_ERROR_BADF;
+            break;
+            
+        case ECONNREFUSED :
+            return GLS_ERROR_CONNREFUSED;
+            break;
+            
+        case EFAULT :
+            return GLS_ERROR_FAULT;
+            break;
+            
+        case EINTR :
+            return GLS_ERROR_INTR;
+            break;
             
-            /* Leave time for the server to process the request (getting password) */
-            sleep(1);
+        case EINVAL :
+            return GLS_ERROR_INVAL;
+            break;
             
-            /* Send second message (encrypted) */
-            error = sendPacket(myGLSSocket, cipherText, sizeCipherText);
+        case ENOMEM :
+            return GLS_ERROR_NOMEM;
+            break;
             
-            /* If impossible to send the message, return error */
-            if (error < 0) {
-                
-                /* free memory */
-                if (userId != NULL) {
-                    
-                    free(userId);
-                    userId = 0;
-                    
-                }
-                if (messageHello != NULL) {
-                    
-                    free(messageHello);
-                    messageHello = 0;
-                    
-                }
-                if (cipherText != NULL) {
-                    
-                    free(cipherText);
-                    cipherText = 0;
-                    
-                }
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Impossible to send the packet.\n");
-                printf("### connexion() End ###\n\n");
-                #endif
-                
-                /* return error */
-                return error;
-                
-            }
+        case ENOTCONN :
+            return GLS_ERROR_NOTCONN;
+            break;
             
-            /* First message reception */
-            byte (*firstMessage) = 0;
-            int sizeFirstMessage = recvPacket(myGLSSocket, &firstMessage, 1);
-            if (sizeFirstMessage < 0) {
-                
-                /* free memory */
-                if (userId != NULL) {
-                    
-                    free(userId);
-                    userId = 0;
-                    
-                }
-                if (messageHello != NULL) {
-                    
-                    free(messageHello);
-                    messageHello = 0;
-                    
-                }
-                if (cipherText != NULL) {
-                    
-                    free(cipherText);
-                    cipherText = 0;
-                    
-                }
-                if (firstMessage != NULL) {
-                    
-                    free(firstMessage);
-                    firstMessage = 0;
-                    
-                }
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Error size firstMessage Connexion\n");
-                printf("### connexion() End ###\n\n");
-                #endif
-                
-                /* return error */
-                return sizeFirstMessage;
-                
-            }
+        case ENOTSOCK :
+            return GLS_ERROR_NOTSOCK;
+            break;
             
-            /* Message decryption */
-            byte (*helloServer) = 0;
-            int sizeHelloServer = allDecrypt(myGLSSocket, firstMessage, sizeFirstMessage, &helloServer);
-            if (sizeHelloServer < 0) {
-                
-                error = -1;
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Error Decrypt Connexion\n");
-                #endif
-                
-            }
-            /*
-             * Check message type, if impossible to decrypt, it's used like
-             * a plaintext message (error message).
-             */
-            int messageType = 0;
-            if (error == 0) messageType = getTypeGLS(helloServer, sizeHelloServer);
-            else messageType = getTypeGLS(firstMessage, sizeFirstMessage);
+        case ECONNRESET :
+            return GLS_ERROR_CONNRESET;
+            break;
             
-            if (messageType == GLS_TYPE_HELLO_SERVER) {
-                
-                /*
-                 * Do something if it's ok.
-                 * Normaly nothing needs to be done, it's just 
-                 * in case (for a futur need).
-                 */
+        default:
+            return GLS_ERROR_UNKNOWN;
+            break;
+            
+    }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ Send a message using the secure connexion. You can use this function
+ on a thread.
+ 
+ Return the message's size send or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int glsSend(GLSSock* myGLSSocket, const byte* buffer, const int sizeBuffer){
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsSend() Start ###\n");
+    #endif
+    
+    /* Check if connexion is ok */
+    if (myGLSSocket->m_isSocketConfig == 1 && myGLSSocket->m_isHandShakeFinish == 1) {
+
+        /* Lock mutex for threading */
+        pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
+        
+        #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
+        struct timeval sTime;
+        gettimeofday(&sTime, NULL);
+        /* ProcessTime example */
+        struct timeval startTime;
+        struct timeval endTime;
+        /*structure for rusage */
+        struct rusage ru;
+        /* get the current time
+         - RUSAGE_SELF for current process
+         - RUSAGE_CHILDREN for *terminated* subprocesses */
+        getrusage(RUSAGE_SELF, &ru);
+        startTime = ru.ru_utime;
+        #endif
+        
+       
+        /* Buffer encryption */
+        unsigned long long timeStart = getTimeMicro();
+        byte (*cipherText) = 0;
+        int sizeCipherText = 0;
+        if (myGLSSocket->m_activeSuite == GLS_SUITE_SERPENT_TWOFISH_CTR) sizeCipherText = ctrEncrypt(myGLSSocket, buffer, sizeBuffer, &cipherText);
+        else if (myGLSSocket->m_activeSuite != GLS_SUITE_SERPENT_TWOFISH) sizeCipherText = aeadEncrypt(myGLSSocket, buffer, sizeBuffer, &cipherText);
+        else sizeCipherText = allEncrypt(myGLSSocket, buffer, sizeBuffer, &cipherText);
+        myGLSSocket->m_statsSend.m_encryptTime += getTimeMicro() - timeStart;
+        
+        #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
+        struct timeval eTime;
+        gettimeofday(&eTime, NULL);
+        double tS = sTime.tv_sec*1000000 + (sTime.tv_usec);
+        double tE = eTime.tv_sec*1000000  + (eTime.tv_usec);
+        printf("Time for total encryption (Clock) : %f microSeconds\n", tE - tS);
+        printf("Speed Encryption (Clock) : %f Mo/s\n", (sizeBuffer / 1000) / ((tE - tS) / 1000));
+        /* get the end time */
+        getrusage(RUSAGE_SELF, &ru);
+        endTime = ru.ru_utime;
+        /* calculate time in microseconds */
+        tS = startTime.tv_sec*1000000 + (startTime.tv_usec);
+        tE = endTime.tv_sec*1000000  + (endTime.tv_usec);
+        printf("Time for total encryption (CPU) : %f microSeconds\n", tE - tS);
+        printf("Speed Encryption (CPU) : %f Mo/s\n", (sizeBuffer / 1000) / ((tE - tS) / 1000));
+        #endif
+        
+        if (sizeCipherText < 0) {
+            
+            /* Free memory */
+            if (cipherText != NULL) {
+                free(cipherText);
+                cipherText = 0;
             }
-            else if (messageType == GLS_TYPE_ERROR) {
-                
-                /* Get the error (considering encryption) */
-                int messageError = 1;
-                if (error == 0) messageError = getNumError(helloServer, sizeHelloServer);
-                else messageError = getNumError(firstMessage, sizeFirstMessage);
-                
-                /* Free memory */
-                if (userId != NULL) {
-                    
-                    free(userId);
-                    userId = 0;
-                    
-                }
-                if (messageHello != NULL) {
-                    
-                    free(messageHello);
-                    messageHello = 0;
-                    
-                }
-                if (cipherText != NULL) {
-                    
-                    free(cipherText);
-                    cipherText = 0;
-                    
-                }
-                if (firstMessage != NULL) {
-                    
-                    free(firstMessage);
-                    firstMessage = 0;
-                    
-                }
-                if (helloServer != NULL) {
-                    
-                    free(helloServer);
-                    helloServer = 0;
-                    
-                }
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### connexion() End ###\n\n");
-                #endif
-                
-                /* Return GLS error */
-                switch (messageError) {
-                        
-                    case 100:
-                        return GLS_ERROR_BADPASSWD;
-                        break;
-                        
-                    case 101:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 102:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 200:
-                        return GLS_ERROR_VERSION;
-                        break;
-                        
-                    case 300:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 301:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 302:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 400:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 401:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 402:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 403:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 404:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    case 500:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                    default:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                }
+            
+            /* Unlock mutex for threading */
+            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
+            
+            /* Debug Only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("### glsSend() End ###\n\n");
+            #endif
+            
+            return sizeCipherText;
+        
+        }
+        
+        /* Send message, the cipher text belongs to sendCipherText() now */
+        int error = sendCipherText(myGLSSocket, cipherText, sizeCipherText, 1);
+        if (error == 0) {
+            
+            myGLSSocket->m_statsSend.m_bytesSent += sizeBuffer;
+            myGLSSocket->m_statsSend.m_messagesSent++;
+            
+        }
+        
+        /* Unlock the mutex */
+        pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("### glsSend() End ###\n\n");
+        #endif
+        
+        return error;
+        
+    }
+    else {
+        
+        /* We don't unlock the mutex because it's only lock
+         if the condition is true */
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("### glsSend() End ###\n\n");
+        #endif
                 
-            }
-            else error = -1;
+        if (myGLSSocket->m_isSocketConfig == 0 || myGLSSocket->m_isHandShakeFinish == 0) return GLS_ERROR_NOTCONN;
+        else return GLS_ERROR_UNKNOWN;
+    
+    }
+
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ Send a message without copy, the message is at buffer +
+ GLS_SIZE_HEADROOM and is encrypted in place.
+ 
+ Return 0 for success or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int glsSendInPlace(GLSSock* myGLSSocket, byte* buffer, const int sizeBuffer){
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsSendInPlace() Start ###\n");
+    #endif
+    
+    /* Check if connexion is ok */
+    if (myGLSSocket->m_isSocketConfig == 0 || myGLSSocket->m_isHandShakeFinish == 0) {
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("### glsSendInPlace() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_NOTCONN;
+        
+    }
+    
+    /* Lock mutex for threading */
+    pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
+    
+    /* Buffer encryption in place, the AEAD header is shorter than the headroom */
+    unsigned long long timeStart = getTimeMicro();
+    byte* cipherText = buffer;
+    int error = 0;
+    if (myGLSSocket->m_activeSuite == GLS_SUITE_SERPENT_TWOFISH_CTR) error = ctrEncryptInPlace(myGLSSocket, buffer, sizeBuffer);
+    else if (myGLSSocket->m_activeSuite != GLS_SUITE_SERPENT_TWOFISH) {
+        
+        cipherText = buffer + GLS_SIZE_HEADROOM - GLS_SIZE_AEAD_HEADER;
+        error = aeadEncryptInPlace(myGLSSocket, cipherText, sizeBuffer);
+        
+    }
+    else error = allEncryptInPlace(myGLSSocket, buffer, sizeBuffer);
+    myGLSSocket->m_statsSend.m_encryptTime += getTimeMicro() - timeStart;
+    
+    /* Send message, the buffer still belongs to the caller */
+    if (error > 0) error = sendCipherText(myGLSSocket, cipherText, error, 0);
+    if (error == 0) {
+        
+        myGLSSocket->m_statsSend.m_bytesSent += sizeBuffer;
+        myGLSSocket->m_statsSend.m_messagesSent++;
+        
+    }
+    
+    /* Unlock mutex for threading */
+    pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsSendInPlace() End ###\n\n");
+    #endif
+    
+    return error;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Send an encrypted message and handle its acknowledgement,
+ m_mutexGlsSend must be locked. If isOwner = 1 the cipher
+ text is freed (or kept until its acknowledgement in
+ pipelined mode), otherwise it is only read.
+ 
+ Return 0 for success or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int sendCipherText(GLSSock* myGLSSocket, byte* cipherText, const int sizeCipherText, const int isOwner) {
+    
+    /* 
+     * Client of the event loop, the thread can't wait : the message is
+     * in flight until the loop reads its acknowledgement (_recvNoWait())
+     */
+    if (myGLSSocket->m_isEventLoop == 1) {
+        
+        if (myGLSSocket->m_sendSeq - myGLSSocket->m_ackSeq >= (unsigned int) myGLSSocket->m_maxInFlight) {
             
-            /* If no error, configuring the socket to say everything is ok */
-            if (error == 0) {
-                
-                myGLSSocket->m_isHandShakeFinish = 1;
-                myGLSSocket->m_isSocketConfig = 1;
-                
-            }
+            if (isOwner == 1) free(cipherText);
             
-            /* free memory */
-            if (userId != NULL) {
-                
-                free(userId);
-                userId = 0;
-                
-            }
-            if (messageHello != NULL) {
-                
-                free(messageHello);
-                messageHello = 0;
-                
-            }
-            if (cipherText != NULL) {
-                
-                free(cipherText);
-                cipherText = 0;
-                
-            }
-            if (firstMessage != NULL) {
-                
-                free(firstMessage);
-                firstMessage = 0;
-                
-            }
-            if (helloServer != NULL) {
-                
-                free(helloServer);
-                helloServer = 0;
-                
-            }
+            return GLS_ERROR_AGAIN;
             
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### connexion() End ###\n\n");
-            #endif
+        }
+        
+        /* The message is kept until its acknowledgement in case of retry */
+        if (isOwner == 0) {
             
-            /* return error if one or 0 if success */
-            if (error != 0) return GLS_ERROR_UNKNOWN;
-            else return 0;
+            byte* copy = malloc(sizeof(byte) * sizeCipherText);
+            if (copy == NULL) return GLS_ERROR_NOMEM;
+            memcpy(copy, cipherText, sizeCipherText);
+            cipherText = copy;
             
         }
-        else {
+        
+        int index = myGLSSocket->m_sendSeq % myGLSSocket->m_maxInFlight;
+        myGLSSocket->m_inFlight[index] = cipherText;
+        myGLSSocket->m_sizeInFlight[index] = sizeCipherText;
+        myGLSSocket->m_timeInFlight[index] = getTimeMicro();
+        myGLSSocket->m_sendSeq++;
+        
+        /* Queued if the socket is full */
+        int error = sendPacket(myGLSSocket, cipherText, sizeCipherText);
+        
+        if (error < 0) return error;
+        else return 0;
+        
+    }
+    
+    /* Pipelined mode, we don't wait for the acknowledgement */
+    if (myGLSSocket->m_sendWindow > 1) {
+        
+        int error = 0;
+        
+        /* The message is kept until its acknowledgement in case of retry */
+        if (isOwner == 0) {
             
-            /* Debug only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("Impossible to connect (WSADATA).\n");
-            printf("### connexion() End ###\n\n");
-            #endif
+            byte* copy = malloc(sizeof(byte) * sizeCipherText);
+            if (copy == NULL) return GLS_ERROR_NOMEM;
+            memcpy(copy, cipherText, sizeCipherText);
+            cipherText = copy;
             
-            /*
-             * RETURN WINDOWS ERROR
-             * not yet implemented
-             */
-            return GLS_ERROR_UNKNOWN;
+        }
+        
+        /* Read the acknowledgements already arrived to keep the window open */
+        while (error == 0 && myGLSSocket->m_ackSeq != myGLSSocket->m_sendSeq && isAckPending(myGLSSocket)) {
+            
+            error = waitAck(myGLSSocket);
             
         }
-                  
-     }
-     else {
-         
-         /* Debug only */
-         #if defined (GLS_DEBUG_MODE_ENABLE)
-         if (myGLSSocket->m_isSocketConfig == 1) printf("Socket already config.\n");
-         if (myGLSSocket->m_isHandShakeFinish == 1) printf("HandShake done.\n");
-         if (myGLSSocket->m_isCryptoKey == 0) printf("No encryption key.\n");
-         if (myGLSSocket->m_isUserConfig == 0) printf("No user id\n");
-         #endif
-         
-         /* Debug Only */
-         #if defined (GLS_DEBUG_MODE_ENABLE)
-         printf("### connexion() End ###\n\n");
-         #endif
-         
-         if (myGLSSocket->m_isSocketConfig == 1 || myGLSSocket->m_isHandShakeFinish == 1) return GLS_ERROR_ISCONN;
-         else if (myGLSSocket->m_isCryptoKey == 0) return GLS_ERROR_NOPASSWD;
-         else if (myGLSSocket->m_isUserConfig == 0) return GLS_ERROR_USERNOTCONF;
-         else return GLS_ERROR_UNKNOWN;
-     
-     }
+        
+        /* Wait until there is a free place in the window */
+        while (error == 0 && (myGLSSocket->m_sendSeq - myGLSSocket->m_ackSeq) >= (unsigned int) myGLSSocket->m_sendWindow) {
+            
+            error = waitAck(myGLSSocket);
+            
+        }
+        
+        if (error < 0) {
+            
+            /* Free memory */
+            free(cipherText);
+            cipherText = 0;
+            
+            return error;
+            
+        }
+        
+        /* Keep the message until its acknowledgement in case of retry */
+        int index = myGLSSocket->m_sendSeq % myGLSSocket->m_maxInFlight;
+        myGLSSocket->m_inFlight[index] = cipherText;
+        myGLSSocket->m_sizeInFlight[index] = sizeCipherText;
+        myGLSSocket->m_timeInFlight[index] = getTimeMicro();
+        myGLSSocket->m_sendSeq++;
+        
+        /* Debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        if (myGLSSocket->m_isServeur) printf("Server - glsSend() sendPacket pipelined (seq %u)\n", myGLSSocket->m_sendSeq - 1);
+        else printf("Client - glsSend() sendPacket pipelined (seq %u)\n", myGLSSocket->m_sendSeq - 1);
+        #endif
+        
+        /* Send message */
+        error = sendPacket(myGLSSocket, cipherText, sizeCipherText);
+        
+        if (error < 0) return error;
+        else return 0;
+        
+    }
+    
+    /* Send message */
+    int nbEssai = 0;
+    int error = -1;
+    while (error != 0 && nbEssai < 3) {
+        
+        /* Debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        if (myGLSSocket->m_isServeur) printf("Server - glsSend() sendPacket\n");
+        else printf("Client - glsSend() sendPacket\n");
+        #endif
+        
+        /* Send message */
+        unsigned long long timeSend = getTimeMicro();
+        if (nbEssai > 0) myGLSSocket->m_statsSend.m_nbRetry++;
+        error = sendPacket(myGLSSocket, cipherText, sizeCipherText);
+        if (error < 0) {
+            
+            /* Free memory */
+            if (isOwner == 1) free(cipherText);
+            
+            return error;
+        
+        }
+        
+        /* Debug only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        if (myGLSSocket->m_isServeur) printf("Server - glsSend() receive confirm\n");
+        else printf("Client - glsSend() receive confirm\n");
+        #endif
+        
+        /* Waiting for the acknowledgement of receipt with timeout */
+        byte (*okMessage) = 0;
+        int sizeOkMessage = recvAck(myGLSSocket, &okMessage);
+        if (sizeOkMessage < 0) {
+            
+            /* On vide la mémoire */
+            if (isOwner == 1) free(cipherText);
+            if (okMessage != NULL) {
+                free(okMessage);
+                okMessage = 0;
+            }
+            
+            return sizeOkMessage;
+            
+        }
+        
+        /* Round trip of the acknowledgement */
+        unsigned long long timeAck = getTimeMicro() - timeSend;
+        myGLSSocket->m_statsSend.m_nbAck++;
+        myGLSSocket->m_statsSend.m_ackTime += timeAck;
+        addHistogram(myGLSSocket->m_statsSend.m_ackHistogram, timeAck);
+        
+        /* If any problem occured during the transmission we send
+           the message again */
+        if (sizeOkMessage > 0 && okMessage[0] == 1) error = 0;
+        else error = -1;
+        
+        nbEssai++;
+        
+        /* Free memory */
+        if (okMessage != NULL) {
+            free(okMessage);
+            okMessage = 0;
+        }
+        
+    }
+    
+    /* Free memory */
+    if (isOwner == 1) free(cipherText);
+    
+    /* If there is always an error after 3 attempt we return
+       an error. IVs will be desynchronized */
+    if (error != 0) {
+        
+        myGLSSocket->m_statsSend.m_nbIvDesync++;
+        
+        return GLS_ERROR_IVDESYNC;
+        
+    }
+    
+    /* Keep the sequence numbers synchronized with the receiver */
+    myGLSSocket->m_sendSeq++;
+    myGLSSocket->m_ackSeq++;
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    if (myGLSSocket->m_isServeur) printf("Server - glsSend() finish OK\n");
+    else printf("Client - glsSend() finish OK\n");
+    #endif
+    
+    return 0;
     
 }
 
@@ -3552,718 +4952,339 @@ int connexion(GLSSock* myGLSSocket, const char* address, const char* port) {
 
 /*-------------------------------------------------------
  
- PRIVATE
- 
- Send packet over the network with size = GLS_SIZE_PACKET
- (configurable in GLSHeaders.h).
+ Wait for a message, you can use this function on a thread.
+ You are responsible for deallocating the buffer with free().
  
- Return 0 for success, a negative number for an error.
+ Return the size of the received message or a negative 
+ number for an error.
  
  ---------------------------------------------------------*/
 
-int sendPacket(GLSSock* myGLSSocket, const byte* buffer, const int size) {
+int glsRecv(GLSSock* myGLSSocket, byte** buffer){
     
-    /* Debug only */
+    /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### sendPacket() Start ###\n");
-    if (myGLSSocket->m_isServeur) printf("Serveur - sendPacket() %d bytes\n", size);
-    else printf("Client - sendPacket() %d bytes\n", size);
+    printf("### glsRecv() Start ###\n");
     #endif
     
-    /* Block other send in other threads */
-    pthread_mutex_lock(&myGLSSocket->m_mutexSendPacket);
-    
-    /* Check if we need to send one or more packets */
-    if (size >= GLS_SIZE_PACKET) {
+    /* Check if the connexion is ok */
+    if (myGLSSocket->m_isSocketConfig == 1 && myGLSSocket->m_isHandShakeFinish == 1) {
         
-        /* Variables init */
-        long sock_size = 0;
-        byte temp[GLS_SIZE_PACKET];
-        int y = 0;
-        int sizeLeft = size;
+        /* Lock mutex */
+        pthread_mutex_lock(&myGLSSocket->m_mutexGlsRecv);
         
-        /* While it still content to send */
-        while (sizeLeft > 0) {
+        /* Message already read by glsSend() while waiting for an acknowledgement */
+        pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
+        int sizeQueued = popRecvQueue(myGLSSocket, buffer);
+        pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
+        if (sizeQueued >= 0) {
             
-            /* 
-             * Check if it still more than one packet to send
-             * or we create an array of the size left.
-             */
-            if (sizeLeft > GLS_SIZE_PACKET) {
-                
-                /* fill temp variable with buffer */
-                int i = 0;
-                for (i = 0; i < GLS_SIZE_PACKET; i++) {
-                    
-                    temp[i] = buffer[i + y * GLS_SIZE_PACKET]; 
-                    
-                }
-                
-                /* Debug only (a lot of printf, takes times) */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                usleep(10000);
-                #endif
-                
-                /* if headers in packet are used */
-                #if defined (GLS_HEADER_PACKET)
-                sock_size = sendWithHeader(myGLSSocket->m_sock, temp, GLS_SIZE_PACKET, 0);
-                #else
-                /* Sending packet of GLS_SIZE_PACKET bytes */
-                sock_size = send(myGLSSocket->m_sock, temp, GLS_SIZE_PACKET, 0);
-                #endif
-
-                if(sock_size == SOCKET_ERROR || sock_size == 0) {
-                    
-                    /* get error */
-                    int numError = errno;
-                    
-                    /* Debug only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("Erreur de transmission sendPacket 1\n");
-                    #endif
-                    
-                    /* deblock mutex to let other thread to use the funciton */
-                    pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
-                    
-                    /* Debug Only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("### sendPacket() End ###\n\n");
-                    #endif
-                    
-                    /* return send error */
-                    switch (numError) {
-                            
-                        case EACCES :
-                            return GLS_ERROR_ACCES;
-                            break;
-                            
-                        case EAGAIN :
-                            return GLS_ERROR_AGAIN;
-                            break;
-                            
-                        case EBADF :
-                            return GLS_ERROR_BADF;
-                            break;
-                            
-                        case ECONNRESET :
-                            return GLS_ERROR_CONNRESET;
-                            break;
-                            
-                        case EDESTADDRREQ :
-                            return GLS_ERROR_DESTADDRREQ;
-                            break;
-                            
-                        case EFAULT :
-                            return GLS_ERROR_FAULT;
-                            break;
-                            
-                        case EINTR :
-                            return GLS_ERROR_INTR;
-                            break;
-                            
-                        case EINVAL :
-                            return GLS_ERROR_INVAL;
-                            break;
-                            
-                        case EISCONN :
-                            return GLS_ERROR_ISCONN;
-                            break;
-                            
-                        case EMSGSIZE :
-                            return GLS_ERROR_MSGSIZE;
-                            break;
-                            
-                        case ENOBUFS :
-                            return GLS_ERROR_NOBUFS;
-                            break;
-                            
-                        case ENOMEM :
-                            return GLS_ERROR_NOMEM;
-                            break;
-                            
-                        case ENOTCONN :
-                            return GLS_ERROR_NOTCONN;
-                            break;
-                            
-                        case ENOTSOCK :
-                            return GLS_ERROR_NOTSOCK;
-                            break;
-                        
-                        case EOPNOTSUPP :
-                            return GLS_ERROR_OPNOTSUPP;
-                            break;
-                            
-                        case EPIPE :
-                            return GLS_ERROR_PIPE;
-                            break;
-                            
-                        default:
-                            return GLS_ERROR_UNKNOWN;
-                            break;
-                            
-                    }
-
-                    
-                } 
-                
-                /* remove send bytes from size left */
-                y++;
-                sizeLeft -= GLS_SIZE_PACKET;
-
-            }
-            else if (sizeLeft == GLS_SIZE_PACKET){
+            /* Unlock mutex */
+            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+            
+            /* Debug Only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("Message from the queue\n");
+            printf("### glsRecv() End ###\n\n");
+            #endif
+            
+            return sizeQueued;
+            
+        }
+        
+        /* Receive message */
+        int nbEssai = 0;
+        int nbDiscard = 0;
+        int error = -1;
+        while (error != 0 && nbEssai < 3) {
+            
+            /* Debug only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            if (myGLSSocket->m_isServeur) printf("Server - glsRecV() recvPacket\n");
+            else printf("Client - glsRecv() recvPacket\n");
+            #endif
+            
+            /* Receive the encrypted message without timeout (Blocking mode) */
+            byte (*cipherMessage) = 0;
+            int sizeCipherMessage = recvPacket(myGLSSocket, &cipherMessage, 0);
+            if (sizeCipherMessage < 0) {
                 
-                /* fill temp var from buffer */
-                int i = 0;
-                for (i = 0; i < GLS_SIZE_PACKET; i++) {
-                    
-                    temp[i] = buffer[i + y * GLS_SIZE_PACKET]; 
-                    
+                /* Free memory */
+                if (cipherMessage != NULL) {
+                    free(cipherMessage);
+                    cipherMessage = 0;
                 }
                 
-                /* Debug only (a lot of printf) */
+                /* Unlock mutex */
+                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+                
+                /* Debug Only */
                 #if defined (GLS_DEBUG_MODE_ENABLE)
-                usleep(10000);
+                printf("### glsRecv() End ###\n\n");
                 #endif
                 
-                /* if headers used */
-                #if defined (GLS_HEADER_PACKET)
-                sock_size = sendWithHeader(myGLSSocket->m_sock, temp, GLS_SIZE_PACKET, 0);
-                #else
-                /* Send packet of GLS_SIZE_PACKET bytes */
-                sock_size = send(myGLSSocket->m_sock, temp, GLS_SIZE_PACKET, 0);
-                #endif
-
-                if(sock_size == SOCKET_ERROR || sock_size == 0) {
-                    
-                    /* get error */
-                    int numError = errno;
-                    
-                    /* Debug only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("Erreur de transmission sendPacket 2\n");
-                    #endif
-                    
-                    /* deblock mutex to let other thread to use the funciton */
-                    pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
-                    
-                    /* Debug Only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("### sendPacket() End ###\n\n");
-                    #endif
-
-                    /* return send error */
-                    switch (numError) {
-                            
-                        case EACCES :
-                            return GLS_ERROR_ACCES;
-                            break;
-                            
-                        case EAGAIN :
-                            return GLS_ERROR_AGAIN;
-                            break;
-                            
-                        case EBADF :
-                            return GLS_ERROR_BADF;
-                            break;
-                            
-                        case ECONNRESET :
-                            return GLS_ERROR_CONNRESET;
-                            break;
-                            
-                        case EDESTADDRREQ :
-                            return GLS_ERROR_DESTADDRREQ;
-                            break;
-                            
-                        case EFAULT :
-                            return GLS_ERROR_FAULT;
-                            break;
-                            
-                        case EINTR :
-                            return GLS_ERROR_INTR;
-                            break;
-                            
-                        case EINVAL :
-                            return GLS_ERROR_INVAL;
-                            break;
-                            
-                        case EISCONN :
-                            return GLS_ERROR_ISCONN;
-                            break;
-                            
-                        case EMSGSIZE :
-                            return GLS_ERROR_MSGSIZE;
-                            break;
-                            
-                        case ENOBUFS :
-                            return GLS_ERROR_NOBUFS;
-                            break;
-                            
-                        case ENOMEM :
-                            return GLS_ERROR_NOMEM;
-                            break;
-                            
-                        case ENOTCONN :
-                            return GLS_ERROR_NOTCONN;
-                            break;
-                            
-                        case ENOTSOCK :
-                            return GLS_ERROR_NOTSOCK;
-                            break;
-                            
-                        case EOPNOTSUPP :
-                            return GLS_ERROR_OPNOTSUPP;
-                            break;
-                            
-                        case EPIPE :
-                            return GLS_ERROR_PIPE;
-                            break;
-                            
-                        default:
-                            return GLS_ERROR_UNKNOWN;
-                            break;
-                            
-                    }
-                    
-                }
+                return sizeCipherMessage;
                 
-                /* Debug only (a lot of printf) */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                usleep(10000);
-                #endif
+            }
+            
+            /* 
+             * In pipelined mode the acknowledgements of our own messages can
+             * arrive before the message we are waiting for, a cipher text is
+             * always longer than an acknowledgement (a single byte when the
+             * peer doesn't pipeline).
+             */
+            if ((sizeCipherMessage == 1 || sizeCipherMessage == GLS_SIZE_ACK) && myGLSSocket->m_inFlight != NULL) {
                 
-                /* Last packet, send EOF (only when packet = GLS_SIZE_PACKET) */
-                /* If headers used */
-                #if defined (GLS_HEADER_PACKET)
-                sock_size = sendWithHeader(myGLSSocket->m_sock, (byte*) "EOF", 4, 0);
-                #else
-                sock_size = send(myGLSSocket->m_sock, "EOF", 4, 0);
-                #endif
-
-                if(sock_size == SOCKET_ERROR || sock_size == 0) {
-                    
-                    /* get error */
-                    int numError = errno;
-                    
-                    /* Debug only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("Erreur de transmission sendPacket 3\n");
-                    #endif
+                pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
+                error = processAck(myGLSSocket, cipherMessage, sizeCipherMessage);
+                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
+                
+                /* Free memory */
+                free(cipherMessage);
+                cipherMessage = 0;
+                
+                if (error < 0) {
                     
-                    /* deblock mutex to let other thread to use the funciton */
-                    pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
+                    /* Unlock mutex */
+                    pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
                     
                     /* Debug Only */
                     #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("### sendPacket() End ###\n\n");
+                    printf("### glsRecv() End ###\n\n");
                     #endif
-
-                    /* Return send error */
-                    switch (numError) {
-                            
-                        case EACCES :
-                            return GLS_ERROR_ACCES;
-                            break;
-                            
-                        case EAGAIN :
-                            return GLS_ERROR_AGAIN;
-                            break;
-                            
-                        case EBADF :
-                            return GLS_ERROR_BADF;
-                            break;
-                            
-                        case ECONNRESET :
-                            return GLS_ERROR_CONNRESET;
-                            break;
-                            
-                        case EDESTADDRREQ :
-                            return GLS_ERROR_DESTADDRREQ;
-                            break;
-                            
-                        case EFAULT :
-                            return GLS_ERROR_FAULT;
-                            break;
-                            
-                        case EINTR :
-                            return GLS_ERROR_INTR;
-                            break;
-                            
-                        case EINVAL :
-                            return GLS_ERROR_INVAL;
-                            break;
-                            
-                        case EISCONN :
-                            return GLS_ERROR_ISCONN;
-                            break;
-                            
-                        case EMSGSIZE :
-                            return GLS_ERROR_MSGSIZE;
-                            break;
-                            
-                        case ENOBUFS :
-                            return GLS_ERROR_NOBUFS;
-                            break;
-                            
-                        case ENOMEM :
-                            return GLS_ERROR_NOMEM;
-                            break;
-                            
-                        case ENOTCONN :
-                            return GLS_ERROR_NOTCONN;
-                            break;
-                            
-                        case ENOTSOCK :
-                            return GLS_ERROR_NOTSOCK;
-                            break;
-                            
-                        case EOPNOTSUPP :
-                            return GLS_ERROR_OPNOTSUPP;
-                            break;
-                            
-                        case EPIPE :
-                            return GLS_ERROR_PIPE;
-                            break;
-                            
-                        default:
-                            return GLS_ERROR_UNKNOWN;
-                            break;
-                            
-                    }
+                    
+                    return error;
                     
                 }
                 
-                /* remove send bytes from size left */
-                y++;
-                sizeLeft -= GLS_SIZE_PACKET;
+                error = -1;
+                continue;
+                
+            }
+            
+            /* Message decryption in place and acknowledgement */
+            int sizePlainTextMessage = readCipherText(myGLSSocket, cipherMessage, sizeCipherMessage);
+            if (sizePlainTextMessage == GLS_ERROR_IVDESYNC && myGLSSocket->m_isRecvRecovery == 1 && nbDiscard < GLS_MAX_WINDOW) {
                 
                 /* Debug only */
                 #if defined (GLS_DEBUG_MODE_ENABLE)
-                if (myGLSSocket->m_isServeur) printf("Serveur - sendPacket(myGLSSocket, ) EOF\n");
-                else printf("Client - sendPacket() EOF\n");
+                if (myGLSSocket->m_isServeur) printf("Serveur - glsRecV() discard pipelined message\n");
+                else printf("Client - glsRecv() discard pipelined message\n");
                 #endif
                 
+                /* 
+                 * Message sent before the sender got our retry, it will be
+                 * sent again so we drop it without acknowledgement
+                 */
+                nbDiscard++;
+                myGLSSocket->m_statsRecv.m_nbIvDesync++;
+                
+                /* Free memory */
+                free(cipherMessage);
+                cipherMessage = 0;
+                
+                error = -1;
+                continue;
+                
             }
-            else {
+            else if (sizePlainTextMessage >= 0) {
                 
-                /* Alloc memory of the buffer size */
-                byte (*tempFinal) = malloc(sizeLeft * sizeof(byte));                
-                if (tempFinal == NULL) {
-                    
-                    /* Debug only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("No memory sendPacket.\n");
-                    #endif
-                    
-                    return GLS_ERROR_NOMEM;
-                    
-                }
-
-                /* fill temp var from buffer */
-                int i = 0;
-                for (i = 0; i < sizeLeft; i++) {
-                    
-                    tempFinal[i] = buffer[i + y * GLS_SIZE_PACKET]; 
-                    
-                }
+                /* The received buffer is given to the user */
+                *buffer = cipherMessage;
+                cipherMessage = 0;
                 
-                /* Debug only (a lot of printf) */
+                /* Unlock mutex */
+                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+                
+                /* Debug only */
                 #if defined (GLS_DEBUG_MODE_ENABLE)
-                usleep(10000);
+                if (myGLSSocket->m_isServeur) printf("Server - glsRecV() finish OK\n");
+                else printf("Client - glsRecv() finish OK\n");
+                printf("### glsRecv() End ###\n\n");
                 #endif
                 
-                /* Send packet of sizeLeft bytes */
-                /* If headers used */
-                #if defined (GLS_HEADER_PACKET)
-                sock_size = sendWithHeader(myGLSSocket->m_sock, tempFinal, sizeLeft, 0);
-                #else
-                /* Send packet of sizeLeft bytes */
-                sock_size = send(myGLSSocket->m_sock, tempFinal, sizeLeft, 0);
-                #endif
-
-                if(sock_size == SOCKET_ERROR || sock_size == 0) {
-                    
-                    /* get error */
-                    int numError = errno;
-                    
-                    /* free memory */
-                    free(tempFinal);
-                    tempFinal = 0;
-                    
-                    /* Debug only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("Erreur de transmission sendPacket 4\n");
-                    #endif
-                    
-                    /* deblock mutex to let other thread to use the funciton */
-                    pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
-                    
-                    /* Debug Only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("### sendPacket() End ###\n\n");
-                    #endif
-
-                    /* Return send error */
-                    switch (numError) {
-                            
-                        case EACCES :
-                            return GLS_ERROR_ACCES;
-                            break;
-                            
-                        case EAGAIN :
-                            return GLS_ERROR_AGAIN;
-                            break;
-                            
-                        case EBADF :
-                            return GLS_ERROR_BADF;
-                            break;
-                            
-                        case ECONNRESET :
-                            return GLS_ERROR_CONNRESET;
-                            break;
-                            
-                        case EDESTADDRREQ :
-                            return GLS_ERROR_DESTADDRREQ;
-                            break;
-                            
-                        case EFAULT :
-                            return GLS_ERROR_FAULT;
-                            break;
-                            
-                        case EINTR :
-                            return GLS_ERROR_INTR;
-                            break;
-                            
-                        case EINVAL :
-                            return GLS_ERROR_INVAL;
-                            break;
-                            
-                        case EISCONN :
-                            return GLS_ERROR_ISCONN;
-                            break;
-                            
-                        case EMSGSIZE :
-                            return GLS_ERROR_MSGSIZE;
-                            break;
-                            
-                        case ENOBUFS :
-                            return GLS_ERROR_NOBUFS;
-                            break;
-                            
-                        case ENOMEM :
-                            return GLS_ERROR_NOMEM;
-                            break;
-                            
-                        case ENOTCONN :
-                            return GLS_ERROR_NOTCONN;
-                            break;
-                            
-                        case ENOTSOCK :
-                            return GLS_ERROR_NOTSOCK;
-                            break;
-                            
-                        case EOPNOTSUPP :
-                            return GLS_ERROR_OPNOTSUPP;
-                            break;
-                            
-                        case EPIPE :
-                            return GLS_ERROR_PIPE;
-                            break;
-                            
-                        default:
-                            return GLS_ERROR_UNKNOWN;
-                            break;
-                            
-                    }
-                    
-                }
+                return sizePlainTextMessage;
+                
+            }
+            else if (sizePlainTextMessage != GLS_ERROR_MAC) {
                 
-                /* free buffer */
-                free(tempFinal);
-                tempFinal = 0;
+                /* Free memory */
+                free(cipherMessage);
+                cipherMessage = 0;
+                
+                /* Unlock mutex */
+                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+                
+                /* Debug Only */
+                #if defined (GLS_DEBUG_MODE_ENABLE)
+                printf("### glsRecv() End ###\n\n");
+                #endif
                 
-                /* Set sizeLeft = 0 */
-                sizeLeft = 0;
+                return sizePlainTextMessage;
                 
             }
             
+            /* MAC error, the message is sent again */
+            error = -1;
+            nbEssai++;
+            
+            /* Free memory */
+            free(cipherMessage);
+            cipherMessage = 0;
+            
         }
         
+        /* The sender gives up after 3 attempts too */
+        myGLSSocket->m_statsRecv.m_nbIvDesync++;
+        
+        /* Unlock mutex */
+        pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("### glsRecv() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_IVDESYNC;
+        
+    }
+    else {
+        
+        /* We don't unlock the mutex because it's only lock
+         if the condition is true */
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("### glsRecv() End ###\n\n");
+        #endif
+        
+        if (myGLSSocket->m_isSocketConfig == 0 || myGLSSocket->m_isHandShakeFinish == 0) return GLS_ERROR_NOTCONN;
+        else return GLS_ERROR_UNKNOWN;
+    
     }
-    else if(size > 0 && size < GLS_SIZE_PACKET) {
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Same as glsRecv() without blocking, for the clients of
+ the event loop server. The bytes waiting on the socket
+ are added to the message of m_handShake like
+ _stepAcceptConnexion(), so a client which sends half a
+ message doesn't stop the thread.
+ 
+ Return the message size, GLS_ERROR_AGAIN when no message
+ is complete or another negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int _recvNoWait(GLSSock* myGLSSocket, byte** buffer) {
+    
+    *buffer = 0;
+    
+    if (myGLSSocket->m_isSocketConfig == 0 || myGLSSocket->m_isHandShakeFinish == 0) return GLS_ERROR_NOTCONN;
+    if (myGLSSocket->m_handShake == NULL) return GLS_ERROR_INVAL;
+    
+    GLSHandShake* handShake = myGLSSocket->m_handShake;
+    
+    /* Lock mutex */
+    pthread_mutex_lock(&myGLSSocket->m_mutexGlsRecv);
+    
+    /* Message already read by glsSend() while waiting for an acknowledgement */
+    pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
+    int sizeQueued = popRecvQueue(myGLSSocket, buffer);
+    pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
+    if (sizeQueued >= 0) {
         
-        /* Variables init */
-        long sock_size = 0;
+        pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+        
+        return sizeQueued;
+        
+    }
+    
+    while (1) {
         
-        /* allocate temp buffer of the element size to send */
-        byte (*tempFinal) = malloc(size * sizeof(byte));
-        if (tempFinal == NULL) {
+        byte (*cipherMessage) = 0;
+        int sizeCipherMessage = recvPacketNoWait(myGLSSocket, &cipherMessage);
+        if (sizeCipherMessage < 0) {
             
-            /* Debug only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("No memory sendPacket.\n");
-            #endif
+            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
             
-            return GLS_ERROR_NOMEM;
+            return sizeCipherMessage;
             
         }
         
-        /* Fill the temp array with the buffer */
-        int i = 0;
-        for (i = 0; i < size; i++) {
+        /* Acknowledgement of our own pipelined messages, like glsRecv() */
+        if ((sizeCipherMessage == 1 || sizeCipherMessage == GLS_SIZE_ACK) && myGLSSocket->m_inFlight != NULL) {
+            
+            pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
+            int error = processAck(myGLSSocket, cipherMessage, sizeCipherMessage);
+            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
+            
+            free(cipherMessage);
+            
+            if (error < 0) {
+                
+                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+                
+                return error;
+                
+            }
             
-            tempFinal[i] = buffer[i]; 
+            continue;
             
         }
         
-        /* Debug only (a lot of printf) */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        usleep(10000);
-        #endif
-        
-        /* Sending packet of sizeLeft bytes */
-        /* If headers configured */
-        #if defined (GLS_HEADER_PACKET)
-        sock_size = sendWithHeader(myGLSSocket->m_sock, tempFinal, size, 0);
-        #else
-        /* Sending packet of sizeLeft bytes */
-        sock_size = send(myGLSSocket->m_sock, tempFinal, size, 0);
-        #endif
-
-        if(sock_size == SOCKET_ERROR || sock_size == 0) {
-            
-            /* Get error */
-            int numError = errno;
+        /* Message decryption in place and acknowledgement */
+        int sizePlainTextMessage = readCipherText(myGLSSocket, cipherMessage, sizeCipherMessage);
+        if (sizePlainTextMessage >= 0) {
             
-            /* Free memory */
-            free(tempFinal);
-            tempFinal = 0;
+            handShake->m_nbMacError = 0;
+            handShake->m_nbDiscard = 0;
             
-            /* Debug only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("Erreur de transmission sendPacket 5\n");
-            #endif
+            /* The received buffer is given to the user */
+            *buffer = cipherMessage;
             
-            /* Unlock the mutex to permit to use the socket */
-            pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
+            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
             
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### sendPacket() End ###\n\n");
-            #endif
-
-            /* Return send error */
-            switch (numError) {
-                    
-                case EACCES :
-                    return GLS_ERROR_ACCES;
-                    break;
-                    
-                case EAGAIN :
-                    return GLS_ERROR_AGAIN;
-                    break;
-                    
-                case EBADF :
-                    return GLS_ERROR_BADF;
-                    break;
-                    
-                case ECONNRESET :
-                    return GLS_ERROR_CONNRESET;
-                    break;
-                    
-                case EDESTADDRREQ :
-                    return GLS_ERROR_DESTADDRREQ;
-                    break;
-                    
-                case EFAULT :
-                    return GLS_ERROR_FAULT;
-                    break;
-                    
-                case EINTR :
-                    return GLS_ERROR_INTR;
-                    break;
-                    
-                case EINVAL :
-                    return GLS_ERROR_INVAL;
-                    break;
-                    
-                case EISCONN :
-                    return GLS_ERROR_ISCONN;
-                    break;
-                    
-                case EMSGSIZE :
-                    return GLS_ERROR_MSGSIZE;
-                    break;
-                    
-                case ENOBUFS :
-                    return GLS_ERROR_NOBUFS;
-                    break;
-                    
-                case ENOMEM :
-                    return GLS_ERROR_NOMEM;
-                    break;
-                    
-                case ENOTCONN :
-                    return GLS_ERROR_NOTCONN;
-                    break;
-                    
-                case ENOTSOCK :
-                    return GLS_ERROR_NOTSOCK;
-                    break;
-                    
-                case EOPNOTSUPP :
-                    return GLS_ERROR_OPNOTSUPP;
-                    break;
-                    
-                case EPIPE :
-                    return GLS_ERROR_PIPE;
-                    break;
-                    
-                default:
-                    return GLS_ERROR_UNKNOWN;
-                    break;
-                    
-            }
+            return sizePlainTextMessage;
             
         }
         
-        /* Free buffer */
-        free(tempFinal);
-        tempFinal = 0;
-        
-    }
-    else {
-        
-        /* Debug only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Erreur d'argument sendPacket\n");
-        #endif
+        free(cipherMessage);
         
-        /* Unlock the mutex allowing the socket use */
-        pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
+        /* Message sent before the sender got our retry, dropped without acknowledgement */
+        if (sizePlainTextMessage == GLS_ERROR_IVDESYNC && myGLSSocket->m_isRecvRecovery == 1 && handShake->m_nbDiscard < GLS_MAX_WINDOW) {
+            
+            handShake->m_nbDiscard++;
+            myGLSSocket->m_statsRecv.m_nbIvDesync++;
+            
+            continue;
+            
+        }
         
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### sendPacket() End ###\n\n");
-        #endif
+        /* MAC error, the message is sent again up to 3 times like glsRecv() */
+        if (sizePlainTextMessage == GLS_ERROR_MAC) {
+            
+            handShake->m_nbMacError++;
+            if (handShake->m_nbMacError < 3) continue;
+            
+            myGLSSocket->m_statsRecv.m_nbIvDesync++;
+            sizePlainTextMessage = GLS_ERROR_IVDESYNC;
+            
+        }
         
-        return GLS_ERROR_UNKNOWN;
+        pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+        
+        return sizePlainTextMessage;
         
     }
     
-    /* Unlock the mutex allowing the socket use */
-    pthread_mutex_unlock(&myGLSSocket->m_mutexSendPacket);
-
-    
-    /* Debug only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    if (myGLSSocket->m_isServeur) printf("Serveur - sendPacket() END\n");
-    else printf("Client - sendPacket() END\n");
-    printf("### sendPacket() End ###\n\n");
-    #endif
-    
-    return 0;
-
 }
 
 
@@ -4273,614 +5294,556 @@ int sendPacket(GLSSock* myGLSSocket, const byte* buffer, const int size) {
  
  PRIVATE
  
- Receive packet from the network by GLS_SIZE_PACKET bytes
- (configurable in GLSHeaders.h).
-
+ Prepare a client of the event loop server : its packets
+ are queued when the socket is full (flushOutBuffer())
+ and glsSend() doesn't wait for the acknowledgement, up
+ to GLS_MAX_WINDOW messages in flight.
+ 
  Return 0 for success, a negative number for an error.
  
  ---------------------------------------------------------*/
 
-int recvPacket(GLSSock* myGLSSocket, byte** buffer, const int withTimeout) {
-        
-    /* Debug only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### recvPacket() Start ###\n");
-    if (myGLSSocket->m_isServeur) printf("Server - recvPacket()\n");
-    else printf("Client - recvPacket()\n");
-    #endif
-    
-    /* Lock the mutex */
-    pthread_mutex_lock(&myGLSSocket->m_mutexRecvPacket);
-    
-    /* Variables init */
-    long sock_size = 0;
-    byte temp[GLS_SIZE_PACKET];
-    int size = 0;
-    
-    /* Debug only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    if (myGLSSocket->m_isServeur) printf("Server - recvPacket() - Waiting...\n");
-    else printf("Client - recvPacket() - Waiting...\n");
-    #endif
+int _startEventClient(GLSSock* myGLSSocket) {
     
-    /* If we use a timeout for the waiting period */
-    if (withTimeout == 1) {
+    byte* (*inFlight) = malloc(sizeof(byte*) * GLS_MAX_WINDOW);
+    int* sizeInFlight = malloc(sizeof(int) * GLS_MAX_WINDOW);
+    unsigned long long* timeInFlight = malloc(sizeof(unsigned long long) * GLS_MAX_WINDOW);
+    if (inFlight == NULL || sizeInFlight == NULL || timeInFlight == NULL) {
         
-        sock_size = recvWithTimeout(myGLSSocket->m_sock, temp, GLS_SIZE_PACKET, 0, GLS_TIMEOUT_PACKET);
+        /* Free memory */
+        if (inFlight != NULL) free(inFlight);
+        if (sizeInFlight != NULL) free(sizeInFlight);
+        if (timeInFlight != NULL) free(timeInFlight);
         
-    }
-    else {
+        return GLS_ERROR_NOMEM;
         
-        /* If headers set */
-        #if defined (GLS_HEADER_PACKET)
-        sock_size = recvWithHeader(myGLSSocket->m_sock, temp, GLS_SIZE_PACKET, 0);
-        #else
-        /* Reception of the first packet (No MSG_WAITALL) */
-        sock_size = recv(myGLSSocket->m_sock, temp, GLS_SIZE_PACKET, 0);
-        #endif
+    }
     
+    int i = 0;
+    for (i = 0; i < GLS_MAX_WINDOW; i++) {
+        inFlight[i] = 0;
+        sizeInFlight[i] = 0;
+        timeInFlight[i] = 0;
     }
     
-    /* Debug only */
+    myGLSSocket->m_inFlight = inFlight;
+    myGLSSocket->m_sizeInFlight = sizeInFlight;
+    myGLSSocket->m_timeInFlight = timeInFlight;
+    myGLSSocket->m_maxInFlight = GLS_MAX_WINDOW;
+    myGLSSocket->m_isEventLoop = 1;
+    
+    return 0;
+    
+}
+
+
+
+/*-------------------------------------------------------
+ 
+ Set the number of messages glsSend() can send before
+ waiting for an acknowledgement (1 = stop and wait).
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int glsSetSendWindow(GLSSock* myGLSSocket, const int window) {
+    
+    /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("Size recv recvPacket : %ld\n", sock_size);
+    printf("### glsSetSendWindow() Start ###\n");
     #endif
     
-    if(sock_size == SOCKET_ERROR || sock_size == 0) {
-        
-        /* get error */
-        int numError = errno;
-        
-        /* Debug only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Error transmission recvPacket 1\n");
-        #endif
-        
-        /* Unlock the mutex */
-        pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
+    /* Argument check */
+    if (window < 1 || window > GLS_MAX_WINDOW) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### recvPacket() End ###\n\n");
+        printf("Bad window size : %d\n", window);
+        printf("### glsSetSendWindow() End ###\n\n");
         #endif
         
-        /* Return recv error */
-        switch (numError) {
-                
-            case EAGAIN :
-                return GLS_ERROR_AGAIN;
-                break;
-                
-            case EBADF :
-                return GLS_ERROR_BADF;
-                break;
-                
-            case ECONNREFUSED :
-                return GLS_ERROR_CONNREFUSED;
-                break;
-                
-            case EFAULT :
-                return GLS_ERROR_FAULT;
-                break;
-                
-            case EINTR :
-                return GLS_ERROR_INTR;
-                break;
-                
-            case EINVAL :
-                return GLS_ERROR_INVAL;
-                break;
-                
-            case ENOMEM :
-                return GLS_ERROR_NOMEM;
-                break;
-                
-            case ENOTCONN :
-                return GLS_ERROR_NOTCONN;
-                break;
-                
-            case ENOTSOCK :
-                return GLS_ERROR_NOTSOCK;
-                break;
-                
-            default:
-                return GLS_ERROR_UNKNOWN;
-                break;
-                
-        }
+        return GLS_ERROR_BADSIZE;
         
     }
-    else if(sock_size == GLS_ERROR_TIMEDOUT) {
-        
-        /* Debug only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("Error TimeOut recvPacket 1\n");
-        #endif
-        
-        /* Unlock the mutex */
-        pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
+    
+    /* 
+     * The cascade suites have one IV chain for both directions, messages
+     * in flight both ways would desynchronize it. The AEAD suites have a
+     * counter per direction, the suite must be negotiated first.
+     */
+    if (window > 1 && (myGLSSocket->m_isHandShakeFinish == 0 || (myGLSSocket->m_activeSuite != GLS_SUITE_AES256_GCM && myGLSSocket->m_activeSuite != GLS_SUITE_CHACHA20_POLY1305))) {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### recvPacket() End ###\n\n");
+        if (myGLSSocket->m_isHandShakeFinish == 0) printf("HandShake not done.\n");
+        else printf("Window > 1 only with an AEAD suite.\n");
+        printf("### glsSetSendWindow() End ###\n\n");
         #endif
         
-        return GLS_ERROR_TIMEDOUT;
+        if (myGLSSocket->m_isHandShakeFinish == 0) return GLS_ERROR_NOTCONN;
+        else return GLS_ERROR_OPNOTSUPP;
         
     }
     
-    /* Total size of buffer */
-    size += (int)sock_size;
+    /* Lock mutex */
+    pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
     
-    /* If the packet isn't smaller than GLS_SIZE_PACKET there will be
-       others to receive */
-    if (!(size < GLS_SIZE_PACKET)) {
+    /* The window can't change with messages in flight */
+    if (myGLSSocket->m_ackSeq != myGLSSocket->m_sendSeq) {
         
-        /* Creating and filling the buffer with the first packet */
-        *buffer = malloc(size * sizeof(byte));
-        if (*buffer == NULL) {
-            
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("No memory recvPacket\n");
-            #endif
-            
-            return GLS_ERROR_NOMEM;
-            
-        }
-        int i = 0;
-        for (i = 0; i < size; i++) {
-            
-            (*buffer)[i] = temp[i];
-            
-        }
+        /* Unlock mutex */
+        pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
         
-        /* While we are receiving packets */
-        while (sock_size == GLS_SIZE_PACKET) {
-            
-            sock_size = recvWithTimeout(myGLSSocket->m_sock, temp, GLS_SIZE_PACKET, 0, GLS_TIMEOUT_PACKET);
-            
-            if(sock_size == SOCKET_ERROR || sock_size == 0) {
-                
-                /* Getting error */
-                int numError = errno;
-                
-                /* Debug only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Error transmission recvPacket 2\n");
-                #endif
-                
-                /* Unlock the mutex */
-                pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### recvPacket() End ###\n\n");
-                #endif
-                
-                /* Return recv error */
-                switch (numError) {
-                        
-                    case EAGAIN :
-                        return GLS_ERROR_AGAIN;
-                        break;
-                        
-                    case EBADF :
-                        return GLS_ERROR_BADF;
-                        break;
-                        
-                    case ECONNREFUSED :
-                        return GLS_ERROR_CONNREFUSED;
-                        break;
-                        
-                    case EFAULT :
-                        return GLS_ERROR_FAULT;
-                        break;
-                        
-                    case EINTR :
-                        return GLS_ERROR_INTR;
-                        break;
-                        
-                    case EINVAL :
-                        return GLS_ERROR_INVAL;
-                        break;
-                        
-                    case ENOMEM :
-                        return GLS_ERROR_NOMEM;
-                        break;
-                        
-                    case ENOTCONN :
-                        return GLS_ERROR_NOTCONN;
-                        break;
-                        
-                    case ENOTSOCK :
-                        return GLS_ERROR_NOTSOCK;
-                        break;
-                        
-                    default:
-                        return GLS_ERROR_UNKNOWN;
-                        break;
-                        
-                }
-                
-            }
-            else if(sock_size == GLS_ERROR_TIMEDOUT) {
-                
-                /* Debug only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("Erreur TimeOut recvPacket 2\n");
-                #endif
-                
-                /* Unlock the mutex */
-                pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### recvPacket() End ###\n\n");
-                #endif
-                
-                return GLS_ERROR_TIMEDOUT;
-                
-            }
-            
-            /* If the packet's size is 4 bytes we check for a 
-             EOF signal */
-            if (sock_size == 4) {
-                /* Creation of the EOF signal */
-                char eof[4] = "EOF";
-                
-                /* bytes check */
-                int i = 0;
-                while (temp[i] == eof[i] && i < 4) {
-                    
-                    i++;
-                    
-                }
-                /* If the signal is EOF we return the size and 
-                 exit the funtion */
-                if (i == 4) {
-                    
-                    /* Unlock the mutex */
-                    pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
-                    
-                    /* Debug only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    if (myGLSSocket->m_isServeur) printf("Server - recvPacket() EOF\n");
-                    else printf("Client - recvPacket() EOF\n");
-                    #endif
-
-                    /* Debug Only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("### recvPacket() End ###\n\n");
-                    #endif
-                    
-                    return size;
-                    
-                }
-            }
-            
-            /* Total actual buffer size */
-            size += (int)sock_size;
-            
-            /* Creating a temp buffer to store all the packets */
-            byte (*bufferTemp) = malloc(size * sizeof(byte));
-            if (bufferTemp == NULL) {
-                
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("No memory. recvPacket\n");
-                #endif
-                
-                return GLS_ERROR_NOMEM;
-                
-            }
-            /* Copying old packets in the temp buffer */
-            int i = 0;
-            for (i = 0; i < (size - (int)sock_size); i++) {
-                
-                bufferTemp[i] = (*buffer)[i];
-                
-            }
-            /* Copying the new packet in the temp buffer */
-            i = 0;
-            for (i = 0; i < (int)sock_size; i++) {
-                
-                bufferTemp[i + (size - (int)sock_size)] = temp[i];
-                
-            }
-            
-            /* Free the old buffer and alloc a new one with the actual size */
-            free(*buffer);
-            *buffer = malloc(size * sizeof(byte));
-            if (*buffer == NULL) {
-                
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("No memory. recvPacket\n");
-                #endif
-                
-                return GLS_ERROR_NOMEM;
-                
-            }
-            
-            /* Copying the temp buffer into the buffer and freeing bufferTemp */
-            /* Remove for optimization and directly set buffer with bufferTemp pointer value */
-            i = 0;
-            for (i = 0; i < size; i++) {
-                
-                (*buffer)[i] = bufferTemp[i];
-                
-            }
-            
-            /* Free memory */
-            free(bufferTemp);
-            bufferTemp = 0;
-
-        }
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Messages waiting for acknowledgement, call glsFlush() first\n");
+        printf("### glsSetSendWindow() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_AGAIN;
         
     }
-    else {
+    
+    /* 
+     * Array of the messages waiting for an acknowledgement, an event loop
+     * client keeps its array of GLS_MAX_WINDOW messages
+     */
+    int maxInFlight = (window > 1) ? window : 0;
+    if (myGLSSocket->m_isEventLoop == 1) maxInFlight = myGLSSocket->m_maxInFlight;
+    byte* (*inFlight) = myGLSSocket->m_inFlight;
+    int* sizeInFlight = myGLSSocket->m_sizeInFlight;
+    unsigned long long* timeInFlight = myGLSSocket->m_timeInFlight;
+    if (maxInFlight != myGLSSocket->m_maxInFlight) {
+        
+        inFlight = 0;
+        sizeInFlight = 0;
+        timeInFlight = 0;
+        
+    }
+    if (maxInFlight > 0 && inFlight == NULL) {
         
-        /* If there is only one packet we allocate the buffer */
-        *buffer = malloc(size * sizeof(byte));
-        if (*buffer == NULL) {
+        inFlight = malloc(sizeof(byte*) * maxInFlight);
+        sizeInFlight = malloc(sizeof(int) * maxInFlight);
+        timeInFlight = malloc(sizeof(unsigned long long) * maxInFlight);
+        if (inFlight == NULL || sizeInFlight == NULL || timeInFlight == NULL) {
+            
+            /* Free memory */
+            if (inFlight != NULL) free(inFlight);
+            if (sizeInFlight != NULL) free(sizeInFlight);
+            if (timeInFlight != NULL) free(timeInFlight);
+            
+            /* Unlock mutex */
+            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
             
+            /* Debug Only */
             #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("No memory recvPacket\n");
+            printf("No memory\n");
+            printf("### glsSetSendWindow() End ###\n\n");
             #endif
             
             return GLS_ERROR_NOMEM;
             
         }
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("recvPacket() - Buffer < %d bytes\n", GLS_SIZE_PACKET);
-        printf("Buffer : ");
-        sleep(1);
-        #endif                
+        
         int i = 0;
-        for (i = 0; i < size; i++) {
-                
-            (*buffer)[i] = temp[i];
-            
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("%c", temp[i]);
-            #endif
-                
+        for (i = 0; i < maxInFlight; i++) {
+            inFlight[i] = 0;
+            sizeInFlight[i] = 0;
+            timeInFlight[i] = 0;
         }
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("\n");
-        #endif
         
     }
     
+    /* Swap with the old arrays (all the messages are acknowledged) */
+    if (myGLSSocket->m_inFlight != NULL && myGLSSocket->m_inFlight != inFlight) {
+        free(myGLSSocket->m_inFlight);
+        free(myGLSSocket->m_sizeInFlight);
+        free(myGLSSocket->m_timeInFlight);
+    }
+    myGLSSocket->m_inFlight = inFlight;
+    myGLSSocket->m_sizeInFlight = sizeInFlight;
+    myGLSSocket->m_timeInFlight = timeInFlight;
+    myGLSSocket->m_maxInFlight = maxInFlight;
+    myGLSSocket->m_sendWindow = window;
+    myGLSSocket->m_nbRetry = 0;
+    
     /* Unlock mutex */
-    pthread_mutex_unlock(&myGLSSocket->m_mutexRecvPacket);
+    pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
     
-    /* Debug only */
+    /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    if (myGLSSocket->m_isServeur == 1) printf("Server - recvPacket() END\n");
-    else printf("Client - recvPacket() END\n");
-    printf("### recvPacket() End ###\n\n");
+    printf("Send window : %d\n", window);
+    printf("### glsSetSendWindow() End ###\n\n");
     #endif
     
-    return size;
+    return 0;
     
 }
-   
+
 
 
 
 /*-------------------------------------------------------
  
- Send a message using the secure connexion. You can use this function
- on a thread.
+ Wait for the acknowledgement of all the messages sent
+ in pipelined mode.
  
- Return the message's size send or a negative number for an error.
+ Return 0 for success, a negative number for an error.
  
  ---------------------------------------------------------*/
 
-int glsSend(GLSSock* myGLSSocket, const byte* buffer, const int sizeBuffer){
+int glsFlush(GLSSock* myGLSSocket) {
     
     /* Debug Only */
     #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### glsSend() Start ###\n");
+    printf("### glsFlush() Start ###\n");
     #endif
     
     /* Check if connexion is ok */
-    if (myGLSSocket->m_isSocketConfig == 1 && myGLSSocket->m_isHandShakeFinish == 1) {
+    if (myGLSSocket->m_isSocketConfig == 0 || myGLSSocket->m_isHandShakeFinish == 0) {
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("### glsFlush() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_NOTCONN;
+        
+    }
+    
+    /* Lock mutex */
+    pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
+    
+    /* Wait for all the acknowledgements, the event loop reads them for its clients */
+    int error = 0;
+    while (error == 0 && myGLSSocket->m_ackSeq != myGLSSocket->m_sendSeq) {
+        
+        if (myGLSSocket->m_isEventLoop == 1) error = GLS_ERROR_AGAIN;
+        else error = waitAck(myGLSSocket);
+        
+    }
+    
+    /* Unlock mutex */
+    pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsFlush() End ###\n\n");
+    #endif
+    
+    return error;
+    
+}
 
-        /* Lock mutex for threading */
-        pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
+
+
+
+/*-------------------------------------------------------
+ 
+ Choose the cipher suite used after the handshake, the
+ client offers it and the server chooses it.
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int glsSetCipherSuite(GLSSock* myGLSSocket, const int suite) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsSetCipherSuite() Start ###\n");
+    #endif
+    
+    /* The suite is negotiated during the handshake */
+    if (myGLSSocket->m_isHandShakeFinish == 1) {
         
-        #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
-        struct timeval sTime;
-        gettimeofday(&sTime, NULL);
-        /* ProcessTime example */
-        struct timeval startTime;
-        struct timeval endTime;
-        /*structure for rusage */
-        struct rusage ru;
-        /* get the current time
-         - RUSAGE_SELF for current process
-         - RUSAGE_CHILDREN for *terminated* subprocesses */
-        getrusage(RUSAGE_SELF, &ru);
-        startTime = ru.ru_utime;
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("HandShake done.\n");
+        printf("### glsSetCipherSuite() End ###\n\n");
         #endif
         
-       
-        /* Buffer encryption */
-        byte (*cipherText) = 0;
-        int sizeCipherText = allEncrypt(myGLSSocket, buffer, sizeBuffer, &cipherText);
+        return GLS_ERROR_ISCONN;
         
-        #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
-        struct timeval eTime;
-        gettimeofday(&eTime, NULL);
-        double tS = sTime.tv_sec*1000000 + (sTime.tv_usec);
-        double tE = eTime.tv_sec*1000000  + (eTime.tv_usec);
-        printf("Time for total encryption (Clock) : %f microSeconds\n", tE - tS);
-        printf("Speed Encryption (Clock) : %f Mo/s\n", (sizeBuffer / 1000) / ((tE - tS) / 1000));
-        /* get the end time */
-        getrusage(RUSAGE_SELF, &ru);
-        endTime = ru.ru_utime;
-        /* calculate time in microseconds */
-        tS = startTime.tv_sec*1000000 + (startTime.tv_usec);
-        tE = endTime.tv_sec*1000000  + (endTime.tv_usec);
-        printf("Time for total encryption (CPU) : %f microSeconds\n", tE - tS);
-        printf("Speed Encryption (CPU) : %f Mo/s\n", (sizeBuffer / 1000) / ((tE - tS) / 1000));
+    }
+    
+    /* Argument check */
+    if (suite < GLS_SUITE_SERPENT_TWOFISH || suite > GLS_SUITE_SERPENT_TWOFISH_CTR) return GLS_ERROR_INVAL;
+    
+    /* AEAD suites need a recent libgcrypt */
+    #if !defined (GLS_AEAD_ENABLE)
+    if (suite == GLS_SUITE_AES256_GCM || suite == GLS_SUITE_CHACHA20_POLY1305) {
+        
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("No AEAD suite with this libgcrypt.\n");
+        printf("### glsSetCipherSuite() End ###\n\n");
         #endif
         
-        if (sizeCipherText < 0) {
-            
-            /* Free memory */
-            if (cipherText != NULL) {
-                free(cipherText);
-                cipherText = 0;
-            }
-            
-            /* Unlock mutex for threading */
-            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### glsSend() End ###\n\n");
-            #endif
-            
-            return sizeCipherText;
+        return GLS_ERROR_OPNOTSUPP;
         
-        }
+    }
+    #endif
+    
+    myGLSSocket->m_cipherSuite = suite;
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsSetCipherSuite() End ###\n\n");
+    #endif
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ Return the cipher suite negotiated during the handshake
+ or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int glsGetCipherSuite(GLSSock* myGLSSocket) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsGetCipherSuite() Start ###\n");
+    printf("### glsGetCipherSuite() End ###\n\n");
+    #endif
+    
+    if (myGLSSocket->m_isHandShakeFinish == 0) return GLS_ERROR_NOTCONN;
+    else return myGLSSocket->m_activeSuite;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ Set the size of the IV pool of the socket (0 = no pool).
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int glsSetIVPoolSize(GLSSock* myGLSSocket, const int size) {
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsSetIVPoolSize() Start ###\n");
+    #endif
+    
+    /* Argument check */
+    if (size < 0 || size > GLS_MAX_IV_POOL || (size % 16) != 0) {
         
-        /* Send message */
-        int nbEssai = 0;
-        int error = -1;
-        while (error != 0 && nbEssai < 3) {
-            
-            /* Debug only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            if (myGLSSocket->m_isServeur) printf("Server - glsSend() sendPacket\n");
-            else printf("Client - glsSend() sendPacket\n");
-            #endif
-            
-            /* Send message */
-            error = sendPacket(myGLSSocket, cipherText, sizeCipherText);
-            if (error < 0) {
-                
-                /* Free memory */
-                if (cipherText != NULL) {
-                    free(cipherText);
-                    cipherText = 0;
-                }
-                
-                /* Unlock mutex for threading */
-                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### glsSend() End ###\n\n");
-                #endif
-                
-                return error;
-            
-            }
-            
-            /* Debug only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            if (myGLSSocket->m_isServeur) printf("Server - glsSend() receive confirm\n");
-            else printf("Client - glsSend() receive confirm\n");
-            #endif
-            
-            /* Waiting for the acknowledgement of receipt with timeout */
-            byte (*okMessage) = 0;
-            int sizeOkMessage = recvPacket(myGLSSocket, &okMessage, 1);
-            if (sizeOkMessage < 0) {
-                
-                /* On vide la mémoire */
-                if (cipherText != NULL) {
-                    free(cipherText);
-                    cipherText = 0;
-                }
-                if (okMessage != NULL) {
-                    free(okMessage);
-                    okMessage = 0;
-                }
-                
-                /* Unlock the mutex for threading */
-                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### glsSend() End ###\n\n");
-                #endif
-                
-                return sizeOkMessage;
-                
-            }
-            
-            /* If any problem occured during the transmission we send
-               the message again */
-            if (sizeOkMessage > 0 && okMessage[0] == 1) error = 0;
-            else error = -1;
-            
-            nbEssai++;
-            
-            /* Free memory */
-            if (okMessage != NULL) {
-                free(okMessage);
-                okMessage = 0;
-            }
-            
-        }
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Bad IV pool size : %d\n", size);
+        printf("### glsSetIVPoolSize() End ###\n\n");
+        #endif
+        
+        return GLS_ERROR_BADSIZE;
+        
+    }
+    
+    /* Lock mutex, the IVs are only generated by the sender */
+    pthread_mutex_lock(&myGLSSocket->m_mutexGlsSend);
+    
+    /* The old pool is wiped, the new one is filled by the next getIV() */
+    if (myGLSSocket->m_ivPool != NULL) {
+        
+        memset(myGLSSocket->m_ivPool, 0, myGLSSocket->m_sizeIvPool);
+        free(myGLSSocket->m_ivPool);
+        myGLSSocket->m_ivPool = 0;
+        
+    }
+    myGLSSocket->m_sizeIvPool = size;
+    myGLSSocket->m_posIvPool = 0;
+    
+    /* Unlock mutex */
+    pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
+    
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("IV pool size : %d\n", size);
+    printf("### glsSetIVPoolSize() End ###\n\n");
+    #endif
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Send an acknowledgement (1 = OK, 2 = send again). In
+ pipelined mode the acknowledgement has the sequence 
+ number of the message.
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int sendAck(GLSSock* myGLSSocket, const byte status) {
+    
+    /* Stop and wait, only the status */
+    if (myGLSSocket->m_sendWindow <= 1) {
         
-        /* Free memory */
-        if (cipherText != NULL) {
-            free(cipherText);
-            cipherText = 0;
-        }
+        byte ack[1];
+        ack[0] = status;
+        return sendPacket(myGLSSocket, ack, 1);
         
-        /* If there is always an error after 3 attempt we return
-           an error. IVs will be desynchronized */
-        if (error != 0) {
-            
-            /* Unlock the mutex */
-            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
-            
-            /* Debug Only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            printf("### glsSend() End ###\n\n");
-            #endif
-            
-            return GLS_ERROR_IVDESYNC;
+    }
+    
+    /* Status + sequence number (big-endian) */
+    byte ack[GLS_SIZE_ACK];
+    ack[0] = status;
+    ack[1] = (byte) (myGLSSocket->m_recvSeq >> 24);
+    ack[2] = (byte) (myGLSSocket->m_recvSeq >> 16);
+    ack[3] = (byte) (myGLSSocket->m_recvSeq >> 8);
+    ack[4] = (byte) myGLSSocket->m_recvSeq;
+    
+    return sendPacket(myGLSSocket, ack, GLS_SIZE_ACK);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Process an acknowledgement received in pipelined mode, 
+ m_mutexGlsSend must be locked. An OK acknowledgement is
+ cumulative, a retry sends again all the messages from 
+ the sequence number.
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int processAck(GLSSock* myGLSSocket, const byte* ack, const int size) {
+    
+    /* Nothing in flight */
+    if (myGLSSocket->m_ackSeq == myGLSSocket->m_sendSeq) return 0;
+    
+    /* Sequence number of the acknowledgement */
+    unsigned int seq = 0;
+    if (size == GLS_SIZE_ACK) {
         
-        }
-        else {
-            
-            /* Unlock the mutex */
-            pthread_mutex_unlock(&myGLSSocket->m_mutexGlsSend);
-            
-            /* Debug only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            if (myGLSSocket->m_isServeur) printf("Server - glsSend() finish OK\n");
-            else printf("Client - glsSend() finish OK\n");
-            printf("### glsSend() End ###\n\n");
-            #endif
-            
-            /* Return packet's size */
-            return error;
-            
-        }
+        seq = ((unsigned int) ack[1] << 24) | ((unsigned int) ack[2] << 16) | ((unsigned int) ack[3] << 8) | (unsigned int) ack[4];
         
     }
-    else {
+    else if (size == 1) {
         
-        /* We don't unlock the mutex because it's only lock
-         if the condition is true */
+        /* Stop and wait receiver, acknowledgements are in order */
+        seq = myGLSSocket->m_ackSeq;
+        
+    }
+    else {
         
         /* Debug Only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### glsSend() End ###\n\n");
+        printf("Bad acknowledgement size : %d\n", size);
         #endif
-                
-        if (myGLSSocket->m_isSocketConfig == 0 || myGLSSocket->m_isHandShakeFinish == 0) return GLS_ERROR_NOTCONN;
-        else return GLS_ERROR_UNKNOWN;
+        
+        return GLS_ERROR_NOMESSAGE;
+        
+    }
+    
+    /* Ignore an acknowledgement outside the window */
+    unsigned int inFlight = myGLSSocket->m_sendSeq - myGLSSocket->m_ackSeq;
+    if (seq - myGLSSocket->m_ackSeq >= inFlight) return 0;
+    
+    /* Everything before seq has been received, retry is for seq itself */
+    unsigned int lastAck = seq;
+    if (ack[0] != 1) lastAck = seq - 1;
+    while (myGLSSocket->m_ackSeq != lastAck + 1) {
+        
+        int index = myGLSSocket->m_ackSeq % myGLSSocket->m_maxInFlight;
+        
+        /* Round trip of the last sending of the message */
+        unsigned long long timeAck = getTimeMicro() - myGLSSocket->m_timeInFlight[index];
+        myGLSSocket->m_statsSend.m_nbAck++;
+        myGLSSocket->m_statsSend.m_ackTime += timeAck;
+        addHistogram(myGLSSocket->m_statsSend.m_ackHistogram, timeAck);
+        
+        free(myGLSSocket->m_inFlight[index]);
+        myGLSSocket->m_inFlight[index] = 0;
+        myGLSSocket->m_sizeInFlight[index] = 0;
+        myGLSSocket->m_ackSeq++;
+        myGLSSocket->m_nbRetry = 0;
+        
+    }
+    
+    if (ack[0] == 1) return 0;
+    
+    /* After 3 attempts the IVs will be desynchronized */
+    myGLSSocket->m_nbRetry++;
+    myGLSSocket->m_statsSend.m_nbRetry++;
+    if (myGLSSocket->m_nbRetry >= 3) {
+        
+        myGLSSocket->m_statsSend.m_nbIvDesync++;
+        
+        return GLS_ERROR_IVDESYNC;
+        
+    }
     
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Retry from seq %u to %u\n", myGLSSocket->m_ackSeq, myGLSSocket->m_sendSeq - 1);
+    #endif
+    
+    /* Send again all the messages in flight, in order to keep the IVs chain */
+    unsigned int i = 0;
+    for (i = myGLSSocket->m_ackSeq; i != myGLSSocket->m_sendSeq; i++) {
+        
+        int index = i % myGLSSocket->m_maxInFlight;
+        myGLSSocket->m_timeInFlight[index] = getTimeMicro();
+        int error = sendPacket(myGLSSocket, myGLSSocket->m_inFlight[index], myGLSSocket->m_sizeInFlight[index]);
+        if (error < 0) return error;
+        
     }
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Wait (with timeout) for an acknowledgement and process
+ it, m_mutexGlsSend must be locked.
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
 
+int waitAck(GLSSock* myGLSSocket) {
+    
+    byte (*ack) = 0;
+    int sizeAck = recvAck(myGLSSocket, &ack);
+    if (sizeAck < 0) return sizeAck;
+    
+    int error = processAck(myGLSSocket, ack, sizeAck);
+    free(ack);
+    
+    return error;
+    
 }
 
 
@@ -4888,242 +5851,288 @@ int glsSend(GLSSock* myGLSSocket, const byte* buffer, const int sizeBuffer){
 
 /*-------------------------------------------------------
  
- Wait for a message, you can use this function on a thread.
- You are responsible for deallocating the buffer with free().
+ PRIVATE
  
- Return the size of the received message or a negative 
- number for an error.
+ Wait (with timeout) for the next acknowledgement, in 
+ both modes, m_mutexGlsSend must be locked. The messages
+ of the peer received before it are acknowledged now (the
+ peer may wait for it too) and kept for the next
+ glsRecv().
+ 
+ Return the acknowledgement size, a negative number for
+ an error. You are responsible for deallocating ack.
  
  ---------------------------------------------------------*/
 
-int glsRecv(GLSSock* myGLSSocket, byte** buffer){
+int recvAck(GLSSock* myGLSSocket, byte** ack) {
     
-    /* Debug Only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
-    printf("### glsRecv() Start ###\n");
-    #endif
+    int nbDiscard = 0;
+    *ack = 0;
     
-    /* Check if the connexion is ok */
-    if (myGLSSocket->m_isSocketConfig == 1 && myGLSSocket->m_isHandShakeFinish == 1) {
-        
-        /* Lock mutex */
-        pthread_mutex_lock(&myGLSSocket->m_mutexGlsRecv);
+    while (1) {
         
-        /* Receive message */
-        int nbEssai = 0;
-        int error = -1;
-        while (error != 0 && nbEssai < 3) {
-            
-            /* Debug only */
-            #if defined (GLS_DEBUG_MODE_ENABLE)
-            if (myGLSSocket->m_isServeur) printf("Server - glsRecV() recvPacket\n");
-            else printf("Client - glsRecv() recvPacket\n");
-            #endif
-            
-            /* Receive the encrypted message without timeout (Blocking mode) */
-            byte (*cipherMessage) = 0;
-            int sizeCipherMessage = recvPacket(myGLSSocket, &cipherMessage, 0);
-            if (sizeCipherMessage < 0) {
-                
-                /* Free memory */
-                if (cipherMessage != NULL) {
-                    free(cipherMessage);
-                    cipherMessage = 0;
-                }
-                
-                /* Unlock mutex */
-                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### glsRecv() End ###\n\n");
-                #endif
-                
-                return sizeCipherMessage;
-                
-            }
-            
-            #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
-            struct timeval sTime;
-            gettimeofday(&sTime, NULL);
-            #endif
-
-            /* Message decryption */
-            byte (*plainTextMessage) = 0;
-            int sizePlainTextMessage = allDecrypt(myGLSSocket, cipherMessage, sizeCipherMessage, &plainTextMessage);
-            
-            #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
-            struct timeval eTime;
-            gettimeofday(&eTime, NULL);
-            double tS = sTime.tv_sec*1000000 + (sTime.tv_usec);
-            double tE = eTime.tv_sec*1000000  + (eTime.tv_usec);
-            printf("Time for total decryption : %f microSeconds\n", tE - tS);
-            printf("Speed Decryption : %f Mo/s\n", (sizeCipherMessage / 1000) / ((tE - tS) / 1000));
-            #endif
-            
-            if (sizePlainTextMessage == GLS_ERROR_MAC) {
-                
-                /* Debug only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                if (myGLSSocket->m_isServeur) printf("Serveur - glsRecV() sendPacket error MAC\n");
-                else printf("Client - glsRecv() sendPacket error MAC\n");
-                #endif
-                
-                /* If MAC error we ask for another message */
-                byte returnMessage[1];
-                returnMessage[0] = 2;
-                error = sendPacket(myGLSSocket, returnMessage, 1);
-                if (error < 0) {
-                    
-                    /* Free memory */
-                    if (cipherMessage != NULL) {
-                        free(cipherMessage);
-                        cipherMessage = 0;
-                    }
-                    if (plainTextMessage != NULL) {
-                        free(plainTextMessage);
-                        plainTextMessage = 0;
-                    }
-                    
-                    /* Unlock mutex */
-                    pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
-                    
-                    /* Debug Only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("### glsRecv() End ###\n\n");
-                    #endif
-                    
-                    return error;
-                    
-                }
-                
-                /* Configuring error to do another time the while */
-                error = -1;
-            
-            }
-            else if (sizePlainTextMessage < 0) {
-                
-                /* Free memory */
-                if (cipherMessage != NULL) {
-                    free(cipherMessage);
-                    cipherMessage = 0;
-                }
-                if (plainTextMessage != NULL) {
-                    free(plainTextMessage);
-                    plainTextMessage = 0;
-                }
-                
-                /* Unlock mutex */
-                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
-                
-                /* Debug Only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                printf("### glsRecv() End ###\n\n");
-                #endif
-                
-                return sizePlainTextMessage;
-                
-            }
-            else {
-                
-                /* Debug only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                if (myGLSSocket->m_isServeur) printf("Server - glsRecV() sendPacket OK\n");
-                else printf("Client - glsRecv() sendPacket OK\n");
-                #endif
-                
-                /* If the message is goog we send back an ok message */
-                byte okMessage[1];
-                okMessage[0] = 1;
-                error = sendPacket(myGLSSocket, okMessage, 1);
-                if (error < 0) {
-                    
-                    /* Free memory */
-                    if (cipherMessage != NULL) {
-                        free(cipherMessage);
-                        cipherMessage = 0;
-                    }
-                    if (plainTextMessage != NULL) {
-                        free(plainTextMessage);
-                        plainTextMessage = 0;
-                    }
-                    
-                    /* Unlock mutex */
-                    pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
-                    
-                    /* Debug Only */
-                    #if defined (GLS_DEBUG_MODE_ENABLE)
-                    printf("### glsRecv() End ###\n\n");
-                    #endif
-                    
-                    return error;
-                    
-                }
-                
-                /* Copy plaintext into the buffer */
-                *buffer = plainTextMessage;
-                plainTextMessage = 0;
-                
-                /* Free memory except plainTextMessage used by the buffer pointer */
-                if (cipherMessage != NULL) {
-                    free(cipherMessage);
-                    cipherMessage = 0;
-                }
-                
-                /* Unlock mutex */
-                pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
-                
-                /* Debug only */
-                #if defined (GLS_DEBUG_MODE_ENABLE)
-                if (myGLSSocket->m_isServeur) printf("Server - glsRecV() finish OK\n");
-                else printf("Client - glsRecv() finish OK\n");
-                printf("### glsRecv() End ###\n\n");
-                #endif
-                
-                return sizePlainTextMessage;
-                
-            }
+        byte (*packet) = 0;
+        int sizePacket = recvPacket(myGLSSocket, &packet, 1);
+        if (sizePacket < 0) {
             
-            nbEssai++;
+            if (packet != NULL) free(packet);
+            return sizePacket;
             
-            /* Free memory */
-            if (cipherMessage != NULL) {
-                free(cipherMessage);
-                cipherMessage = 0;
-            }
-            if (plainTextMessage != NULL) {
-                free(plainTextMessage);
-                plainTextMessage = 0;
+        }
+        
+        /* Acknowledgement of our messages */
+        if (sizePacket == 1 || sizePacket == GLS_SIZE_ACK) {
+            
+            *ack = packet;
+            
+            return sizePacket;
+            
+        }
+        
+        /* Message of the peer sent before our acknowledgement */
+        int error = readCipherText(myGLSSocket, packet, sizePacket);
+        if (error >= 0) error = pushRecvQueue(myGLSSocket, packet, error);
+        else {
+            
+            free(packet);
+            
+            /* Sent again by the peer */
+            if (error == GLS_ERROR_MAC) error = 0;
+            else if (error == GLS_ERROR_IVDESYNC && myGLSSocket->m_isRecvRecovery == 1 && nbDiscard < GLS_MAX_WINDOW) {
+                
+                nbDiscard++;
+                myGLSSocket->m_statsRecv.m_nbIvDesync++;
+                error = 0;
+                
             }
             
         }
         
-        /* Unlock mutex */
-        pthread_mutex_unlock(&myGLSSocket->m_mutexGlsRecv);
+        if (error < 0) return error;
         
-        /* Debug Only */
+    }
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Check without blocking if the next packet waiting on
+ the socket is an acknowledgement.
+ 
+ Return 1 if an acknowledgement is waiting, 0 otherwise.
+ 
+ ---------------------------------------------------------*/
+
+int isAckPending(GLSSock* myGLSSocket) {
+    
+    /* Local variable */
+    struct pollfd fds;
+    fds.fd = myGLSSocket->m_sock;
+    fds.events = POLLIN;
+    fds.revents = 0;
+    
+    /* No wait */
+    if (poll(&fds, 1, 0) <= 0) return 0;
+    
+    /* Look at the header without removing it from the socket */
+    byte header[2];
+    if (recv(myGLSSocket->m_sock, header, 2, MSG_PEEK) != 2) return 0;
+    
+    int sizePacket = (header[0] << 8) | header[1];
+    if (sizePacket == GLS_SIZE_ACK || sizePacket == 1) return 1;
+    else return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Decrypt in place a message of the peer and acknowledge
+ it, the plaintext is moved at the beginning of the
+ buffer. A MAC error asks the peer to send it again.
+ 
+ Return the size of the plaintext, GLS_ERROR_MAC if asked
+ again or a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int readCipherText(GLSSock* myGLSSocket, byte* cipherMessage, const int sizeCipherMessage) {
+    
+    #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
+    struct timeval sTime;
+    gettimeofday(&sTime, NULL);
+    #endif
+    
+    /* Message decryption in place */
+    unsigned long long timeStart = getTimeMicro();
+    int sizeHeader = GLS_SIZE_HEADROOM;
+    int sizePlainTextMessage = 0;
+    if (myGLSSocket->m_activeSuite == GLS_SUITE_SERPENT_TWOFISH_CTR) sizePlainTextMessage = ctrDecryptInPlace(myGLSSocket, cipherMessage, sizeCipherMessage);
+    else if (myGLSSocket->m_activeSuite != GLS_SUITE_SERPENT_TWOFISH) {
+        
+        sizeHeader = GLS_SIZE_AEAD_HEADER;
+        sizePlainTextMessage = aeadDecryptInPlace(myGLSSocket, cipherMessage, sizeCipherMessage);
+        
+    }
+    else sizePlainTextMessage = allDecryptInPlace(myGLSSocket, cipherMessage, sizeCipherMessage);
+    myGLSSocket->m_statsRecv.m_decryptTime += getTimeMicro() - timeStart;
+    
+    #if defined (GLS_DEBUG_TIME_MODE_ENABLE)
+    struct timeval eTime;
+    gettimeofday(&eTime, NULL);
+    double tS = sTime.tv_sec*1000000 + (sTime.tv_usec);
+    double tE = eTime.tv_sec*1000000  + (eTime.tv_usec);
+    printf("Time for total decryption : %f microSeconds\n", tE - tS);
+    printf("Speed Decryption : %f Mo/s\n", (sizeCipherMessage / 1000) / ((tE - tS) / 1000));
+    #endif
+    
+    if (sizePlainTextMessage == GLS_ERROR_MAC) {
+        
+        /* Debug only */
         #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### glsRecv() End ###\n\n");
+        if (myGLSSocket->m_isServeur) printf("Serveur - readCipherText() sendPacket error MAC\n");
+        else printf("Client - readCipherText() sendPacket error MAC\n");
         #endif
         
-        return GLS_ERROR_IVDESYNC;
+        /* If MAC error we ask for another message */
+        myGLSSocket->m_statsRecv.m_nbMacError++;
+        int error = sendAck(myGLSSocket, 2);
+        if (error < 0) return error;
+        
+        /* The messages already sent after this one will be desynchronized */
+        myGLSSocket->m_isRecvRecovery = 1;
+        
+        return GLS_ERROR_MAC;
         
     }
-    else {
+    else if (sizePlainTextMessage < 0) return sizePlainTextMessage;
+    
+    /* Debug only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    if (myGLSSocket->m_isServeur) printf("Server - readCipherText() sendPacket OK\n");
+    else printf("Client - readCipherText() sendPacket OK\n");
+    #endif
+    
+    /*
+     * If the message is good we send back an ok message, the sequence
+     * number only counts the acknowledged messages. The IVs already
+     * moved to the next message, so the connexion can't go on without
+     * this acknowledgement.
+     */
+    myGLSSocket->m_isRecvRecovery = 0;
+    int error = sendAck(myGLSSocket, 1);
+    if (error < 0) {
         
-        /* We don't unlock the mutex because it's only lock
-         if the condition is true */
+        shutdown(myGLSSocket->m_sock, SHUT_RDWR);
         
-        /* Debug Only */
-        #if defined (GLS_DEBUG_MODE_ENABLE)
-        printf("### glsRecv() End ###\n\n");
-        #endif
+        return error;
         
-        if (myGLSSocket->m_isSocketConfig == 0 || myGLSSocket->m_isHandShakeFinish == 0) return GLS_ERROR_NOTCONN;
-        else return GLS_ERROR_UNKNOWN;
+    }
+    myGLSSocket->m_recvSeq++;
+    
+    /* Move the plaintext at the beginning of the buffer */
+    memmove(cipherMessage, cipherMessage + sizeHeader, sizePlainTextMessage);
+    
+    myGLSSocket->m_statsRecv.m_bytesRecv += sizePlainTextMessage;
+    myGLSSocket->m_statsRecv.m_messagesRecv++;
+    
+    return sizePlainTextMessage;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Keep a message (plaintext) read by glsSend() for the next
+ glsRecv(), m_mutexGlsSend must be locked. The message is
+ freed on error.
+ 
+ Return 0 for success, a negative number for an error.
+ 
+ ---------------------------------------------------------*/
+
+int pushRecvQueue(GLSSock* myGLSSocket, byte* message, const int size) {
     
+    /* No place at the end, first at the beginning or bigger arrays */
+    if (myGLSSocket->m_firstRecvQueue + myGLSSocket->m_nbRecvQueue == myGLSSocket->m_maxRecvQueue) {
+        
+        if (myGLSSocket->m_firstRecvQueue > 0) {
+            
+            memmove(myGLSSocket->m_recvQueue, myGLSSocket->m_recvQueue + myGLSSocket->m_firstRecvQueue, myGLSSocket->m_nbRecvQueue * sizeof(byte*));
+            memmove(myGLSSocket->m_sizeRecvQueue, myGLSSocket->m_sizeRecvQueue + myGLSSocket->m_firstRecvQueue, myGLSSocket->m_nbRecvQueue * sizeof(int));
+            myGLSSocket->m_firstRecvQueue = 0;
+            
+        }
+        else {
+            
+            int maxRecvQueue = (myGLSSocket->m_maxRecvQueue > 0) ? myGLSSocket->m_maxRecvQueue * 2 : 8;
+            byte* (*recvQueue) = realloc(myGLSSocket->m_recvQueue, maxRecvQueue * sizeof(byte*));
+            if (recvQueue != NULL) myGLSSocket->m_recvQueue = recvQueue;
+            int* sizeRecvQueue = realloc(myGLSSocket->m_sizeRecvQueue, maxRecvQueue * sizeof(int));
+            if (sizeRecvQueue != NULL) myGLSSocket->m_sizeRecvQueue = sizeRecvQueue;
+            if (recvQueue == NULL || sizeRecvQueue == NULL) {
+                
+                free(message);
+                
+                return GLS_ERROR_NOMEM;
+                
+            }
+            myGLSSocket->m_maxRecvQueue = maxRecvQueue;
+            
+        }
+        
     }
     
+    int index = myGLSSocket->m_firstRecvQueue + myGLSSocket->m_nbRecvQueue;
+    myGLSSocket->m_recvQueue[index] = message;
+    myGLSSocket->m_sizeRecvQueue[index] = size;
+    myGLSSocket->m_nbRecvQueue++;
+    
+    return 0;
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Give the oldest message of pushRecvQueue() to the user,
+ m_mutexGlsSend must be locked.
+ 
+ Return the size of the message, -1 if the queue is
+ empty.
+ 
+ ---------------------------------------------------------*/
+
+int popRecvQueue(GLSSock* myGLSSocket, byte** buffer) {
+    
+    if (myGLSSocket->m_nbRecvQueue == 0) return -1;
+    
+    int index = myGLSSocket->m_firstRecvQueue;
+    *buffer = myGLSSocket->m_recvQueue[index];
+    myGLSSocket->m_recvQueue[index] = 0;
+    myGLSSocket->m_firstRecvQueue++;
+    myGLSSocket->m_nbRecvQueue--;
+    if (myGLSSocket->m_nbRecvQueue == 0) myGLSSocket->m_firstRecvQueue = 0;
+    
+    return myGLSSocket->m_sizeRecvQueue[index];
+    
 }
 
 
@@ -5167,7 +6176,7 @@ int addKey(GLSSock* myGLSSocket, const char* key, int isSha){
         if (strlen(key) >= 127) {
             
             /* Secure memory allocation for the encryption key */
-            byte (*keyToAdd) = (byte*) gcry_malloc_secure(64);
+            byte (*keyToAdd) = newKeyBuffer(myGLSSocket);
             if (keyToAdd == NULL) {
                 
                 #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -5179,7 +6188,7 @@ int addKey(GLSSock* myGLSSocket, const char* key, int isSha){
             }
             
             /* Secure allocation for the temp memory */
-            char *temp = (char*) gcry_malloc_secure(3);
+            char *temp = (char*) mallocSecure(3);
             if (temp == NULL) {
                 
                 #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -5210,7 +6219,7 @@ int addKey(GLSSock* myGLSSocket, const char* key, int isSha){
                 temp[i] = 1;
                 temp[i] = 2;
             }
-            gcry_free(temp);
+            freeSecure((byte*) temp, 3);
             temp = 0;
 
         }
@@ -5232,7 +6241,7 @@ int addKey(GLSSock* myGLSSocket, const char* key, int isSha){
         if(!gcry_md_test_algo(GCRY_MD_SHA512)) {
             
             /* Secure memory allocation of the encryption key */
-            byte (*keyToAdd) = (byte*) gcry_malloc_secure(64);
+            byte (*keyToAdd) = newKeyBuffer(myGLSSocket);
             if (keyToAdd == NULL) {
                 
                 #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -5284,7 +6293,7 @@ int addKey(GLSSock* myGLSSocket, const char* key, int isSha){
         sizeKeys*= 64;
         
         /* Secure memory allocation */
-        byte (*tempKey) = (byte*) gcry_malloc_secure(sizeKeys);
+        byte (*tempKey) = mallocSecure(sizeKeys);
         if (tempKey == NULL) {
             
             #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -5323,13 +6332,15 @@ int addKey(GLSSock* myGLSSocket, const char* key, int isSha){
         if(!gcry_md_test_algo(GCRY_MD_SHA512)) {
             
             /* Secure memory allocation for the final encryption key */
-            byte (*finalKey) = (byte*) gcry_malloc_secure(64);
+            byte (*finalKey) = mallocSecure(64);
             if (finalKey == NULL) {
                 
                 #if defined (GLS_DEBUG_MODE_ENABLE)
                 printf("No memory. addKey()\n");
                 #endif
                 
+                freeSecure(tempKey, sizeKeys);
+                
                 return GLS_ERROR_NOMEM;
                 
             }
@@ -5362,7 +6373,7 @@ int addKey(GLSSock* myGLSSocket, const char* key, int isSha){
             }
             
             /* Free finalKey */
-            gcry_free(finalKey);
+            freeSecure(finalKey, 64);
             finalKey = 0;
             
         }
@@ -5377,7 +6388,7 @@ int addKey(GLSSock* myGLSSocket, const char* key, int isSha){
             }
             
             /* Free tempKey */
-            gcry_free(tempKey);
+            freeSecure(tempKey, sizeKeys);
             tempKey = 0;
             
             #if defined (GLS_DEBUG_MODE_ENABLE)
@@ -5398,7 +6409,7 @@ int addKey(GLSSock* myGLSSocket, const char* key, int isSha){
         }
         
         /* Free tempKey */
-        gcry_free(tempKey);
+        freeSecure(tempKey, sizeKeys);
         tempKey = 0;
         
     }
@@ -5490,30 +6501,9 @@ int clearKey(GLSSock* myGLSSocket){
     
     if (myGLSSocket->m_isCryptoKey == 1) {
         
-        /* Keys wipe */
-        /* Iteration of all the keys and wipe */
+        /* Keys wipe and free of the key array */
+        freeKeys(myGLSSocket);
         int i = 0;
-        for(i = 0; i < myGLSSocket->m_sizeKeys; i++)
-        {
-            
-            byte* myKey = (byte*) myGLSSocket->m_keys[i];
-            
-            int y = 0;
-            for (y = 0; y < 64; y++) {
-                
-                myKey[y] = 0; 
-                myKey[y] = 1; 
-                myKey[y] = 2; 
-                
-            }
-            gcry_free(myKey);
-            myKey = 0;
-
-        }
-        /* Free the key array */
-        free(myGLSSocket->m_keys);
-        myGLSSocket->m_keys = 0;
-        myGLSSocket->m_sizeKeys = 0;
         
         #if defined (GLS_DEBUG_MODE_ENABLE)
         printf("Wipe key array\n");
@@ -5572,43 +6562,89 @@ int clearKey(GLSSock* myGLSSocket){
  
  PRIVATE
  
- Reception Socket with Timeout
+ Wait for a packet (with a timeout in seconds, 0 = no 
+ timeout) and read its 2 bytes header. The packet stays
+ on the socket, only the header is read.
+ 
+ Return the packet size, SOCKET_ERROR or GLS_ERROR_TIMEDOUT.
  
  ---------------------------------------------------------*/
 
-ssize_t recvWithTimeout(const int socket, byte *buffer, const ssize_t size, const int flag, const int timeout) {
+ssize_t recvHeader(const int socket, const int flag, const int timeout) {
     
-    /* Local variable */
-    fd_set fds;
-    int error;
-    struct timeval tv;
-    
-    /* Selectors configuration */
-    FD_ZERO(&fds);
-    FD_SET(socket, &fds);
-    
-    /* Timeout configuration */
-    tv.tv_sec = timeout;
-    tv.tv_usec = 0;
-    
-    /* Waiting for data or a timeout */
-    error = select(socket + 1, &fds, NULL, NULL, &tv);
-    /* If we get a timeout we return it */
-    if (error == 0) return GLS_ERROR_TIMEDOUT;
-    /* If it's an error the same */
-    else if (error < 0) return error;
-    /* If everything is ok we return the data size */
-    else {
+    /* Waiting for data or a timeout (no limit on the descriptor number like select) */
+    if (timeout > 0) {
         
-        /* Si les headers sont configuré */
-        #if defined (GLS_HEADER_PACKET)
-        return recvWithHeader(socket, buffer, size, flag);
-        #else
-        return recv(socket, buffer, size, flag);
-        #endif
+        struct pollfd fds;
+        int error;
+        
+        fds.fd = socket;
+        fds.events = POLLIN;
+        fds.revents = 0;
+        
+        do {
+            
+            error = poll(&fds, 1, timeout * 1000);
+            
+        } while (error < 0 && errno == EINTR);
+        
+        /* If we get a timeout we return it */
+        if (error == 0) return GLS_ERROR_TIMEDOUT;
+        /* If it's an error the same */
+        else if (error < 0) return SOCKET_ERROR;
+        
+    }
+    
+    /* 
+     * Get only the 2 bytes header, the next packet can already
+     * be on the socket (pipelined send) and must stay there.
+     */
+    byte header[2];
+    if (recvAll(socket, header, 2, flag) == SOCKET_ERROR) return SOCKET_ERROR;
+    
+    /* Packet size (big-endian) */
+    return (ssize_t) ((header[0] << 8) | header[1]);
+    
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Receive exactly size bytes.
+ 
+ Return size or SOCKET_ERROR.
+ 
+ ---------------------------------------------------------*/
+
+ssize_t recvAll(const int socket, byte *buffer, const size_t size, const int flag) {
+    
+    /* Variable init */
+    ssize_t sock_size = 0;
+    size_t total = 0;
     
+    /* Get all the data */
+    while (total < size) {
+        
+        sock_size = recv(socket, buffer + total, size - total, flag);
+        if (sock_size < 0 && errno == EINTR) continue;
+        
+        /* Connexion closed by the other side */
+        if (sock_size == 0) errno = ENOTCONN;
+        
+        /* In case of error or 0 */
+        if (sock_size <= 0) return SOCKET_ERROR;
+        
+        /* Size ajustement */
+        total += sock_size;
+        
     }
     
+    return (ssize_t) total;
+    
 }
 
 
@@ -5625,139 +6661,176 @@ ssize_t recvWithTimeout(const int socket, byte *buffer, const ssize_t size, cons
 ssize_t	sendWithHeader(const int socket, const byte *buffer, const ssize_t size, const int flag) {
     
     /* Packet size encoding (big-endian for network) in 2 bytes */
-    unsigned short int sizePacket = htons((unsigned short int)size);
-    byte *sizePacketByte = (byte*) &sizePacket;
+    byte header[2];
+    header[0] = (byte) (size >> 8);
+    header[1] = (byte) size;
     
-    /* Temp memory allocation */
-    byte (*temp) = malloc(sizeof(byte) * (size + 2));
+    /* Header and buffer sent together without copy */
+    struct iovec iov[2];
+    iov[0].iov_base = header;
+    iov[0].iov_len = 2;
+    iov[1].iov_base = (void*) buffer;
+    iov[1].iov_len = size;
     
-    /* Insertion of the packet's size */
-    temp[0] = sizePacketByte[0];
-    temp[1] = sizePacketByte[1];
+    /* If no error happened return the size, otherwise SOCKET_ERROR */
+    ssize_t sock_size = sendIov(socket, iov, 2, flag);
+    if (sock_size != SOCKET_ERROR) return sock_size - 2;
+    else return SOCKET_ERROR;
     
-    /* Fill the temp var with buffer */
-    int i = 0;
-    for (i = 0; i < size; i++) {
-        
-        temp[i + 2] = buffer[i]; 
-        
-    }
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Send all the iovec in one system call when possible, the
+ iovec array is modified if only a part is sent.
+ 
+ ---------------------------------------------------------*/
+
+ssize_t sendIov(const int socket, struct iovec *iov, int iovcnt, const int flag) {
     
-    /* Configuration of the size left to send */
-    ssize_t sizeLeftTemp = size + 2;
+    /* Variable init */
     ssize_t sizeTotal = 0;
-    byte *tempPtr = temp;
     ssize_t sock_size = 0;
+    struct msghdr message;
+    memset(&message, 0, sizeof(struct msghdr));
     
     /* Sending information until there is none */
-    while (sizeLeftTemp > 0 && sock_size != SOCKET_ERROR) {
+    while (iovcnt > 0) {
+        
+        message.msg_iov = iov;
+        message.msg_iovlen = iovcnt;
         
         /* Sending info */
-        sock_size = send(socket, tempPtr, sizeLeftTemp, flag);
-        /* Ajusting pointer with the size left */
-        tempPtr += sock_size;
-        /* Remove the information's size sent from the total size left */
-        sizeLeftTemp -= sock_size;
+        sock_size = sendmsg(socket, &message, flag);
+        if (sock_size < 0 && errno == EINTR) continue;
+        
+        /* In case of an error or 0 */
+        if (sock_size <= 0) return SOCKET_ERROR;
+        
         /* Add the size sent to the total size */
         sizeTotal += sock_size;
         
-        /* In case of an error 0 */
-        if (sock_size == 0) sock_size = SOCKET_ERROR;
+        /* Skip the iovec already sent and ajust the first one */
+        while (iovcnt > 0 && (size_t) sock_size >= iov->iov_len) {
+            
+            sock_size -= iov->iov_len;
+            iov++;
+            iovcnt--;
+            
+        }
+        if (iovcnt > 0) {
             
+            iov->iov_base = (byte*) iov->iov_base + sock_size;
+            iov->iov_len -= sock_size;
+            
+        }
+        
     }
     
-    /* Free memory */
-    free(temp);
-    temp = 0;
-    tempPtr = 0;
-    
-    /* If no error happened return the size, otherwise SOCKET_ERROR */
-    if (sock_size != SOCKET_ERROR) return sizeTotal - 2;
-    else return SOCKET_ERROR;
+    return sizeTotal;
     
 }
 
 
 
-
 /*-------------------------------------------------------
  
  PRIVATE
  
- Socket Recv with Header
+ Send the iovec of an event loop client without blocking,
+ what the socket doesn't take now is copied at the end of
+ m_outBuffer for flushOutBuffer(). Nothing is sent before
+ the packets already waiting. m_mutexSendPacket must be
+ locked.
+ 
+ Return the size sent or queued, SOCKET_ERROR for an error
+ (errno is set).
  
  ---------------------------------------------------------*/
 
-ssize_t	recvWithHeader(const int socket, byte *buffer, const size_t size, const int flag) {
-    
-    /* Variable init */
-    ssize_t sock_size = 0;
-    unsigned short int sizePacketTemp = 0;
-    ssize_t sizePacket = 0;
-    ssize_t total = 0;
-    byte *sizePacketByte = (byte*) &sizePacketTemp;
+ssize_t queueIov(GLSSock* myGLSSocket, struct iovec *iov, int iovcnt, const int flag) {
     
-    /* Memory temp allocation */
-    byte (*temp) = malloc(sizeof(byte) * (size + 2));
-    byte *tempPtr = temp;
-    
-    /* Info reception */
-    sock_size = recv(socket, temp, size + 2, flag);
+    ssize_t sizeTotal = 0;
+    int i = 0;
+    for (i = 0; i < iovcnt; i++) sizeTotal += iov[i].iov_len;
     
-    /* Get the packet size */
-    if (sock_size > 2) {
+    /* The socket takes what it can if nothing is waiting */
+    if (myGLSSocket->m_posOutBuffer == myGLSSocket->m_sizeOutBuffer) {
         
-        /* Get size and convert it */
-        sizePacketByte[0] = temp[0];
-        sizePacketByte[1] = temp[1];
-        sizePacket = (ssize_t) ntohs(sizePacketTemp);
-        total += sock_size;
+        struct msghdr message;
+        memset(&message, 0, sizeof(struct msghdr));
+        message.msg_iov = iov;
+        message.msg_iovlen = iovcnt;
+        
+        ssize_t sock_size = 0;
+        do {
+            sock_size = sendmsg(myGLSSocket->m_sock, &message, flag | GLS_MSG_EVENT);
+        } while (sock_size < 0 && errno == EINTR);
+        
+        if (sock_size < 0 && errno != EAGAIN && errno != EWOULDBLOCK) return SOCKET_ERROR;
+        if (sock_size < 0) sock_size = 0;
+        
+        /* Skip the iovec already sent and ajust the first one */
+        while (iovcnt > 0 && (size_t) sock_size >= iov->iov_len) {
+            
+            sock_size -= iov->iov_len;
+            iov++;
+            iovcnt--;
+            
+        }
+        if (iovcnt == 0) return sizeTotal;
+        
+        iov->iov_base = (byte*) iov->iov_base + sock_size;
+        iov->iov_len -= sock_size;
         
     }
-    else {
     
-        /* Free memory */
-        free(temp);
-        temp = 0;
-        tempPtr = 0;
-        
-        return -1;
+    /* The rest after the packets waiting, the sent part is removed first */
+    int sizeRest = 0;
+    for (i = 0; i < iovcnt; i++) sizeRest += iov[i].iov_len;
     
+    if (myGLSSocket->m_posOutBuffer > 0) {
+        
+        memmove(myGLSSocket->m_outBuffer, myGLSSocket->m_outBuffer + myGLSSocket->m_posOutBuffer, myGLSSocket->m_sizeOutBuffer - myGLSSocket->m_posOutBuffer);
+        myGLSSocket->m_sizeOutBuffer -= myGLSSocket->m_posOutBuffer;
+        myGLSSocket->m_posOutBuffer = 0;
+        
     }
     
-    /* Get all the data */
-    while (total < (sizePacket + 2) && sock_size != SOCKET_ERROR) {
+    if (myGLSSocket->m_sizeOutBuffer + sizeRest > myGLSSocket->m_maxOutBuffer) {
         
-        /* Pointer ajustement */
-        tempPtr += sock_size;
-        /* Get info */
-        sock_size = recv(socket, tempPtr, (sizePacket + 2 - total), flag);
-        /* Size ajustement */
-        total += sock_size;
+        int maxOutBuffer = (myGLSSocket->m_maxOutBuffer > 0) ? myGLSSocket->m_maxOutBuffer * 2 : GLS_SIZE_PACKET;
+        while (maxOutBuffer < myGLSSocket->m_sizeOutBuffer + sizeRest) maxOutBuffer *= 2;
         
-        /* In case of error 0 */
-        if (sock_size == 0) sock_size = SOCKET_ERROR;
+        byte* outBuffer = realloc(myGLSSocket->m_outBuffer, maxOutBuffer);
+        if (outBuffer == NULL) {
+            
+            errno = ENOMEM;
+            
+            return SOCKET_ERROR;
+            
+        }
+        myGLSSocket->m_outBuffer = outBuffer;
+        myGLSSocket->m_maxOutBuffer = maxOutBuffer;
         
     }
     
-    /* Copy temp buffer into final buffer */
-    int i = 0;
-    for (i = 0; i < sizePacket && i < size; i++) {
+    for (i = 0; i < iovcnt; i++) {
         
-        buffer[i] = temp[i + 2];
+        memcpy(myGLSSocket->m_outBuffer + myGLSSocket->m_sizeOutBuffer, iov[i].iov_base, iov[i].iov_len);
+        myGLSSocket->m_sizeOutBuffer += iov[i].iov_len;
         
     }
     
-    /* Free memory */
-    free(temp);
-    temp = 0;
-    tempPtr = 0;
-    
-    /* Return size if no error, otherwise SOCKET_ERROR */
-    if (sock_size != SOCKET_ERROR) return total - 2;
-    else return SOCKET_ERROR;
+    return sizeTotal;
     
 }
      
 
 
+
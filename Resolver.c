@@ -0,0 +1,476 @@
+/*
+ *  Resolver.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+#include "GLSHeaders.h"
+
+/* Resolved names and threads resolving the queued ones */
+static pthread_mutex_t m_mutexDns = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t m_condDns = PTHREAD_COND_INITIALIZER;
+static GLSDnsEntry m_dnsCache[GLS_SIZE_DNS_CACHE];
+static int m_nbResolver = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ Empty the cache of the resolved names, the names being
+ resolved are kept for the sockets waiting for them.
+
+ ---------------------------------------------------------*/
+
+void glsClearDnsCache(void) {
+
+    int i = 0;
+
+    pthread_mutex_lock(&m_mutexDns);
+
+    for (i = 0; i < GLS_SIZE_DNS_CACHE; i++) {
+
+        if (m_dnsCache[i].m_state == GLS_DNS_DONE) m_dnsCache[i].m_state = GLS_DNS_FREE;
+
+    }
+
+    pthread_mutex_unlock(&m_mutexDns);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Address of a server from the cache. A numeric address is
+ converted here, a name not in the cache is queued for the
+ resolver threads and notify (a pipe) is written when it
+ is resolved. Without notify (-1) nothing is queued.
+
+ Return 0 and fill result if found, GLS_WAIT_READ if not
+ resolved yet or a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int lookupAddress(const char* address, const char* port, GLSAddress* result, const int notify) {
+
+    /* Numeric address, nothing to wait for */
+    int error = getAddress(address, port, AI_NUMERICHOST, result);
+    if (error != GLS_ERROR_AI_NONAME || address == NULL) return error;
+
+    /* Too long to be kept */
+    if (strlen(address) >= GLS_SIZE_DNS_NAME || port == NULL || strlen(port) >= GLS_SIZE_DNS_PORT) return getAddress(address, port, 0, result);
+
+    pthread_mutex_lock(&m_mutexDns);
+
+    /* Resolved and not expired */
+    GLSDnsEntry* entry = findDnsEntry(address, port);
+    if (entry != NULL && entry->m_state == GLS_DNS_DONE && time(NULL) > entry->m_expire) {
+        entry->m_state = GLS_DNS_FREE;
+        entry = 0;
+    }
+    if (entry != NULL && entry->m_state == GLS_DNS_DONE) {
+
+        error = entry->m_error;
+        if (error == 0) memcpy(result, &entry->m_result, sizeof(GLSAddress));
+
+        pthread_mutex_unlock(&m_mutexDns);
+
+        return error;
+
+    }
+
+    if (notify < 0) {
+
+        pthread_mutex_unlock(&m_mutexDns);
+
+        return GLS_WAIT_READ;
+
+    }
+
+    /* New name for the resolver threads */
+    if (entry == NULL) {
+
+        entry = newDnsEntry(address, port);
+        if (entry == NULL) {
+
+            /* All the entries are being resolved */
+            pthread_mutex_unlock(&m_mutexDns);
+
+            return GLS_ERROR_AI_AGAIN;
+
+        }
+
+        /* Threads started with the first name */
+        while (m_nbResolver < GLS_NB_RESOLVER) {
+
+            pthread_t thread;
+            if (pthread_create(&thread, NULL, resolverLoop, NULL) != 0) break;
+            pthread_detach(thread);
+            m_nbResolver++;
+
+        }
+        if (m_nbResolver == 0) {
+
+            entry->m_state = GLS_DNS_FREE;
+            pthread_mutex_unlock(&m_mutexDns);
+
+            return GLS_ERROR_NOMEM;
+
+        }
+
+        pthread_cond_signal(&m_condDns);
+
+    }
+
+    /* Pipe written by setDnsResult(), once */
+    int i = 0;
+    for (i = 0; i < entry->m_nbWaiter; i++) {
+
+        if (entry->m_waiters[i] == notify) break;
+
+    }
+    if (i == entry->m_nbWaiter) {
+
+        if (entry->m_nbWaiter == entry->m_maxWaiter) {
+
+            int maxWaiter = (entry->m_maxWaiter > 0) ? entry->m_maxWaiter * 2 : 4;
+            int* waiters = realloc(entry->m_waiters, maxWaiter * sizeof(int));
+            if (waiters == NULL) {
+
+                pthread_mutex_unlock(&m_mutexDns);
+
+                return GLS_ERROR_NOMEM;
+
+            }
+            entry->m_waiters = waiters;
+            entry->m_maxWaiter = maxWaiter;
+
+        }
+        entry->m_waiters[entry->m_nbWaiter] = notify;
+        entry->m_nbWaiter++;
+
+    }
+
+    pthread_mutex_unlock(&m_mutexDns);
+
+    return GLS_WAIT_READ;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Address of a server from the cache, resolved by the
+ calling thread (blocking) if not found.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int resolveAddress(const char* address, const char* port, GLSAddress* result) {
+
+    int error = lookupAddress(address, port, result, -1);
+    if (error != GLS_WAIT_READ) return error;
+
+    error = getAddress(address, port, 0, result);
+
+    pthread_mutex_lock(&m_mutexDns);
+
+    /* A name queued is given to its waiters too */
+    GLSDnsEntry* entry = findDnsEntry(address, port);
+    if (entry == NULL) entry = newDnsEntry(address, port);
+    if (entry != NULL && entry->m_state != GLS_DNS_RESOLVING) setDnsResult(entry, error, result);
+
+    pthread_mutex_unlock(&m_mutexDns);
+
+    return error;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ First address of getaddrinfo() for a TCP connexion.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int getAddress(const char* address, const char* port, const int flags, GLSAddress* result) {
+
+    /* addrinfo configuration for getaddrinfo() */
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(struct addrinfo));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = flags;
+
+    struct addrinfo* info = 0;
+    int error = getaddrinfo(address, port, &hints, &info);
+    if (error != 0) return getAddrInfoError(error);
+
+    if (info->ai_addrlen > sizeof(result->m_addr)) {
+
+        freeaddrinfo(info);
+
+        return GLS_ERROR_AI_FAMILY;
+
+    }
+
+    result->m_family = info->ai_family;
+    result->m_protocol = info->ai_protocol;
+    result->m_size = info->ai_addrlen;
+    memcpy(&result->m_addr, info->ai_addr, info->ai_addrlen);
+
+    freeaddrinfo(info);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Stop waiting for a name of lookupAddress() and close the
+ pipe notify.
+
+ ---------------------------------------------------------*/
+
+void stopResolveWait(const int notify) {
+
+    int i = 0;
+    int j = 0;
+
+    pthread_mutex_lock(&m_mutexDns);
+
+    for (i = 0; i < GLS_SIZE_DNS_CACHE; i++) {
+
+        GLSDnsEntry* entry = &m_dnsCache[i];
+        for (j = 0; j < entry->m_nbWaiter; j++) {
+
+            if (entry->m_waiters[j] != notify) continue;
+
+            entry->m_nbWaiter--;
+            entry->m_waiters[j] = entry->m_waiters[entry->m_nbWaiter];
+            break;
+
+        }
+
+    }
+
+    pthread_mutex_unlock(&m_mutexDns);
+
+    /* Never written after the mutex */
+    closesocket(notify);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Search a name in the cache, the mutex must be locked.
+
+ Return the entry, NULL if not found.
+
+ ---------------------------------------------------------*/
+
+GLSDnsEntry* findDnsEntry(const char* address, const char* port) {
+
+    int i = 0;
+
+    for (i = 0; i < GLS_SIZE_DNS_CACHE; i++) {
+
+        GLSDnsEntry* entry = &m_dnsCache[i];
+        if (entry->m_state != GLS_DNS_FREE && strcmp(entry->m_address, address) == 0 && strcmp(entry->m_port, port) == 0) return entry;
+
+    }
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Entry for a new name, a free one or in place of the one
+ expiring first. The names being resolved are never
+ replaced. The mutex must be locked.
+
+ Return the entry (GLS_DNS_QUEUED), NULL if all the
+ entries are being resolved.
+
+ ---------------------------------------------------------*/
+
+GLSDnsEntry* newDnsEntry(const char* address, const char* port) {
+
+    GLSDnsEntry* entry = 0;
+    int i = 0;
+
+    for (i = 0; i < GLS_SIZE_DNS_CACHE; i++) {
+
+        if (m_dnsCache[i].m_state == GLS_DNS_FREE) {
+            entry = &m_dnsCache[i];
+            break;
+        }
+        if (m_dnsCache[i].m_state == GLS_DNS_DONE && (entry == NULL || m_dnsCache[i].m_expire < entry->m_expire)) entry = &m_dnsCache[i];
+
+    }
+    if (entry == NULL) return 0;
+
+    strcpy(entry->m_address, address);
+    strcpy(entry->m_port, port);
+    entry->m_state = GLS_DNS_QUEUED;
+    entry->m_error = 0;
+    entry->m_expire = 0;
+
+    return entry;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Keep the result of a name and wake up the sockets
+ waiting for it, the result (an int) is written in their
+ pipe. An unknown name is kept GLS_DNS_NEGATIVE_TTL
+ seconds, the other errors (EAI_AGAIN...) are not kept,
+ the next connexion resolves the name again. The mutex
+ must be locked.
+
+ ---------------------------------------------------------*/
+
+void setDnsResult(GLSDnsEntry* entry, const int error, const GLSAddress* result) {
+
+    time_t actualTime = time(NULL);
+    int i = 0;
+
+    entry->m_state = GLS_DNS_DONE;
+    entry->m_error = error;
+
+    if (error == 0) {
+        memcpy(&entry->m_result, result, sizeof(GLSAddress));
+        entry->m_expire = actualTime + GLS_DNS_TTL;
+    }
+    else if (error == GLS_ERROR_AI_NONAME || error == GLS_ERROR_AI_NODATA || error == GLS_ERROR_AI_SERVICE || error == GLS_ERROR_AI_FAIL) entry->m_expire = actualTime + GLS_DNS_NEGATIVE_TTL;
+    else entry->m_state = GLS_DNS_FREE;
+
+    /* Non blocking pipes, written once with less than PIPE_BUF bytes */
+    for (i = 0; i < entry->m_nbWaiter; i++) {
+
+        if (write(entry->m_waiters[i], &error, sizeof(int)) < 0) continue;
+
+    }
+
+    if (entry->m_waiters != NULL) free(entry->m_waiters);
+    entry->m_waiters = 0;
+    entry->m_nbWaiter = 0;
+    entry->m_maxWaiter = 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Resolver thread, getaddrinfo() for the queued names.
+ Never stops, the threads are shared by the sockets.
+
+ ---------------------------------------------------------*/
+
+void* resolverLoop(void* arg) {
+
+    (void) arg;
+
+    char address[GLS_SIZE_DNS_NAME];
+    char port[GLS_SIZE_DNS_PORT];
+    int i = 0;
+
+    pthread_mutex_lock(&m_mutexDns);
+
+    while (1) {
+
+        GLSDnsEntry* entry = 0;
+        for (i = 0; i < GLS_SIZE_DNS_CACHE; i++) {
+
+            if (m_dnsCache[i].m_state == GLS_DNS_QUEUED) {
+                entry = &m_dnsCache[i];
+                break;
+            }
+
+        }
+
+        if (entry == NULL) {
+            pthread_cond_wait(&m_condDns, &m_mutexDns);
+            continue;
+        }
+
+        /* Not replaced nor cleared while resolving */
+        entry->m_state = GLS_DNS_RESOLVING;
+        strcpy(address, entry->m_address);
+        strcpy(port, entry->m_port);
+
+        pthread_mutex_unlock(&m_mutexDns);
+
+        GLSAddress result;
+        int error = getAddress(address, port, 0, &result);
+
+        pthread_mutex_lock(&m_mutexDns);
+
+        setDnsResult(entry, error, &result);
+
+    }
+
+    pthread_mutex_unlock(&m_mutexDns);
+
+    return 0;
+
+}
@@ -0,0 +1,637 @@
+/*
+ *  Roots.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+#include "GLSHeaders.h"
+
+
+
+
+/*-------------------------------------------------------
+
+ Create an empty list of root certificates, it can be
+ shared by many sockets with setRootList().
+
+ Return the list or NULL if no memory.
+
+ ---------------------------------------------------------*/
+
+GLSRoots* GLSRootList() {
+
+    GLSRoots* roots = malloc(sizeof(GLSRoots));
+    if (roots == NULL) return 0;
+
+    roots->m_roots = 0;
+    roots->m_nbRoot = 0;
+    roots->m_maxRoot = 0;
+    roots->m_nbRef = 1;
+    pthread_mutex_init(&roots->m_mutex, NULL);
+
+    return roots;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Release the list of root certificates, it's freed when
+ the last socket using it is freed.
+
+ ---------------------------------------------------------*/
+
+void freeGLSRootList(GLSRoots* roots) {
+
+    if (roots != NULL) releaseRootList(roots);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Add the root certificates of a PEM string (one or more
+ certificates) to a list. Each root is parsed and its
+ signature checked here, once.
+
+ Return the number of roots added or a negative number
+ for an error.
+
+ ---------------------------------------------------------*/
+
+int addToRootList(GLSRoots* roots, const char* cert) {
+
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### addToRootList() Start ###\n");
+    #endif
+
+    /* Argument check */
+    if (roots == NULL || cert == NULL) return GLS_ERROR_INVAL;
+
+    int nbRoot = 0;
+    int error = 0;
+    const char* begin = strstr(cert, "-----BEGIN CERTIFICATE-----");
+
+    while (begin != NULL && error == 0) {
+
+        const char* end = strstr(begin, "-----END CERTIFICATE-----");
+        if (end == NULL) {
+
+            error = GLS_ERROR_BADROOTCERT;
+            break;
+
+        }
+        end += strlen("-----END CERTIFICATE-----");
+
+        byte* der = 0;
+        int sizeDer = pemToAsn((const byte*) begin, (int) (end - begin), &der);
+        if (sizeDer < 0) error = sizeDer;
+        else {
+
+            GLSRootCert root;
+            error = parseRootCert(der, sizeDer, &root);
+            if (error == 0) {
+
+                pthread_mutex_lock(&roots->m_mutex);
+                error = addRootCert(roots, &root);
+                pthread_mutex_unlock(&roots->m_mutex);
+
+            }
+            if (error == 0) nbRoot++;
+
+        }
+
+        if (der != NULL) free(der);
+
+        begin = strstr(end, "-----BEGIN CERTIFICATE-----");
+
+    }
+
+    if (error == 0 && nbRoot == 0) error = GLS_ERROR_BADROOTCERT;
+
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Roots added : %d, error : %d\n", nbRoot, error);
+    printf("### addToRootList() End ###\n\n");
+    #endif
+
+    if (error != 0) return error;
+
+    return nbRoot;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Add the root certificates of a PEM file to a list.
+
+ Return the number of roots added or a negative number
+ for an error.
+
+ ---------------------------------------------------------*/
+
+int loadRootList(GLSRoots* roots, const char* fileName) {
+
+    /* Argument check */
+    if (roots == NULL || fileName == NULL) return GLS_ERROR_INVAL;
+
+    char* content = 0;
+    int error = charFromFile(fileName, &content);
+    if (error == 0) error = addToRootList(roots, content);
+
+    if (content != NULL) free(content);
+
+    return error;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Use a shared list of root certificates for the socket
+ instead of its own list.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int setRootList(GLSSock* myGLSSocket, GLSRoots* roots) {
+
+    /* Argument check */
+    if (myGLSSocket == NULL || roots == NULL) return GLS_ERROR_INVAL;
+
+    retainRootList(roots);
+    if (myGLSSocket->m_roots != NULL) releaseRootList(myGLSSocket->m_roots);
+    myGLSSocket->m_roots = roots;
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Parse a DER root certificate : public key, SHA-256 of
+ the subject name and of the certificate, subject key
+ identifier and validity. The self signature is checked,
+ the validity is only checked with a server certificate.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int parseRootCert(const byte* der, const int sizeDer, GLSRootCert* root) {
+
+    asn1_node certDef = getAsnDefinition(GLS_ASN_PKIX);
+    if (certDef == NULL) return GLS_ERROR_ASN1;
+
+    asn1_node rootDer = NULL;
+    char errorDescription[ASN1_MAX_ERROR_DESCRIPTION_SIZE];
+    int result = asn1_create_element(certDef, "PKIX1Implicit88.Certificate", &rootDer);
+    if (result == ASN1_SUCCESS) result = asn1_der_decoding(&rootDer, der, sizeDer, errorDescription);
+    if (result != ASN1_SUCCESS) {
+
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Bad root certificate : %s\n", errorDescription);
+        #endif
+
+        asn1_delete_structure(&rootDer);
+
+        return GLS_ERROR_BADROOTCERT;
+
+    }
+
+    memset(root, 0, sizeof(GLSRootCert));
+    gcry_md_hash_buffer(GCRY_MD_SHA256, root->m_fingerprint, der, sizeDer);
+
+    int error = hashCertName(rootDer, der, sizeDer, "tbsCertificate.subject", root->m_subject);
+    if (error == 0) error = readCertTime(rootDer, "tbsCertificate.validity.notBefore", &root->m_notBefore);
+    if (error == 0) error = readCertTime(rootDer, "tbsCertificate.validity.notAfter", &root->m_notAfter);
+
+    /* Public key of the root */
+    if (error == 0) {
+
+        int lenPubKeyDer = 2048;
+        byte pubKeyDer[2048];
+        if (asn1_read_value(rootDer, "tbsCertificate.subjectPublicKeyInfo.subjectPublicKey", pubKeyDer, &lenPubKeyDer) != ASN1_SUCCESS) error = GLS_ERROR_ASN1;
+        else error = getPublicRsaFromDer(pubKeyDer, lenPubKeyDer, &root->m_publicKey);
+
+    }
+
+    /* Signed by itself */
+    if (error == 0 && verifyCertSignature(rootDer, der, sizeDer, root->m_publicKey) != 0) error = GLS_ERROR_BADROOTCERT;
+
+    if (error == 0) root->m_keyIdSize = readKeyId(rootDer, GLS_OID_SUBJECT_KEY_ID, root->m_keyId);
+
+    asn1_delete_structure(&rootDer);
+
+    if (error != 0) {
+
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Root certificate refused : %d\n", error);
+        #endif
+
+        if (root->m_publicKey != NULL) gcry_sexp_release(root->m_publicKey);
+        root->m_publicKey = 0;
+
+        if (error == GLS_ERROR_ASN1) return GLS_ERROR_BADROOTCERT;
+
+        return error;
+
+    }
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Add a parsed root to a list (locked by the caller), the
+ list stays sorted by subject. A root already in the list
+ is ignored.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int addRootCert(GLSRoots* roots, GLSRootCert* root) {
+
+    int i = 0;
+    for (i = 0; i < roots->m_nbRoot; i++) {
+
+        if (memcmp(roots->m_roots[i].m_fingerprint, root->m_fingerprint, GLS_SIZE_FINGERPRINT) == 0) {
+
+            gcry_sexp_release(root->m_publicKey);
+            root->m_publicKey = 0;
+
+            return 0;
+
+        }
+
+    }
+
+    /* Double the list if full */
+    if (roots->m_nbRoot == roots->m_maxRoot) {
+
+        int maxRoot = roots->m_maxRoot == 0 ? 8 : roots->m_maxRoot * 2;
+        GLSRootCert* list = realloc(roots->m_roots, sizeof(GLSRootCert) * maxRoot);
+        if (list == NULL) {
+
+            gcry_sexp_release(root->m_publicKey);
+            root->m_publicKey = 0;
+
+            return GLS_ERROR_NOMEM;
+
+        }
+
+        roots->m_roots = list;
+        roots->m_maxRoot = maxRoot;
+
+    }
+
+    /* Insert at its place */
+    int index = roots->m_nbRoot;
+    while (index > 0 && memcmp(roots->m_roots[index - 1].m_subject, root->m_subject, GLS_SIZE_FINGERPRINT) > 0) index--;
+
+    memmove(&roots->m_roots[index + 1], &roots->m_roots[index], sizeof(GLSRootCert) * (roots->m_nbRoot - index));
+    memcpy(&roots->m_roots[index], root, sizeof(GLSRootCert));
+    roots->m_nbRoot++;
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Find the roots with a subject name (binary search), the
+ ones with another key identifier are skipped if both
+ are known. The public keys of the roots found belong to
+ the list, they are valid while it is retained.
+
+ Return the number of roots copied in found.
+
+ ---------------------------------------------------------*/
+
+int findRootCerts(GLSRoots* roots, const byte* subject, const byte* keyId, const int keyIdSize, GLSRootCert* found, const int maxFound) {
+
+    int nbFound = 0;
+
+    pthread_mutex_lock(&roots->m_mutex);
+
+    /* First root with this subject */
+    int low = 0;
+    int high = roots->m_nbRoot;
+    while (low < high) {
+
+        int middle = (low + high) / 2;
+        if (memcmp(roots->m_roots[middle].m_subject, subject, GLS_SIZE_FINGERPRINT) < 0) low = middle + 1;
+        else high = middle;
+
+    }
+
+    int i = 0;
+    for (i = low; i < roots->m_nbRoot && nbFound < maxFound; i++) {
+
+        GLSRootCert* root = &roots->m_roots[i];
+        if (memcmp(root->m_subject, subject, GLS_SIZE_FINGERPRINT) != 0) break;
+        if (keyIdSize > 0 && root->m_keyIdSize > 0 && (keyIdSize != root->m_keyIdSize || memcmp(root->m_keyId, keyId, keyIdSize) != 0)) continue;
+
+        memcpy(&found[nbFound], root, sizeof(GLSRootCert));
+        nbFound++;
+
+    }
+
+    pthread_mutex_unlock(&roots->m_mutex);
+
+    return nbFound;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Check that a root (SHA-256 of the certificate) is still
+ in a list, for a verdict of the cache.
+
+ Return 1 if the root is in the list, 0 otherwise.
+
+ ---------------------------------------------------------*/
+
+int hasRootCert(GLSRoots* roots, const byte* subject, const byte* fingerprint) {
+
+    GLSRootCert found[GLS_MAX_ROOT_MATCH];
+    int nbFound = findRootCerts(roots, subject, NULL, 0, found, GLS_MAX_ROOT_MATCH);
+
+    int i = 0;
+    for (i = 0; i < nbFound; i++) {
+
+        if (memcmp(found[i].m_fingerprint, fingerprint, GLS_SIZE_FINGERPRINT) == 0) return 1;
+
+    }
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ SHA-256 of a name of a certificate (subject or issuer)
+ as it is encoded in the DER.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int hashCertName(asn1_node cert, const byte* der, const int sizeDer, const char* name, byte* hash) {
+
+    int start = 0;
+    int end = 0;
+    if (asn1_der_decoding_startEnd(cert, der, sizeDer, name, &start, &end) != ASN1_SUCCESS) return GLS_ERROR_ASN1;
+
+    gcry_md_hash_buffer(GCRY_MD_SHA256, hash, der + start, end + 1 - start);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Read a validity date (UTC time) of a certificate.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int readCertTime(asn1_node cert, const char* name, long* time) {
+
+    char fullName[128];
+    byte date[1024];
+    int len = sizeof(date);
+    snprintf(fullName, sizeof(fullName), "%s.utcTime", name);
+    if (asn1_read_value(cert, fullName, date, &len) != ASN1_SUCCESS) return GLS_ERROR_ASN1;
+
+    /* aparently strptime doesn't fill all the structure
+     and mktime don't like it so we do a memset 0 */
+    struct tm tm;
+    memset(&tm, 0, sizeof(struct tm));
+    strptime((char*) date, "%y%m%d%H%M%SZ", &tm);
+    *time = mktime(&tm);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Read a key identifier extension of a certificate (subject
+ or authority key identifier).
+
+ Return the size of the identifier, 0 if not found.
+
+ ---------------------------------------------------------*/
+
+int readKeyId(asn1_node cert, const char* oid, byte* keyId) {
+
+    int nbExtension = 0;
+    if (asn1_number_of_elements(cert, "tbsCertificate.extensions", &nbExtension) != ASN1_SUCCESS) return 0;
+
+    int i = 0;
+    for (i = 1; i <= nbExtension; i++) {
+
+        char name[64];
+        char extnId[64];
+        int len = sizeof(extnId);
+        snprintf(name, sizeof(name), "tbsCertificate.extensions.?%d.extnID", i);
+        if (asn1_read_value(cert, name, extnId, &len) != ASN1_SUCCESS || strcmp(extnId, oid) != 0) continue;
+
+        byte value[256];
+        len = sizeof(value);
+        snprintf(name, sizeof(name), "tbsCertificate.extensions.?%d.extnValue", i);
+        if (asn1_read_value(cert, name, value, &len) != ASN1_SUCCESS) return 0;
+
+        /* OCTET STRING, or SEQUENCE with [0] keyIdentifier first */
+        int position = 0;
+        if (len >= 2 && value[0] == 0x30 && value[1] < 0x80) position = 2;
+        if (position + 2 > len || (value[position] != 0x04 && value[position] != 0x80)) return 0;
+
+        int size = value[position + 1];
+        if (size <= 0 || size > GLS_SIZE_KEY_ID || position + 2 + size > len) return 0;
+
+        memcpy(keyId, value + position + 2, size);
+
+        return size;
+
+    }
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Check the signature (SHA1 + RSA) of a certificate with
+ the public key of its issuer.
+
+ Return 0 if the signature is good, a negative number
+ otherwise.
+
+ ---------------------------------------------------------*/
+
+int verifyCertSignature(asn1_node cert, const byte* der, const int sizeDer, gcry_sexp_t publicKey) {
+
+    asn1_node certDef = getAsnDefinition(GLS_ASN_PKIX);
+    if (certDef == NULL) return GLS_ERROR_ASN1;
+
+    /* We check if the signing algorithme is sha1 with RSA */
+    char algo[128], algoSha1[128];
+    int len = sizeof(algo);
+    int result = asn1_read_value(cert, "signatureAlgorithm.algorithm", algo, &len);
+    len = sizeof(algoSha1);
+    int result2 = asn1_read_value(certDef, "PKIX1Implicit88.sha1WithRSAEncryption", algoSha1, &len);
+    if (result != ASN1_SUCCESS || result2 != ASN1_SUCCESS || strcmp(algo, algoSha1) != 0) return GLS_ERROR_BADSERVERCERT;
+
+    /* Hash of the signed part */
+    int start = 0;
+    int end = 0;
+    if (asn1_der_decoding_startEnd(cert, der, sizeDer, "tbsCertificate", &start, &end) != ASN1_SUCCESS) return GLS_ERROR_ASN1;
+
+    byte MAC[20];
+    gcry_md_hash_buffer(GCRY_MD_SHA1, MAC, der + start, end + 1 - start);
+
+    /* Size of the signature in bits */
+    byte signature[2048];
+    int lenSignature = sizeof(signature);
+    if (asn1_read_value(cert, "signature", signature, &lenSignature) != ASN1_SUCCESS) return GLS_ERROR_ASN1;
+
+    gcry_sexp_t gcrySignature = 0;
+    gcry_sexp_t gcryCert = 0;
+    int error = gcry_sexp_build(&gcrySignature, NULL, "(sig-val(rsa(s %b)))", (lenSignature / 8), signature);
+    if (error == 0) error = gcry_sexp_build(&gcryCert, NULL, "(data(flags pkcs1)(hash sha1 %b))", 20, MAC);
+
+    if (error == 0) error = gcry_pk_verify(gcrySignature, gcryCert, publicKey) == 0 ? 0 : GLS_ERROR_BADSERVERCERT;
+    else error = GLS_ERROR_CRYPTO;
+
+    gcry_sexp_release(gcrySignature);
+    gcry_sexp_release(gcryCert);
+
+    return error;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Add a reference to a list of root certificates (a new
+ socket).
+
+ ---------------------------------------------------------*/
+
+void retainRootList(GLSRoots* roots) {
+
+    pthread_mutex_lock(&roots->m_mutex);
+    roots->m_nbRef++;
+    pthread_mutex_unlock(&roots->m_mutex);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Remove a reference to a list of root certificates, the
+ last one frees it.
+
+ ---------------------------------------------------------*/
+
+void releaseRootList(GLSRoots* roots) {
+
+    pthread_mutex_lock(&roots->m_mutex);
+    roots->m_nbRef--;
+    int isLast = roots->m_nbRef == 0;
+    pthread_mutex_unlock(&roots->m_mutex);
+
+    if (isLast == 0) return;
+
+    int i = 0;
+    for (i = 0; i < roots->m_nbRoot; i++) gcry_sexp_release(roots->m_roots[i].m_publicKey);
+
+    if (roots->m_roots != NULL) free(roots->m_roots);
+    pthread_mutex_destroy(&roots->m_mutex);
+    free(roots);
+
+}
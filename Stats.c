@@ -0,0 +1,273 @@
+/*
+ *  Stats.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+#include "GLSHeaders.h"
+
+/* Secure memory used by the buffers of GLS */
+pthread_mutex_t m_mutexSecure = PTHREAD_MUTEX_INITIALIZER;
+GLSSecureMem m_secureMem = { 0, 0, 0, 0, 0 };
+
+
+
+
+/*-------------------------------------------------------
+
+ Get the statistics of a socket. The counters of each
+ direction are only written by the thread which holds its
+ mutex and are added here without lock.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int glsGetStats(GLSSock* myGLSSocket, GLSStats* stats) {
+
+    /* Argument check */
+    if (myGLSSocket == NULL || stats == NULL) return GLS_ERROR_INVAL;
+
+    memset(stats, 0, sizeof(GLSStats));
+    addStats(stats, &myGLSSocket->m_statsHandShake);
+    addStats(stats, &myGLSSocket->m_statsSend);
+    addStats(stats, &myGLSSocket->m_statsRecv);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Get the statistics of a server : the handshakes of
+ waitForClient() and all the clients of the event loop,
+ connected or closed.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int glsServerGetStats(GLSServerSock* myGLSServerSock, GLSStats* stats) {
+
+    /* Argument check */
+    if (myGLSServerSock == NULL || stats == NULL) return GLS_ERROR_INVAL;
+
+    pthread_mutex_lock(&myGLSServerSock->m_mutexConns);
+
+    /* Clients already gone */
+    memcpy(stats, &myGLSServerSock->m_stats, sizeof(GLSStats));
+
+    /* Clients of the event loop */
+    GLSEventConn* conn = myGLSServerSock->m_conns;
+    while (conn != NULL) {
+
+        addStats(stats, &conn->m_client->m_statsHandShake);
+        addStats(stats, &conn->m_client->m_statsSend);
+        addStats(stats, &conn->m_client->m_statsRecv);
+        conn = conn->m_next;
+
+    }
+
+    pthread_mutex_unlock(&myGLSServerSock->m_mutexConns);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Monotonic time in microseconds for the statistics.
+
+ ---------------------------------------------------------*/
+
+unsigned long long getTimeMicro(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long long) now.tv_sec * 1000000 + (unsigned long long) (now.tv_nsec / 1000);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Add the counters of stats to total, all the fields are
+ counters.
+
+ ---------------------------------------------------------*/
+
+void addStats(GLSStats* total, const GLSStats* stats) {
+
+    unsigned long long* totalField = (unsigned long long*) total;
+    const unsigned long long* field = (const unsigned long long*) stats;
+
+    int i = 0;
+    for (i = 0; i < (int) (sizeof(GLSStats) / sizeof(unsigned long long)); i++) {
+
+        totalField[i] += field[i];
+
+    }
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Add a time in microseconds to a histogram, bucket i
+ counts the times below 2^(i + 1) microseconds.
+
+ ---------------------------------------------------------*/
+
+void addHistogram(unsigned long long* histogram, const unsigned long long time) {
+
+    int bucket = 0;
+    unsigned long long limit = 2;
+    while (time >= limit && bucket < GLS_STATS_BUCKETS - 1) {
+
+        limit <<= 1;
+        bucket++;
+
+    }
+
+    histogram[bucket]++;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Get the secure memory used by the sockets.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int glsGetSecureMemory(GLSSecureMem* secureMem) {
+
+    /* Argument check */
+    if (secureMem == NULL) return GLS_ERROR_INVAL;
+
+    pthread_mutex_lock(&m_mutexSecure);
+    memcpy(secureMem, &m_secureMem, sizeof(GLSSecureMem));
+    pthread_mutex_unlock(&m_mutexSecure);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Size of the secure memory pool, set by glsGlobalInit().
+
+ ---------------------------------------------------------*/
+
+void setSecurePool(const int size) {
+
+    pthread_mutex_lock(&m_mutexSecure);
+    m_secureMem.m_poolSize = (size > 0) ? (unsigned long long) size : 0;
+    pthread_mutex_unlock(&m_mutexSecure);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Allocate a buffer in secure memory, counted for
+ glsGetSecureMemory(). Free it with freeSecure() and the
+ same size.
+
+ Return the buffer or NULL if the pool is full.
+
+ ---------------------------------------------------------*/
+
+byte* mallocSecure(const int size) {
+
+    byte* buffer = (byte*) gcry_malloc_secure(size);
+
+    pthread_mutex_lock(&m_mutexSecure);
+
+    if (buffer != NULL) {
+
+        m_secureMem.m_used += size;
+        m_secureMem.m_nbBuffer++;
+        if (m_secureMem.m_used > m_secureMem.m_highWater) m_secureMem.m_highWater = m_secureMem.m_used;
+
+    }
+    else m_secureMem.m_nbFailed++;
+
+    pthread_mutex_unlock(&m_mutexSecure);
+
+    return buffer;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Wipe and free a buffer of mallocSecure().
+
+ ---------------------------------------------------------*/
+
+void freeSecure(byte* buffer, const int size) {
+
+    if (buffer == NULL) return;
+
+    memset(buffer, 0, size);
+    gcry_free(buffer);
+
+    pthread_mutex_lock(&m_mutexSecure);
+    m_secureMem.m_used -= size;
+    m_secureMem.m_nbBuffer--;
+    pthread_mutex_unlock(&m_mutexSecure);
+
+}
@@ -0,0 +1,274 @@
+/*
+ *  Worker.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+#include "GLSHeaders.h"
+
+/* Worker pool shared by all the sockets */
+pthread_mutex_t m_mutexWorker = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t m_condWorker = PTHREAD_COND_INITIALIZER;
+pthread_cond_t m_condJobDone = PTHREAD_COND_INITIALIZER;
+GLSJob* m_jobs = 0;
+int m_nbWorker = 0;
+int m_nbWorkerWanted = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ Set the number of threads used to encrypt and decrypt
+ the big messages, the calling thread is one of them.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int glsSetCryptoThreads(const int nbThread) {
+
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("### glsSetCryptoThreads() Start ###\n");
+    #endif
+
+    /* Argument check */
+    if (nbThread < 1 || nbThread > GLS_MAX_THREAD) {
+
+        /* Debug Only */
+        #if defined (GLS_DEBUG_MODE_ENABLE)
+        printf("Bad number of threads : %d\n", nbThread);
+        printf("### glsSetCryptoThreads() End ###\n\n");
+        #endif
+
+        return GLS_ERROR_BADSIZE;
+
+    }
+
+    pthread_mutex_lock(&m_mutexWorker);
+
+    /* The calling thread works too */
+    m_nbWorkerWanted = nbThread - 1;
+
+    /* New threads */
+    while (m_nbWorker < m_nbWorkerWanted) {
+
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, workerLoop, NULL) != 0) {
+
+            m_nbWorkerWanted = m_nbWorker;
+            pthread_mutex_unlock(&m_mutexWorker);
+
+            /* Debug Only */
+            #if defined (GLS_DEBUG_MODE_ENABLE)
+            printf("Impossible to create a thread\n");
+            printf("### glsSetCryptoThreads() End ###\n\n");
+            #endif
+
+            return GLS_ERROR_NOMEM;
+
+        }
+        pthread_detach(thread);
+        m_nbWorker++;
+
+    }
+
+    /* The threads in excess stop themselves */
+    pthread_cond_broadcast(&m_condWorker);
+
+    pthread_mutex_unlock(&m_mutexWorker);
+
+    /* Debug Only */
+    #if defined (GLS_DEBUG_MODE_ENABLE)
+    printf("Crypto threads : %d\n", nbThread);
+    printf("### glsSetCryptoThreads() End ###\n\n");
+    #endif
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+ 
+ PRIVATE
+ 
+ Number of threads which can run the tasks of a job at
+ the same time, the calling thread included.
+ 
+ ---------------------------------------------------------*/
+
+int getCryptoThreads(void) {
+
+    pthread_mutex_lock(&m_mutexWorker);
+    int nbThread = m_nbWorker + 1;
+    pthread_mutex_unlock(&m_mutexWorker);
+
+    return nbThread;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Run task(arg, index) for index = 0 to nbTask - 1 on the
+ worker pool and the calling thread. Return when all the
+ tasks are finished.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int runParallel(void (*task)(void* arg, const int index), void* arg, const int nbTask) {
+
+    if (nbTask <= 0) return 0;
+
+    pthread_mutex_lock(&m_mutexWorker);
+
+    /* Without thread or with only one task it's done here */
+    if (m_nbWorker == 0 || nbTask == 1) {
+
+        pthread_mutex_unlock(&m_mutexWorker);
+
+        int i = 0;
+        for (i = 0; i < nbTask; i++) {
+
+            task(arg, i);
+
+        }
+
+        return 0;
+
+    }
+
+    /* Job at the end of the queue */
+    GLSJob job;
+    job.m_task = task;
+    job.m_arg = arg;
+    job.m_nbTask = nbTask;
+    job.m_nextTask = 0;
+    job.m_nbDone = 0;
+    job.m_next = 0;
+
+    GLSJob* (*last) = &m_jobs;
+    while (*last != NULL) last = &(*last)->m_next;
+    *last = &job;
+
+    pthread_cond_broadcast(&m_condWorker);
+
+    /* The calling thread takes tasks like the others */
+    while (job.m_nextTask < job.m_nbTask) {
+
+        int index = job.m_nextTask;
+        job.m_nextTask++;
+
+        /* Last task given, the job leaves the queue */
+        if (job.m_nextTask == job.m_nbTask) {
+
+            GLSJob* (*current) = &m_jobs;
+            while (*current != &job) current = &(*current)->m_next;
+            *current = job.m_next;
+
+        }
+
+        pthread_mutex_unlock(&m_mutexWorker);
+        task(arg, index);
+        pthread_mutex_lock(&m_mutexWorker);
+
+        job.m_nbDone++;
+
+    }
+
+    /* Waiting for the tasks running on the other threads */
+    while (job.m_nbDone < job.m_nbTask) {
+
+        pthread_cond_wait(&m_condJobDone, &m_mutexWorker);
+
+    }
+
+    pthread_mutex_unlock(&m_mutexWorker);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ PRIVATE
+
+ Thread of the worker pool, takes the tasks of the first
+ job in the queue.
+
+ ---------------------------------------------------------*/
+
+void* workerLoop(void* arg) {
+
+    (void) arg;
+
+    pthread_mutex_lock(&m_mutexWorker);
+
+    while (1) {
+
+        /* Too many threads after glsSetCryptoThreads() */
+        if (m_nbWorker > m_nbWorkerWanted) {
+
+            m_nbWorker--;
+            pthread_mutex_unlock(&m_mutexWorker);
+
+            return NULL;
+
+        }
+
+        /* Nothing to do */
+        if (m_jobs == NULL) {
+
+            pthread_cond_wait(&m_condWorker, &m_mutexWorker);
+            continue;
+
+        }
+
+        /* Next task of the first job */
+        GLSJob* job = m_jobs;
+        int index = job->m_nextTask;
+        job->m_nextTask++;
+        if (job->m_nextTask == job->m_nbTask) m_jobs = job->m_next;
+
+        pthread_mutex_unlock(&m_mutexWorker);
+        job->m_task(job->m_arg, index);
+        pthread_mutex_lock(&m_mutexWorker);
+
+        /* The job can be freed by its thread after that */
+        job->m_nbDone++;
+        if (job->m_nbDone == job->m_nbTask) pthread_cond_broadcast(&m_condJobDone);
+
+    }
+
+}
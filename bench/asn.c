@@ -0,0 +1,104 @@
+/*
+ *  asn.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * checkCertificate() calls per second with the ASN.1 grammars built once
+ * for the process, and with the PKIX grammar built and deleted for each
+ * call like before. The cache of the verdicts is emptied before each
+ * call so the certificate is parsed every time.
+ */
+
+#include "bench.h"
+
+extern const asn1_static_node m_asnPKIX[];
+
+
+
+
+/*-------------------------------------------------------
+
+ Calls during BENCH_DURATION seconds.
+
+ ---------------------------------------------------------*/
+
+static int measure(GLSSock* socket, const char* cert, const int isRebuild, const int isCached) {
+
+    long long nbCall = 0;
+    int error = 0;
+    double timeStart = benchNow();
+
+    while (error == 0 && benchNow() - timeStart < BENCH_DURATION) {
+
+        if (isRebuild) {
+
+            asn1_node definitions = NULL;
+            if (asn1_array2tree(m_asnPKIX, &definitions, NULL) != ASN1_SUCCESS) error = GLS_ERROR_UNKNOWN;
+            asn1_delete_structure(&definitions);
+
+        }
+
+        if (!isCached) glsClearCertificateCache();
+        if (error == 0) error = checkCertificate(socket, (const byte*) cert, strlen(cert));
+        nbCall++;
+
+    }
+
+    double duration = benchNow() - timeStart;
+    printf("  %-34s : %8.0f calls/s%s\n", isCached ? "verdict cached" : isRebuild ? "grammar built for each call" : "grammar built once", nbCall / duration, (error != 0) ? " FAILED" : "");
+
+    return (error != 0);
+
+}
+
+
+
+
+int benchAsn(void) {
+
+    char* cert = 0;
+    if (charFromFile("pki/server.crt", &cert) != 0) {
+
+        printf("  pki/server.crt missing, run make\n");
+
+        return 1;
+
+    }
+
+    GLSSock* socket = GLSSocket();
+    int nbError = (addRootCertificateFromFile(socket, "pki/ca.crt") != 0);
+
+    if (nbError == 0) {
+
+        nbError += measure(socket, cert, 1, 0);
+        nbError += measure(socket, cert, 0, 0);
+        nbError += measure(socket, cert, 0, 1);
+
+    }
+
+    freeGLSSocket(socket);
+    free(cert);
+
+    return nbError;
+
+}
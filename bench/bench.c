@@ -0,0 +1,389 @@
+/*
+ *  bench.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Runs the workloads given as arguments, all of them without argument.
+ *
+ *   ./bench [-p port] [workload ...]
+ */
+
+#include <sys/time.h>
+#include "bench.h"
+
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nb, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+typedef struct {
+
+    const char* m_name;
+    const char* m_description;
+    int (*m_run)(void);
+
+} BenchWorkload;
+
+static const BenchWorkload m_workloads[] = {
+
+    {"pipeline", "messages/s by round trip time and send window", benchPipeline},
+    {"inplace", "allEncrypt() / allDecrypt() copying and in place", benchInPlace},
+    {"recv", "reception of the messages of several packets", benchRecv},
+    {"suites", "throughput of the cipher suites", benchSuites},
+    {"threads", "counter mode cascade with 1 to N crypto threads", benchThreads},
+    {"ivpool", "encryption of 64 bytes messages with and without IV pool", benchIVPool},
+    {"asn", "checkCertificate() with the ASN.1 grammars built once", benchAsn},
+    {"register", "registrations by message size and simultaneous ones", benchRegister},
+    {"slowloris", "connexion rate of waitForClient() with slow clients", benchSlowloris},
+    {"cycles", "connexion, handshake and close cycles", benchCycles},
+    {"crl", "loading and search of revocation lists", benchCrl},
+    {"connect", "sessions established by one thread", benchConnect},
+    {"load", "10000 clients of glsServerRun() connected at once", benchLoad},
+
+};
+
+#define NB_WORKLOAD (int) (sizeof(m_workloads) / sizeof(m_workloads[0]))
+
+static unsigned long long m_nbAllocation = 0;
+/* Above the ephemeral ports of Linux (32768-60999), used by the clients */
+static int m_port = 61000;
+
+
+
+
+/*-------------------------------------------------------
+
+ Allocations counted for the whole process, libgcrypt
+ included.
+
+ ---------------------------------------------------------*/
+
+void* malloc(size_t size) {
+
+    __sync_fetch_and_add(&m_nbAllocation, 1);
+
+    return __libc_malloc(size);
+
+}
+
+void* calloc(size_t nb, size_t size) {
+
+    __sync_fetch_and_add(&m_nbAllocation, 1);
+
+    return __libc_calloc(nb, size);
+
+}
+
+void* realloc(void* ptr, size_t size) {
+
+    __sync_fetch_and_add(&m_nbAllocation, 1);
+
+    return __libc_realloc(ptr, size);
+
+}
+
+unsigned long long benchAllocations(void) {
+
+    return __sync_fetch_and_add(&m_nbAllocation, 0);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Time in seconds.
+
+ ---------------------------------------------------------*/
+
+double benchNow(void) {
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    return now.tv_sec + now.tv_usec / 1000000.0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Server on a new port, a closed connexion keeps its port
+ a while (TIME_WAIT). The ports in use are skipped.
+
+ ---------------------------------------------------------*/
+
+GLSServerSock* benchListen(const int waitQueue, char* port) {
+
+    int error = GLS_ERROR_ADDRINUSE;
+    int i = 0;
+
+    for (i = 0; error == GLS_ERROR_ADDRINUSE && i < 100; i++) {
+
+        snprintf(port, 8, "%d", m_port++);
+
+        GLSServerSock* server = GLSServer();
+        error = initServer(server, port, waitQueue, 1);
+        if (error == 0) return server;
+
+        freeGLSServer(server);
+
+    }
+
+    printf("  initServer() error %d\n", error);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Two sockets with the same key and IVs, without
+ connexion.
+
+ ---------------------------------------------------------*/
+
+int benchKeyPair(GLSSock** sender, GLSSock** receiver) {
+
+    *sender = GLSSocket();
+    *receiver = GLSSocket();
+    if (*sender == NULL || *receiver == NULL) return GLS_ERROR_NOMEM;
+
+    addKey(*sender, "myPassword", 0);
+    addKey(*receiver, "myPassword", 0);
+    if (initHandler(*sender) != 0 || initHandler(*receiver) != 0) return GLS_ERROR_CRYPTO;
+
+    gcry_create_nonce((*sender)->m_iv3, 16);
+    gcry_create_nonce((*sender)->m_iv4, 16);
+    memcpy((*receiver)->m_iv3, (*sender)->m_iv3, 16);
+    memcpy((*receiver)->m_iv4, (*sender)->m_iv4, 16);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Sink thread, one client.
+
+ ---------------------------------------------------------*/
+
+static void* sinkLoop(void* arg) {
+
+    BenchSink* sink = arg;
+    GLSSock* client = 0;
+
+    if (waitForClient(sink->m_server, &client) != 0) return NULL;
+
+    addKey(client, "myPassword", 0);
+    glsSetCipherSuite(client, sink->m_suite);
+    if (finishHandShake(client) == 0) {
+
+        while (1) {
+
+            byte (*message) = 0;
+            int size = glsRecv(client, &message);
+            if (size < 0) break;
+
+            int error = (size == 1) ? glsSend(client, message, 1) : 0;
+            free(message);
+            if (error != 0) break;
+
+        }
+
+    }
+
+    freeGLSSocket(client);
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Start a sink with a cipher suite.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int benchStartSink(BenchSink* sink, const int suite) {
+
+    sink->m_suite = suite;
+
+    /* Listening before the client connects */
+    sink->m_server = benchListen(1, sink->m_port);
+    if (sink->m_server == NULL) return GLS_ERROR_ADDRINUSE;
+
+    pthread_create(&sink->m_thread, NULL, sinkLoop, sink);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Client of a sink, NULL for an error.
+
+ ---------------------------------------------------------*/
+
+GLSSock* benchConnectSink(BenchSink* sink) {
+
+    GLSSock* client = GLSSocket();
+    setUserId(client, "myUserId");
+    addKey(client, "myPassword", 0);
+    glsSetCipherSuite(client, sink->m_suite);
+
+    int error = connexion(client, "127.0.0.1", sink->m_port);
+    if (error != 0) {
+
+        printf("  connexion() error %d\n", error);
+        freeGLSSocket(client);
+
+        return 0;
+
+    }
+
+    return client;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Wait for the sink to receive all the messages sent.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+int benchSyncSink(GLSSock* client) {
+
+    byte sync = 0;
+    int error = glsSend(client, &sync, 1);
+    if (error != 0) return error;
+
+    byte (*answer) = 0;
+    int size = glsRecv(client, &answer);
+    if (size < 0) return size;
+    free(answer);
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Stop a sink and free its client (may be NULL).
+
+ ---------------------------------------------------------*/
+
+void benchStopSink(BenchSink* sink, GLSSock* client) {
+
+    /* The end of the connexion stops the loop */
+    if (client != NULL) freeGLSSocket(client);
+    else shutdown(sink->m_server->m_sock, SHUT_RDWR);
+
+    pthread_join(sink->m_thread, NULL);
+    freeGLSServer(sink->m_server);
+
+}
+
+
+
+
+int main(int argc, const char* argv[]) {
+
+    int nbError = 0;
+    int isRun = 0;
+    int i = 0;
+    int j = 0;
+
+    /* libgcrypt initialised with enough secure memory for all the workloads */
+    if (glsGlobalInit(1, 16000000) != 0) {
+
+        printf("bench : libgcrypt init error\n");
+
+        return 1;
+
+    }
+
+    for (i = 1; i < argc; i++) {
+
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            m_port = atoi(argv[++i]);
+            continue;
+        }
+
+        for (j = 0; j < NB_WORKLOAD; j++) {
+
+            if (strcmp(argv[i], m_workloads[j].m_name) != 0) continue;
+
+            printf("== %s : %s\n", m_workloads[j].m_name, m_workloads[j].m_description);
+            nbError += m_workloads[j].m_run();
+            isRun = 1;
+            break;
+
+        }
+        if (j == NB_WORKLOAD) {
+
+            printf("bench : unknown workload %s, available :", argv[i]);
+            for (j = 0; j < NB_WORKLOAD; j++) printf(" %s", m_workloads[j].m_name);
+            printf("\n");
+
+            return 1;
+
+        }
+
+    }
+
+    /* All of them */
+    for (j = 0; !isRun && j < NB_WORKLOAD; j++) {
+
+        printf("== %s : %s\n", m_workloads[j].m_name, m_workloads[j].m_description);
+        nbError += m_workloads[j].m_run();
+
+    }
+
+    return (nbError != 0);
+
+}
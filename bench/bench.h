@@ -0,0 +1,84 @@
+/*
+ *  bench.h
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Benchmarks of GLS, one workload per optimisation. Each workload prints
+ * its own results and returns 0, or 1 if something went wrong.
+ */
+
+#ifndef GLS_BENCH_H
+#define GLS_BENCH_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "GLSHeaders.h"
+
+/* Seconds spent on each measure */
+#define BENCH_DURATION 0.5
+
+/* Time in seconds */
+double benchNow(void);
+
+/* Number of malloc(), calloc() and realloc() since the start */
+unsigned long long benchAllocations(void);
+
+/* Server listening on loopback on a new port (at least 8 chars), NULL for an error */
+GLSServerSock* benchListen(const int waitQueue, char* port);
+
+/* Two sockets sharing a key, the messages encrypted by the first one are decrypted by the second one */
+int benchKeyPair(GLSSock** sender, GLSSock** receiver);
+
+/* Server on loopback receiving the messages of one client, answers the messages of 1 byte */
+typedef struct {
+
+    GLSServerSock* m_server;
+    pthread_t m_thread;
+    int m_suite;
+    char m_port[8];
+
+} BenchSink;
+
+int benchStartSink(BenchSink* sink, const int suite);
+GLSSock* benchConnectSink(BenchSink* sink);
+int benchSyncSink(GLSSock* client);
+void benchStopSink(BenchSink* sink, GLSSock* client);
+
+/* Workloads */
+int benchPipeline(void);
+int benchInPlace(void);
+int benchRecv(void);
+int benchSuites(void);
+int benchThreads(void);
+int benchIVPool(void);
+int benchAsn(void);
+int benchRegister(void);
+int benchSlowloris(void);
+int benchCycles(void);
+int benchCrl(void);
+int benchConnect(void);
+int benchLoad(void);
+
+#endif
@@ -0,0 +1,232 @@
+/*
+ *  connect.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Sessions established per second by one thread against a glsServerRun()
+ * server : connexion() one after the other, and glsConnectStart() /
+ * glsConnectPoll() with up to NB_IN_FLIGHT handshakes at the same time
+ * waiting with poll().
+ */
+
+#include <poll.h>
+#include "bench.h"
+
+#define NB_SESSION 1000
+#define NB_IN_FLIGHT 64
+
+static GLSServerSock* m_server = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ glsServerRun() server thread and its callback.
+
+ ---------------------------------------------------------*/
+
+static int onHandShake(GLSSock* client, void* userData) {
+
+    (void) userData;
+
+    return addKey(client, "myPassword", 0);
+
+}
+
+static void* sessionServer(void* arg) {
+
+    (void) arg;
+
+    GLSServerCallback callbacks = {onHandShake, NULL, NULL, NULL};
+    glsServerRun(m_server, &callbacks, NULL, 1);
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ New client socket.
+
+ ---------------------------------------------------------*/
+
+static GLSSock* newClient(void) {
+
+    GLSSock* client = GLSSocketSecure(0, 0);
+    setUserId(client, "myUserId");
+    addKey(client, "myPassword", 0);
+
+    return client;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Blocking connexions, return the number of failures.
+
+ ---------------------------------------------------------*/
+
+static int connectBlocking(GLSSock** clients, const char* port) {
+
+    int nbError = 0;
+    int i = 0;
+
+    for (i = 0; i < NB_SESSION; i++) {
+
+        clients[i] = newClient();
+        if (connexion(clients[i], "127.0.0.1", port) != 0) nbError++;
+
+    }
+
+    return nbError;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Non blocking connexions, return the number of failures.
+
+ ---------------------------------------------------------*/
+
+static int connectAsync(GLSSock** clients, const char* port) {
+
+    int states[NB_SESSION];
+    struct pollfd events[NB_IN_FLIGHT];
+    int indexes[NB_IN_FLIGHT];
+    int nbStarted = 0;
+    int nbDone = 0;
+    int nbError = 0;
+    int i = 0;
+
+    while (nbDone < NB_SESSION) {
+
+        /* Handshakes in progress, then new ones up to NB_IN_FLIGHT */
+        int nbEvent = 0;
+        for (i = 0; i < nbStarted; i++) {
+
+            if (states[i] <= 0) continue;
+
+            events[nbEvent].fd = glsGetSocket(clients[i]);
+            events[nbEvent].events = (states[i] == GLS_WAIT_WRITE) ? POLLOUT : POLLIN;
+            indexes[nbEvent++] = i;
+
+        }
+        while (nbEvent < NB_IN_FLIGHT && nbStarted < NB_SESSION) {
+
+            i = nbStarted++;
+            clients[i] = newClient();
+            states[i] = glsConnectStart(clients[i], "127.0.0.1", port);
+            if (states[i] <= 0) {
+                nbDone++;
+                if (states[i] < 0) nbError++;
+                continue;
+            }
+
+            events[nbEvent].fd = glsGetSocket(clients[i]);
+            events[nbEvent].events = (states[i] == GLS_WAIT_WRITE) ? POLLOUT : POLLIN;
+            indexes[nbEvent++] = i;
+
+        }
+        if (nbEvent == 0) continue;
+
+        poll(events, nbEvent, 1000);
+
+        for (i = 0; i < nbEvent; i++) {
+
+            if (events[i].revents == 0) continue;
+
+            int index = indexes[i];
+            states[index] = glsConnectPoll(clients[index]);
+            if (states[index] <= 0) {
+                nbDone++;
+                if (states[index] < 0) nbError++;
+            }
+
+        }
+
+    }
+
+    return nbError;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ NB_SESSION sessions opened, then closed.
+
+ ---------------------------------------------------------*/
+
+static int measure(const int isAsync) {
+
+    char port[8];
+    m_server = benchListen(1024, port);
+    if (m_server == NULL) return 1;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, sessionServer, NULL);
+
+    GLSSock* clients[NB_SESSION];
+    double timeStart = benchNow();
+    int nbError = isAsync ? connectAsync(clients, port) : connectBlocking(clients, port);
+    double duration = benchNow() - timeStart;
+
+    int i = 0;
+    for (i = 0; i < NB_SESSION; i++) freeGLSSocket(clients[i]);
+
+    glsServerStop(m_server);
+    pthread_join(thread, NULL);
+    freeGLSServer(m_server);
+
+    char name[64];
+    if (isAsync) snprintf(name, sizeof(name), "glsConnectStart(), %d in flight", NB_IN_FLIGHT);
+    else snprintf(name, sizeof(name), "connexion()");
+    printf("  %-32s : %6.0f sessions/s, %d failed\n", name, NB_SESSION / duration, nbError);
+
+    return (nbError != 0);
+
+}
+
+
+
+
+int benchConnect(void) {
+
+    int nbError = measure(0);
+    nbError += measure(1);
+
+    return nbError;
+
+}
@@ -0,0 +1,143 @@
+/*
+ *  crl.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Revocation lists of random 20 bytes serials loaded from a text file by
+ * loadCrlList(), the first search sorts the list, then NB_LOOKUP
+ * searches (half of them in the list) like checkCertificate() does.
+ */
+
+#include "bench.h"
+
+#define SIZE_SERIAL 20
+#define NB_LOOKUP 1000000
+
+static const int m_sizes[] = {1000, 100000, 1000000};
+static unsigned long long m_random = 88172645463325252ULL;
+
+#define NB_SIZE (int) (sizeof(m_sizes) / sizeof(m_sizes[0]))
+
+
+
+
+/*-------------------------------------------------------
+
+ Random numbers (xorshift), the same at each run.
+
+ ---------------------------------------------------------*/
+
+static unsigned long long nextRandom(void) {
+
+    m_random ^= m_random << 13;
+    m_random ^= m_random >> 7;
+    m_random ^= m_random << 17;
+
+    return m_random;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ One list of nbSerial serials.
+
+ ---------------------------------------------------------*/
+
+static int measure(const int nbSerial) {
+
+    char fileName[] = "/tmp/glsBenchCrlXXXXXX";
+    int fd = mkstemp(fileName);
+    FILE* file = (fd >= 0) ? fdopen(fd, "w") : NULL;
+    byte (*serials)[SIZE_SERIAL] = malloc((size_t) nbSerial * SIZE_SERIAL);
+    if (file == NULL || serials == NULL) return 1;
+
+    int i = 0;
+    int j = 0;
+
+    for (i = 0; i < nbSerial; i++) {
+
+        for (j = 0; j < SIZE_SERIAL; j++) serials[i][j] = (byte) nextRandom();
+        serials[i][0] = (serials[i][0] & 0x7f) | 0x01;
+        for (j = 0; j < SIZE_SERIAL; j++) fprintf(file, "%02X", serials[i][j]);
+        fprintf(file, "\n");
+
+    }
+    fclose(file);
+
+    GLSCrl* crl = GLSCrlList();
+    double timeStart = benchNow();
+    int nbLoad = loadCrlList(crl, fileName);
+    double timeLoad = benchNow() - timeStart;
+    unlink(fileName);
+
+    /* Sorted by the first search */
+    byte entry[GLS_SIZE_CRL_ENTRY];
+    timeStart = benchNow();
+    serialToCrlEntry(serials[0], SIZE_SERIAL, entry);
+    int isFound = isEntryInCrl(crl, entry);
+    double timeSort = benchNow() - timeStart;
+
+    byte serial[SIZE_SERIAL];
+    int nbFound = 0;
+    timeStart = benchNow();
+
+    for (i = 0; i < NB_LOOKUP; i++) {
+
+        if (i % 2 == 0) memcpy(serial, serials[nextRandom() % nbSerial], SIZE_SERIAL);
+        else {
+            for (j = 0; j < SIZE_SERIAL; j++) serial[j] = (byte) nextRandom();
+            serial[0] |= 0x01;
+        }
+        serialToCrlEntry(serial, SIZE_SERIAL, entry);
+        nbFound += isEntryInCrl(crl, entry);
+
+    }
+
+    double timeLookup = benchNow() - timeStart;
+    int isOk = (nbLoad == nbSerial && isFound == 1 && nbFound >= NB_LOOKUP / 2);
+
+    printf("  %8d serials : load %8.1f ms, sort %7.1f ms, %5.0f ns/lookup%s\n", nbSerial, timeLoad * 1000, timeSort * 1000, timeLookup / NB_LOOKUP * 1000000000, isOk ? "" : " FAILED");
+
+    freeGLSCrlList(crl);
+    free(serials);
+
+    return !isOk;
+
+}
+
+
+
+
+int benchCrl(void) {
+
+    int nbError = 0;
+    int i = 0;
+
+    for (i = 0; i < NB_SIZE; i++) nbError += measure(m_sizes[i]);
+
+    return nbError;
+
+}
@@ -0,0 +1,179 @@
+/*
+ *  cycles.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Cycles of connexion, handshake, one echo of 64 bytes and close per
+ * second. The waitForClient() server frees its clients with
+ * freeGLSSocket() or keeps them with glsServerReleaseClient() for the
+ * next ones, the glsServerRun() server always keeps them.
+ */
+
+#include "bench.h"
+
+#define NB_CYCLE 500
+#define SIZE_MESSAGE 64
+
+static GLSServerSock* m_server = 0;
+static int m_isRelease = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ waitForClient() server thread.
+
+ ---------------------------------------------------------*/
+
+static void* cycleServer(void* arg) {
+
+    (void) arg;
+
+    int i = 0;
+
+    for (i = 0; i < NB_CYCLE; i++) {
+
+        GLSSock* client = 0;
+        if (waitForClient(m_server, &client) != 0) continue;
+
+        addKey(client, "myPassword", 0);
+        if (finishHandShake(client) == 0) {
+
+            byte (*message) = 0;
+            int size = glsRecv(client, &message);
+            if (size > 0) glsSend(client, message, size);
+            free(message);
+
+        }
+
+        if (m_isRelease) glsServerReleaseClient(m_server, client);
+        else freeGLSSocket(client);
+
+    }
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ glsServerRun() server thread and its callbacks.
+
+ ---------------------------------------------------------*/
+
+static int onHandShake(GLSSock* client, void* userData) {
+
+    (void) userData;
+
+    return addKey(client, "myPassword", 0);
+
+}
+
+static void onMessage(GLSSock* client, byte* message, const int size, void* userData) {
+
+    (void) userData;
+
+    glsSend(client, message, size);
+
+}
+
+static void* eventServer(void* arg) {
+
+    (void) arg;
+
+    GLSServerCallback callbacks = {onHandShake, NULL, onMessage, NULL};
+    glsServerRun(m_server, &callbacks, NULL, 1);
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ NB_CYCLE cycles with one kind of server.
+
+ ---------------------------------------------------------*/
+
+static int measure(const char* name, void* (*server)(void* arg), const int isRelease) {
+
+    m_isRelease = isRelease;
+    char port[8];
+    m_server = benchListen(128, port);
+    if (m_server == NULL) return 1;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, server, NULL);
+
+    byte message[SIZE_MESSAGE];
+    memset(message, 'a', SIZE_MESSAGE);
+    int nbError = 0;
+    int i = 0;
+    double timeStart = benchNow();
+
+    for (i = 0; i < NB_CYCLE; i++) {
+
+        GLSSock* client = GLSSocketSecure(0, 0);
+        setUserId(client, "myUserId");
+        addKey(client, "myPassword", 0);
+
+        byte (*answer) = 0;
+        int error = connexion(client, "127.0.0.1", port);
+        if (error == 0) error = glsSend(client, message, SIZE_MESSAGE);
+        if (error == 0) error = glsRecv(client, &answer);
+        if (error != SIZE_MESSAGE) nbError++;
+        free(answer);
+        freeGLSSocket(client);
+
+    }
+
+    double duration = benchNow() - timeStart;
+
+    if (server == eventServer) glsServerStop(m_server);
+    pthread_join(thread, NULL);
+    freeGLSServer(m_server);
+
+    printf("  %-42s : %6.0f cycles/s, %d failed\n", name, NB_CYCLE / duration, nbError);
+
+    return (nbError != 0);
+
+}
+
+
+
+
+int benchCycles(void) {
+
+    int nbError = measure("waitForClient() + freeGLSSocket()", cycleServer, 0);
+    nbError += measure("waitForClient() + glsServerReleaseClient()", cycleServer, 1);
+    nbError += measure("glsServerRun()", eventServer, 0);
+
+    return nbError;
+
+}
@@ -0,0 +1,125 @@
+/*
+ *  inplace.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Encryption and decryption of one message by allEncrypt() and
+ * allDecrypt(), which copy it in a new buffer, and by allEncryptInPlace()
+ * and allDecryptInPlace(), which use the buffer of the caller. Each
+ * message is encrypted then decrypted.
+ */
+
+#include "bench.h"
+
+static const int m_sizes[] = {64, 4096, 1048576};
+
+#define NB_SIZE (int) (sizeof(m_sizes) / sizeof(m_sizes[0]))
+
+
+
+
+/*-------------------------------------------------------
+
+ One size, copying (isInPlace 0) or in place.
+
+ ---------------------------------------------------------*/
+
+static int measure(GLSSock* sender, GLSSock* receiver, const int size, const int isInPlace) {
+
+    byte* message = malloc(size);
+    byte* buffer = malloc(GLS_SIZE_HEADROOM + size);
+    if (message == NULL || buffer == NULL) return 1;
+
+    int i = 0;
+    for (i = 0; i < size; i++) message[i] = (byte) (i * 13);
+
+    int isOk = 1;
+    long long nbMessage = 0;
+    unsigned long long nbAllocation = benchAllocations();
+    double timeStart = benchNow();
+
+    while (benchNow() - timeStart < BENCH_DURATION) {
+
+        int sizePlainText = 0;
+
+        if (isInPlace) {
+
+            memcpy(buffer + GLS_SIZE_HEADROOM, message, size);
+            int sizeCipherText = allEncryptInPlace(sender, buffer, size);
+            sizePlainText = allDecryptInPlace(receiver, buffer, sizeCipherText);
+            if (nbMessage == 0 && memcmp(buffer + GLS_SIZE_HEADROOM, message, size) != 0) isOk = 0;
+
+        }
+        else {
+
+            byte (*cipherText) = 0;
+            byte (*plainText) = 0;
+            int sizeCipherText = allEncrypt(sender, message, size, &cipherText);
+            sizePlainText = allDecrypt(receiver, cipherText, sizeCipherText, &plainText);
+            if (nbMessage == 0 && sizePlainText == size && memcmp(plainText, message, size) != 0) isOk = 0;
+            free(cipherText);
+            free(plainText);
+
+        }
+
+        if (sizePlainText != size) isOk = 0;
+        if (!isOk) break;
+        nbMessage++;
+
+    }
+
+    double duration = benchNow() - timeStart;
+    nbAllocation = benchAllocations() - nbAllocation;
+
+    printf("  %-9s %8d bytes : %9.1f MB/s %10.0f messages/s %6.2f allocations/message%s\n", isInPlace ? "in place" : "copying", size, nbMessage * (double) size / duration / 1000000, nbMessage / duration, nbMessage > 0 ? (double) nbAllocation / nbMessage : 0.0, isOk ? "" : " FAILED");
+
+    free(message);
+    free(buffer);
+
+    return !isOk;
+
+}
+
+
+
+
+int benchInPlace(void) {
+
+    GLSSock* sender = 0;
+    GLSSock* receiver = 0;
+    int nbError = benchKeyPair(&sender, &receiver) != 0;
+    int i = 0;
+
+    for (i = 0; nbError == 0 && i < NB_SIZE; i++) {
+
+        nbError += measure(sender, receiver, m_sizes[i], 0);
+        nbError += measure(sender, receiver, m_sizes[i], 1);
+
+    }
+
+    freeGLSSocket(sender);
+    freeGLSSocket(receiver);
+
+    return nbError;
+
+}
@@ -0,0 +1,85 @@
+/*
+ *  ivpool.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Encryption rate of 64 bytes messages, one call to the random generator
+ * per IV (pool of 0 bytes) and IVs taken from pools of several sizes.
+ */
+
+#include "bench.h"
+
+#define SIZE_MESSAGE 64
+
+static const int m_poolSizes[] = {0, 1024, GLS_SIZE_IV_POOL, GLS_MAX_IV_POOL};
+
+#define NB_POOL_SIZE (int) (sizeof(m_poolSizes) / sizeof(m_poolSizes[0]))
+
+
+
+
+int benchIVPool(void) {
+
+    GLSSock* sender = 0;
+    GLSSock* receiver = 0;
+    int nbError = benchKeyPair(&sender, &receiver) != 0;
+
+    byte buffer[GLS_SIZE_HEADROOM + SIZE_MESSAGE];
+    int i = 0;
+
+    for (i = 0; nbError == 0 && i < NB_POOL_SIZE; i++) {
+
+        if (glsSetIVPoolSize(sender, m_poolSizes[i]) != 0) {
+
+            nbError++;
+            break;
+
+        }
+
+        long long nbMessage = 0;
+        double timeStart = benchNow();
+
+        while (benchNow() - timeStart < BENCH_DURATION) {
+
+            memset(buffer + GLS_SIZE_HEADROOM, 'a', SIZE_MESSAGE);
+            if (allEncryptInPlace(sender, buffer, SIZE_MESSAGE) < 0) {
+
+                nbError++;
+                break;
+
+            }
+            nbMessage++;
+
+        }
+
+        double duration = benchNow() - timeStart;
+        printf("  pool of %5d bytes : %9.0f messages/s\n", m_poolSizes[i], nbMessage / duration);
+
+    }
+
+    freeGLSSocket(sender);
+    freeGLSSocket(receiver);
+
+    return nbError;
+
+}
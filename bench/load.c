@@ -0,0 +1,264 @@
+/*
+ *  load.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Load of NB_CLIENT clients connected at the same time to a glsServerRun()
+ * echo server, fewer if the limit of file descriptors can't hold both
+ * sides of the connexions. NB_LOAD_THREAD threads connect the clients
+ * (connexions/s), then each thread sends a message of SIZE_MESSAGE bytes
+ * from each of its clients and reads the echoes (echoes/s), so the
+ * server has answers in flight for all the clients.
+ */
+
+#include <sys/resource.h>
+#include "bench.h"
+
+#define NB_CLIENT 10000
+#define NB_LOAD_THREAD 4
+#define SIZE_MESSAGE 64
+
+typedef struct {
+
+    GLSSock* (*m_clients);
+    int m_nbClient;
+    const char* m_port;
+    double m_timeStop;
+    long long m_nbEcho;
+    int m_nbFailed;
+    pthread_t m_thread;
+
+} LoadThread;
+
+static GLSServerSock* m_server = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ glsServerRun() echo server and its callbacks.
+
+ ---------------------------------------------------------*/
+
+static int onHandShake(GLSSock* client, void* userData) {
+
+    (void) userData;
+
+    return addKey(client, "myPassword", 0);
+
+}
+
+static void onMessage(GLSSock* client, byte* message, const int size, void* userData) {
+
+    (void) userData;
+
+    glsSend(client, message, size);
+
+}
+
+static void* eventServer(void* arg) {
+
+    int nbThread = *(int*) arg;
+
+    GLSServerCallback callbacks = {onHandShake, NULL, onMessage, NULL};
+    glsServerRun(m_server, &callbacks, NULL, nbThread);
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Client threads : connexion of all the clients of the
+ thread, then rounds of messages until m_timeStop.
+
+ ---------------------------------------------------------*/
+
+static void* connectClients(void* arg) {
+
+    LoadThread* load = arg;
+    int i = 0;
+
+    for (i = 0; i < load->m_nbClient; i++) {
+
+        GLSSock* client = GLSSocketSecure(0, 0);
+        setUserId(client, "myUserId");
+        addKey(client, "myPassword", 0);
+
+        if (connexion(client, "127.0.0.1", load->m_port) != 0) {
+
+            freeGLSSocket(client);
+            client = 0;
+            load->m_nbFailed++;
+
+        }
+        load->m_clients[i] = client;
+
+    }
+
+    return NULL;
+
+}
+
+static void* echoClients(void* arg) {
+
+    LoadThread* load = arg;
+    byte message[SIZE_MESSAGE];
+    memset(message, 'a', SIZE_MESSAGE);
+    int i = 0;
+
+    while (benchNow() < load->m_timeStop) {
+
+        /* All the messages first, the echoes wait in the sockets */
+        for (i = 0; i < load->m_nbClient; i++) {
+
+            if (load->m_clients[i] == NULL) continue;
+            if (glsSend(load->m_clients[i], message, SIZE_MESSAGE) == 0) continue;
+
+            freeGLSSocket(load->m_clients[i]);
+            load->m_clients[i] = 0;
+            load->m_nbFailed++;
+
+        }
+
+        for (i = 0; i < load->m_nbClient; i++) {
+
+            if (load->m_clients[i] == NULL) continue;
+
+            byte (*answer) = 0;
+            int size = glsRecv(load->m_clients[i], &answer);
+            if (size == SIZE_MESSAGE && memcmp(answer, message, SIZE_MESSAGE) == 0) load->m_nbEcho++;
+            else {
+
+                freeGLSSocket(load->m_clients[i]);
+                load->m_clients[i] = 0;
+                load->m_nbFailed++;
+
+            }
+            free(answer);
+
+        }
+
+    }
+
+    return NULL;
+
+}
+
+
+
+
+int benchLoad(void) {
+
+    /* Both sides of the connexions are in this process */
+    struct rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+
+    int nbClient = NB_CLIENT;
+    if (limit.rlim_cur != RLIM_INFINITY && (long long) limit.rlim_cur < 2LL * NB_CLIENT + 100) nbClient = ((int) limit.rlim_cur - 100) / 2;
+
+    char port[8];
+    m_server = benchListen(1024, port);
+    if (m_server == NULL) return 1;
+
+    int nbServerThread = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (nbServerThread < 2) nbServerThread = 2;
+    pthread_t server;
+    pthread_create(&server, NULL, eventServer, &nbServerThread);
+
+    GLSSock* (*clients) = calloc(nbClient, sizeof(GLSSock*));
+    if (clients == NULL) {
+
+        glsServerStop(m_server);
+        pthread_join(server, NULL);
+        freeGLSServer(m_server);
+
+        return 1;
+
+    }
+
+    /* Connexions, the clients stay connected */
+    LoadThread loads[NB_LOAD_THREAD];
+    int first = 0;
+    int i = 0;
+    for (i = 0; i < NB_LOAD_THREAD; i++) {
+
+        memset(&loads[i], 0, sizeof(LoadThread));
+        loads[i].m_clients = clients + first;
+        loads[i].m_nbClient = nbClient / NB_LOAD_THREAD + (i < nbClient % NB_LOAD_THREAD);
+        loads[i].m_port = port;
+        first += loads[i].m_nbClient;
+
+    }
+
+    double timeStart = benchNow();
+    for (i = 0; i < NB_LOAD_THREAD; i++) pthread_create(&loads[i].m_thread, NULL, connectClients, &loads[i]);
+    for (i = 0; i < NB_LOAD_THREAD; i++) pthread_join(loads[i].m_thread, NULL);
+    double duration = benchNow() - timeStart;
+
+    int nbFailed = 0;
+    for (i = 0; i < NB_LOAD_THREAD; i++) nbFailed += loads[i].m_nbFailed;
+    printf("  %d clients, %d threads : %7.0f connexions/s, %d failed\n", nbClient, NB_LOAD_THREAD, nbClient / duration, nbFailed);
+
+    /* Messages from all the clients */
+    timeStart = benchNow();
+    for (i = 0; i < NB_LOAD_THREAD; i++) {
+
+        loads[i].m_timeStop = timeStart + 4 * BENCH_DURATION;
+        loads[i].m_nbFailed = 0;
+        pthread_create(&loads[i].m_thread, NULL, echoClients, &loads[i]);
+
+    }
+    for (i = 0; i < NB_LOAD_THREAD; i++) pthread_join(loads[i].m_thread, NULL);
+    duration = benchNow() - timeStart;
+
+    long long nbEcho = 0;
+    int nbEchoFailed = 0;
+    for (i = 0; i < NB_LOAD_THREAD; i++) {
+
+        nbEcho += loads[i].m_nbEcho;
+        nbEchoFailed += loads[i].m_nbFailed;
+
+    }
+    printf("  %d clients, %d bytes echoes    : %7.0f messages/s, %d failed\n", nbClient, SIZE_MESSAGE, nbEcho / duration, nbEchoFailed);
+
+    for (i = 0; i < nbClient; i++) {
+
+        if (clients[i] != NULL) freeGLSSocket(clients[i]);
+
+    }
+    free(clients);
+
+    glsServerStop(m_server);
+    pthread_join(server, NULL);
+    freeGLSServer(m_server);
+
+    return (nbFailed + nbEchoFailed != 0);
+
+}
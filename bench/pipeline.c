@@ -0,0 +1,330 @@
+/*
+ *  pipeline.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Messages of SIZE_MESSAGE bytes sent by glsSend() with several send
+ * windows, through a proxy delaying each direction by half of the round
+ * trip time. Stop and wait (window 1) sends one message per round trip,
+ * a window of n up to n. The messages/s include the final glsFlush().
+ */
+
+#define _GNU_SOURCE
+#include <poll.h>
+#include <netinet/tcp.h>
+#include "bench.h"
+
+#define SIZE_MESSAGE 64
+#define SIZE_PROXY_BUFFER 65536
+
+static const int m_rtts[] = {0, 1, 10, 50};
+static const int m_windows[] = {1, 8, 64};
+
+#define NB_RTT (int) (sizeof(m_rtts) / sizeof(m_rtts[0]))
+#define NB_WINDOW (int) (sizeof(m_windows) / sizeof(m_windows[0]))
+
+/* Bytes read by the proxy and sent after the delay */
+typedef struct ProxyData {
+
+    double m_time;
+    int m_size;
+    struct ProxyData* m_next;
+    byte m_data[];
+
+} ProxyData;
+
+typedef struct {
+
+    GLSServerSock* m_listen;
+    int m_sock[2];
+    ProxyData* m_first[2];
+    ProxyData* m_last[2];
+    double m_delay;
+    pthread_t m_thread;
+    char m_port[8];
+
+} DelayProxy;
+
+
+
+
+/*-------------------------------------------------------
+
+ Proxy thread, one client. The bytes read from one side
+ are written to the other one after the delay.
+
+ ---------------------------------------------------------*/
+
+static void* proxyLoop(void* arg) {
+
+    DelayProxy* proxy = arg;
+    byte buffer[SIZE_PROXY_BUFFER];
+    int isOpen = 1;
+    int side = 0;
+
+    while (isOpen) {
+
+        /* Wait until the next bytes to send or new bytes to read */
+        double now = benchNow();
+        double timeout = -1;
+        for (side = 0; side < 2; side++) {
+
+            if (proxy->m_first[side] == NULL) continue;
+
+            double wait = proxy->m_first[side]->m_time - now;
+            if (wait < 0) wait = 0;
+            if (timeout < 0 || wait < timeout) timeout = wait;
+
+        }
+
+        /* ppoll() for the delays shorter than a millisecond */
+        struct timespec waitTime;
+        waitTime.tv_sec = (time_t) timeout;
+        waitTime.tv_nsec = (long) ((timeout - waitTime.tv_sec) * 1000000000);
+
+        struct pollfd fds[2];
+        fds[0].fd = proxy->m_sock[0];
+        fds[1].fd = proxy->m_sock[1];
+        fds[0].events = POLLIN;
+        fds[1].events = POLLIN;
+        if (ppoll(fds, 2, (timeout < 0) ? NULL : &waitTime, NULL) < 0) break;
+
+        /* Bytes read from a side are for the other one */
+        now = benchNow();
+        for (side = 0; side < 2 && isOpen; side++) {
+
+            if (fds[side].revents == 0) continue;
+
+            ssize_t size = recv(proxy->m_sock[side], buffer, SIZE_PROXY_BUFFER, 0);
+            if (size <= 0) {
+
+                isOpen = 0;
+                break;
+
+            }
+
+            ProxyData* data = malloc(sizeof(ProxyData) + size);
+            if (data == NULL) {
+
+                isOpen = 0;
+                break;
+
+            }
+            data->m_time = now + proxy->m_delay;
+            data->m_size = (int) size;
+            data->m_next = 0;
+            memcpy(data->m_data, buffer, size);
+
+            int other = 1 - side;
+            if (proxy->m_last[other] != NULL) proxy->m_last[other]->m_next = data;
+            else proxy->m_first[other] = data;
+            proxy->m_last[other] = data;
+
+        }
+
+        /* Bytes whose delay is over */
+        for (side = 0; side < 2 && isOpen; side++) {
+
+            while (proxy->m_first[side] != NULL && proxy->m_first[side]->m_time <= now) {
+
+                ProxyData* data = proxy->m_first[side];
+                if (send(proxy->m_sock[side], data->m_data, data->m_size, MSG_NOSIGNAL) != data->m_size) isOpen = 0;
+
+                proxy->m_first[side] = data->m_next;
+                if (proxy->m_first[side] == NULL) proxy->m_last[side] = 0;
+                free(data);
+
+            }
+
+        }
+
+    }
+
+    /* The end of a side closes the other one */
+    for (side = 0; side < 2; side++) {
+
+        while (proxy->m_first[side] != NULL) {
+
+            ProxyData* data = proxy->m_first[side];
+            proxy->m_first[side] = data->m_next;
+            free(data);
+
+        }
+        close(proxy->m_sock[side]);
+
+    }
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Proxy to a sink with a round trip time in milliseconds,
+ the client connects to proxy->m_port.
+
+ Return 0 for success, a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+static int startProxy(DelayProxy* proxy, BenchSink* sink, const int rtt) {
+
+    memset(proxy, 0, sizeof(DelayProxy));
+    proxy->m_delay = rtt / 2000.0;
+    proxy->m_listen = benchListen(1, proxy->m_port);
+    if (proxy->m_listen == NULL) return GLS_ERROR_ADDRINUSE;
+
+    /* Side 1, the connexion to the sink */
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(atoi(sink->m_port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    proxy->m_sock[1] = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(proxy->m_sock[1], (struct sockaddr*) &address, sizeof(address)) != 0) {
+
+        close(proxy->m_sock[1]);
+        freeGLSServer(proxy->m_listen);
+
+        return GLS_ERROR_CONNREFUSED;
+
+    }
+
+    return 0;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Accept the client of the proxy (side 0) and start the
+ proxy thread.
+
+ ---------------------------------------------------------*/
+
+static void* acceptProxy(void* arg) {
+
+    DelayProxy* proxy = arg;
+
+    proxy->m_sock[0] = accept(proxy->m_listen->m_sock, NULL, NULL);
+
+    int noDelay = 1;
+    setsockopt(proxy->m_sock[0], IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+    setsockopt(proxy->m_sock[1], IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+    if (proxy->m_sock[0] >= 0) proxyLoop(proxy);
+    else close(proxy->m_sock[1]);
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ One round trip time and one window.
+
+ ---------------------------------------------------------*/
+
+static int measure(const int rtt, const int window) {
+
+    BenchSink sink;
+    if (benchStartSink(&sink, GLS_SUITE_AES256_GCM) != 0) return 1;
+
+    DelayProxy proxy;
+    if (startProxy(&proxy, &sink, rtt) != 0) {
+
+        benchStopSink(&sink, NULL);
+
+        return 1;
+
+    }
+    pthread_create(&proxy.m_thread, NULL, acceptProxy, &proxy);
+
+    /* The client connects to the proxy instead of the sink */
+    BenchSink viaProxy = sink;
+    memcpy(viaProxy.m_port, proxy.m_port, sizeof(proxy.m_port));
+    GLSSock* client = benchConnectSink(&viaProxy);
+
+    int error = (client == NULL) ? GLS_ERROR_NOTCONN : 0;
+    if (error == 0 && window > 1) error = glsSetSendWindow(client, window);
+
+    byte message[SIZE_MESSAGE];
+    memset(message, 'a', SIZE_MESSAGE);
+    long long nbMessage = 0;
+    double timeStart = benchNow();
+
+    while (error == 0 && benchNow() - timeStart < BENCH_DURATION) {
+
+        error = glsSend(client, message, SIZE_MESSAGE);
+        nbMessage++;
+
+    }
+    if (error == 0) error = glsFlush(client);
+
+    double duration = benchNow() - timeStart;
+
+    printf("  rtt %2d ms, window %2d : %8.0f messages/s%s\n", rtt, window, nbMessage / duration, (error != 0) ? " FAILED" : "");
+    if (error != 0) printf("  error %d\n", error);
+
+    /* The end of the client closes the proxy then the sink */
+    if (client != NULL) freeGLSSocket(client);
+    else shutdown(proxy.m_listen->m_sock, SHUT_RDWR);
+    pthread_join(proxy.m_thread, NULL);
+    freeGLSServer(proxy.m_listen);
+    pthread_join(sink.m_thread, NULL);
+    freeGLSServer(sink.m_server);
+
+    return (error != 0);
+
+}
+
+
+
+
+int benchPipeline(void) {
+
+    int nbError = 0;
+    int i = 0;
+    int j = 0;
+
+    for (i = 0; i < NB_RTT; i++) {
+
+        for (j = 0; j < NB_WINDOW; j++) {
+
+            nbError += measure(m_rtts[i], m_windows[j]);
+
+        }
+
+    }
+
+    return nbError;
+
+}
@@ -0,0 +1,88 @@
+/*
+ *  recv.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Messages of 1 MB to 256 MB sent on loopback, each one is split in
+ * packets of GLS_SIZE_PACKET bytes and reassembled by the server. The
+ * time per MB must not grow with the size. The AES-256-GCM suite keeps
+ * the encryption small next to the reception.
+ */
+
+#include "bench.h"
+
+#define SIZE_MB 1048576
+
+static const int m_sizes[] = {1, 4, 16, 64, 256};
+
+#define NB_SIZE (int) (sizeof(m_sizes) / sizeof(m_sizes[0]))
+
+
+
+
+int benchRecv(void) {
+
+    BenchSink sink;
+    if (benchStartSink(&sink, GLS_SUITE_AES256_GCM) != 0) return 1;
+
+    GLSSock* client = benchConnectSink(&sink);
+    if (client == NULL) {
+
+        benchStopSink(&sink, client);
+
+        return 1;
+
+    }
+
+    int nbError = 0;
+    int i = 0;
+
+    for (i = 0; nbError == 0 && i < NB_SIZE; i++) {
+
+        int size = m_sizes[i] * SIZE_MB;
+        byte* message = malloc(size);
+        if (message == NULL) {
+
+            nbError++;
+            break;
+
+        }
+        memset(message, 'a', size);
+
+        double timeStart = benchNow();
+        int error = glsSend(client, message, size);
+        if (error == 0) error = benchSyncSink(client);
+        double duration = benchNow() - timeStart;
+
+        if (error != 0) nbError++;
+        printf("  %4d MB : %8.1f ms %7.2f ms/MB %8.1f MB/s%s\n", m_sizes[i], duration * 1000, duration * 1000 / m_sizes[i], m_sizes[i] / duration, (error != 0) ? " FAILED" : "");
+
+        free(message);
+
+    }
+
+    benchStopSink(&sink, client);
+
+    return nbError;
+
+}
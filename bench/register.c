@@ -0,0 +1,403 @@
+/*
+ *  register.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Registrations one after the other for several message sizes, with the
+ * CPU time of the server thread : a single private key operation for the
+ * session key whatever the size. Then NB_CLIENT clients call
+ * sendRegister() together with a big message. The server thread accepts
+ * all of them with waitForClient() and only then decrypts the messages
+ * with getRegisterMessage(), the accepting thread is never held by the
+ * private key. Then the rounds of a message encrypted with the public key
+ * (older peers) decrypted by decryptWithPK() with 1 and several crypto
+ * threads.
+ */
+
+#include <time.h>
+#include "bench.h"
+
+#define NB_SERIAL 16
+#define NB_CLIENT 16
+#define SIZE_REGISTER 65536
+#define SIZE_REGISTER_PK 16384
+#define NB_CRYPTO_THREAD 4
+
+typedef struct {
+
+    const char* m_port;
+    double m_latency;
+    int m_error;
+
+} RegisterClient;
+
+static const int m_sizes[] = {1024, 16384, 65536, 262144, 1048576};
+
+#define NB_SIZE (int) (sizeof(m_sizes) / sizeof(m_sizes[0]))
+
+static GLSServerSock* m_server = 0;
+static pthread_barrier_t m_barrier;
+static double m_timeAccept = 0;
+static double m_timeDecrypt = 0;
+static int m_nbRegister = 0;
+static int m_sizeSerial = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ CPU time of the calling thread in seconds.
+
+ ---------------------------------------------------------*/
+
+static double threadTime(void) {
+
+    struct timespec now;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Server thread, reads the registrations one after the
+ other.
+
+ ---------------------------------------------------------*/
+
+static void* serialServer(void* arg) {
+
+    (void) arg;
+
+    double timeStart = threadTime();
+    int i = 0;
+
+    for (i = 0; i < NB_SERIAL; i++) {
+
+        GLSSock* client = 0;
+        if (waitForClient(m_server, &client) != 0) break;
+
+        byte (*message) = 0;
+        if (getRegisterMessage(client, &message) == m_sizeSerial) m_nbRegister++;
+        free(message);
+        freeGLSSocket(client);
+
+    }
+    m_timeDecrypt = threadTime() - timeStart;
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Registrations per second and server CPU time for each
+ message size.
+
+ ---------------------------------------------------------*/
+
+static int measureSizes(void) {
+
+    char port[8];
+    m_server = benchListen(NB_SERIAL, port);
+    if (m_server == NULL) return 1;
+
+    GLSSock* socket = GLSSocketSecure(0, 0);
+    int error = addServerCertificateFromFile(m_server, "pki/server.crt", "pki/server.key");
+    if (error == 0) error = addRootCertificateFromFile(socket, "pki/ca.crt");
+    if (error != 0) {
+
+        printf("  certificate error %d\n", error);
+        freeGLSSocket(socket);
+        freeGLSServer(m_server);
+
+        return 1;
+
+    }
+
+    byte* message = calloc(m_sizes[NB_SIZE - 1], 1);
+    int nbError = 0;
+    int i = 0;
+    int j = 0;
+
+    for (i = 0; i < NB_SIZE && error == 0; i++) {
+
+        pthread_t thread;
+        m_sizeSerial = m_sizes[i];
+        m_nbRegister = 0;
+        pthread_create(&thread, NULL, serialServer, NULL);
+
+        double timeStart = benchNow();
+        for (j = 0; j < NB_SERIAL && error == 0; j++) {
+
+            error = sendRegister(socket, "127.0.0.1", port, message, m_sizes[i]);
+
+        }
+        double duration = benchNow() - timeStart;
+
+        /* The server stops waiting when the client failed */
+        if (error != 0) shutdown(m_server->m_sock, SHUT_RDWR);
+        pthread_join(thread, NULL);
+
+        if (error != 0 || m_nbRegister != NB_SERIAL) nbError++;
+        printf("  %7d bytes : %6.1f registrations/s, server %6.2f ms CPU/registration%s\n", m_sizes[i], NB_SERIAL / duration, m_timeDecrypt * 1000 / NB_SERIAL, (error != 0 || m_nbRegister != NB_SERIAL) ? " FAILED" : "");
+
+    }
+
+    free(message);
+    freeGLSSocket(socket);
+    freeGLSServer(m_server);
+
+    return nbError;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Server thread, accepts all the clients then reads
+ their messages.
+
+ ---------------------------------------------------------*/
+
+static void* registerServer(void* arg) {
+
+    (void) arg;
+
+    GLSSock* clients[NB_CLIENT];
+    int nbClient = 0;
+    int i = 0;
+
+    pthread_barrier_wait(&m_barrier);
+    double timeStart = benchNow();
+
+    for (nbClient = 0; nbClient < NB_CLIENT; nbClient++) {
+
+        if (waitForClient(m_server, &clients[nbClient]) != 0) break;
+
+    }
+    m_timeAccept = benchNow() - timeStart;
+
+    timeStart = benchNow();
+    for (i = 0; i < nbClient; i++) {
+
+        byte (*message) = 0;
+        if (getRegisterMessage(clients[i], &message) == SIZE_REGISTER) m_nbRegister++;
+        free(message);
+        freeGLSSocket(clients[i]);
+
+    }
+    m_timeDecrypt = benchNow() - timeStart;
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Client thread, one register message.
+
+ ---------------------------------------------------------*/
+
+static void* registerClient(void* arg) {
+
+    RegisterClient* client = arg;
+
+    static byte message[SIZE_REGISTER];
+    GLSSock* socket = GLSSocketSecure(0, 0);
+    client->m_error = addRootCertificateFromFile(socket, "pki/ca.crt");
+
+    pthread_barrier_wait(&m_barrier);
+    double timeStart = benchNow();
+
+    if (client->m_error == 0) client->m_error = sendRegister(socket, "127.0.0.1", client->m_port, message, SIZE_REGISTER);
+    client->m_latency = benchNow() - timeStart;
+
+    freeGLSSocket(socket);
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Sort of the latencies.
+
+ ---------------------------------------------------------*/
+
+static int compareLatency(const void* a, const void* b) {
+
+    double latencyA = *(const double*) a;
+    double latencyB = *(const double*) b;
+
+    return (latencyA > latencyB) - (latencyA < latencyB);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Simultaneous registrations.
+
+ ---------------------------------------------------------*/
+
+static int measureRegister(void) {
+
+    char port[8];
+    m_server = benchListen(NB_CLIENT, port);
+    if (m_server == NULL) return 1;
+
+    int error = addServerCertificateFromFile(m_server, "pki/server.crt", "pki/server.key");
+    if (error != 0) {
+
+        printf("  server error %d\n", error);
+        freeGLSServer(m_server);
+
+        return 1;
+
+    }
+
+    RegisterClient clients[NB_CLIENT];
+    pthread_t threads[NB_CLIENT];
+    pthread_t thread;
+    double latencies[NB_CLIENT];
+    int nbError = 0;
+    int i = 0;
+
+    pthread_barrier_init(&m_barrier, NULL, NB_CLIENT + 1);
+    m_nbRegister = 0;
+    pthread_create(&thread, NULL, registerServer, NULL);
+
+    for (i = 0; i < NB_CLIENT; i++) {
+
+        clients[i].m_port = port;
+        pthread_create(&threads[i], NULL, registerClient, &clients[i]);
+
+    }
+    for (i = 0; i < NB_CLIENT; i++) {
+
+        pthread_join(threads[i], NULL);
+        latencies[i] = clients[i].m_latency;
+        if (clients[i].m_error != 0) nbError++;
+
+    }
+    pthread_join(thread, NULL);
+    pthread_barrier_destroy(&m_barrier);
+    freeGLSServer(m_server);
+
+    qsort(latencies, NB_CLIENT, sizeof(double), compareLatency);
+    printf("  %d registrations of %d bytes : sendRegister() median %.1f ms, max %.1f ms\n", NB_CLIENT, SIZE_REGISTER, latencies[NB_CLIENT / 2] * 1000, latencies[NB_CLIENT - 1] * 1000);
+    printf("  waitForClient() : %.0f accepts/s, getRegisterMessage() : %.1f ms/message, %d/%d read%s\n", NB_CLIENT / m_timeAccept, m_timeDecrypt * 1000 / NB_CLIENT, m_nbRegister, NB_CLIENT, (nbError != 0 || m_nbRegister != NB_CLIENT) ? " FAILED" : "");
+
+    return (nbError != 0 || m_nbRegister != NB_CLIENT);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Rounds of decryptWithPK() on the crypto threads.
+
+ ---------------------------------------------------------*/
+
+static int measureRounds(void) {
+
+    char* cert = 0;
+    GLSServerCert* serverCert = 0;
+    if (charFromFile("pki/server.crt", &cert) != 0) return 1;
+    if (newServerCertFromFile("pki/server.crt", "pki/server.key", &serverCert) != 0) {
+
+        free(cert);
+
+        return 1;
+
+    }
+
+    GLSSock* server = GLSSocket();
+    server->m_serverCert = serverCert;
+
+    byte message[SIZE_REGISTER_PK];
+    memset(message, 'a', SIZE_REGISTER_PK);
+    byte (*cipherText) = 0;
+    int sizeCipherText = encryptWithPK((const byte*) cert, strlen(cert), message, SIZE_REGISTER_PK, &cipherText);
+
+    int nbThreads[] = {1, NB_CRYPTO_THREAD};
+    int nbError = (sizeCipherText <= 0);
+    int i = 0;
+
+    for (i = 0; nbError == 0 && i < 2; i++) {
+
+        glsSetCryptoThreads(nbThreads[i]);
+
+        byte (*plainText) = 0;
+        double timeStart = benchNow();
+        int size = decryptWithPK(server, cipherText, sizeCipherText, &plainText);
+        double duration = benchNow() - timeStart;
+
+        if (size != SIZE_REGISTER_PK || memcmp(plainText, message, size) != 0) nbError++;
+        printf("  decryptWithPK() %d bytes, %d crypto threads : %.1f ms%s\n", SIZE_REGISTER_PK, nbThreads[i], duration * 1000, (nbError != 0) ? " FAILED" : "");
+        free(plainText);
+
+    }
+
+    glsSetCryptoThreads(1);
+    free(cipherText);
+    free(cert);
+    freeGLSSocket(server);
+
+    return nbError;
+
+}
+
+
+
+
+int benchRegister(void) {
+
+    int nbError = measureSizes();
+    nbError += measureRegister();
+    nbError += measureRounds();
+
+    return nbError;
+
+}
@@ -0,0 +1,184 @@
+/*
+ *  slowloris.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Connexion rate of a waitForClient() server while 1% of the clients
+ * send 1 byte of their hello and nothing more (slowloris). The rate is
+ * measured by windows of NB_WINDOW connexions, it stays the same as
+ * without slow clients when their handshake doesn't hold the others.
+ */
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "bench.h"
+
+#define NB_CONNEXION 500
+#define NB_WINDOW 100
+#define SLOW_EVERY 100
+
+static GLSServerSock* m_server = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ Server thread, the standard clients only.
+
+ ---------------------------------------------------------*/
+
+static void* acceptServer(void* arg) {
+
+    (void) arg;
+
+    int i = 0;
+
+    for (i = 0; i < NB_CONNEXION; i++) {
+
+        GLSSock* client = 0;
+        if (waitForClient(m_server, &client) != 0) continue;
+
+        addKey(client, "myPassword", 0);
+        finishHandShake(client);
+        freeGLSSocket(client);
+
+    }
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Slow client, connected and 1 byte of the header sent.
+
+ ---------------------------------------------------------*/
+
+static int slowClient(const char* port) {
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(atoi(port));
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    int sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (sock < 0) return sock;
+
+    byte header = 0;
+    if (connect(sock, (struct sockaddr*) &address, sizeof(address)) != 0 || write(sock, &header, 1) != 1) {
+
+        close(sock);
+
+        return -1;
+
+    }
+
+    return sock;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ NB_CONNEXION connexions, with or without slow clients.
+
+ ---------------------------------------------------------*/
+
+static int measure(const int withSlow) {
+
+    char port[8];
+    m_server = benchListen(128, port);
+    if (m_server == NULL) return 1;
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, acceptServer, NULL);
+
+    int slowSocks[NB_CONNEXION / SLOW_EVERY];
+    int nbSlow = 0;
+    int nbError = 0;
+    double slowest = 0;
+    double rateMin = 0;
+    double rateMax = 0;
+    double timeWindow = benchNow();
+    int i = 0;
+
+    for (i = 0; i < NB_CONNEXION; i++) {
+
+        if (withSlow && i % SLOW_EVERY == SLOW_EVERY / 2) {
+
+            int sock = slowClient(port);
+            if (sock >= 0) slowSocks[nbSlow++] = sock;
+
+        }
+
+        double timeStart = benchNow();
+        GLSSock* client = GLSSocketSecure(0, 0);
+        setUserId(client, "myUserId");
+        addKey(client, "myPassword", 0);
+        if (connexion(client, "127.0.0.1", port) != 0) nbError++;
+        freeGLSSocket(client);
+
+        double latency = benchNow() - timeStart;
+        if (latency > slowest) slowest = latency;
+
+        /* Rate of the last window */
+        if ((i + 1) % NB_WINDOW == 0) {
+
+            double rate = NB_WINDOW / (benchNow() - timeWindow);
+            if (rateMin == 0 || rate < rateMin) rateMin = rate;
+            if (rate > rateMax) rateMax = rate;
+            timeWindow = benchNow();
+
+        }
+
+    }
+
+    pthread_join(thread, NULL);
+    for (i = 0; i < nbSlow; i++) close(slowSocks[i]);
+    freeGLSServer(m_server);
+
+    printf("  %-16s : %4.0f to %4.0f connexions/s by %d, slowest connexion %.1f ms, %d failed\n", withSlow ? "1% slow clients" : "no slow client", rateMin, rateMax, NB_WINDOW, slowest * 1000, nbError);
+
+    return (nbError != 0);
+
+}
+
+
+
+
+int benchSlowloris(void) {
+
+    int nbError = measure(0);
+    nbError += measure(1);
+
+    return nbError;
+
+}
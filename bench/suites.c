@@ -0,0 +1,114 @@
+/*
+ *  suites.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Throughput of each cipher suite on loopback, per message size. The
+ * client sends messages during BENCH_DURATION seconds then waits for the
+ * server to have received all of them.
+ */
+
+#include "bench.h"
+
+static const int m_suites[] = {GLS_SUITE_SERPENT_TWOFISH, GLS_SUITE_AES256_GCM, GLS_SUITE_CHACHA20_POLY1305, GLS_SUITE_SERPENT_TWOFISH_CTR};
+static const char* m_suiteNames[] = {"Serpent+Twofish CTS", "AES-256-GCM", "ChaCha20-Poly1305", "Serpent+Twofish CTR"};
+static const int m_sizes[] = {64, 4096, 65536, 1048576};
+
+#define NB_SUITE (int) (sizeof(m_suites) / sizeof(m_suites[0]))
+#define NB_SIZE (int) (sizeof(m_sizes) / sizeof(m_sizes[0]))
+
+
+
+
+/*-------------------------------------------------------
+
+ One suite, all the sizes.
+
+ ---------------------------------------------------------*/
+
+static int measure(const int index) {
+
+    BenchSink sink;
+    if (benchStartSink(&sink, m_suites[index]) != 0) return 1;
+
+    GLSSock* client = benchConnectSink(&sink);
+    if (client == NULL || glsGetCipherSuite(client) != m_suites[index]) {
+
+        printf("  %-20s not negotiated\n", m_suiteNames[index]);
+        benchStopSink(&sink, client);
+
+        return 1;
+
+    }
+
+    byte* message = malloc(m_sizes[NB_SIZE - 1]);
+    if (message == NULL) {
+
+        benchStopSink(&sink, client);
+
+        return 1;
+
+    }
+    memset(message, 'a', m_sizes[NB_SIZE - 1]);
+
+    int error = 0;
+    int i = 0;
+
+    for (i = 0; error == 0 && i < NB_SIZE; i++) {
+
+        long long nbMessage = 0;
+        double timeStart = benchNow();
+
+        while (error == 0 && benchNow() - timeStart < BENCH_DURATION) {
+
+            error = glsSend(client, message, m_sizes[i]);
+            nbMessage++;
+
+        }
+        if (error == 0) error = benchSyncSink(client);
+
+        double duration = benchNow() - timeStart;
+        printf("  %-20s %8d bytes : %8.1f MB/s %9.0f messages/s%s\n", m_suiteNames[index], m_sizes[i], nbMessage * (double) m_sizes[i] / duration / 1000000, nbMessage / duration, (error != 0) ? " FAILED" : "");
+
+    }
+
+    free(message);
+    benchStopSink(&sink, client);
+
+    return (error != 0);
+
+}
+
+
+
+
+int benchSuites(void) {
+
+    int nbError = 0;
+    int i = 0;
+
+    for (i = 0; i < NB_SUITE; i++) nbError += measure(i);
+
+    return nbError;
+
+}
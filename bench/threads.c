@@ -0,0 +1,143 @@
+/*
+ *  threads.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Throughput of the cascade in counter mode with 1 to N crypto threads
+ * (glsSetCryptoThreads()), N being the number of cores and at least 2.
+ * A message of SIZE_MESSAGE bytes is cut in chunks of GLS_SIZE_CHUNK
+ * bytes shared by the threads of runParallel(), it is encrypted by
+ * ctrEncryptInPlace() then decrypted by ctrDecryptInPlace().
+ */
+
+#include "bench.h"
+
+#define SIZE_MESSAGE 16777216
+
+
+
+
+/*-------------------------------------------------------
+
+ One number of threads, returns the encryption speed
+ (MB/s) or a negative number for an error.
+
+ ---------------------------------------------------------*/
+
+static double measure(GLSSock* sender, GLSSock* receiver, byte* buffer, const byte* message, const int nbThread, double* decryptSpeed) {
+
+    if (glsSetCryptoThreads(nbThread) != 0) return -1;
+
+    double timeEncrypt = 0;
+    double timeDecrypt = 0;
+    long long nbMessage = 0;
+    double timeStart = benchNow();
+
+    while (benchNow() - timeStart < BENCH_DURATION) {
+
+        memcpy(buffer + GLS_SIZE_HEADROOM, message, SIZE_MESSAGE);
+
+        double timeCrypto = benchNow();
+        int sizeCipherText = ctrEncryptInPlace(sender, buffer, SIZE_MESSAGE);
+        timeEncrypt += benchNow() - timeCrypto;
+
+        timeCrypto = benchNow();
+        int sizePlainText = ctrDecryptInPlace(receiver, buffer, sizeCipherText);
+        timeDecrypt += benchNow() - timeCrypto;
+
+        if (sizePlainText != SIZE_MESSAGE) return -1;
+        if (nbMessage == 0 && memcmp(buffer + GLS_SIZE_HEADROOM, message, SIZE_MESSAGE) != 0) return -1;
+        nbMessage++;
+
+    }
+
+    *decryptSpeed = nbMessage * (double) SIZE_MESSAGE / timeDecrypt / 1000000;
+
+    return nbMessage * (double) SIZE_MESSAGE / timeEncrypt / 1000000;
+
+}
+
+
+
+
+int benchThreads(void) {
+
+    GLSSock* sender = 0;
+    GLSSock* receiver = 0;
+    int nbError = benchKeyPair(&sender, &receiver) != 0;
+
+    /* Counter mode keys (MAC) derived from the shared IVs */
+    if (nbError == 0) {
+
+        sender->m_activeSuite = GLS_SUITE_SERPENT_TWOFISH_CTR;
+        receiver->m_activeSuite = GLS_SUITE_SERPENT_TWOFISH_CTR;
+        if (initSuiteHandler(sender) != 0 || initSuiteHandler(receiver) != 0) nbError++;
+
+    }
+
+    byte* message = malloc(SIZE_MESSAGE);
+    byte* buffer = malloc(GLS_SIZE_HEADROOM + SIZE_MESSAGE);
+    if (message == NULL || buffer == NULL) nbError++;
+
+    int i = 0;
+    for (i = 0; nbError == 0 && i < SIZE_MESSAGE; i++) message[i] = (byte) (i * 13);
+
+    int nbCore = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    int nbMax = nbCore;
+    if (nbMax < 2) nbMax = 2;
+    if (nbMax > GLS_MAX_THREAD) nbMax = GLS_MAX_THREAD;
+
+    double encryptOne = 0;
+    double decryptOne = 0;
+    int nbThread = 1;
+
+    while (nbError == 0 && nbThread <= nbMax) {
+
+        double decryptSpeed = 0;
+        double encryptSpeed = measure(sender, receiver, buffer, message, nbThread, &decryptSpeed);
+        if (encryptSpeed < 0) nbError++;
+        if (nbThread == 1) {
+
+            encryptOne = encryptSpeed;
+            decryptOne = decryptSpeed;
+
+        }
+
+        printf("  %2d threads (%d cores), %d MB : encryption %7.1f MB/s (x%.2f), decryption %7.1f MB/s (x%.2f)%s\n", nbThread, nbCore, SIZE_MESSAGE / 1048576, encryptSpeed, encryptSpeed / encryptOne, decryptSpeed, decryptSpeed / decryptOne, (nbError != 0) ? " FAILED" : "");
+
+        /* Every number up to 8, then doubling up to the number of cores */
+        if (nbThread < 8 || nbThread == nbMax) nbThread++;
+        else if (nbThread * 2 > nbMax) nbThread = nbMax;
+        else nbThread *= 2;
+
+    }
+
+    glsSetCryptoThreads(1);
+    free(message);
+    free(buffer);
+    freeGLSSocket(sender);
+    freeGLSSocket(receiver);
+
+    return nbError;
+
+}
@@ -6,6 +6,13 @@ LIBGPG=$CURRENT"/dep/libgpg-error-1.12"
 LIBGCRYPT=$CURRENT"/dep/libgcrypt-1.5.2"
 LIBTASN=$CURRENT"/dep/libtasn1-3.3"
 
+# libgcrypt of the system when it has the AEAD suites (1.7 or later),
+# GLS_BUNDLED_GCRYPT=1 builds the bundled libgcrypt 1.5.2 without them
+SYSTEM_GCRYPT=0
+if [ -z "$GLS_BUNDLED_GCRYPT" ] && printf '#include <gcrypt.h>\n#if GCRYPT_VERSION_NUMBER < 0x010700\n#error\n#endif\n' | gcc -E - > /dev/null 2>&1; then
+SYSTEM_GCRYPT=1
+fi
+
 # check
 rm -r tmp || true
 rm -r lib || true
@@ -28,6 +35,7 @@ echo "* GLS Dynamic library compilation... *"
 echo "**************************************"
 echo " "
 echo " "
+if [ $SYSTEM_GCRYPT = 0 ]; then
 echo "#################################"
 echo "# Compilation Libgpg-error 1.12 #"
 echo "#################################"
@@ -46,6 +54,11 @@ ln -s $LIBGPG/src/gpg-error.h ./src/gpg-error.h
 export LDFLAGS="$LDFLAGS -L$LIBGPG/src/.libs"
 ./configure --with-gpg-error-prefix=$LIBGPG/
 make
+else
+echo "##################################"
+echo "# System libgcrypt (AEAD suites) #"
+echo "##################################"
+fi
 
 # Compile libtasn1
 echo " "
@@ -62,22 +75,38 @@ echo "##########################"
 echo "# Compilation GLS Alpha  #"
 echo "##########################"
 cd $CURRENT
+if [ $SYSTEM_GCRYPT = 0 ]; then
 ln -s $LIBGCRYPT/src/gcrypt.h gcrypt.h
 ln -s $LIBGCRYPT/src/gcrypt-module.h gcrypt-module.h
 ln -s $LIBGPG/src/gpg-error.h gpg-error.h
+fi
 ln -s $LIBTASN/lib/libtasn1.h libtasn1.h
 mkdir lib
 gcc -fPIC -DEAI_ADDRFAMILY=5001 -DEAI_NODATA=5002 -c GLSServer.c -o ./tmp/GLSServer.o
 gcc -fPIC -DEAI_ADDRFAMILY=5001 -DEAI_NODATA=5002 -c GLSSocket.c -o ./tmp/GLSSocket.o
 gcc -fPIC -c Crypto.c -o ./tmp/Crypto.o
+gcc -fPIC -c Worker.c -o ./tmp/Worker.o
+gcc -fPIC -c Stats.c -o ./tmp/Stats.o
+gcc -fPIC -c Crl.c -o ./tmp/Crl.o
+gcc -fPIC -c CertCache.c -o ./tmp/CertCache.o
+gcc -fPIC -c Resolver.c -o ./tmp/Resolver.o
+gcc -fPIC -c Roots.c -o ./tmp/Roots.o
 gcc -fPIC -c Certificate.c -o ./tmp/Certificate.o
-gcc -shared -Wl,-soname,libgls.so.1 -o ./lib/libgls.so ./tmp/*.o $LIBGPG/src/.libs/libgpg-error.so $LIBGCRYPT/src/.libs/libgcrypt.so $LIBTASN/lib/.libs/libtasn1.so
+gcc -fPIC -c Asn.c -o ./tmp/Asn.o
+if [ $SYSTEM_GCRYPT = 0 ]; then
+GCRYPT_LIBS="$LIBGPG/src/.libs/libgpg-error.so $LIBGCRYPT/src/.libs/libgcrypt.so"
+else
+GCRYPT_LIBS="-lgcrypt -lgpg-error"
+fi
+gcc -shared -Wl,-soname,libgls.so.1 -o ./lib/libgls.so ./tmp/*.o $GCRYPT_LIBS $LIBTASN/lib/.libs/libtasn1.so
 cp libgls.h ./lib/
+if [ $SYSTEM_GCRYPT = 0 ]; then
 cp $LIBGPG/src/gpg-error.h ./lib/
 cp $LIBGCRYPT/src/gcrypt.h ./lib/
 cp $LIBGCRYPT/src/gcrypt-module.h ./lib/
 cp $LIBGPG/src/.libs/libgpg-error.so ./lib/
 cp $LIBGCRYPT/src/.libs/libgcrypt.so ./lib/
+fi
 cp $LIBTASN/lib/.libs/libtasn1.so ./lib/
 
 # Clean
@@ -86,16 +115,18 @@ echo "#############"
 echo "# Cleaning  #"
 echo "#############"
 rm -r tmp
+rm libtasn1.h
+if [ $SYSTEM_GCRYPT = 0 ]; then
 rm gcrypt.h
 rm gcrypt-module.h
 rm gpg-error.h
-rm libtasn1.h
 cd $LIBGPG
 rm bin
 make clean
 cd $LIBGCRYPT
 rm ./src/gpg-error.h
 make clean
+fi
 cd $LIBTASN
 make clean
 
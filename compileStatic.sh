@@ -6,6 +6,13 @@ LIBGPG=$CURRENT"/dep/libgpg-error-1.12"
 LIBGCRYPT=$CURRENT"/dep/libgcrypt-1.5.2"
 LIBTASN=$CURRENT"/dep/libtasn1-3.3"
 
+# libgcrypt of the system when it has the AEAD suites (1.7 or later),
+# GLS_BUNDLED_GCRYPT=1 builds the bundled libgcrypt 1.5.2 without them
+SYSTEM_GCRYPT=0
+if [ -z "$GLS_BUNDLED_GCRYPT" ] && printf '#include <gcrypt.h>\n#if GCRYPT_VERSION_NUMBER < 0x010700\n#error\n#endif\n' | gcc -E - > /dev/null 2>&1; then
+SYSTEM_GCRYPT=1
+fi
+
 # check
 rm -r tmp || true
 rm -r lib || true
@@ -28,6 +35,7 @@ echo "* GLS Static library compilation... *"
 echo "*************************************"
 echo " "
 echo " "
+if [ $SYSTEM_GCRYPT = 0 ]; then
 echo "#################################"
 echo "# Compilation Libgpg-error 1.12 #"
 echo "#################################"
@@ -52,6 +60,14 @@ make
 cd src/.libs
 ar x libgcrypt.a
 cp *.o $CURRENT/tmp/
+else
+echo "##################################"
+echo "# System libgcrypt (AEAD suites) #"
+echo "##################################"
+cd $CURRENT/tmp
+ar x $(gcc -print-file-name=libgpg-error.a)
+ar x $(gcc -print-file-name=libgcrypt.a)
+fi
 
 # Compile libtasn1
 echo " "
@@ -72,20 +88,31 @@ echo "##########################"
 echo "# Compilation GLS Alpha  #"
 echo "##########################"
 cd $CURRENT
+if [ $SYSTEM_GCRYPT = 0 ]; then
 ln -s $LIBGCRYPT/src/gcrypt.h gcrypt.h
 ln -s $LIBGCRYPT/src/gcrypt-module.h gcrypt-module.h
 ln -s $LIBGPG/src/gpg-error.h gpg-error.h
+fi
 ln -s $LIBTASN/lib/libtasn1.h libtasn1.h
 mkdir lib
 gcc -DEAI_ADDRFAMILY=5001 -DEAI_NODATA=5002 -c GLSServer.c -o ./tmp/GLSServer.o
 gcc -DEAI_ADDRFAMILY=5001 -DEAI_NODATA=5002 -c GLSSocket.c -o ./tmp/GLSSocket.o
 gcc -c Crypto.c -o ./tmp/Crypto.o
+gcc -c Worker.c -o ./tmp/Worker.o
+gcc -c Stats.c -o ./tmp/Stats.o
+gcc -c Crl.c -o ./tmp/Crl.o
+gcc -c CertCache.c -o ./tmp/CertCache.o
+gcc -c Resolver.c -o ./tmp/Resolver.o
+gcc -c Roots.c -o ./tmp/Roots.o
 gcc -c Certificate.c -o ./tmp/Certificate.o
+gcc -c Asn.c -o ./tmp/Asn.o
 ar rcs ./lib/libgls.a ./tmp/*.o
 cp libgls.h ./lib/
+if [ $SYSTEM_GCRYPT = 0 ]; then
 cp $LIBGPG/src/gpg-error.h ./lib/
 cp $LIBGCRYPT/src/gcrypt.h ./lib/
 cp $LIBGCRYPT/src/gcrypt-module.h ./lib/
+fi
 
 # Clean
 echo " "
@@ -93,16 +120,18 @@ echo "#############"
 echo "# Cleaning  #"
 echo "#############"
 rm -r tmp
+rm libtasn1.h
+if [ $SYSTEM_GCRYPT = 0 ]; then
 rm gcrypt.h
 rm gcrypt-module.h
 rm gpg-error.h
-rm libtasn1.h
 cd $LIBGPG
 rm bin
 make clean
 cd $LIBGCRYPT
 rm ./src/gpg-error.h
 make clean
+fi
 cd $LIBTASN
 make clean
 
@@ -73,6 +73,15 @@ typedef unsigned char byte;
 #define GLS_CONNEXION_STANDARD 1
 #define GLS_CONNEXION_REGISTER 2
 
+/* Space needed in front of a message for glsSendInPlace() (MAC + IVS) */
+#define GLS_SIZE_HEADROOM 96
+
+/* Cipher suites for glsSetCipherSuite() */
+#define GLS_SUITE_SERPENT_TWOFISH 0
+#define GLS_SUITE_AES256_GCM 1
+#define GLS_SUITE_CHACHA20_POLY1305 2
+#define GLS_SUITE_SERPENT_TWOFISH_CTR 3
+
 /*
  * Error abstraction make easier background
  * API modification without interfering with
@@ -164,6 +173,88 @@ namespace libgls {
 extern "C" {
 #endif
 
+/* Buckets of the histograms of GLSStats, bucket i counts the times below 2^(i + 1) microseconds */
+#define GLS_STATS_BUCKETS 24
+
+/* Phases of the handshake in GLSStats */
+#define GLS_PHASE_HELLO 0
+#define GLS_PHASE_HELLO_CIPHER 1
+#define GLS_PHASE_FINISH 2
+#define GLS_NB_PHASE 3
+
+/* Socket to wait for, returned by glsConnectStart() and glsConnectPoll() */
+#define GLS_WAIT_READ 1
+#define GLS_WAIT_WRITE 2
+
+/*
+ * Statistics of a socket or a server, see glsGetStats(). The times
+ * are in microseconds. Handshake phases, server side : Hello message
+ * received, encrypted Hello received, finishHandShake(). Client side :
+ * connexion to the server, Hello messages sent, answer of the server.
+ */
+struct glsStatsStr {
+
+    /* Messages of glsSend() and glsRecv() (plaintext size) */
+    unsigned long long m_bytesSent;
+    unsigned long long m_bytesRecv;
+    unsigned long long m_messagesSent;
+    unsigned long long m_messagesRecv;
+
+    /* Time in the cipher suite, the MAC of the cascade suites is also in m_macTime */
+    unsigned long long m_encryptTime;
+    unsigned long long m_decryptTime;
+    unsigned long long m_macTime;
+
+    /* Round trip of the acknowledgements */
+    unsigned long long m_nbAck;
+    unsigned long long m_ackTime;
+    unsigned long long m_ackHistogram[GLS_STATS_BUCKETS];
+
+    /* Errors of transmission */
+    unsigned long long m_nbRetry;
+    unsigned long long m_nbMacError;
+    unsigned long long m_nbIvDesync;
+
+    /* Handshakes */
+    unsigned long long m_nbHandShake;
+    unsigned long long m_nbHandShakeError;
+    unsigned long long m_handShakeTime[GLS_NB_PHASE];
+
+};
+
+typedef struct glsStatsStr GLSStats;
+
+/* Secure memory of a socket with one key : key1, key2 and the hash of the key */
+#define GLS_SIZE_SECRET 128
+
+/*
+ * Secure memory (libgcrypt pool) used by the buffers of GLS, see
+ * glsGetSecureMemory(). The sizes are in bytes, without the few
+ * bytes added by libgcrypt to each buffer.
+ */
+struct glsSecureMemStr {
+
+    /* Size given to glsGlobalInit(), 0 if the pool is not initialised by GLS */
+    unsigned long long m_poolSize;
+
+    /* Buffers in use and highest use since the start */
+    unsigned long long m_used;
+    unsigned long long m_highWater;
+    unsigned long long m_nbBuffer;
+
+    /* Allocations refused because the pool was full */
+    unsigned long long m_nbFailed;
+
+};
+
+typedef struct glsSecureMemStr GLSSecureMem;
+
+/* Revocation list, see GLSCrlList() */
+typedef struct glsCrlStr GLSCrl;
+
+/* Root certificates, see GLSRootList() */
+typedef struct glsRootListStr GLSRoots;
+
 /*
  * Structure of the GLS socket
  */
@@ -171,13 +262,10 @@ struct glsSockStr {
 
     /* network variables */
     int m_sock;
-    struct addrinfo *m_infoConnexion;
     struct sockaddr *m_infoClient;
 
-    /* Debug only */
-    #if defined (GLS_DEBUG_MODE_ENABLE)
+    /* Side of the connexion (server = 1) */
     int m_isServeur;
-    #endif
 
     /* state configuration variables */
     int m_isSocketConfig;
@@ -187,6 +275,7 @@ struct glsSockStr {
     int m_isUserConfig;
 
     /* encryption keys */
+    /* key1, key2 and the first key of m_keys in one secure buffer (GLS_SIZE_SECRET) */
     byte *m_key1;
     byte *m_key2;
     byte* (*m_keys);
@@ -198,12 +287,21 @@ struct glsSockStr {
     byte m_iv3[16];
     byte m_iv4[16];
 
+    /* Pool of random bytes for the IVs (filled in bulk) */
+    byte* m_ivPool;
+    int m_sizeIvPool;
+    int m_posIvPool;
+
     /* Encryption handlers from libgcrypt */
     gcry_cipher_hd_t m_serpentHandlerCTS;
     gcry_cipher_hd_t m_twofishHandlerCTS;
     gcry_cipher_hd_t m_serpentHandlerECB;
     gcry_cipher_hd_t m_twofishHandlerECB;
 
+    /* MAC handlers (one per direction, reset between messages) */
+    gcry_md_hd_t m_macSendHandler;
+    gcry_md_hd_t m_macRecvHandler;
+
     /* State connexion variables */
     byte *m_idUser;
     int m_sizeIdUser;
@@ -217,21 +315,67 @@ struct glsSockStr {
     pthread_mutex_t m_mutexGlsSend;
     pthread_mutex_t m_mutexGlsRecv;
 
-    /* Certificat */
-    byte* m_certRoot;
-    int m_certRootSize;
-    byte* m_publicCert;
-    int m_publicCertSize;
-    byte* m_privateKey;
-    int m_privateKeySize;
+    /* Certificat, the roots may be shared with other sockets (setRootList()) */
+    struct glsRootListStr* m_roots;
+    struct glsServerCertStr* m_serverCert;
 
-    /* CRL */
-    byte* (*m_crl);
-    int m_sizeCrl;
+    /* CRL, may be shared with other sockets (setCrlList()) */
+    struct glsCrlStr* m_crl;
 
-    /* Message Register */
+    /* Message Register (decrypted by getRegisterMessage()) */
     byte* m_messageRegister;
     int m_sizeMessageRegister;
+    byte* m_messageRegisterEncrypt;
+    int m_sizeMessageRegisterEncrypt;
+
+    /* Handshake of the server side in progress (resumed without blocking) */
+    struct glsHandShakeStr* m_handShake;
+
+    /* Pipelined send (window of messages waiting for an acknowledgement) */
+    int m_sendWindow;
+    unsigned int m_sendSeq;
+    unsigned int m_ackSeq;
+    unsigned int m_recvSeq;
+    int m_nbRetry;
+    int m_isRecvRecovery;
+    byte* (*m_inFlight);
+    int* m_sizeInFlight;
+    unsigned long long* m_timeInFlight;
+    int m_maxInFlight;
+
+    /* Client of glsServerRun() : packets queued when the socket is full, acknowledgements not waited */
+    int m_isEventLoop;
+    byte* m_outBuffer;
+    int m_sizeOutBuffer;
+    int m_posOutBuffer;
+    int m_maxOutBuffer;
+
+    /* Messages of the peer read by glsSend() while waiting for an acknowledgement */
+    byte* (*m_recvQueue);
+    int* m_sizeRecvQueue;
+    int m_firstRecvQueue;
+    int m_nbRecvQueue;
+    int m_maxRecvQueue;
+
+    /* Cipher suite (wanted, negotiated and AEAD state) */
+    int m_cipherSuite;
+    int m_activeSuite;
+    int m_peerVersion;
+    int m_isAeadInit;
+    gcry_cipher_hd_t m_aeadHandler;
+    unsigned long long m_aeadSendSeq;
+    unsigned long long m_aeadRecvSeq;
+    int m_isHmacInit;
+    gcry_md_hd_t m_hmacSendHandler;
+    gcry_md_hd_t m_hmacRecvHandler;
+
+    /* Handlers of the CTR cascade keyed once, a Serpent and Twofish pair by crypto thread */
+    gcry_cipher_hd_t* m_ctrHandler;
+
+    /* Statistics, each block written by one thread at a time (glsGetStats()) */
+    GLSStats m_statsHandShake;
+    GLSStats m_statsSend;
+    GLSStats m_statsRecv;
 
 };
 
@@ -252,6 +396,29 @@ struct glsServerStr {
     char *m_privateKey;
     char *m_publicKeyFile;
     char *m_privateKeyFile;
+    struct glsServerCertStr* m_serverCert;
+
+    /* Handshakes in progress in waitForClient() */
+    struct glsSockStr* (*m_pending);
+    int m_nbPending;
+
+    /* Closed clients ready for the next ones (glsServerReleaseClient()) */
+    struct glsSockStr* (*m_pool);
+    int m_nbPool;
+    pthread_mutex_t m_mutexPool;
+
+    /* Event loop (glsServerRun()) */
+    int m_epoll;
+    int m_wakePipe[2];
+    int m_isRunning;
+    const struct glsServerCallbackStr* m_callbacks;
+    void* m_userData;
+    struct glsEventConnStr* m_conns;
+    pthread_mutex_t m_mutexConns;
+    time_t m_lastExpire;
+
+    /* Statistics of the clients gone (glsServerGetStats()) */
+    GLSStats m_stats;
 
 };
 
@@ -259,8 +426,31 @@ struct glsServerStr {
 typedef struct glsSockStr GLSSock;
 typedef struct glsServerStr GLSServerSock;
 
+/*
+ * Callbacks of the event loop server, see glsServerRun()
+ */
+struct glsServerCallbackStr {
+
+    int (*onHandShake)(GLSSock* myClient, void* userData);
+    void (*onConnect)(GLSSock* myClient, void* userData);
+    void (*onMessage)(GLSSock* myClient, byte* buffer, const int size, void* userData);
+    void (*onClose)(GLSSock* myClient, const int error, void* userData);
+
+};
+typedef struct glsServerCallbackStr GLSServerCallback;
+
+
 
 
+/*
+ * Initialise libgcrypt (with sizeMem bytes of secure memory if secureMem
+ * is 1) and the ASN.1 definitions. Called by GLSSocketSecure(), only
+ * the first call does the work, call it at the start of your application
+ * to choose the secure memory before the first socket.
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsGlobalInit(const int secureMem, const int sizeMem);
 
 /*
  * GLSSocket use libgcrypt, if your application use it too
@@ -291,10 +481,33 @@ void freeGLSSocket(GLSSock* myGLSSocket);
  */
 int connexion(GLSSock* myGLSSocket, const char* address, const char* port);
 
+/*
+ * Same as connexion() without blocking, to connect many sockets from
+ * one thread. glsConnectStart() starts the handshake, then call
+ * glsConnectPoll() each time the socket of glsGetSocket() is ready for
+ * what was asked : GLS_WAIT_READ or GLS_WAIT_WRITE. The handshake must
+ * finish in GLS_TIMEOUT_HANDSHAKE seconds (configurable in GLSHeaders.h,
+ * checked by glsConnectPoll()).
+ *
+ * A name not in the DNS cache is resolved by a thread of the library,
+ * glsGetSocket() is a pipe until then and keeps its number for the
+ * connexion (with epoll, add it again when GLS_WAIT_WRITE is asked).
+ *
+ * Return 0 when connected, GLS_WAIT_READ or GLS_WAIT_WRITE to wait for
+ * the socket, or a negative number for an error (the socket is closed).
+ */
+int glsConnectStart(GLSSock* myGLSSocket, const char* address, const char* port);
+int glsConnectPoll(GLSSock* myGLSSocket);
+int glsGetSocket(GLSSock* myGLSSocket);
+
 /*
  * Send an register message to a GLS Server. You need to
  * add a root certificate first with addRootCertificate().
  *
+ * A GLS/1.2 server only decrypts a session key with its
+ * private key and the message with the session key, older
+ * servers get the message encrypted with the public key.
+ *
  * Return 0 for success, a negative number for an error.
  */
 int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, const byte* buffer, const int sizeBuffer);
@@ -302,6 +515,12 @@ int sendRegister(GLSSock* myGLSSocket, const char* address, const char* port, co
 /*
  * For Server - Get the register message send by sendRegister().
  *
+ * The message is decrypted at the first call and not by
+ * waitForClient(), call it on a thread of your own to keep
+ * accepting the clients. The rounds of a big message encrypted
+ * with the public key are decrypted on the threads set by
+ * glsSetCryptoThreads().
+ *
  * You are responsible for deallocating message with free().
  *
  * Return the message's size or a negative number for an error.
@@ -325,6 +544,88 @@ int glsSend(GLSSock* myGLSSocket, const byte* buffer, const int sizeBuffer);
  */
 int glsRecv(GLSSock* myGLSSocket, byte** buffer);
 
+/*
+ * Same as glsSend() without copy, the message must start at
+ * buffer + GLS_SIZE_HEADROOM and the GLS_SIZE_HEADROOM bytes in
+ * front of it are used for the encryption header. The buffer is
+ * encrypted in place so its content is lost after the call.
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsSendInPlace(GLSSock* myGLSSocket, byte* buffer, const int sizeBuffer);
+
+/*
+ * Set the number of messages glsSend() can send without waiting
+ * for their acknowledgement (1 = wait after each message, default).
+ * With a window > 1 the acknowledgements are cumulative and
+ * glsSend() only blocks when the window is full, the peer can keep
+ * its own window. The window can only be changed when all the
+ * messages have been acknowledged.
+ *
+ * A window > 1 needs an AEAD suite (GLS_SUITE_AES256_GCM or
+ * GLS_SUITE_CHACHA20_POLY1305, see glsSetCipherSuite()) and is set
+ * after the handshake : the Serpent/Twofish suites chain the IVs of
+ * both directions and can't have messages in flight both ways (with
+ * them, only one side sends until its message is read by the peer).
+ * GLS_ERROR_NOTCONN before the handshake, GLS_ERROR_OPNOTSUPP with
+ * another suite.
+ *
+ * With a window > 1 glsSend() reads the socket for the
+ * acknowledgements, the messages of the peer arriving first are kept
+ * for glsRecv(). glsSend() and glsRecv() can't run at the same time on
+ * the socket from two threads anymore.
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsSetSendWindow(GLSSock* myGLSSocket, const int window);
+
+/*
+ * Wait for the acknowledgement of all the messages sent with
+ * glsSend() in pipelined mode.
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsFlush(GLSSock* myGLSSocket);
+
+/*
+ * Choose the cipher suite used after the handshake, call it before
+ * connexion() or finishHandShake(). The client offers the AEAD suites
+ * (GLS/1.2 Hello) and the server chooses with its own setting, the
+ * default GLS_SUITE_SERPENT_TWOFISH is kept with an old peer.
+ * The AEAD suites need libgcrypt 1.7 or newer (GLS_ERROR_OPNOTSUPP
+ * with the bundled libgcrypt 1.5.2).
+ * GLS_SUITE_SERPENT_TWOFISH_CTR is the same cascade in counter mode,
+ * big messages are encrypted by the threads of glsSetCryptoThreads().
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsSetCipherSuite(GLSSock* myGLSSocket, const int suite);
+
+/*
+ * Return the cipher suite negotiated during the handshake or a
+ * negative number for an error.
+ */
+int glsGetCipherSuite(GLSSock* myGLSSocket);
+
+/*
+ * Set the number of threads (1 = no thread, default) used by all the
+ * sockets to encrypt and decrypt the big messages with the
+ * GLS_SUITE_SERPENT_TWOFISH_CTR suite. The calling thread is one of them.
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsSetCryptoThreads(const int nbThread);
+
+/*
+ * Set the size in bytes (multiple of 16) of the pool used to generate
+ * the IVs of a socket, the pool is filled in one call to the random
+ * generator when it's empty. 0 = a call for each IV.
+ * Default 4096 bytes (256 IVs).
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsSetIVPoolSize(GLSSock* myGLSSocket, const int size);
+
 /*
  * Add user's password, you can have 10 different password.
  * If the password is already in SHA-512, use the function
@@ -373,7 +674,9 @@ int setUserId(GLSSock* myGLSSocket, const char* userId);
 int finishHandShake(GLSSock* myGLSSocket);
 
 /*
- * Add a root certificate for the Register connexion. PEM format.
+ * Add a root certificate for the Register connexion. PEM format, it can
+ * hold many certificates. The roots are added to the ones of the socket,
+ * or to the list given to setRootList().
  * Return 0 for success, a negative number for an error.
  */
 int addRootCertificate(GLSSock* myGLSSocket, const char* cert);
@@ -385,11 +688,88 @@ int addRootCertificate(GLSSock* myGLSSocket, const char* cert);
 int addRootCertificateFromFile(GLSSock* myGLSSocket, const char* certFile);
 
 /*
- * Add a serial number to the CRL.
+ * Create a list of root certificates to share between many sockets with
+ * setRootList(). Each root is parsed and its signature checked once when
+ * added, the issuer of a server certificate is found by its name (and key
+ * identifier). Release it with freeGLSRootList(), the sockets using it
+ * keep it until they are freed.
+ *
+ * Return a pointer to the list or NULL if no memory.
+ */
+GLSRoots* GLSRootList();
+void freeGLSRootList(GLSRoots* roots);
+
+/*
+ * Add the root certificates of a PEM string or file (one or more
+ * certificates) to a list.
+ * Return the number of roots added or a negative number for an error.
+ */
+int addToRootList(GLSRoots* roots, const char* cert);
+int loadRootList(GLSRoots* roots, const char* fileName);
+
+/*
+ * Check the server certificates of the socket with a shared list of
+ * root certificates instead of the roots of addRootCertificate().
+ * Return 0 for success, a negative number for an error.
+ */
+int setRootList(GLSSock* myGLSSocket, GLSRoots* roots);
+
+/*
+ * Add a serial number (hexadecimal) to the CRL of the socket, or to
+ * the list given to setCrlList().
  * Return 0 for success, a negative number for an error.
  */
 int addToCrl(GLSSock* myGLSSocket, const char* serial);
 
+/*
+ * Create a revocation list to share between many sockets with
+ * setCrlList(), a search costs log2(number of serials). Release it
+ * with freeGLSCrlList(), the sockets using it keep it until they
+ * are freed.
+ *
+ * Return a pointer to the list or NULL if no memory.
+ */
+GLSCrl* GLSCrlList();
+void freeGLSCrlList(GLSCrl* crl);
+
+/*
+ * Add a serial number (hexadecimal) to a revocation list.
+ * Return 0 for success, a negative number for an error.
+ */
+int addToCrlList(GLSCrl* crl, const char* serial);
+
+/*
+ * Add all the serial numbers of a file to a revocation list : DER X.509
+ * CRL (the signature is not checked) or text file with one hexadecimal
+ * serial number by line.
+ *
+ * Return the number of serial numbers read or a negative number for an error.
+ */
+int loadCrlList(GLSCrl* crl, const char* fileName);
+
+/*
+ * Check the server certificates of the socket with a shared revocation
+ * list instead of the list of addToCrl().
+ * Return 0 for success, a negative number for an error.
+ */
+int setCrlList(GLSSock* myGLSSocket, GLSCrl* crl);
+
+/*
+ * The server certificates verified with a root are kept by the library
+ * (process wide) until one of the two expires, a new register with the
+ * same certificates only checks the CRL. Empty the cache, if the time of
+ * the system was changed for example.
+ */
+void glsClearCertificateCache(void);
+
+/*
+ * The names of the servers given to connexion() and sendRegister() are
+ * kept by the library (process wide) GLS_DNS_TTL seconds, the unknown
+ * names GLS_DNS_NEGATIVE_TTL seconds (configurable in GLSHeaders.h).
+ * Empty the cache, if /etc/hosts or the network changed for example.
+ */
+void glsClearDnsCache(void);
+
 
 
 /*
@@ -422,12 +802,90 @@ int initServer(GLSServerSock* myGLSServerSock, const char *port, const int waitQ
 
 /*
  * Wait for a connexion and allocate a GLSSock on myClient.
- * You are responsible for deallocating the socket with freeGLSSocket().
+ * You are responsible for deallocating the socket with freeGLSSocket()
+ * or glsServerReleaseClient().
+ *
+ * The handshakes of the waiting clients go on at the same time, a
+ * slow client doesn't delay the others and is closed after 10
+ * seconds. The handshakes still in progress are kept by the server
+ * for the next call.
  *
  * Return 0 for success, a negative number for an error.
  */
 int waitForClient(GLSServerSock* myGLSServerSock, GLSSock** myClient);
 
+/*
+ * Close a client of waitForClient() like freeGLSSocket() but keep the
+ * socket, its keys buffers and its cipher handlers (the keys are
+ * wiped) for the next client of the server. The clients of
+ * glsServerRun() are always kept this way. The socket must not be
+ * used after the call.
+ */
+void glsServerReleaseClient(GLSServerSock* myGLSServerSock, GLSSock* myClient);
+
+/*
+ * Serve the clients with an event loop instead of waitForClient(),
+ * nbThread threads (the calling thread is one of them) share all the
+ * connexions and call the callbacks when a client is ready (Linux only).
+ * The callbacks of a client are never called at the same time and a
+ * NULL callback is ignored :
+ *
+ * onHandShake : Hello or Register message received. For a standard
+ *   connexion add the user's key with addKey() and return 0 to finish
+ *   the handshake, another value closes the connexion. A register
+ *   connexion is closed after the call.
+ * onConnect : handshake finished.
+ * onMessage : message received, the buffer is freed after the call.
+ * onClose : connexion closed (error = 0 or the error which closed it),
+ *   the GLSSock is freed after the call.
+ *
+ * Use glsSend() only from the callbacks of the client, it never blocks
+ * the thread : the packets wait for the socket when it's full and the
+ * acknowledgement is read by the loop, GLS_ERROR_AGAIN with 64
+ * messages already waiting for theirs (glsFlush() too). A client which
+ * doesn't read our packets or acknowledge our messages for 3 seconds
+ * is closed. The function returns after glsServerStop(), all the
+ * connexions are then closed.
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsServerRun(GLSServerSock* myGLSServerSock, const GLSServerCallback* callbacks, void* userData, const int nbThread);
+
+/*
+ * Stop glsServerRun(), can be called from a callback or another thread.
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsServerStop(GLSServerSock* myGLSServerSock);
+
+/*
+ * Statistics of a socket since its creation. The counters are
+ * updated without lock by glsSend() and glsRecv() and can be read
+ * from any thread, a message in progress may be partly counted.
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsGetStats(GLSSock* myGLSSocket, GLSStats* stats);
+
+/*
+ * Statistics of a server : the handshakes of waitForClient() and the
+ * sum of all the clients of glsServerRun(), connected or closed.
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsServerGetStats(GLSServerSock* myGLSServerSock, GLSStats* stats);
+
+/*
+ * Secure memory used by all the sockets. A socket holds GLS_SIZE_SECRET
+ * bytes and 64 bytes for each key after the first one, the handlers
+ * of the AEAD suites and of GLS_SUITE_SERPENT_TWOFISH_CTR are also in
+ * the pool (not counted here). Use the high water mark to choose the
+ * size of the pool for glsGlobalInit().
+ *
+ * Return 0 for success, a negative number for an error.
+ */
+int glsGetSecureMemory(GLSSecureMem* secureMem);
+
 /*
  * Add the server certificate from a file for the Register connexion. PEM format.
  * Return 0 for success, a negative number for an error.
@@ -0,0 +1,192 @@
+/*
+ *  latency.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Latency of a 100 bytes glsSend() / glsRecv() round trip on loopback,
+ * with an echo server. Fails if the median round trip is longer than
+ * the limit (milliseconds, 5 by default).
+ *
+ *   ./latency [limit] [port]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "libgls.h"
+
+#define NB_ROUND_TRIP 1000
+#define SIZE_MESSAGE 100
+
+static GLSServerSock* m_server = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ Time in microseconds.
+
+ ---------------------------------------------------------*/
+
+static unsigned long long timeMicro(void) {
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    return (unsigned long long) now.tv_sec * 1000000 + now.tv_usec;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Sort of the round trips.
+
+ ---------------------------------------------------------*/
+
+static int compareTime(const void* a, const void* b) {
+
+    unsigned long long timeA = *(const unsigned long long*) a;
+    unsigned long long timeB = *(const unsigned long long*) b;
+
+    return (timeA > timeB) - (timeA < timeB);
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Echo server thread, one client.
+
+ ---------------------------------------------------------*/
+
+static void* echoServer(void* arg) {
+
+    (void) arg;
+
+    GLSSock* client = 0;
+    if (waitForClient(m_server, &client) != 0) return NULL;
+
+    addKey(client, "myPassword", 0);
+    if (finishHandShake(client) == 0) {
+
+        while (1) {
+
+            byte (*message) = 0;
+            int size = glsRecv(client, &message);
+            if (size < 0) break;
+
+            int error = glsSend(client, message, size);
+            free(message);
+            if (error != 0) break;
+
+        }
+
+    }
+
+    freeGLSSocket(client);
+
+    return NULL;
+
+}
+
+
+
+
+int main(int argc, const char* argv[]) {
+
+    double limit = (argc > 1) ? atof(argv[1]) : 5.0;
+    const char* port = (argc > 2) ? argv[2] : "61101";
+
+    /* Listening before the client connects, above the ephemeral ports */
+    m_server = GLSServer();
+    int error = initServer(m_server, port, 1, 0);
+    if (error != 0) {
+
+        printf("latency : initServer() error %d\n", error);
+
+        return 1;
+
+    }
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, echoServer, NULL);
+
+    GLSSock* client = GLSSocket();
+    setUserId(client, "myUserId");
+    addKey(client, "myPassword", 0);
+    error = connexion(client, "127.0.0.1", port);
+    if (error != 0) {
+
+        printf("latency : connexion() error %d\n", error);
+
+        return 1;
+
+    }
+
+    byte message[SIZE_MESSAGE];
+    memset(message, 'a', SIZE_MESSAGE);
+    unsigned long long roundTrip[NB_ROUND_TRIP];
+    int i = 0;
+
+    for (i = 0; i < NB_ROUND_TRIP; i++) {
+
+        unsigned long long timeStart = timeMicro();
+
+        byte (*answer) = 0;
+        error = glsSend(client, message, SIZE_MESSAGE);
+        if (error == 0) error = glsRecv(client, &answer);
+        if (error != SIZE_MESSAGE || memcmp(answer, message, SIZE_MESSAGE) != 0) {
+
+            printf("latency : bad echo %d at round trip %d\n", error, i);
+
+            return 1;
+
+        }
+        free(answer);
+
+        roundTrip[i] = timeMicro() - timeStart;
+
+    }
+
+    freeGLSSocket(client);
+    pthread_join(thread, NULL);
+    freeGLSServer(m_server);
+
+    qsort(roundTrip, NB_ROUND_TRIP, sizeof(unsigned long long), compareTime);
+    double median = roundTrip[NB_ROUND_TRIP / 2] / 1000.0;
+    double p99 = roundTrip[NB_ROUND_TRIP * 99 / 100] / 1000.0;
+
+    printf("latency : %d round trips of %d bytes, median %.3f ms, p99 %.3f ms (limit %.1f ms)\n", NB_ROUND_TRIP, SIZE_MESSAGE, median, p99, limit);
+
+    if (median > limit) return 1;
+
+    return 0;
+
+}
@@ -0,0 +1,315 @@
+/*
+ *  resolver.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Cache of the resolved names, against a DNS server answering on
+ * 127.0.0.1:53 (the nameserver of /etc/resolv.conf must be 127.0.0.1,
+ * the test is skipped otherwise). Built with GLS_DNS_TTL 2 and
+ * GLS_DNS_NEGATIVE_TTL 1.
+ *
+ *   ok.gls.test    127.0.0.1
+ *   nx.gls.test    unknown name (NXDOMAIN)
+ *   fail.gls.test  server failure (SERVFAIL)
+ *
+ * The connexions are made to a closed port, a resolved name gives
+ * GLS_ERROR_CONNREFUSED.
+ *
+ *   ./resolver [port]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include "GLSHeaders.h"
+
+#define NAME_OK "ok.gls.test"
+#define NAME_NX "nx.gls.test"
+#define NAME_FAIL "fail.gls.test"
+
+static int m_dnsSock = -1;
+static int m_nbQuery[3];
+static pthread_mutex_t m_mutexQuery = PTHREAD_MUTEX_INITIALIZER;
+static const char* m_port = "45201";
+static int m_nbError = 0;
+
+
+
+
+/*-------------------------------------------------------
+
+ Stub DNS server thread, one answer per query.
+
+ ---------------------------------------------------------*/
+
+static void* dnsServer(void* arg) {
+
+    (void) arg;
+
+    unsigned char query[512];
+    unsigned char answer[512];
+
+    while (1) {
+
+        struct sockaddr_in from;
+        socklen_t sizeFrom = sizeof(from);
+        int size = recvfrom(m_dnsSock, query, sizeof(query), 0, (struct sockaddr*) &from, &sizeFrom);
+        if (size < 12) continue;
+
+        /* Name of the question, labels to dotted string */
+        char name[256];
+        int sizeName = 0;
+        int index = 12;
+        while (index < size && query[index] != 0 && sizeName + query[index] + 1 < (int) sizeof(name)) {
+            if (sizeName > 0) name[sizeName++] = '.';
+            memcpy(name + sizeName, query + index + 1, query[index]);
+            sizeName += query[index];
+            index += query[index] + 1;
+        }
+        name[sizeName] = 0;
+        if (index + 5 > size) continue;
+        int type = (query[index + 1] << 8) | query[index + 2];
+        int sizeQuestion = index + 5;
+
+        int kind = -1;
+        if (strcmp(name, NAME_OK) == 0) kind = 0;
+        else if (strcmp(name, NAME_NX) == 0) kind = 1;
+        else if (strcmp(name, NAME_FAIL) == 0) kind = 2;
+
+        if (kind >= 0) {
+            pthread_mutex_lock(&m_mutexQuery);
+            m_nbQuery[kind]++;
+            pthread_mutex_unlock(&m_mutexQuery);
+        }
+
+        /* Header: same id, response, recursion available */
+        memcpy(answer, query, sizeQuestion);
+        answer[2] = 0x81;
+        answer[3] = (kind == 0) ? 0x80 : (kind == 2) ? 0x82 : 0x83;
+        answer[6] = 0;
+        answer[7] = 0;
+        memset(answer + 8, 0, 4);
+        int sizeAnswer = sizeQuestion;
+
+        /* One A record, the AAAA question has no answer */
+        if (kind == 0 && type == 1) {
+            static const unsigned char record[] = {0xc0, 0x0c, 0, 1, 0, 1, 0, 0, 1, 0x2c, 0, 4, 127, 0, 0, 1};
+            memcpy(answer + sizeAnswer, record, sizeof(record));
+            sizeAnswer += sizeof(record);
+            answer[7] = 1;
+        }
+
+        sendto(m_dnsSock, answer, sizeAnswer, 0, (struct sockaddr*) &from, sizeFrom);
+
+    }
+
+    return NULL;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Number of queries received for a name.
+
+ ---------------------------------------------------------*/
+
+static int nbQuery(const int kind) {
+
+    pthread_mutex_lock(&m_mutexQuery);
+    int nb = m_nbQuery[kind];
+    pthread_mutex_unlock(&m_mutexQuery);
+
+    return nb;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Blocking connexion to a name (closed port).
+
+ ---------------------------------------------------------*/
+
+static int connectTo(const char* address) {
+
+    GLSSock* client = GLSSocketSecure(0, 0);
+    setUserId(client, "myUserId");
+    addKey(client, "myPassword", 0);
+    int error = connexion(client, address, m_port);
+    freeGLSSocket(client);
+
+    return error;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Connexion without blocking (glsConnectStart()), waits
+ with poll() on glsGetSocket().
+
+ ---------------------------------------------------------*/
+
+static int connectAsync(const char* address) {
+
+    GLSSock* client = GLSSocketSecure(0, 0);
+    setUserId(client, "myUserId");
+    addKey(client, "myPassword", 0);
+
+    int error = glsConnectStart(client, address, m_port);
+    while (error > 0) {
+
+        struct pollfd event;
+        event.fd = glsGetSocket(client);
+        event.events = (error == GLS_WAIT_WRITE) ? POLLOUT : POLLIN;
+        event.revents = 0;
+        poll(&event, 1, 5000);
+        error = glsConnectPoll(client);
+
+    }
+    freeGLSSocket(client);
+
+    return error;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Check a result and the number of queries it made.
+
+ ---------------------------------------------------------*/
+
+static void check(const char* step, const int error, const int expected, const int nbNew, const int isQuery) {
+
+    int isOk = (error == expected) && ((nbNew > 0) == isQuery);
+    if (!isOk) m_nbError++;
+
+    printf("resolver : %-32s %s (error %d, expected %d, %d queries)\n", step, isOk ? "ok" : "FAILED", error, expected, nbNew);
+
+}
+
+
+
+
+int main(int argc, const char* argv[]) {
+
+    if (argc > 1) m_port = argv[1];
+
+    /* The stub must be the nameserver */
+    FILE* resolvConf = fopen("/etc/resolv.conf", "r");
+    char line[256];
+    int isLocal = 0;
+    while (resolvConf != NULL && fgets(line, sizeof(line), resolvConf) != NULL) {
+        char server[64];
+        if (sscanf(line, "nameserver %63s", server) != 1) continue;
+        isLocal = (strcmp(server, "127.0.0.1") == 0);
+        break;
+    }
+    if (resolvConf != NULL) fclose(resolvConf);
+
+    struct sockaddr_in dnsAddr;
+    memset(&dnsAddr, 0, sizeof(dnsAddr));
+    dnsAddr.sin_family = AF_INET;
+    dnsAddr.sin_port = htons(53);
+    dnsAddr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    m_dnsSock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (!isLocal || m_dnsSock < 0 || bind(m_dnsSock, (struct sockaddr*) &dnsAddr, sizeof(dnsAddr)) != 0) {
+
+        printf("resolver : skipped, needs 127.0.0.1 as nameserver and the port 53\n");
+
+        return 0;
+
+    }
+
+    pthread_t thread;
+    pthread_create(&thread, NULL, dnsServer, NULL);
+    pthread_detach(thread);
+
+    int nb = 0;
+    int error = 0;
+
+    /* /etc/hosts, not sent to the server */
+    error = connectTo("localhost");
+    check("localhost (/etc/hosts)", error, GLS_ERROR_CONNREFUSED, 0, 0);
+
+    /* Resolved once, then from the cache */
+    nb = nbQuery(0);
+    error = connectTo(NAME_OK);
+    check("name resolved", error, GLS_ERROR_CONNREFUSED, nbQuery(0) - nb, 1);
+    nb = nbQuery(0);
+    error = connectTo(NAME_OK);
+    check("name cached", error, GLS_ERROR_CONNREFUSED, nbQuery(0) - nb, 0);
+    nb = nbQuery(0);
+    error = connectAsync(NAME_OK);
+    check("name cached (async)", error, GLS_ERROR_CONNREFUSED, nbQuery(0) - nb, 0);
+
+    /* Unknown name, kept GLS_DNS_NEGATIVE_TTL seconds */
+    nb = nbQuery(1);
+    error = connectAsync(NAME_NX);
+    check("unknown name (async)", error, GLS_ERROR_AI_NONAME, nbQuery(1) - nb, 1);
+    nb = nbQuery(1);
+    error = connectTo(NAME_NX);
+    check("unknown name cached", error, GLS_ERROR_AI_NONAME, nbQuery(1) - nb, 0);
+
+    /* Server failure, never kept */
+    nb = nbQuery(2);
+    error = connectTo(NAME_FAIL);
+    check("server failure", error, GLS_ERROR_AI_AGAIN, nbQuery(2) - nb, 1);
+    nb = nbQuery(2);
+    error = connectAsync(NAME_FAIL);
+    check("server failure not cached", error, GLS_ERROR_AI_AGAIN, nbQuery(2) - nb, 1);
+
+    /* Both entries expired */
+    sleep((GLS_DNS_TTL > GLS_DNS_NEGATIVE_TTL ? GLS_DNS_TTL : GLS_DNS_NEGATIVE_TTL) + 1);
+
+    nb = nbQuery(1);
+    error = connectTo(NAME_NX);
+    check("unknown name expired", error, GLS_ERROR_AI_NONAME, nbQuery(1) - nb, 1);
+    nb = nbQuery(0);
+    error = connectAsync(NAME_OK);
+    check("name expired (async)", error, GLS_ERROR_CONNREFUSED, nbQuery(0) - nb, 1);
+
+    /* Emptied by glsClearDnsCache() */
+    glsClearDnsCache();
+    nb = nbQuery(0);
+    error = connectTo(NAME_OK);
+    check("name after glsClearDnsCache()", error, GLS_ERROR_CONNREFUSED, nbQuery(0) - nb, 1);
+
+    if (m_nbError != 0) return 1;
+
+    return 0;
+
+}
@@ -0,0 +1,147 @@
+/*
+ *  stress.c
+ *
+ *  Goswell Layer Security Project
+ *
+ *  Copyright (c) 2012 Goswell.
+ *
+ *  This library is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2.1 of the License, or (at
+ *  your option) any later version.
+ *
+ *  This library is distributed in the hope that it will be useful, but
+ *  WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public
+ *  License along with this library; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307,
+ *  USA.
+ *
+ */
+
+/*
+ * Creation of 10000 sockets by 16 threads started together, the first
+ * one initialises libgcrypt. Fails if a creation fails or if one takes
+ * longer than the limit (milliseconds, 500 by default), a thread waiting
+ * for the initialisation must never sleep.
+ *
+ *   ./stress [limit]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "libgls.h"
+
+#define NB_THREAD 16
+#define NB_SOCKET 625
+#define SIZE_SECURE_MEM 16000000
+
+static pthread_barrier_t m_barrier;
+static unsigned long long m_slowest[NB_THREAD];
+static int m_nbFailed[NB_THREAD];
+
+
+
+
+/*-------------------------------------------------------
+
+ Time in microseconds.
+
+ ---------------------------------------------------------*/
+
+static unsigned long long timeMicro(void) {
+
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    return (unsigned long long) now.tv_sec * 1000000 + now.tv_usec;
+
+}
+
+
+
+
+/*-------------------------------------------------------
+
+ Thread creating NB_SOCKET sockets, they are freed at
+ the end so all the sockets are alive together.
+
+ ---------------------------------------------------------*/
+
+static void* createSockets(void* arg) {
+
+    int index = *(int*) arg;
+    GLSSock* sockets[NB_SOCKET];
+    int i = 0;
+
+    pthread_barrier_wait(&m_barrier);
+
+    for (i = 0; i < NB_SOCKET; i++) {
+
+        unsigned long long timeStart = timeMicro();
+        sockets[i] = GLSSocketSecure(1, SIZE_SECURE_MEM);
+        unsigned long long timeCreate = timeMicro() - timeStart;
+
+        if (timeCreate > m_slowest[index]) m_slowest[index] = timeCreate;
+        if (sockets[i] == NULL) m_nbFailed[index]++;
+
+    }
+
+    for (i = 0; i < NB_SOCKET; i++) {
+
+        if (sockets[i] != NULL) freeGLSSocket(sockets[i]);
+
+    }
+
+    return NULL;
+
+}
+
+
+
+
+int main(int argc, const char* argv[]) {
+
+    double limit = (argc > 1) ? atof(argv[1]) : 500.0;
+
+    pthread_t threads[NB_THREAD];
+    int indexes[NB_THREAD];
+    int i = 0;
+
+    pthread_barrier_init(&m_barrier, NULL, NB_THREAD + 1);
+
+    for (i = 0; i < NB_THREAD; i++) {
+
+        indexes[i] = i;
+        pthread_create(&threads[i], NULL, createSockets, &indexes[i]);
+
+    }
+
+    unsigned long long timeStart = timeMicro();
+    pthread_barrier_wait(&m_barrier);
+
+    unsigned long long slowest = 0;
+    int nbFailed = 0;
+
+    for (i = 0; i < NB_THREAD; i++) {
+
+        pthread_join(threads[i], NULL);
+        if (m_slowest[i] > slowest) slowest = m_slowest[i];
+        nbFailed += m_nbFailed[i];
+
+    }
+
+    double total = (timeMicro() - timeStart) / 1000.0;
+    pthread_barrier_destroy(&m_barrier);
+
+    printf("stress : %d sockets by %d threads in %.1f ms, slowest %.3f ms, %d failed (limit %.1f ms)\n", NB_THREAD * NB_SOCKET, NB_THREAD, total, slowest / 1000.0, nbFailed, limit);
+
+    if (nbFailed != 0 || slowest / 1000.0 > limit) return 1;
+
+    return 0;
+
+}